@@ -30,6 +30,12 @@
  * - QuicServer sends data to QuicClient
  * - Tracing of queues and packet receptions to file "quic-example.tr"
  *   and pcap tracing available when tracing is turned on.
+ * - Request latency/throughput and client packet receptions are streamed
+ *   to data/quic/*.qres; the FlowMonitor XML is only written with
+ *   --flowmonXml.
+ * - --QuicProfilerSummary=- prints the wall-clock time spent per QUIC
+ *   subsystem and simulated second, --QuicProfilerTrace=quic.json writes
+ *   it as a Chrome trace.
  */
 
 #include "ns3/core-module.h"
@@ -61,36 +67,62 @@ Time last_time(Ptr<FlowMonitor> fm) {
 
 
 
-void latency_throughput_plot(Ptr<FlowMonitor> fm, string name) {
+/*
+ * Samples are streamed to QuicResultsWriter files while the simulation runs,
+ * so the memory and end-of-run cost do not grow with the length of the run.
+ * Use experiments/qres2dat.py to turn them into gnuplot data.
+ */
+void
+StreamComplete (Ptr<QuicResultsWriter> writer, uint64_t requestId,
+                uint64_t bytes, Time latency)
+{
+  double seconds = latency.GetSeconds ();
+  writer->Write (latency.GetNanoSeconds (),
+                 seconds > 0 ? bytes * 8 / seconds : 0.0);
+}
 
-  AsciiTraceHelper asciiTraceHelper;
-  Ptr<OutputStreamWrapper> stream1 = asciiTraceHelper.CreateFileStream ("data/quic/first_flow_" + name + "_p" + ".dat");
-  Ptr<OutputStreamWrapper> stream2 = asciiTraceHelper.CreateFileStream ("data/quic/second_flow_" + name + "_p" + ".dat");
-  
-  int i = 0;
+void
+PacketReceived (Ptr<QuicResultsWriter> writer, Ptr<const Packet> packet,
+                const Address &from)
+{
+  writer->Write (Simulator::Now ().GetNanoSeconds (), packet->GetSize ());
+}
 
-  for(auto e : fm->GetFlowStats())
-  {
-      if(i)
-      {
-        for(uint32_t i = 0; i< e.second.delays_container.size(); i++)
-        {
-           *stream1->GetStream ()<< e.second.delays_container[i].GetNanoSeconds () << "\t" <<
-                        e.second.throughputs_container[i] << std::endl;
-        }
-      }
-      else
-      {
-        for(uint32_t i = 0; i< e.second.delays_container.size(); i++)
-          {
-            *stream2->GetStream () << e.second.delays_container[i].GetNanoSeconds () << "\t" <<
-                         e.second.throughputs_container[i] << std::endl;
-          }
-      }
-      i++;
-  }
-  
-  std::cout << i << std::endl;
+void
+ReportPercentiles (const QuicPercentiles &latency,
+                   const QuicPercentiles &throughput)
+{
+  std::cout << Simulator::Now ().As (Time::S) << " " << latency.count
+            << " requests, latency p50/p99/p99.9 "
+            << NanoSeconds (latency.p50).As (Time::MS) << " "
+            << NanoSeconds (latency.p99).As (Time::MS) << " "
+            << NanoSeconds (latency.p999).As (Time::MS)
+            << ", throughput p50/p99/p99.9 " << throughput.p50 << " "
+            << throughput.p99 << " " << throughput.p999 << " bps" << std::endl;
+}
+
+void
+PrintPercentiles (string metric, const QuicQuantileSketch &sketch,
+                  double percentile)
+{
+  std::cout << metric << ": " << sketch.GetCount () << " samples, p50 "
+            << sketch.GetQuantile (0.5) << ", p99 " << sketch.GetQuantile (0.99)
+            << ", p99.9 " << sketch.GetQuantile (0.999) << ", p" << percentile * 100
+            << " " << sketch.GetQuantile (percentile) << std::endl;
+}
+
+Ptr<QuicResultsWriter>
+CreateResultsWriter (string filename, bool compress, string firstColumn,
+                     QuicResultsWriter::ColumnType firstType,
+                     string secondColumn,
+                     QuicResultsWriter::ColumnType secondType)
+{
+  Ptr<QuicResultsWriter> writer = CreateObject<QuicResultsWriter> ();
+  writer->SetAttribute ("Compress", BooleanValue (compress));
+  writer->AddColumn (firstColumn, firstType);
+  writer->AddColumn (secondColumn, secondType);
+  writer->Open (filename);
+  return writer;
 }
 
 
@@ -104,7 +136,11 @@ main (int argc, char *argv[])
   uint64_t maxBytes = 100000;
   double err = 0.1;
   double percentile = 0.999;
-  uint64_t maxPacketSize = 128;
+  uint64_t maxPacketSize = 1350;
+  string mtuDiscovery = "None";
+  bool compress = false;
+  bool flowmonXml = false;
+  double reportInterval = 0;
 
   string dataRate = "1Mbps";
   string delay = "0ms";
@@ -116,8 +152,22 @@ main (int argc, char *argv[])
   cmd.AddValue("dataRate", " ", dataRate);
   cmd.AddValue("delay", " ", delay);
   cmd.AddValue("err", " ", err);
-  cmd.AddValue("percentile", "enter the percentile", percentile);
-  cmd.AddValue("packetSize", "enter the packet size", maxPacketSize);
+  cmd.AddValue("percentile",
+               "Quantile of latency and throughput to report, besides "
+               "p50, p99 and p99.9", percentile);
+  cmd.AddValue("packetSize",
+               "Initial maximum QUIC packet size, at most the link MTU minus 48",
+               maxPacketSize);
+  cmd.AddValue("mtuDiscovery",
+               "Path MTU discovery target: None, Low, High or Jumbo",
+               mtuDiscovery);
+  cmd.AddValue("compress", "Compress the binary results files", compress);
+  cmd.AddValue("flowmonXml",
+               "Write the FlowMonitor XML, with histograms and probes",
+               flowmonXml);
+  cmd.AddValue("reportInterval",
+               "Seconds between percentile reports, 0 for the end only",
+               reportInterval);
 
   cmd.Parse (argc,argv);
 
@@ -152,9 +202,29 @@ main (int argc, char *argv[])
   uint16_t port = 6121;
   QuicClientHelper clientHelper ("ns3::UdpSocketFactory",
                          InetSocketAddress (interfaces.GetAddress (1), port), true, maxBytes, maxPacketSize);
+  clientHelper.SetAttribute ("PercentileInterval",
+                             TimeValue (Seconds (reportInterval)));
+  clientHelper.SetAttribute ("MtuDiscovery", StringValue (mtuDiscovery));
   ApplicationContainer clientApps = clientHelper.Install (nodes.Get (0));
+  clientApps.Get (0)->TraceConnectWithoutContext (
+    "Percentiles", MakeCallback (&ReportPercentiles));
   clientApps.Start (Seconds (0.0));
 
+  string name = dataRate + "_" + std::to_string (maxPacketSize);
+  Ptr<QuicResultsWriter> latencyWriter =
+    CreateResultsWriter ("data/quic/latency_throughput_" + name + ".qres",
+                         compress,
+                         "latency_ns", QuicResultsWriter::INT64,
+                         "throughput_bps", QuicResultsWriter::DOUBLE);
+  Ptr<QuicResultsWriter> rxWriter =
+    CreateResultsWriter ("data/quic/rx_" + name + ".qres", compress,
+                         "time_ns", QuicResultsWriter::INT64,
+                         "bytes", QuicResultsWriter::INT64);
+  clientApps.Get (0)->TraceConnectWithoutContext (
+    "StreamComplete", MakeBoundCallback (&StreamComplete, latencyWriter));
+  clientApps.Get (0)->TraceConnectWithoutContext (
+    "Rx", MakeBoundCallback (&PacketReceived, rxWriter));
+
   /* Server */
   QuicServerHelper serverHelper ("ns3::UdpSocketFactory",
                          InetSocketAddress (interfaces.GetAddress (1), port),
@@ -180,10 +250,19 @@ main (int argc, char *argv[])
 
   std::cout << "Now " << last_time(flowMonitor).As(Time::S) << std::endl;
   //flowMonitor->SerializeToXmlFile("data/quic_simple_" + std::to_string(maxBytes) + "_" + dataRate + "_" + delay + "_" + std::to_string(err) + "_" + std::to_string(percentile) + ".xml", false, false);
-  flowMonitor->SerializeToXmlFile("data/quic/quic_simple_aghax.xml", true, true);
-  latency_throughput_plot(flowMonitor, dataRate + "_" + std::to_string(maxPacketSize));
+  if (flowmonXml)
+    {
+      flowMonitor->SerializeToXmlFile ("data/quic/quic_simple_aghax.xml",
+                                       true, true);
+    }
+  latencyWriter->Close ();
+  rxWriter->Close ();
+  std::cout << latencyWriter->GetRecords () << " requests, "
+            << rxWriter->GetRecords () << " packets recorded" << std::endl;
+  Ptr<QuicClient> client = DynamicCast<QuicClient> (clientApps.Get (0));
+  PrintPercentiles ("Latency (ns)", client->GetLatencySketch (), percentile);
+  PrintPercentiles ("Throughput (bps)", client->GetThroughputSketch (),
+                    percentile);
   Simulator::Destroy ();
-  //Ptr<QuicClient> client = DynamicCast<QuicClient> (clientApps.Get (0));
-  //std::cout << "Total Bytes Received: " << client->GetTotalRx () << std::endl;
   return 0;
 }
@@ -0,0 +1,109 @@
+#! /usr/bin/env python
+# -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
+#
+# Converts the binary results files written by ns3::QuicResultsWriter (.qres)
+# into the tab-separated text the gnuplot scripts in plots/ read.
+#
+#   python src/quic/experiments/qres2dat.py data/quic/latency_throughput_1Mbps_128.qres
+#   python src/quic/experiments/qres2dat.py --columns throughput_bps,latency_ns \
+#       --out data/quic/second_flow.dat data/quic/latency_throughput_1Mbps_128.qres
+#
+# Without --out, every <name>.qres is written next to itself as <name>.dat.
+# Blocks are decoded one at a time, so memory stays bounded by one block.
+
+import argparse
+import struct
+import sys
+import zlib
+
+MAGIC = b'QRES'
+VERSION = 1
+FLAG_COMPRESSED = 1
+TYPES = {0: 'q', 1: 'd'}  # int64, double
+
+
+def read_exactly(source, size):
+    data = source.read(size)
+    if len(data) != size:
+        raise ValueError('truncated file')
+    return data
+
+
+def read_header(source):
+    magic, version, columns, flags = struct.unpack('<4sIII', read_exactly(source, 16))
+    if magic != MAGIC:
+        raise ValueError('not a results file')
+    if version != VERSION:
+        raise ValueError('unsupported version %d' % version)
+    names, types = [], []
+    for _ in range(columns):
+        column_type, length = struct.unpack('<BB', read_exactly(source, 2))
+        if column_type not in TYPES:
+            raise ValueError('unknown column type %d' % column_type)
+        names.append(read_exactly(source, length).decode('utf-8'))
+        types.append(TYPES[column_type])
+    return names, types, bool(flags & FLAG_COMPRESSED)
+
+
+def records(source):
+    """Yields the column names, then every record as a tuple."""
+    names, types, compressed = read_header(source)
+    yield names
+    while True:
+        head = source.read(8)
+        if not head:
+            return
+        if len(head) != 8:
+            raise ValueError('truncated block')
+        count, size = struct.unpack('<II', head)
+        payload = read_exactly(source, size)
+        if compressed:
+            payload = zlib.decompress(payload)
+        columns = [struct.unpack_from('<%d%s' % (count, kind), payload, 8 * count * i)
+                   for i, kind in enumerate(types)]
+        for record in zip(*columns):
+            yield record
+
+
+def convert(path, out, selected):
+    with open(path, 'rb') as source:
+        rows = records(source)
+        names = next(rows)
+        if selected:
+            missing = [name for name in selected if name not in names]
+            if missing:
+                raise ValueError('no column %s' % ', '.join(missing))
+            indexes = [names.index(name) for name in selected]
+        else:
+            indexes = list(range(len(names)))
+        with open(out, 'w') as dat:
+            dat.write('# %s\n' % '\t'.join(names[i] for i in indexes))
+            for record in rows:
+                dat.write('\t'.join(repr(record[i]) for i in indexes))
+                dat.write('\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Convert QUIC binary results files to gnuplot data.')
+    parser.add_argument('files', nargs='+', help='.qres files to convert')
+    parser.add_argument('--columns', default='',
+                        help='comma-separated columns to write, in order '
+                             '(default: all)')
+    parser.add_argument('--out', help='output file (only with a single input)')
+    args = parser.parse_args()
+
+    if args.out and len(args.files) != 1:
+        sys.exit('--out needs exactly one input file')
+    selected = [name for name in args.columns.split(',') if name]
+    for path in args.files:
+        out = args.out or (path[:-len('.qres')] if path.endswith('.qres') else path) + '.dat'
+        try:
+            convert(path, out, selected)
+        except (IOError, ValueError, zlib.error) as error:
+            sys.exit('%s: %s' % (path, error))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
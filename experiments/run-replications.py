@@ -0,0 +1,198 @@
+#! /usr/bin/env python
+# -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
+#
+# Runs independent replications of a QUIC experiment concurrently and merges
+# their outputs into one summary.
+#
+# Every (parameter point, replication) pair is a separate ns-3 process with
+# its own working directory and its own RNG stream (--RngSeed is fixed, --RngRun
+# is derived from the replication index), so a sweep is reproducible no
+# matter how many jobs run at once or in which order they finish.
+#
+# Run it from the top of the ns-3 tree after building:
+#
+#   ./waf build
+#   python src/quic/experiments/run-replications.py --program quic-example \
+#       --runs 10 --param dataRate=1Mbps,10Mbps --param err=0,0.01 \
+#       --out results/quic-sweep
+#
+# Layout of the output directory:
+#
+#   <out>/<point>/run-<n>/          working directory of one replication
+#   <out>/merged/<name>.dat         every replication's data/**/<name>.dat,
+#                                   one gnuplot data block (index) per run;
+#                                   .qres results files are converted first
+#   <out>/summary.csv               one row per flow of every FlowMonitor XML
+
+import argparse
+import csv
+import itertools
+import multiprocessing
+import os
+import subprocess
+import sys
+import xml.etree.ElementTree as ElementTree
+from concurrent.futures import ThreadPoolExecutor
+
+import qres2dat
+
+# Directories the experiment programs write into, relative to their cwd.
+OUTPUT_DIRS = ['data', os.path.join('data', 'quic'), os.path.join('data', 'tcp')]
+
+FLOW_FIELDS = ['txPackets', 'rxPackets', 'lostPackets', 'txBytes', 'rxBytes']
+
+
+def parse_params(specs):
+    """Turns ['a=1,2', 'b=x'] into [('a', ['1', '2']), ('b', ['x'])]."""
+    params = []
+    for spec in specs:
+        name, _, values = spec.partition('=')
+        if not name or not values:
+            sys.exit('bad --param "%s", expected name=v1,v2,...' % spec)
+        params.append((name, values.split(',')))
+    return params
+
+
+def point_name(point):
+    if not point:
+        return 'default'
+    return '_'.join('%s-%s' % (name, value) for name, value in point)
+
+
+def run_one(args, point, run):
+    workdir = os.path.abspath(os.path.join(args.out, point_name(point), 'run-%d' % run))
+    for sub in OUTPUT_DIRS:
+        path = os.path.join(workdir, sub)
+        if not os.path.isdir(path):
+            os.makedirs(path)
+    # QuicServer loads its certificates from src/quic/... relative to the cwd.
+    src = os.path.join(workdir, 'src')
+    if not os.path.lexists(src):
+        os.symlink(os.path.abspath(os.path.join(args.ns3_dir, 'src')), src)
+
+    program = [args.program]
+    program += ['--%s=%s' % (name, value) for name, value in point]
+    program += ['--RngSeed=%d' % args.seed, '--RngRun=%d' % (args.first_run + run)]
+    command = [args.waf, '--run-no-build', ' '.join(program), '--cwd=%s' % workdir]
+
+    with open(os.path.join(workdir, 'stdout.log'), 'w') as log:
+        status = subprocess.call(command, cwd=args.ns3_dir, stdout=log,
+                                 stderr=subprocess.STDOUT)
+    return point, run, workdir, status
+
+
+def nanoseconds(value):
+    # FlowMonitor writes times as e.g. "+1.5e+06ns".
+    return float(value.lstrip('+').rstrip('ns'))
+
+
+def flow_rows(point, run, workdir):
+    for root, _, files in os.walk(workdir):
+        for name in sorted(files):
+            if not name.endswith('.xml'):
+                continue
+            tree = ElementTree.parse(os.path.join(root, name))
+            for flow in tree.getroot().iter('Flow'):
+                if flow.get('txBytes') is None:
+                    continue  # classifier or probe entry
+                row = dict(point)
+                row.update(run=run, file=name, flowId=flow.get('flowId'))
+                for field in FLOW_FIELDS:
+                    row[field] = int(flow.get(field))
+                rx_packets = row['rxPackets']
+                duration = (nanoseconds(flow.get('timeLastRxPacket')) -
+                            nanoseconds(flow.get('timeFirstTxPacket')))
+                row['meanDelayNs'] = (nanoseconds(flow.get('delaySum')) / rx_packets
+                                      if rx_packets else '')
+                row['throughputBps'] = (row['rxBytes'] * 8e9 / duration
+                                        if duration > 0 else '')
+                yield row
+
+
+def merge_dat(results, merged_dir):
+    if not os.path.isdir(merged_dir):
+        os.makedirs(merged_dir)
+    outputs = {}
+    try:
+        for point, run, workdir, _ in results:
+            data_dir = os.path.join(workdir, 'data')
+            for root, _, files in os.walk(data_dir):
+                for name in sorted(files):
+                    if name.endswith('.qres'):
+                        dat = name[:-len('.qres')] + '.dat'
+                        qres2dat.convert(os.path.join(root, name),
+                                         os.path.join(root, dat), [])
+            for root, _, files in os.walk(data_dir):
+                for name in sorted(files):
+                    if not name.endswith('.dat'):
+                        continue
+                    if name not in outputs:
+                        outputs[name] = open(os.path.join(merged_dir, name), 'w')
+                    merged = outputs[name]
+                    merged.write('# %s run=%d\n' % (point_name(point), run))
+                    with open(os.path.join(root, name)) as source:
+                        merged.write(source.read())
+                    # Two blank lines end a gnuplot data block.
+                    merged.write('\n\n')
+    finally:
+        for merged in outputs.values():
+            merged.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Run QUIC experiment replications concurrently.')
+    parser.add_argument('--program', default='quic-example',
+                        help='ns-3 program to run (default: quic-example)')
+    parser.add_argument('--runs', type=int, default=1,
+                        help='replications per parameter point')
+    parser.add_argument('--param', action='append', default=[],
+                        help='name=v1,v2,... sweep over a program argument; '
+                             'repeat for a cartesian product')
+    parser.add_argument('--seed', type=int, default=1,
+                        help='RngSeed shared by every replication')
+    parser.add_argument('--first-run', type=int, default=1,
+                        help='RngRun of the first replication')
+    parser.add_argument('--jobs', type=int, default=multiprocessing.cpu_count(),
+                        help='concurrent replications (default: all cores)')
+    parser.add_argument('--out', default='replications',
+                        help='output directory')
+    parser.add_argument('--ns3-dir', default='.',
+                        help='top of the ns-3 tree (default: cwd)')
+    parser.add_argument('--waf', default='./waf', help='waf to run programs with')
+    args = parser.parse_args()
+
+    params = parse_params(args.param)
+    names = [name for name, _ in params]
+    points = [list(zip(names, values))
+              for values in itertools.product(*[values for _, values in params])]
+    jobs = [(point, run) for point in points for run in range(args.runs)]
+
+    with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        results = list(pool.map(lambda job: run_one(args, *job), jobs))
+
+    failed = [r for r in results if r[3] != 0]
+    for point, run, workdir, status in failed:
+        sys.stderr.write('%s run %d failed with status %d, see %s\n'
+                         % (point_name(point), run, status,
+                            os.path.join(workdir, 'stdout.log')))
+    done = [r for r in results if r[3] == 0]
+
+    merge_dat(done, os.path.join(args.out, 'merged'))
+
+    columns = names + ['run', 'file', 'flowId'] + FLOW_FIELDS + \
+        ['meanDelayNs', 'throughputBps']
+    with open(os.path.join(args.out, 'summary.csv'), 'w') as summary:
+        writer = csv.DictWriter(summary, fieldnames=columns)
+        writer.writeheader()
+        for point, run, workdir, _ in done:
+            for row in flow_rows(point, run, workdir):
+                writer.writerow(row)
+
+    print('%d of %d replications succeeded, summary in %s'
+          % (len(done), len(results), os.path.join(args.out, 'summary.csv')))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -3,17 +3,23 @@
 //
 #include "ns3/ptr.h"
 #include "ns3/socket.h"
+#include "ns3/packet.h"
+#include "ns3/boolean.h"
+#include "ns3/udp-socket.h"
 #include "ns3/udp-l4-protocol.h"
 #include "ns3/tcp-l4-protocol.h"
 #include "ns3/tcp-congestion-ops.h"
 #include "../../internet/model/tcp-socket-factory-impl.h"
 #include "../../internet/model/udp-socket-factory-impl.h"
+#include "utils/quic-profiler.h"
 
 #include <iostream>
 #include <arpa/inet.h>
 #include <vector>
 #include <cassert>
 #include <cerrno>
+#include <cstring>
+#include <algorithm>
 #include "fcntl.h"
 
 using namespace ns3;
@@ -21,10 +27,63 @@ using namespace std;
 
 Ptr<Node> kCurNode;
 
-std::vector<Ptr<Socket>> socket_map;
-std::vector<sockaddr> addr_map;
-std::vector<int> len_map;
-std::vector<bool> nonblock_map;
+namespace {
+
+SocketNs3Stats send_stats;
+
+// Descriptor table kept as parallel arrays indexed by fd. A slot is live
+// while its socket is non-null; closed slots are chained through next_free
+// and handed out again before the table grows, so its size is bounded by
+// the peak number of simultaneously open sockets.
+struct DescriptorTable {
+  std::vector<Ptr<Socket>> sockets;
+  std::vector<Ptr<Node>> nodes;
+  std::vector<sockaddr_storage> addrs;
+  std::vector<socklen_t> lens;
+  std::vector<bool> nonblock;
+  std::vector<int> next_free;
+  int free_head = -1;
+  size_t live = 0;
+
+  int Allocate(Ptr<Socket> socket, Ptr<Node> node) {
+    int fd = free_head;
+    if(fd >= 0) {
+      free_head = next_free[fd];
+    } else {
+      fd = int(sockets.size());
+      sockets.emplace_back();
+      nodes.emplace_back();
+      addrs.emplace_back();
+      lens.push_back(0);
+      nonblock.push_back(false);
+      next_free.push_back(-1);
+    }
+    sockets[fd] = socket;
+    nodes[fd] = node;
+    addrs[fd] = sockaddr_storage();
+    lens[fd] = 0;
+    nonblock[fd] = false;
+    next_free[fd] = -1;
+    live++;
+    return fd;
+  }
+
+  void Release(int fd) {
+    sockets[fd] = 0;
+    nodes[fd] = 0;
+    next_free[fd] = free_head;
+    free_head = fd;
+    live--;
+  }
+
+  bool IsLive(int fd) const {
+    return fd >= 0 && fd < int(sockets.size()) && sockets[fd];
+  }
+};
+
+DescriptorTable fd_table;
+
+} // namespace
 
 int socket_ns3 (int domain, int type, int protocol) {
   Ptr<Socket> new_socket;
@@ -33,11 +92,7 @@ int socket_ns3 (int domain, int type, int protocol) {
   } else {
     new_socket = Socket::CreateSocket(kCurNode, TcpSocketFactory::GetTypeId());
   }
-  socket_map.push_back(new_socket);
-  addr_map.push_back(sockaddr());
-  len_map.push_back(-1);
-  nonblock_map.push_back(false);
-  return int(socket_map.size()) - 1;
+  return fd_table.Allocate(new_socket, kCurNode);
 }
 
 int socketpair_ns3 (int domain, int type, int protocol, int fds[2]) {
@@ -49,8 +104,14 @@ int socketpair_ns3 (int domain, int type, int protocol, int fds[2]) {
 namespace {
 
 auto get(int fd) {
-  assert(fd >= 0 && fd < int(socket_map.size()));
-  return socket_map[fd];
+  assert(fd_table.IsLive(fd));
+  return fd_table.sockets[fd];
+}
+
+void save_addr(int fd, __CONST_SOCKADDR_ARG addr, socklen_t len) {
+  len = std::min<socklen_t>(len, sizeof(sockaddr_storage));
+  memcpy(&fd_table.addrs[fd], addr, len);
+  fd_table.lens[fd] = len;
 }
 
 Address convert_addr(__CONST_SOCKADDR_ARG addr, socklen_t len) {
@@ -60,31 +121,123 @@ Address convert_addr(__CONST_SOCKADDR_ARG addr, socklen_t len) {
   return ad;
 }
 
+// The Packet is built straight from the caller's buffer, which is the only
+// copy made on the send path. The caller keeps ownership of |buf|.
+Ptr<Packet> make_packet(const void *buf, size_t n) {
+  send_stats.packets_created++;
+  send_stats.bytes_copied += n;
+  return Create<Packet>(reinterpret_cast<const uint8_t*>(buf), n);
+}
+
+// Sets errno from the last error of |sckt| and returns -1, so a failed
+// ns-3 send reads like a failed system call to the Chromium socket code.
+int fail_send(Ptr<Socket> sckt) {
+  switch(sckt->GetErrno()) {
+    case Socket::ERROR_ISCONN: errno = EISCONN; break;
+    case Socket::ERROR_NOTCONN: errno = ENOTCONN; break;
+    case Socket::ERROR_MSGSIZE: errno = EMSGSIZE; break;
+    case Socket::ERROR_AGAIN: errno = EAGAIN; break;
+    case Socket::ERROR_SHUTDOWN: errno = EPIPE; break;
+    case Socket::ERROR_OPNOTSUPP: errno = EOPNOTSUPP; break;
+    case Socket::ERROR_AFNOSUPPORT: errno = EAFNOSUPPORT; break;
+    case Socket::ERROR_INVAL: errno = EINVAL; break;
+    case Socket::ERROR_BADF: errno = EBADF; break;
+    case Socket::ERROR_NOROUTETOHOST: errno = EHOSTUNREACH; break;
+    case Socket::ERROR_NODEV: errno = ENODEV; break;
+    case Socket::ERROR_ADDRNOTAVAIL: errno = EADDRNOTAVAIL; break;
+    case Socket::ERROR_ADDRINUSE: errno = EADDRINUSE; break;
+    default: errno = EIO; break;
+  }
+  return -1;
+}
+
+// Only IPv4 endpoints are ever handed out by the simulated sockets.
+socklen_t convert_addr(const Address &from, sockaddr *addr, socklen_t len) {
+  struct sockaddr_in in = sockaddr_in();
+  InetSocketAddress inet = InetSocketAddress::ConvertFrom(from);
+  in.sin_family = AF_INET;
+  in.sin_port = htons(inet.GetPort());
+  in.sin_addr.s_addr = htonl(inet.GetIpv4().Get());
+  memcpy(addr, &in, std::min<size_t>(len, sizeof(in)));
+  return sizeof(in);
+}
+
+// A single iovec is the common case and goes straight into the Packet.
+// Scattered messages are gathered into a scratch buffer first, so the
+// Packet still owns one contiguous copy of the datagram.
+Ptr<Packet> gather_packet(const struct msghdr *message) {
+  if(message->msg_iovlen == 1)
+    return make_packet(message->msg_iov[0].iov_base, message->msg_iov[0].iov_len);
+  static std::vector<uint8_t> scratch;
+  scratch.clear();
+  for(size_t i = 0; i < message->msg_iovlen; i++) {
+    const uint8_t *base = (const uint8_t *)message->msg_iov[i].iov_base;
+    scratch.insert(scratch.end(), base, base + message->msg_iov[i].iov_len);
+  }
+  return make_packet(scratch.data(), scratch.size());
+}
+
+// Packet::CopyData always reads from the front of the packet, so each
+// chunk is trimmed off once it has been copied into its iovec.
+ssize_t scatter_packet(Ptr<Packet> packet, struct msghdr *message) {
+  uint32_t size = packet->GetSize();
+  uint32_t offset = 0;
+  for(size_t i = 0; i < message->msg_iovlen && offset < size; i++) {
+    uint32_t chunk = std::min<size_t>(message->msg_iov[i].iov_len, size - offset);
+    packet->CopyData((uint8_t *)message->msg_iov[i].iov_base, chunk);
+    packet->RemoveAtStart(chunk);
+    offset += chunk;
+  }
+  if(offset < size) message->msg_flags |= MSG_TRUNC;
+  return offset;
+}
+
 } // namespace
 
 ns3::Ptr<ns3::Socket> get_socket(int fd) {
   return get(fd);
 }
 
+const SocketNs3Stats &get_socket_ns3_stats() {
+  return send_stats;
+}
+
+void reset_socket_ns3_stats() {
+  send_stats = SocketNs3Stats();
+}
+
+size_t open_sockets_ns3() {
+  return fd_table.live;
+}
+
+int close_node_sockets_ns3(ns3::Ptr<ns3::Node> node) {
+  int closed = 0;
+  for(int fd = 0; fd < int(fd_table.sockets.size()); fd++) {
+    if(fd_table.IsLive(fd) && fd_table.nodes[fd] == node) {
+      close_ns3(fd);
+      closed++;
+    }
+  }
+  return closed;
+}
+
 // It seems addr is 0.0.0.0 that does not seem right...
 int bind_ns3 (int fd, __CONST_SOCKADDR_ARG addr, socklen_t len) {
   auto sckt = get(fd);
-  len_map[fd] = len;
-  addr_map[fd] = *addr;
+  save_addr(fd, addr, len);
   return sckt->Bind(convert_addr(addr, len));
 }
 
 int getsockname_ns3 (int fd, __SOCKADDR_ARG addr, socklen_t *__restrict len) {
   auto sckt = get(fd);
-  *len = len_map[fd];
-  *addr = addr_map[fd];
+  memcpy(addr, &fd_table.addrs[fd], std::min(*len, fd_table.lens[fd]));
+  *len = fd_table.lens[fd];
   return 0;
 }
 
 int connect_ns3 (int fd, __CONST_SOCKADDR_ARG addr, socklen_t len) {
   auto sckt = get(fd);
-  len_map[fd] = len;
-  addr_map[fd] = *addr;
+  save_addr(fd, addr, len);
   return sckt->Connect(convert_addr(addr, len));
 }
 
@@ -93,35 +246,116 @@ int getpeername_ns3 (int fd, __SOCKADDR_ARG addr, socklen_t *__restrict len) {
 }
 
 ssize_t send_ns3 (int fd, const void *buf, size_t n, int flags) {
+  QUIC_PROFILE_SCOPE(NS3_SOCKET);
   auto sckt = get(fd);
-  uint8_t *bbuf = new uint8_t[n]; // TODO CLEAN
-  for(int i = 0; i < n; i++) bbuf[i] = *(((uint8_t*)buf) + i);
-  return sckt->Send(bbuf, n, flags);
+  int ret = sckt->Send(make_packet(buf, n), flags);
+  return ret < 0 ? fail_send(sckt) : ret;
 }
 
 ssize_t recv_ns3 (int fd, void *buf, size_t n, int flags) {
+  QUIC_PROFILE_SCOPE(NS3_SOCKET);
   auto sckt = get(fd);
   return sckt->Recv(reinterpret_cast<uint8_t*>(buf), n, flags);
 }
 
 ssize_t sendto_ns3 (int fd, const void *buf, size_t n, int flags, __CONST_SOCKADDR_ARG addr, socklen_t len) {
   if(addr == NULL) return send_ns3(fd, buf, n, flags);
+  QUIC_PROFILE_SCOPE(NS3_SOCKET);
   auto sckt = get(fd);
-  uint8_t *bbuf = new uint8_t[n]; // TODO CLEAN
-  for(int i = 0; i < n; i++) bbuf[i] = *(((uint8_t*)buf) + i);
-  return sckt->SendTo(bbuf, n, flags, convert_addr(addr, len));
+  int ret = sckt->SendTo(make_packet(buf, n), flags, convert_addr(addr, len));
+  return ret < 0 ? fail_send(sckt) : ret;
 }
 
+// Profiled in recvmsg_ns3, so that every read counts once.
 ssize_t recvfrom_ns3 (int fd, void *__restrict buf, size_t n, int flags, __SOCKADDR_ARG addr, socklen_t *__restrict len) {
-  assert(false);
+  struct iovec iov;
+  iov.iov_base = buf;
+  iov.iov_len = n;
+  struct msghdr message = msghdr();
+  message.msg_name = addr;
+  message.msg_namelen = len ? *len : 0;
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  ssize_t ret = recvmsg_ns3(fd, &message, flags);
+  if(ret >= 0 && len) *len = message.msg_namelen;
+  return ret;
 }
 
 ssize_t sendmsg_ns3 (int fd, const struct msghdr *message, int flags) {
-  abort();
+  QUIC_PROFILE_SCOPE(NS3_SOCKET);
+  auto sckt = get(fd);
+  Ptr<Packet> packet = gather_packet(message);
+  int ret;
+  if(message->msg_name == NULL) ret = sckt->Send(packet, flags);
+  else ret = sckt->SendTo(packet, flags, convert_addr((const sockaddr *)message->msg_name, message->msg_namelen));
+  return ret < 0 ? fail_send(sckt) : ret;
 }
 
 ssize_t recvmsg_ns3 (int fd, struct msghdr *message, int flags) {
-  abort();
+  QUIC_PROFILE_SCOPE(NS3_SOCKET);
+  auto sckt = get(fd);
+  Address from;
+  Ptr<Packet> packet = sckt->RecvFrom(from);
+  if(!packet) {
+    errno = EAGAIN;
+    return -1;
+  }
+  message->msg_flags = 0;
+  message->msg_controllen = 0;
+  if(message->msg_name)
+    message->msg_namelen = convert_addr(from, (sockaddr *)message->msg_name, message->msg_namelen);
+  return scatter_packet(packet, message);
+}
+
+int sendmmsg_ns3 (int fd, struct mmsghdr *vmessages, unsigned int vlen, int flags) {
+  unsigned int sent = 0;
+  for(; sent < vlen; sent++) {
+    ssize_t ret = sendmsg_ns3(fd, &vmessages[sent].msg_hdr, flags);
+    if(ret < 0) break;
+    vmessages[sent].msg_len = ret;
+  }
+  if(sent > 0) {
+    send_stats.batches_sent++;
+    return sent;
+  }
+  return vlen == 0 ? 0 : -1;
+}
+
+Ptr<Packet> make_packet_ns3(const void *buf, size_t n) {
+  return make_packet(buf, n);
+}
+
+int sendpackets_ns3(int fd, const Ptr<Packet> *packets, const sockaddr *const *addrs,
+                    const socklen_t *lens, unsigned int n) {
+  QUIC_PROFILE_SCOPE(NS3_SOCKET);
+  auto sckt = get(fd);
+  unsigned int sent = 0;
+  for(; sent < n; sent++) {
+    int ret;
+    if(addrs == NULL || addrs[sent] == NULL) ret = sckt->Send(packets[sent], 0);
+    else ret = sckt->SendTo(packets[sent], 0, convert_addr(addrs[sent], lens[sent]));
+    if(ret < 0) {
+      fail_send(sckt);
+      break;
+    }
+  }
+  if(sent > 0) {
+    send_stats.batches_sent++;
+    return sent;
+  }
+  return n == 0 ? 0 : -1;
+}
+
+int recvmmsg_ns3 (int fd, struct mmsghdr *vmessages, unsigned int vlen, int flags, struct timespec *tmo) {
+  unsigned int received = 0;
+  for(; received < vlen; received++) {
+    ssize_t ret = recvmsg_ns3(fd, &vmessages[received].msg_hdr, flags);
+    if(ret < 0) break;
+    vmessages[received].msg_len = ret;
+  }
+  if(received > 0) return received;
+  errno = EAGAIN;
+  return -1;
 }
 
 int getsockopt_ns3 (int fd, int level, int optname,
@@ -132,7 +366,17 @@ int getsockopt_ns3 (int fd, int level, int optname,
 
 // quic_socket_utils tries to set options: receive buffer size, overflow detection, send buffer size among others
 // I think NS3 sockets only have support for setting the receive buffer. And it is a private function.
+// IP_MTU_DISCOVER maps to the MtuDiscover attribute of UDP sockets, which sets
+// the DF flag so that datagrams larger than the path MTU (e.g. QUIC MTU probes)
+// are dropped instead of fragmented.
 int setsockopt_ns3 (int fd, int level, int optname, const void *optval, socklen_t optlen)  {
+  if(level == IPPROTO_IP && optname == IP_MTU_DISCOVER && optlen >= sizeof(int)) {
+    auto sckt = DynamicCast<UdpSocket>(get(fd));
+    if(sckt) {
+      int value = *static_cast<const int *>(optval);
+      sckt->SetAttribute("MtuDiscover", BooleanValue(value == IP_PMTUDISC_DO));
+    }
+  }
   return 0;
 }
 
@@ -145,17 +389,39 @@ int accept_ns3 (int fd, __SOCKADDR_ARG addr, socklen_t *__restrict addr_len) {
 }
 
 int shutdown_ns3 (int fd, int how) {
-  abort();
+  if(!fd_table.IsLive(fd)) {
+    errno = EBADF;
+    return -1;
+  }
+  auto sckt = get(fd);
+  int ret = 0;
+  if(how == SHUT_RD || how == SHUT_RDWR) ret |= sckt->ShutdownRecv();
+  if(how == SHUT_WR || how == SHUT_RDWR) ret |= sckt->ShutdownSend();
+  return ret == 0 ? 0 : -1;
+}
+
+// Closing drops the table's reference to the ns-3 socket and returns the
+// slot to the free list, so the descriptor number may be reused right away.
+int close_ns3 (int fd) {
+  if(!fd_table.IsLive(fd)) {
+    errno = EBADF;
+    return -1;
+  }
+  auto sckt = get(fd);
+  sckt->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+  sckt->Close();
+  fd_table.Release(fd);
+  return 0;
 }
 
 int fcntl_ns3(int fd, int cmd) {
   assert(cmd == F_GETFL);
-  return nonblock_map[fd];
+  return fd_table.nonblock[fd];
 }
 
 int fcntls_ns3(int fd, int cmd, int fl) {
   assert(cmd == F_SETFL);
   assert(fl & O_NONBLOCK);
-  nonblock_map[fd] = true;
+  fd_table.nonblock[fd] = true;
   return 0;
 }
@@ -22,9 +22,13 @@
 #include <sys/socket.h>
 #ifdef __cplusplus
 #include "ns3/node.h"
+#include "ns3/packet.h"
 #include "ns3/ptr.h"
 #include "ns3/socket.h"
 extern "C" {
+// Node on which socket_ns3 creates new sockets. Set it through
+// ns3::QuicContext::Scope rather than directly; once created, a descriptor
+// stays bound to its node.
 extern ns3::Ptr<ns3::Node> kCurNode;
 #endif
 
@@ -43,17 +47,54 @@ ssize_t recvfrom_ns3 (int __fd, void *__restrict __buf, size_t __n,
 int __flags, __SOCKADDR_ARG __addr, socklen_t *__restrict __addr_len);
 ssize_t sendmsg_ns3 (int __fd, const struct msghdr *__message, int __flags);
 ssize_t recvmsg_ns3 (int __fd, struct msghdr *__message, int __flags);
+int sendmmsg_ns3 (int __fd, struct mmsghdr *__vmessages, unsigned int __vlen,
+int __flags);
+int recvmmsg_ns3 (int __fd, struct mmsghdr *__vmessages, unsigned int __vlen,
+int __flags, struct timespec *__tmo);
 int getsockopt_ns3 (int __fd, int __level, int __optname,
 void *__restrict __optval, socklen_t *__restrict __optlen);
 int setsockopt_ns3 (int __fd, int __level, int __optname, const void *__optval, socklen_t __optlen);
 int listen_ns3 (int __fd, int __n);
 int accept_ns3 (int __fd, __SOCKADDR_ARG __addr, socklen_t *__restrict __addr_len);
 int shutdown_ns3 (int __fd, int __how);
+int close_ns3 (int __fd);
 int fcntl_ns3(int fd, int cmd);
 int fcntls_ns3(int fd, int cmd, int fl);
 
 #ifdef __cplusplus
 ns3::Ptr<ns3::Socket> get_socket(int fd);
+
+// Counters for the send path. Every datagram handed to send_ns3/sendto_ns3
+// becomes exactly one ns3::Packet, so packets_created should track the
+// number of datagrams sent and bytes_copied their total size. batches_sent
+// counts the sendmmsg_ns3 and sendpackets_ns3 calls that moved at least one
+// datagram.
+struct SocketNs3Stats {
+  uint64_t packets_created = 0;
+  uint64_t bytes_copied = 0;
+  uint64_t batches_sent = 0;
+};
+const SocketNs3Stats &get_socket_ns3_stats();
+void reset_socket_ns3_stats();
+
+// Builds the packet of a datagram for sendpackets_ns3, copying |buf| once,
+// and counts it like the packets send_ns3 builds.
+ns3::Ptr<ns3::Packet> make_packet_ns3(const void *buf, size_t n);
+// Sends packets built by make_packet_ns3, the |i|th to |addrs[i]|, or to the
+// connected peer when |addrs| or |addrs[i]| is null. Returns the number
+// sent, like sendmmsg_ns3, with errno telling why the next one failed if
+// not all were; -1 if none was.
+int sendpackets_ns3(int fd, const ns3::Ptr<ns3::Packet> *packets,
+                    const struct sockaddr *const *addrs, const socklen_t *lens,
+                    unsigned int n);
+
+// Number of descriptors currently open in the socket table.
+size_t open_sockets_ns3();
+// Closes every descriptor created while |node| was the current node and
+// returns how many were closed. Only for descriptors nothing else owns: a
+// Chromium socket whose descriptor is closed under it closes it again, or
+// closes whatever reused the slot.
+int close_node_sockets_ns3(ns3::Ptr<ns3::Node> node);
 } // closing brace for extern "C"
 #endif
 #endif // SOCKET_NS3_H
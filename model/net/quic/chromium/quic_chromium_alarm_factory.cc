@@ -4,9 +4,13 @@
 
 #include "net/quic/chromium/quic_chromium_alarm_factory.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "base/bind.h"
 #include "base/location.h"
 #include "base/logging.h"
+#include "base/memory/ref_counted.h"
 #include "base/metrics/sparse_histogram.h"
 #include "base/task_runner.h"
 #include "base/time/time.h"
@@ -21,117 +25,206 @@ using ns3::EventId;
 
 namespace net {
 
-  namespace {
-
-    class QuicChromeAlarm : public QuicAlarm {
-      public:
-        QuicChromeAlarm(const QuicClock* clock,
-            base::TaskRunner* task_runner,
-            QuicArenaScopedPtr<QuicAlarm::Delegate> delegate)
-          : QuicAlarm(std::move(delegate)),
-          clock_(clock),
-          task_runner_(task_runner),
-          task_deadline_(QuicTime::Zero()),
-          weak_factory_(this) {}
-
-      protected:
-        void SetImpl() override {
-          DCHECK(deadline().IsInitialized());
-          if (task_deadline_.IsInitialized()) {
-            if (task_deadline_ <= deadline()) {
-              // Since tasks can not be un-posted, OnAlarm will be invoked which
-              // will notice that deadline has not yet been reached, and will set
-              // the alarm for the new deadline.
-              return;
-            }
-            // The scheduled task is after new deadline.  Invalidate the weak ptrs
-            // so that task does not execute when we're not expecting it.
-            weak_factory_.InvalidateWeakPtrs();
-          }
-
-          int64_t delay_us = (deadline() - (clock_->Now())).ToMicroseconds();
-          //delay_us = int64_t((delay_us + 999) / 1000) * 1000; // Assuming granularity of NS-3 is milliseconds
-          if (delay_us < 10) {
-            deadline_ = clock_->Now();
-            delay_us = 0;
-            id = Simulator::ScheduleNow(&QuicChromeAlarm::OnAlarmWrapper, weak_factory_.GetWeakPtr().get());
-          } else {
-            id = Simulator::Schedule(MicroSeconds(delay_us), &QuicChromeAlarm::OnAlarmWrapper, weak_factory_.GetWeakPtr().get());
-          }
-          //task_runner_->PostDelayedTask(
-          //    FROM_HERE,
-          //    base::Bind(&QuicChromeAlarm::OnAlarm, weak_factory_.GetWeakPtr()),
-          //    base::TimeDelta::FromMicroseconds(delay_us));
-          task_deadline_ = deadline();
+  class QuicChromeAlarm;
+
+  // Keeps the alarms of one connection and the one simulator event that
+  // serves them all.
+  class QuicChromiumAlarmFactory::Multiplexer
+      : public base::RefCounted<Multiplexer> {
+    public:
+      Multiplexer(QuicChromiumAlarmFactory* factory,
+          QuicConnectionArena* arena,
+          const QuicClock* clock)
+        : factory_(factory),
+        arena_(arena),
+        clock_(clock),
+        event_deadline_(QuicTime::Zero()),
+        firing_(false) {}
+
+      void Add(QuicChromeAlarm* alarm) { alarms_.push_back(alarm); }
+
+      void Remove(QuicChromeAlarm* alarm) {
+        alarms_.erase(std::remove(alarms_.begin(), alarms_.end(), alarm),
+            alarms_.end());
+      }
+
+      // Called whenever one of the alarms gets a new deadline.
+      void Reschedule();
+
+      void DetachFromFactory() { factory_ = nullptr; }
+
+    private:
+      friend class base::RefCounted<Multiplexer>;
+
+      ~Multiplexer() {
+        Simulator::Cancel(event_);
+        if (!factory_)
+          return;
+        if (arena_)
+          factory_->multiplexers_.erase(arena_);
+        else
+          factory_->private_multiplexers_.erase(this);
+      }
+
+      QuicTime EarliestDeadline() const;
+      void OnEvent();
+
+      // Null once the factory is gone.
+      QuicChromiumAlarmFactory::EventStats* stats() {
+        return factory_ ? &factory_->event_stats_ : nullptr;
+      }
+
+      QuicChromiumAlarmFactory* factory_;
+      QuicConnectionArena* arena_;
+      const QuicClock* clock_;
+      std::vector<QuicChromeAlarm*> alarms_;
+      EventId event_;
+      // Time the pending event fires at, or Zero if none is pending.
+      QuicTime event_deadline_;
+      bool firing_;
+
+      DISALLOW_COPY_AND_ASSIGN(Multiplexer);
+  };
+
+  class QuicChromeAlarm : public QuicAlarm {
+    public:
+      QuicChromeAlarm(QuicChromiumAlarmFactory::Multiplexer* multiplexer,
+          QuicArenaScopedPtr<QuicAlarm::Delegate> delegate)
+        : QuicAlarm(std::move(delegate)),
+        multiplexer_(multiplexer) {
+          multiplexer_->Add(this);
         }
 
-        void CancelImpl() override {
-          DCHECK(!deadline().IsInitialized());
-          if(id.IsRunning()) {
-            id.Cancel();
-            id = EventId();
-          }
-          // Since tasks can not be un-posted, OnAlarm will be invoked which
-          // will notice that deadline is not Initialized and will do nothing.
-        }
+      ~QuicChromeAlarm() override { multiplexer_->Remove(this); }
 
-      private:
+      void FireFromMultiplexer() { Fire(); }
 
-        void OnAlarm() {
-          DCHECK(task_deadline_.IsInitialized());
-          task_deadline_ = QuicTime::Zero();
-          // The alarm may have been cancelled.
-          if (!deadline().IsInitialized()) {
-            return;
-          }
+    protected:
+      void SetImpl() override {
+        DCHECK(deadline().IsInitialized());
+        multiplexer_->Reschedule();
+      }
 
-          // The alarm may have been re-set to a later time.
-          if (clock_->Now() < deadline()) {
-            SetImpl();
-            return;
-          }
+      void CancelImpl() override {
+        DCHECK(!deadline().IsInitialized());
+        // The shared event stays put; if nothing is due when it fires it
+        // simply moves on to the next deadline.
+      }
 
-          Fire();
-        }
-        void OnAlarmWrapper() {
-          return OnAlarm();
-        }
-        ns3::EventId id;
-        const QuicClock* clock_;
-        base::TaskRunner* task_runner_;
-        // If a task has been posted to the message loop, this is the time it
-        // was scheduled to fire.  Tracking this allows us to avoid posting a
-        // new tast if the new deadline is in the future, but permits us to
-        // post a new task when the new deadline now earlier than when
-        // previously posted.
-        QuicTime task_deadline_;
-        base::WeakPtrFactory<QuicChromeAlarm> weak_factory_;
-    };
-
-  }  // namespace
+    private:
+      scoped_refptr<QuicChromiumAlarmFactory::Multiplexer> multiplexer_;
+  };
+
+  QuicTime QuicChromiumAlarmFactory::Multiplexer::EarliestDeadline() const {
+    QuicTime earliest = QuicTime::Zero();
+    for (const QuicChromeAlarm* alarm : alarms_) {
+      if (alarm->IsSet() &&
+          (!earliest.IsInitialized() || alarm->deadline() < earliest))
+        earliest = alarm->deadline();
+    }
+    return earliest;
+  }
+
+  void QuicChromiumAlarmFactory::Multiplexer::Reschedule() {
+    if (firing_) {
+      // OnEvent() schedules the next event once every due alarm has run.
+      return;
+    }
+    QuicTime earliest = EarliestDeadline();
+    if (!earliest.IsInitialized())
+      return;
+    if (event_deadline_.IsInitialized() && event_deadline_ <= earliest)
+      return;
+
+    Simulator::Cancel(event_);
+    QuicTime now = clock_->Now();
+    int64_t delay_us = (earliest - now).ToMicroseconds();
+    if (delay_us <= 0) {
+      event_deadline_ = now;
+      event_ = Simulator::ScheduleNow(
+          &QuicChromiumAlarmFactory::Multiplexer::OnEvent, this);
+    } else {
+      event_deadline_ = earliest;
+      event_ = Simulator::Schedule(MicroSeconds(delay_us),
+          &QuicChromiumAlarmFactory::Multiplexer::OnEvent, this);
+    }
+    if (stats())
+      stats()->events_scheduled++;
+  }
+
+  void QuicChromiumAlarmFactory::Multiplexer::OnEvent() {
+    // Alarm delegates may destroy every alarm, and with them the last
+    // reference to this multiplexer.
+    scoped_refptr<Multiplexer> self(this);
+    event_deadline_ = QuicTime::Zero();
+    if (stats())
+      stats()->events_fired++;
+
+    // Only alarms whose deadline has passed run; the clock has microsecond
+    // resolution, like the deadlines, so none of them runs early.
+    QuicTime now = clock_->Now();
+    std::vector<QuicChromeAlarm*> fired;
+    for (QuicChromeAlarm* alarm : alarms_) {
+      if (alarm->IsSet() && alarm->deadline() <= now)
+        fired.push_back(alarm);
+    }
+
+    firing_ = true;
+    for (QuicChromeAlarm* alarm : fired) {
+      // Skip alarms destroyed or re-armed by an earlier delegate.
+      if (std::find(alarms_.begin(), alarms_.end(), alarm) == alarms_.end())
+        continue;
+      if (!alarm->IsSet() || alarm->deadline() > now)
+        continue;
+      if (stats())
+        stats()->alarms_fired++;
+      alarm->FireFromMultiplexer();
+    }
+    firing_ = false;
+
+    Reschedule();
+  }
 
   QuicChromiumAlarmFactory::QuicChromiumAlarmFactory(
       base::TaskRunner* task_runner,
       const QuicClock* clock)
     : task_runner_(task_runner), clock_(clock), weak_factory_(this) {}
 
-  QuicChromiumAlarmFactory::~QuicChromiumAlarmFactory() {}
+  QuicChromiumAlarmFactory::~QuicChromiumAlarmFactory() {
+    for (auto& entry : multiplexers_)
+      entry.second->DetachFromFactory();
+    for (Multiplexer* multiplexer : private_multiplexers_)
+      multiplexer->DetachFromFactory();
+  }
+
+  QuicChromiumAlarmFactory::Multiplexer*
+  QuicChromiumAlarmFactory::GetMultiplexer(QuicConnectionArena* arena) {
+    if (arena == nullptr) {
+      Multiplexer* multiplexer = new Multiplexer(this, nullptr, clock_);
+      private_multiplexers_.insert(multiplexer);
+      return multiplexer;
+    }
+    Multiplexer*& multiplexer = multiplexers_[arena];
+    if (multiplexer == nullptr)
+      multiplexer = new Multiplexer(this, arena, clock_);
+    return multiplexer;
+  }
 
   QuicArenaScopedPtr<QuicAlarm> QuicChromiumAlarmFactory::CreateAlarm(
       QuicArenaScopedPtr<QuicAlarm::Delegate> delegate,
       QuicConnectionArena* arena) {
+    Multiplexer* multiplexer = GetMultiplexer(arena);
     if (arena != nullptr) {
-      return arena->New<QuicChromeAlarm>(clock_, task_runner_,
-          std::move(delegate));
+      return arena->New<QuicChromeAlarm>(multiplexer, std::move(delegate));
     } else {
       return QuicArenaScopedPtr<QuicAlarm>(
-          new QuicChromeAlarm(clock_, task_runner_, std::move(delegate)));
+          new QuicChromeAlarm(multiplexer, std::move(delegate)));
     }
   }
 
   QuicAlarm* QuicChromiumAlarmFactory::CreateAlarm(
       QuicAlarm::Delegate* delegate) {
-    return new QuicChromeAlarm(clock_, task_runner_,
+    return new QuicChromeAlarm(GetMultiplexer(nullptr),
         QuicArenaScopedPtr<QuicAlarm::Delegate>(delegate));
   }
 
@@ -8,7 +8,10 @@
 #ifndef NET_QUIC_CHROMIUM_QUIC_CHROMIUM_ALARM_FACTORY_H_
 #define NET_QUIC_CHROMIUM_QUIC_CHROMIUM_ALARM_FACTORY_H_
 
-#include <set>
+#include <stdint.h>
+
+#include <unordered_map>
+#include <unordered_set>
 
 #include "base/macros.h"
 #include "base/memory/weak_ptr.h"
@@ -24,8 +27,24 @@ class TaskRunner;
 
 namespace net {
 
+// Alarms created with the same QuicConnectionArena belong to one connection
+// and share a single ns-3 simulator event, scheduled for the earliest
+// deadline among them. The event is only moved when that deadline moves
+// earlier; a later or cancelled deadline is picked up when the event fires.
+// Each alarm still fires at its own deadline: alarms due at the same time
+// share the event, the others get one when the earlier ones have run.
+// Alarms created without an arena get an event of their own.
 class NET_EXPORT_PRIVATE QuicChromiumAlarmFactory : public QuicAlarmFactory {
  public:
+  // Counters of simulator events used by the alarms of this factory.
+  struct EventStats {
+    uint64_t events_scheduled = 0;
+    uint64_t events_fired = 0;
+    uint64_t alarms_fired = 0;
+  };
+
+  class Multiplexer;
+
   QuicChromiumAlarmFactory(base::TaskRunner* task_runner,
                            const QuicClock* clock);
   ~QuicChromiumAlarmFactory() override;
@@ -36,9 +55,24 @@ class NET_EXPORT_PRIVATE QuicChromiumAlarmFactory : public QuicAlarmFactory {
       QuicArenaScopedPtr<QuicAlarm::Delegate> delegate,
       QuicConnectionArena* arena) override;
 
+  const EventStats& event_stats() const { return event_stats_; }
+  void ResetEventStats() { event_stats_ = EventStats(); }
+
  private:
+  friend class Multiplexer;
+
+  // Returns the multiplexer shared by the alarms of |arena|, creating it if
+  // needed, or a private one if |arena| is null.
+  Multiplexer* GetMultiplexer(QuicConnectionArena* arena);
+
   base::TaskRunner* task_runner_;
   const QuicClock* clock_;
+  // Not owned; each multiplexer is kept alive by its alarms and removes
+  // itself from these when the last one goes away.
+  std::unordered_map<QuicConnectionArena*, Multiplexer*> multiplexers_;
+  // Multiplexers of the alarms created without an arena.
+  std::unordered_set<Multiplexer*> private_multiplexers_;
+  EventStats event_stats_;
   base::WeakPtrFactory<QuicChromiumAlarmFactory> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(QuicChromiumAlarmFactory);
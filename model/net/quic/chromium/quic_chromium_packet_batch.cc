@@ -0,0 +1,89 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/chromium/quic_chromium_packet_batch.h"
+
+#include <errno.h>
+
+#include "base/logging.h"
+#include "helper/socket_ns3.h"
+#include "net/base/net_errors.h"
+
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+
+namespace net {
+
+QuicChromiumPacketBatch::QuicChromiumPacketBatch(
+    int fd,
+    const ErrorCallback& error_callback)
+    : fd_(fd),
+      error_callback_(error_callback),
+      num_pending_(0),
+      batches_flushed_(0),
+      packets_flushed_(0) {}
+
+QuicChromiumPacketBatch::~QuicChromiumPacketBatch() {
+  ns3::Simulator::Cancel(flush_event_);
+}
+
+int QuicChromiumPacketBatch::Add(const char* buffer,
+                                 size_t buf_len,
+                                 const IPEndPoint* peer_address) {
+  if (num_pending_ == kMaxBatchSize) {
+    int rv = Flush();
+    if (rv != OK)
+      return rv;
+  }
+
+  size_t slot = num_pending_;
+  names_[slot] = nullptr;
+  name_lens_[slot] = 0;
+  if (peer_address) {
+    SockaddrStorage* storage = &addresses_[slot];
+    storage->addr_len = sizeof(storage->addr_storage);
+    if (!peer_address->ToSockAddr(storage->addr, &storage->addr_len))
+      return ERR_ADDRESS_INVALID;
+    names_[slot] = storage->addr;
+    name_lens_[slot] = storage->addr_len;
+  }
+  packets_[slot] = make_packet_ns3(buffer, buf_len);
+
+  if (num_pending_++ == 0) {
+    flush_event_ = ns3::Simulator::ScheduleNow(
+        &QuicChromiumPacketBatch::OnFlushAlarm, this);
+  }
+  return OK;
+}
+
+int QuicChromiumPacketBatch::Flush() {
+  ns3::Simulator::Cancel(flush_event_);
+  if (num_pending_ == 0)
+    return OK;
+
+  size_t num_pending = num_pending_;
+  num_pending_ = 0;
+  int rv = sendpackets_ns3(fd_, packets_, names_, name_lens_, num_pending);
+  int result = OK;
+  if (rv != static_cast<int>(num_pending)) {
+    result = MapSystemError(errno);
+    DVLOG(1) << "sendpackets_ns3 sent " << rv << " of " << num_pending
+             << " packets: " << ErrorToString(result);
+  }
+  if (rv > 0) {
+    batches_flushed_++;
+    packets_flushed_ += rv;
+  }
+  for (size_t i = 0; i < num_pending; ++i)
+    packets_[i] = ns3::Ptr<ns3::Packet> ();
+  return result;
+}
+
+void QuicChromiumPacketBatch::OnFlushAlarm() {
+  int rv = Flush();
+  if (rv != OK && !error_callback_.is_null())
+    error_callback_.Run(rv);
+}
+
+}  // namespace net
@@ -0,0 +1,83 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CHROMIUM_QUIC_CHROMIUM_PACKET_BATCH_H_
+#define NET_QUIC_CHROMIUM_QUIC_CHROMIUM_PACKET_BATCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/callback.h"
+#include "base/macros.h"
+#include "net/base/ip_endpoint.h"
+#include "net/base/net_export.h"
+#include "net/base/sockaddr_storage.h"
+#include "net/quic/core/quic_packets.h"
+
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+class Packet;
+}  // namespace ns3
+
+namespace net {
+
+// Collects the packets a connection writes during one simulated instant and
+// hands them to the ns-3 socket shim with a single sendpackets_ns3() call.
+// The flush is scheduled with Simulator::ScheduleNow(), so it runs right
+// after the event that produced the packets and at the same simulated time.
+//
+// Each packet is built as an ns3::Packet when it is added. That is the only
+// copy of its data, which the batch then owns until the flush.
+class NET_EXPORT_PRIVATE QuicChromiumPacketBatch {
+ public:
+  // Runs with the net error of a scheduled flush that did not send every
+  // packet. The packets that were not sent are dropped. The callback may
+  // delete the batch.
+  typedef base::Callback<void(int)> ErrorCallback;
+
+  // Upper bound on the number of packets in one batch. A full batch is
+  // flushed synchronously.
+  static const size_t kMaxBatchSize = 64;
+
+  // |fd| is a socket_ns3 descriptor and must outlive the batch.
+  QuicChromiumPacketBatch(int fd, const ErrorCallback& error_callback);
+  ~QuicChromiumPacketBatch();
+
+  // Queues a packet holding |buffer|. |peer_address| may be null for
+  // connected sockets. Returns OK, ERR_ADDRESS_INVALID if the address cannot
+  // be converted, or the error of the flush a full batch needs first.
+  int Add(const char* buffer, size_t buf_len, const IPEndPoint* peer_address);
+
+  // Sends every pending packet. Returns OK if they were all sent, or the net
+  // error of the first one that was not; the rest are dropped.
+  int Flush();
+
+  size_t pending() const { return num_pending_; }
+  uint64_t batches_flushed() const { return batches_flushed_; }
+  uint64_t packets_flushed() const { return packets_flushed_; }
+
+ private:
+  void OnFlushAlarm();
+
+  int fd_;
+  ErrorCallback error_callback_;
+  ns3::Ptr<ns3::Packet> packets_[kMaxBatchSize];
+  SockaddrStorage addresses_[kMaxBatchSize];
+  // The destination of each packet in |addresses_|, or null.
+  const struct sockaddr* names_[kMaxBatchSize];
+  socklen_t name_lens_[kMaxBatchSize];
+  size_t num_pending_;
+  ns3::EventId flush_event_;
+
+  uint64_t batches_flushed_;
+  uint64_t packets_flushed_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicChromiumPacketBatch);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CHROMIUM_QUIC_CHROMIUM_PACKET_BATCH_H_
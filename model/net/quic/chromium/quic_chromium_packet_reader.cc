@@ -32,7 +32,8 @@ QuicChromiumPacketReader::QuicChromiumPacketReader(
       yield_after_packets_(yield_after_packets),
       yield_after_duration_(yield_after_duration),
       yield_after_(QuicTime::Infinite()),
-      read_buffer_(new IOBufferWithSize(static_cast<size_t>(kMaxPacketSize))),
+      read_buffer_(
+          new IOBufferWithSize(static_cast<size_t>(kMaxJumboPacketSize))),
       net_log_(net_log),
       weak_factory_(this) {
         }
@@ -49,7 +50,9 @@ void QuicChromiumPacketReader::StartReading() {
 
     DCHECK(socket_);
     read_pending_ = true;
-    get_socket(dynamic_cast<UDPClientSocket*>(socket_)->socket_.socket_)->SetRecvCallback(MakeCallback(&QuicClient::HandleRead, client_));
+    client_->WatchSocket(
+        get_socket(dynamic_cast<UDPClientSocket*>(socket_)->socket_.socket_),
+        this);
     return;
     int rv = socket_->Read(read_buffer_.get(), read_buffer_->size(),
                            base::Bind(&QuicChromiumPacketReader::OnReadComplete,
@@ -79,7 +82,7 @@ void QuicChromiumPacketReader::StartReading() {
 
 size_t QuicChromiumPacketReader::EstimateMemoryUsage() const {
   // Return the size of |read_buffer_|.
-  return kMaxPacketSize;
+  return kMaxJumboPacketSize;
 }
 
 bool QuicChromiumPacketReader::ProcessReadResult(int result) {
@@ -4,6 +4,7 @@
 
 #include "net/quic/chromium/quic_chromium_packet_writer.h"
 
+#include <algorithm>
 #include <string>
 
 #include "base/location.h"
@@ -13,6 +14,7 @@
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
 #include "net/quic/chromium/quic_chromium_client_session.h"
+#include "net/socket/udp_client_socket.h"
 
 namespace net {
 
@@ -32,6 +34,19 @@ void RecordNotReusableReason(NotReusableReason reason) {
 
 }  // namespace
 
+std::unique_ptr<QuicChromiumPacketBatch>
+QuicChromiumPacketWriter::CreatePacketBatch(DatagramClientSocket* socket) {
+  UDPClientSocket* udp_socket = dynamic_cast<UDPClientSocket*>(socket);
+  if (!udp_socket)
+    return nullptr;
+  // The writer owns the batch, so the batch never runs the callback after
+  // the writer is gone.
+  return std::unique_ptr<QuicChromiumPacketBatch>(new QuicChromiumPacketBatch(
+      udp_socket->socket_.socket_,
+      base::Bind(&QuicChromiumPacketWriter::OnFlushError,
+                 base::Unretained(this))));
+}
+
 QuicChromiumPacketWriter::ReusableIOBuffer::ReusableIOBuffer(size_t capacity)
     : IOBuffer(capacity), capacity_(capacity), size_(0) {}
 
@@ -45,16 +60,40 @@ void QuicChromiumPacketWriter::ReusableIOBuffer::Set(const char* buffer,
   std::memcpy(data(), buffer, buf_len);
 }
 
-QuicChromiumPacketWriter::QuicChromiumPacketWriter() : weak_factory_(this) {}
+QuicChromiumPacketWriter::QuicChromiumPacketWriter()
+    : max_batched_packet_size_(kDefaultMaxPacketSize),
+      write_error_(OK),
+      weak_factory_(this) {}
 
 QuicChromiumPacketWriter::QuicChromiumPacketWriter(DatagramClientSocket* socket)
     : socket_(socket),
       delegate_(nullptr),
       packet_(new ReusableIOBuffer(kMaxPacketSize)),
+      batch_(CreatePacketBatch(socket)),
+      max_batched_packet_size_(kDefaultMaxPacketSize),
+      write_error_(OK),
       write_blocked_(false),
       weak_factory_(this) {}
 
-QuicChromiumPacketWriter::~QuicChromiumPacketWriter() {}
+QuicChromiumPacketWriter::~QuicChromiumPacketWriter() {
+  if (batch_)
+    batch_->Flush();
+}
+
+void QuicChromiumPacketWriter::Flush() {
+  if (!batch_)
+    return;
+  int rv = batch_->Flush();
+  if (rv != OK)
+    OnFlushError(rv);
+}
+
+void QuicChromiumPacketWriter::OnFlushError(int error_code) {
+  UMA_HISTOGRAM_SPARSE_SLOWLY("Net.QuicSession.WriteError", -error_code);
+  write_error_ = error_code;
+  if (delegate_ != nullptr)
+    delegate_->OnWriteError(error_code);
+}
 
 void QuicChromiumPacketWriter::SetPacket(const char* buffer, size_t buf_len) {
   if (UNLIKELY(!packet_)) {
@@ -81,8 +120,30 @@ WriteResult QuicChromiumPacketWriter::WritePacket(
     const QuicSocketAddress& peer_address,
     PerPacketOptions* /*options*/) {
   DCHECK(!IsWriteBlocked());
+  if (write_error_ != OK)
+    return WriteResult(WRITE_STATUS_ERROR, write_error_);
+  // The connected ns-3 socket never blocks, so batched packets are reported
+  // as written and go out together from a ScheduleNow() event. A flush that
+  // fails later reports its error through OnFlushError().
+  if (batch_ && buf_len <= max_batched_packet_size_) {
+    int rv = batch_->Add(buffer, buf_len, nullptr);
+    if (rv != OK)
+      return WriteResult(WRITE_STATUS_ERROR, rv);
+    return WriteResult(WRITE_STATUS_OK, static_cast<int>(buf_len));
+  }
+  if (batch_) {
+    // Keeps the packets in order.
+    int rv = batch_->Flush();
+    if (rv != OK) {
+      write_error_ = rv;
+      return WriteResult(WRITE_STATUS_ERROR, rv);
+    }
+  }
   SetPacket(buffer, buf_len);
-  return WritePacketToSocketImpl();
+  WriteResult result = WritePacketToSocketImpl();
+  if (result.status == WRITE_STATUS_OK)
+    max_batched_packet_size_ = std::max(max_batched_packet_size_, buf_len);
+  return result;
 }
 
 WriteResult QuicChromiumPacketWriter::WritePacketToSocket(
@@ -162,7 +223,7 @@ void QuicChromiumPacketWriter::OnWriteComplete(int rv) {
 
 QuicByteCount QuicChromiumPacketWriter::GetMaxPacketSize(
     const QuicSocketAddress& peer_address) const {
-  return kMaxPacketSize;
+  return kMaxJumboPacketSize;
 }
 
 }  // namespace net
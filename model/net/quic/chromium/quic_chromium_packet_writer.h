@@ -7,10 +7,13 @@
 
 #include <stddef.h>
 
+#include <memory>
+
 #include "base/macros.h"
 #include "base/memory/weak_ptr.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_export.h"
+#include "net/quic/chromium/quic_chromium_packet_batch.h"
 #include "net/quic/core/quic_connection.h"
 #include "net/quic/core/quic_packet_writer.h"
 #include "net/quic/core/quic_packets.h"
@@ -89,7 +92,23 @@ class NET_EXPORT_PRIVATE QuicChromiumPacketWriter : public QuicPacketWriter {
 
   void OnWriteComplete(int rv);
 
+  // Sends every packet written so far in the current simulated instant. A
+  // failure is reported like the failure of a scheduled flush.
+  void Flush();
+
+  const QuicChromiumPacketBatch* batch() const { return batch_.get(); }
+
  private:
+  // Returns a batch writing to the descriptor of |socket|, or null unless
+  // |socket| is a UDPClientSocket backed by the ns-3 shim.  A member, as the
+  // descriptor is only visible to friends of UDPSocketPosix.
+  std::unique_ptr<QuicChromiumPacketBatch> CreatePacketBatch(
+      DatagramClientSocket* socket);
+
+  // Called when the batch fails to send packets already reported as
+  // written. Puts the writer in error and tells the delegate.
+  void OnFlushError(int error_code);
+
   void SetPacket(const char* buffer, size_t buf_len);
   WriteResult WritePacketToSocketImpl();
   DatagramClientSocket* socket_;  // Unowned.
@@ -97,6 +116,15 @@ class NET_EXPORT_PRIVATE QuicChromiumPacketWriter : public QuicPacketWriter {
   // Reused for every packet write for the lifetime of the writer.  Is
   // moved to the delegate in the case of a write error.
   scoped_refptr<ReusableIOBuffer> packet_;
+  // Packets written in the current simulated instant, sent together by one
+  // sendpackets_ns3() call. Null when the writer has no socket.
+  std::unique_ptr<QuicChromiumPacketBatch> batch_;
+  // Largest packet the socket has taken so far. Larger packets, such as MTU
+  // probes, are written synchronously so that the connection sees a packet
+  // that is too big fail on its own write.
+  size_t max_batched_packet_size_;
+  // Error of a failed flush; every later write fails with it.
+  int write_error_;
 
   // Whether a write is currently in flight.
   bool write_blocked_;
@@ -32,7 +32,8 @@ GeneralLossAlgorithm::GeneralLossAlgorithm()
       largest_sent_on_spurious_retransmit_(0),
       loss_type_(kNack),
       reordering_shift_(kDefaultLossDelayShift),
-      largest_previously_acked_(0) {}
+      largest_previously_acked_(0),
+      least_in_flight_(0) {}
 
 GeneralLossAlgorithm::GeneralLossAlgorithm(LossDetectionType loss_type)
     : loss_detection_timeout_(QuicTime::Zero()),
@@ -41,7 +42,8 @@ GeneralLossAlgorithm::GeneralLossAlgorithm(LossDetectionType loss_type)
       reordering_shift_(loss_type == kAdaptiveTime
                             ? kDefaultAdaptiveLossDelayShift
                             : kDefaultLossDelayShift),
-      largest_previously_acked_(0) {}
+      largest_previously_acked_(0),
+      least_in_flight_(0) {}
 
 LossDetectionType GeneralLossAlgorithm::GetLossDetectionType() const {
   return loss_type_;
@@ -55,6 +57,7 @@ void GeneralLossAlgorithm::SetLossDetectionType(LossDetectionType loss_type) {
                           ? kDefaultAdaptiveLossDelayShift
                           : kDefaultLossDelayShift;
   largest_previously_acked_ = 0;
+  least_in_flight_ = 0;
 }
 
 // Uses nack counts to decide when packets are lost.
@@ -71,8 +74,21 @@ void GeneralLossAlgorithm::DetectLosses(
       std::max(QuicTime::Delta::FromMilliseconds(kMinLossDelayMs),
                max_rtt + (max_rtt >> reordering_shift_));
   QuicPacketNumber packet_number = unacked_packets.GetLeastUnacked();
-  for (QuicUnackedPacketMap::const_iterator it = unacked_packets.begin();
-       it != unacked_packets.end() && packet_number <= largest_newly_acked;
+  QuicUnackedPacketMap::const_iterator it = unacked_packets.begin();
+  if (least_in_flight_ > packet_number) {
+    if (least_in_flight_ > unacked_packets.largest_sent_packet() + 1) {
+      QUIC_BUG << "least_in_flight: " << least_in_flight_
+               << " is greater than largest_sent_packet + 1: "
+               << unacked_packets.largest_sent_packet() + 1;
+      return;
+    }
+    // The unacked packets are indexed by packet number: skip the acked and
+    // lost ones in one step.
+    it += least_in_flight_ - packet_number;
+    packet_number = least_in_flight_;
+  }
+  least_in_flight_ = 0;
+  for (; it != unacked_packets.end() && packet_number <= largest_newly_acked;
        ++it, ++packet_number) {
     if (!it->in_flight) {
       continue;
@@ -107,6 +123,9 @@ void GeneralLossAlgorithm::DetectLosses(
       QuicTime when_lost = it->sent_time + loss_delay;
       if (time < when_lost) {
         loss_detection_timeout_ = when_lost;
+        if (least_in_flight_ == 0) {
+          least_in_flight_ = packet_number;
+        }
         break;
       }
       packets_lost->push_back(std::make_pair(packet_number, it->bytes_sent));
@@ -119,6 +138,14 @@ void GeneralLossAlgorithm::DetectLosses(
       packets_lost->push_back(std::make_pair(packet_number, it->bytes_sent));
       continue;
     }
+    // The packet stays in flight.
+    if (least_in_flight_ == 0) {
+      least_in_flight_ = packet_number;
+    }
+  }
+  if (least_in_flight_ == 0) {
+    // Every packet up to the largest acked is acked or lost.
+    least_in_flight_ = largest_newly_acked + 1;
   }
   largest_previously_acked_ = largest_newly_acked;
 }
@@ -53,6 +53,11 @@ class QUIC_EXPORT_PRIVATE GeneralLossAlgorithm : public LossDetectionInterface {
       const RttStats& rtt_stats,
       QuicPacketNumber spurious_retransmission) override;
 
+  // Makes the next call to DetectLosses scan every unacked packet again.
+  // Called when the losses reported by the previous call were not applied,
+  // so those packets are still in flight below |least_in_flight_|.
+  void ResetLeastInFlight() { least_in_flight_ = 0; }
+
   int reordering_shift() const { return reordering_shift_; }
 
  private:
@@ -69,6 +74,13 @@ class QUIC_EXPORT_PRIVATE GeneralLossAlgorithm : public LossDetectionInterface {
   int reordering_shift_;
   // The largest newly acked from the previous call to DetectLosses.
   QuicPacketNumber largest_previously_acked_;
+  // Packets below this one were neither in flight nor undecided at the end of
+  // the previous call to DetectLosses, and packets only go back in flight
+  // above the largest acked, so the next call starts from here instead of
+  // scanning every unacked packet.  This assumes the caller applies every
+  // loss it is told about; ResetLeastInFlight covers the ones it drops.
+  // 0 when unknown.
+  QuicPacketNumber least_in_flight_;
 
   DISALLOW_COPY_AND_ASSIGN(GeneralLossAlgorithm);
 };
@@ -0,0 +1,200 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/congestion_control/pcc_monitor_interval_queue.h"
+
+#include <cmath>
+
+#include "net/quic/platform/api/quic_bug_tracker.h"
+#include "net/quic/platform/api/quic_flags.h"
+#include "net/quic/platform/api/quic_logging.h"
+
+namespace net {
+
+namespace {
+// Exponent of the throughput reward, below 1 so that senders sharing a
+// bottleneck converge to a fair share.
+const double kThroughputExponent = 0.9;
+// RTT gradients smaller than this are noise, not a queue building up.
+const double kRttGradientTolerance = 0.01;
+}  // namespace
+
+MonitorInterval::MonitorInterval(QuicBandwidth sending_rate,
+                                 bool is_useful,
+                                 QuicTime start_time,
+                                 QuicTime end_time)
+    : sending_rate(sending_rate),
+      is_useful(is_useful),
+      end_time(end_time),
+      first_packet_sent_time(start_time),
+      last_packet_sent_time(start_time),
+      first_packet_number(0),
+      last_packet_number(0),
+      bytes_sent(0),
+      bytes_acked(0),
+      bytes_lost(0),
+      utility(0.0) {}
+
+MonitorInterval::MonitorInterval(const MonitorInterval& other) = default;
+
+MonitorInterval::~MonitorInterval() {}
+
+PccMonitorIntervalQueue::PccMonitorIntervalQueue(
+    PccMonitorIntervalQueueDelegateInterface* delegate)
+    : num_useful_intervals_(0), delegate_(delegate) {}
+
+PccMonitorIntervalQueue::~PccMonitorIntervalQueue() {}
+
+void PccMonitorIntervalQueue::EnqueueNewMonitorInterval(
+    QuicBandwidth sending_rate,
+    bool is_useful,
+    QuicTime start_time,
+    QuicTime end_time) {
+  if (is_useful) {
+    ++num_useful_intervals_;
+  }
+  monitor_intervals_.emplace_back(sending_rate, is_useful, start_time,
+                                  end_time);
+}
+
+void PccMonitorIntervalQueue::OnPacketSent(QuicTime sent_time,
+                                           QuicPacketNumber packet_number,
+                                           QuicByteCount bytes) {
+  if (monitor_intervals_.empty()) {
+    QUIC_BUG << "OnPacketSent called with no monitor interval";
+    return;
+  }
+  MonitorInterval& interval = monitor_intervals_.back();
+  if (interval.bytes_sent == 0) {
+    interval.first_packet_sent_time = sent_time;
+    interval.first_packet_number = packet_number;
+  }
+  interval.last_packet_sent_time = sent_time;
+  interval.last_packet_number = packet_number;
+  interval.bytes_sent += bytes;
+}
+
+void PccMonitorIntervalQueue::OnCongestionEvent(
+    const SendAlgorithmInterface::CongestionVector& acked_packets,
+    const SendAlgorithmInterface::CongestionVector& lost_packets,
+    bool rtt_updated,
+    QuicTime::Delta latest_rtt,
+    QuicTime event_time,
+    QuicTime::Delta timeout) {
+  // Both vectors are sorted, and so are the MIs: walk them together.
+  auto attribute = [this](
+      const SendAlgorithmInterface::CongestionVector& packets,
+      QuicByteCount MonitorInterval::*counter) {
+    auto interval = monitor_intervals_.begin();
+    for (const auto& packet : packets) {
+      while (interval != monitor_intervals_.end() &&
+             (interval->bytes_sent == 0 ||
+              interval->last_packet_number < packet.first)) {
+        ++interval;
+      }
+      if (interval == monitor_intervals_.end()) {
+        return;
+      }
+      // Packets sent before the oldest MI in the queue, or not tracked by
+      // any MI, are skipped.
+      if (packet.first >= interval->first_packet_number) {
+        (*interval).*counter += packet.second;
+      }
+    }
+  };
+  attribute(acked_packets, &MonitorInterval::bytes_acked);
+  attribute(lost_packets, &MonitorInterval::bytes_lost);
+
+  if (rtt_updated && !acked_packets.empty()) {
+    // |latest_rtt| was measured on the largest acked packet.
+    QuicPacketNumber largest_acked = acked_packets.back().first;
+    for (MonitorInterval& interval : monitor_intervals_) {
+      if (interval.bytes_sent > 0 &&
+          interval.first_packet_number <= largest_acked &&
+          largest_acked <= interval.last_packet_number) {
+        interval.packet_rtt_samples.emplace_back(event_time, latest_rtt);
+        break;
+      }
+    }
+  }
+
+  while (IsFrontComplete(event_time, timeout)) {
+    MonitorInterval interval = monitor_intervals_.front();
+    monitor_intervals_.pop_front();
+    if (!interval.is_useful) {
+      continue;
+    }
+    --num_useful_intervals_;
+    interval.utility =
+        ComputeUtility(interval, FLAGS_quic_pcc_latency_coefficient,
+                       FLAGS_quic_pcc_loss_coefficient);
+    delegate_->OnUtilityAvailable(interval);
+  }
+}
+
+void PccMonitorIntervalQueue::MarkAllNotUseful() {
+  for (MonitorInterval& interval : monitor_intervals_) {
+    interval.is_useful = false;
+  }
+  num_useful_intervals_ = 0;
+}
+
+const MonitorInterval& PccMonitorIntervalQueue::current() const {
+  DCHECK(!monitor_intervals_.empty());
+  return monitor_intervals_.back();
+}
+
+bool PccMonitorIntervalQueue::IsFrontComplete(QuicTime event_time,
+                                              QuicTime::Delta timeout) const {
+  // The newest MI may still get packets.
+  if (monitor_intervals_.size() < 2) {
+    return false;
+  }
+  const MonitorInterval& front = monitor_intervals_.front();
+  return front.bytes_acked + front.bytes_lost >= front.bytes_sent ||
+         event_time > front.last_packet_sent_time + timeout;
+}
+
+// static
+float PccMonitorIntervalQueue::ComputeUtility(const MonitorInterval& interval,
+                                              double latency_coefficient,
+                                              double loss_coefficient) {
+  if (interval.bytes_sent == 0) {
+    return 0.0;
+  }
+  double rate_mbps = interval.sending_rate.ToBitsPerSecond() / 1e6;
+
+  // Least squares slope of the RTT samples over time, in seconds per second.
+  double rtt_gradient = 0.0;
+  const std::vector<PacketRttSample>& samples = interval.packet_rtt_samples;
+  if (samples.size() >= 2) {
+    double sum_x = 0.0, sum_y = 0.0, sum_xx = 0.0, sum_xy = 0.0;
+    for (const PacketRttSample& sample : samples) {
+      double x = (sample.ack_time - samples.front().ack_time).ToMicroseconds() /
+                 1e6;
+      double y = sample.rtt.ToMicroseconds() / 1e6;
+      sum_x += x;
+      sum_y += y;
+      sum_xx += x * x;
+      sum_xy += x * y;
+    }
+    double n = samples.size();
+    double denominator = n * sum_xx - sum_x * sum_x;
+    if (denominator > 0) {
+      rtt_gradient = (n * sum_xy - sum_x * sum_y) / denominator;
+    }
+  }
+  if (std::abs(rtt_gradient) < kRttGradientTolerance) {
+    rtt_gradient = 0.0;
+  }
+
+  double loss_rate = static_cast<double>(interval.bytes_lost) /
+                     static_cast<double>(interval.bytes_sent);
+
+  return static_cast<float>(std::pow(rate_mbps, kThroughputExponent) -
+                            latency_coefficient * rate_mbps * rtt_gradient -
+                            loss_coefficient * rate_mbps * loss_rate);
+}
+
+}  // namespace net
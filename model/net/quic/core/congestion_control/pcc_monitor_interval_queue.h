@@ -0,0 +1,136 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Monitor intervals of the PCC sender, and the queue that attributes acks,
+// losses and RTT samples to them.
+
+#ifndef NET_QUIC_CORE_CONGESTION_CONTROL_PCC_MONITOR_INTERVAL_QUEUE_H_
+#define NET_QUIC_CORE_CONGESTION_CONTROL_PCC_MONITOR_INTERVAL_QUEUE_H_
+
+#include <deque>
+#include <vector>
+
+#include "base/macros.h"
+#include "net/quic/core/congestion_control/send_algorithm_interface.h"
+#include "net/quic/core/quic_bandwidth.h"
+#include "net/quic/core/quic_packets.h"
+#include "net/quic/core/quic_time.h"
+#include "net/quic/platform/api/quic_export.h"
+
+namespace net {
+
+// An RTT measured when the packet it was taken on got acked.
+struct QUIC_EXPORT_PRIVATE PacketRttSample {
+  PacketRttSample(QuicTime ack_time, QuicTime::Delta rtt)
+      : ack_time(ack_time), rtt(rtt) {}
+
+  QuicTime ack_time;
+  QuicTime::Delta rtt;
+};
+
+// A monitor interval (MI) is a stretch of packets sent at one rate.  Once
+// every packet of an MI is acked or lost, its utility tells the sender how
+// good that rate was.
+struct QUIC_EXPORT_PRIVATE MonitorInterval {
+  MonitorInterval(QuicBandwidth sending_rate,
+                  bool is_useful,
+                  QuicTime start_time,
+                  QuicTime end_time);
+  MonitorInterval(const MonitorInterval& other);
+  ~MonitorInterval();
+
+  // Rate the packets of the MI were paced at.
+  QuicBandwidth sending_rate;
+  // Whether the sender waits on the utility of this MI.  MIs sent while the
+  // sender has nothing to learn are not.
+  bool is_useful;
+  // New packets belong to the next MI from |end_time| on.
+  QuicTime end_time;
+
+  QuicTime first_packet_sent_time;
+  QuicTime last_packet_sent_time;
+  QuicPacketNumber first_packet_number;
+  QuicPacketNumber last_packet_number;
+
+  QuicByteCount bytes_sent;
+  QuicByteCount bytes_acked;
+  QuicByteCount bytes_lost;
+
+  std::vector<PacketRttSample> packet_rtt_samples;
+
+  // Valid once the MI is complete.
+  float utility;
+};
+
+// Notified of the utility of every useful MI, in the order they were sent.
+class QUIC_EXPORT_PRIVATE PccMonitorIntervalQueueDelegateInterface {
+ public:
+  virtual ~PccMonitorIntervalQueueDelegateInterface() {}
+
+  virtual void OnUtilityAvailable(const MonitorInterval& interval) = 0;
+};
+
+class QUIC_EXPORT_PRIVATE PccMonitorIntervalQueue {
+ public:
+  explicit PccMonitorIntervalQueue(
+      PccMonitorIntervalQueueDelegateInterface* delegate);
+  ~PccMonitorIntervalQueue();
+
+  // Starts a new MI, which gets the packets sent from now on.
+  void EnqueueNewMonitorInterval(QuicBandwidth sending_rate,
+                                 bool is_useful,
+                                 QuicTime start_time,
+                                 QuicTime end_time);
+
+  // Adds a packet to the newest MI.
+  void OnPacketSent(QuicTime sent_time,
+                    QuicPacketNumber packet_number,
+                    QuicByteCount bytes);
+
+  // Attributes acked and lost packets to their MIs, and |latest_rtt|, when
+  // |rtt_updated|, to the MI of the largest acked packet.  Then completes the
+  // MIs at the front of the queue whose packets are all accounted for, or
+  // that saw no ack or loss for |timeout| after their last packet: packets
+  // removed from flight without a loss, e.g. by an RTO, are never reported.
+  void OnCongestionEvent(
+      const SendAlgorithmInterface::CongestionVector& acked_packets,
+      const SendAlgorithmInterface::CongestionVector& lost_packets,
+      bool rtt_updated,
+      QuicTime::Delta latest_rtt,
+      QuicTime event_time,
+      QuicTime::Delta timeout);
+
+  // Stops waiting on the MIs in the queue: their utilities are dropped.
+  void MarkAllNotUseful();
+
+  // Returns the newest MI, which must exist.
+  const MonitorInterval& current() const;
+
+  bool empty() const { return monitor_intervals_.empty(); }
+  size_t size() const { return monitor_intervals_.size(); }
+  // Number of useful MIs whose utility is yet to be reported.
+  size_t num_useful_intervals() const { return num_useful_intervals_; }
+
+  // Vivace utility of a complete MI: rewards throughput, penalizes a rising
+  // RTT and loss.
+  static float ComputeUtility(const MonitorInterval& interval,
+                              double latency_coefficient,
+                              double loss_coefficient);
+
+ private:
+  // Whether the front MI is done: no more packets go into it and they are all
+  // acked or lost, or it timed out.
+  bool IsFrontComplete(QuicTime event_time, QuicTime::Delta timeout) const;
+
+  std::deque<MonitorInterval> monitor_intervals_;
+  size_t num_useful_intervals_;
+  // Not owned.
+  PccMonitorIntervalQueueDelegateInterface* delegate_;
+
+  DISALLOW_COPY_AND_ASSIGN(PccMonitorIntervalQueue);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_CONGESTION_CONTROL_PCC_MONITOR_INTERVAL_QUEUE_H_
@@ -0,0 +1,338 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/congestion_control/pcc_sender.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include "net/quic/core/congestion_control/rtt_stats.h"
+#include "net/quic/platform/api/quic_logging.h"
+
+namespace net {
+
+namespace {
+// Constants based on TCP defaults.
+const QuicByteCount kMaxSegmentSize = kDefaultTCPMSS;
+// The minimum CWND, so that delayed acks do not stall a slow sender.
+const QuicByteCount kMinimumCongestionWindow = 4 * kMaxSegmentSize;
+// The bytes in flight are bounded to this many times rate * RTT.
+const float kCongestionWindowGain = 2.0f;
+// The rate is never reduced below this.
+const QuicBandwidth kMinSendingRate = QuicBandwidth::FromKBitsPerSecond(200);
+
+// The probing MIs are sent at (1 +- kProbingStepSize) times the rate.
+const double kProbingStepSize = 0.05;
+// Rate change, in Mbps, per unit of utility gradient in DECISION_MADE.
+const double kRateChangeStepSize = 1.0;
+// A single rate change is bounded to this fraction of the rate, plus
+// kIncrementalBoundary for every step in a row that hit the bound.
+const double kInitialBoundary = 0.05;
+const double kIncrementalBoundary = 0.1;
+
+// An MI whose packets are not all acked or lost this many RTTs after its last
+// packet is scored with what is known.
+const int kMonitorIntervalTimeoutRtts = 4;
+}  // namespace
+
+PccSender::PccSender(const RttStats* rtt_stats,
+                     QuicPacketCount initial_congestion_window,
+                     QuicPacketCount max_congestion_window,
+                     QuicRandom* random)
+    : rtt_stats_(rtt_stats),
+      random_(random),
+      mode_(STARTING),
+      sending_rate_(QuicBandwidth::FromBytesAndTimeDelta(
+          initial_congestion_window * kMaxSegmentSize,
+          QuicTime::Delta::FromMicroseconds(rtt_stats->initial_rtt_us()))),
+      initial_sending_rate_(sending_rate_),
+      max_congestion_window_(max_congestion_window * kMaxSegmentSize),
+      interval_queue_(this),
+      best_utility_(0.0),
+      best_rate_(QuicBandwidth::Zero()),
+      direction_(0),
+      rounds_(0),
+      boundary_hits_(0),
+      previous_rate_(QuicBandwidth::Zero()),
+      previous_utility_(0.0) {}
+
+PccSender::~PccSender() {}
+
+bool PccSender::InSlowStart() const {
+  return mode_ == STARTING;
+}
+
+bool PccSender::InRecovery() const {
+  return false;
+}
+
+void PccSender::AdjustNetworkParameters(QuicBandwidth bandwidth,
+                                        QuicTime::Delta rtt) {
+  if (mode_ == STARTING && !bandwidth.IsZero()) {
+    sending_rate_ = std::max(bandwidth, kMinSendingRate);
+  }
+}
+
+void PccSender::OnCongestionEvent(bool rtt_updated,
+                                  QuicByteCount prior_in_flight,
+                                  QuicTime event_time,
+                                  const CongestionVector& acked_packets,
+                                  const CongestionVector& lost_packets) {
+  interval_queue_.OnCongestionEvent(acked_packets, lost_packets, rtt_updated,
+                                    rtt_stats_->latest_rtt(), event_time,
+                                    kMonitorIntervalTimeoutRtts * GetRtt());
+}
+
+bool PccSender::OnPacketSent(QuicTime sent_time,
+                             QuicByteCount bytes_in_flight,
+                             QuicPacketNumber packet_number,
+                             QuicByteCount bytes,
+                             HasRetransmittableData is_retransmittable) {
+  if (is_retransmittable != HAS_RETRANSMITTABLE_DATA) {
+    return false;
+  }
+  if (interval_queue_.empty() ||
+      sent_time >= interval_queue_.current().end_time) {
+    StartMonitorInterval(sent_time);
+  }
+  interval_queue_.OnPacketSent(sent_time, packet_number, bytes);
+  return true;
+}
+
+void PccSender::OnRetransmissionTimeout(bool packets_retransmitted) {
+  if (!packets_retransmitted) {
+    return;
+  }
+  // The packets the RTO gave up on are lost to every MI: back off and look
+  // for a direction again.
+  sending_rate_ = std::max(sending_rate_ * 0.5f, kMinSendingRate);
+  EnterProbing();
+}
+
+void PccSender::OnConnectionMigration() {
+  mode_ = STARTING;
+  sending_rate_ = initial_sending_rate_;
+  best_utility_ = 0.0;
+  best_rate_ = QuicBandwidth::Zero();
+  probing_rates_.clear();
+  probing_results_.clear();
+  interval_queue_.MarkAllNotUseful();
+}
+
+QuicTime::Delta PccSender::TimeUntilSend(QuicTime now,
+                                         QuicByteCount bytes_in_flight) {
+  if (bytes_in_flight < GetCongestionWindow()) {
+    return QuicTime::Delta::Zero();
+  }
+  return QuicTime::Delta::Infinite();
+}
+
+QuicBandwidth PccSender::PacingRate(QuicByteCount bytes_in_flight) const {
+  // Probing MIs are paced at their own rate.
+  return interval_queue_.empty() ? sending_rate_
+                                 : interval_queue_.current().sending_rate;
+}
+
+QuicBandwidth PccSender::BandwidthEstimate() const {
+  return sending_rate_;
+}
+
+QuicByteCount PccSender::GetCongestionWindow() const {
+  QuicByteCount congestion_window = static_cast<QuicByteCount>(
+      kCongestionWindowGain * (PacingRate(0) * GetRtt()));
+  return std::min(std::max(congestion_window, kMinimumCongestionWindow),
+                  max_congestion_window_);
+}
+
+QuicByteCount PccSender::GetSlowStartThreshold() const {
+  return 0;
+}
+
+CongestionControlType PccSender::GetCongestionControlType() const {
+  return kPCC;
+}
+
+std::string PccSender::GetDebugState() const {
+  std::ostringstream stream;
+  stream << "Mode: " << mode_ << std::endl;
+  stream << "Sending rate: " << sending_rate_ << std::endl;
+  stream << "Congestion window: " << GetCongestionWindow() << " bytes"
+         << std::endl;
+  stream << "Monitor intervals: " << interval_queue_.size() << " ("
+         << interval_queue_.num_useful_intervals() << " useful)" << std::endl;
+  if (mode_ == DECISION_MADE) {
+    stream << "Direction: " << direction_ << ", rounds: " << rounds_
+           << std::endl;
+  }
+  return stream.str();
+}
+
+void PccSender::OnUtilityAvailable(const MonitorInterval& interval) {
+  switch (mode_) {
+    case STARTING:
+      if (best_rate_.IsZero() || interval.utility > best_utility_) {
+        best_utility_ = interval.utility;
+        best_rate_ = interval.sending_rate;
+        return;
+      }
+      // Doubling stopped paying off: the best rate so far is the starting
+      // point of the search.
+      QUIC_DVLOG(1) << "Leaving STARTING at " << best_rate_;
+      sending_rate_ = best_rate_;
+      EnterProbing();
+      return;
+    case PROBING:
+      probing_results_.push_back(interval);
+      if (probing_results_.size() == 4) {
+        OnProbingComplete();
+      }
+      return;
+    case DECISION_MADE: {
+      // QuicBandwidth clamps differences at zero.
+      double rate_difference_mbps = (interval.sending_rate.ToBitsPerSecond() -
+                                     previous_rate_.ToBitsPerSecond()) /
+                                    1e6;
+      double gradient =
+          rate_difference_mbps == 0
+              ? 0
+              : (interval.utility - previous_utility_) / rate_difference_mbps;
+      if (gradient * direction_ <= 0) {
+        // The utility no longer improves in this direction.
+        EnterProbing();
+        return;
+      }
+      previous_rate_ = interval.sending_rate;
+      previous_utility_ = interval.utility;
+      ++rounds_;
+      ChangeSendingRate(kRateChangeStepSize * rounds_ * gradient);
+      return;
+    }
+  }
+}
+
+QuicTime::Delta PccSender::GetRtt() const {
+  if (!rtt_stats_->smoothed_rtt().IsZero()) {
+    return rtt_stats_->smoothed_rtt();
+  }
+  return QuicTime::Delta::FromMicroseconds(rtt_stats_->initial_rtt_us());
+}
+
+void PccSender::StartMonitorInterval(QuicTime sent_time) {
+  QuicBandwidth rate = sending_rate_;
+  bool is_useful = false;
+  switch (mode_) {
+    case STARTING:
+      if (!interval_queue_.empty()) {
+        sending_rate_ = sending_rate_ * 2;
+        rate = sending_rate_;
+      }
+      is_useful = true;
+      break;
+    case PROBING:
+      if (!probing_rates_.empty()) {
+        rate = probing_rates_.front();
+        probing_rates_.erase(probing_rates_.begin());
+        is_useful = true;
+      }
+      break;
+    case DECISION_MADE:
+      // One useful MI at a time: the next rate depends on its utility.
+      is_useful = interval_queue_.num_useful_intervals() == 0;
+      break;
+  }
+  interval_queue_.EnqueueNewMonitorInterval(rate, is_useful, sent_time,
+                                            sent_time + GetRtt());
+}
+
+void PccSender::EnterProbing() {
+  mode_ = PROBING;
+  interval_queue_.MarkAllNotUseful();
+  probing_results_.clear();
+  probing_rates_.clear();
+  const QuicBandwidth higher = sending_rate_ * (1 + kProbingStepSize);
+  const QuicBandwidth lower = sending_rate_ * (1 - kProbingStepSize);
+  // Two pairs, each in random order so that a trend in the path does not
+  // always favour the same side.
+  for (int pair = 0; pair < 2; ++pair) {
+    if (random_->RandUint64() % 2 == 0) {
+      probing_rates_.push_back(higher);
+      probing_rates_.push_back(lower);
+    } else {
+      probing_rates_.push_back(lower);
+      probing_rates_.push_back(higher);
+    }
+  }
+  direction_ = 0;
+  rounds_ = 0;
+  boundary_hits_ = 0;
+}
+
+void PccSender::OnProbingComplete() {
+  int votes = 0;
+  double gradient = 0;
+  QuicBandwidth chosen_rate = QuicBandwidth::Zero();
+  float chosen_utility = 0.0;
+  for (size_t pair = 0; pair < 2; ++pair) {
+    const MonitorInterval& first = probing_results_[2 * pair];
+    const MonitorInterval& second = probing_results_[2 * pair + 1];
+    const MonitorInterval& high =
+        first.sending_rate > second.sending_rate ? first : second;
+    const MonitorInterval& low = &high == &first ? second : first;
+    votes += high.utility > low.utility ? 1 : -1;
+    gradient += (high.utility - low.utility) /
+                ((high.sending_rate - low.sending_rate).ToBitsPerSecond() /
+                 1e6) /
+                2;
+  }
+  if (votes == 0) {
+    // The pairs disagree: probe again around the same rate.
+    EnterProbing();
+    return;
+  }
+
+  direction_ = votes > 0 ? 1 : -1;
+  for (const MonitorInterval& interval : probing_results_) {
+    if ((interval.sending_rate > sending_rate_) == (direction_ > 0)) {
+      chosen_rate = interval.sending_rate;
+      chosen_utility += interval.utility / 2;
+    }
+  }
+  QUIC_DVLOG(1) << "Probing around " << sending_rate_ << " chose direction "
+                << direction_;
+  mode_ = DECISION_MADE;
+  rounds_ = 1;
+  previous_rate_ = chosen_rate;
+  previous_utility_ = chosen_utility;
+  sending_rate_ = chosen_rate;
+  // The vote picks the direction; the summed gradient only sizes the step,
+  // since a large gradient of one pair can outweigh the other.
+  ChangeSendingRate(kRateChangeStepSize * direction_ * std::abs(gradient));
+}
+
+void PccSender::ChangeSendingRate(double rate_change_mbps) {
+  double rate_mbps = sending_rate_.ToBitsPerSecond() / 1e6;
+  double boundary =
+      rate_mbps * (kInitialBoundary + boundary_hits_ * kIncrementalBoundary);
+  if (std::abs(rate_change_mbps) > boundary) {
+    rate_change_mbps = std::copysign(boundary, rate_change_mbps);
+    ++boundary_hits_;
+  } else {
+    boundary_hits_ = 0;
+  }
+  sending_rate_ = std::max(
+      QuicBandwidth::FromBitsPerSecond(
+          static_cast<int64_t>((rate_mbps + rate_change_mbps) * 1e6)),
+      kMinSendingRate);
+}
+
+std::ostream& operator<<(std::ostream& os, const PccSender::SenderMode& mode) {
+  static const char* const mode_strings[] = {
+      "STARTING", "PROBING", "DECISION_MADE",
+  };
+  os << mode_strings[mode];
+  return os;
+}
+
+}  // namespace net
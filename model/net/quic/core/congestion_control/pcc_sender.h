@@ -0,0 +1,145 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// PCC Vivace (Performance-oriented Congestion Control) algorithm.
+
+#ifndef NET_QUIC_CORE_CONGESTION_CONTROL_PCC_SENDER_H_
+#define NET_QUIC_CORE_CONGESTION_CONTROL_PCC_SENDER_H_
+
+#include <ostream>
+
+#include "base/macros.h"
+#include "net/quic/core/congestion_control/pcc_monitor_interval_queue.h"
+#include "net/quic/core/congestion_control/send_algorithm_interface.h"
+#include "net/quic/core/crypto/quic_random.h"
+#include "net/quic/core/quic_bandwidth.h"
+#include "net/quic/core/quic_packets.h"
+#include "net/quic/core/quic_time.h"
+#include "net/quic/platform/api/quic_export.h"
+
+namespace net {
+
+class RttStats;
+
+// PccSender implements the PCC Vivace rate control.  Instead of reacting to
+// individual losses, it sends at a rate for a monitor interval (MI) of about
+// one RTT, scores the MI with a utility function of its throughput, RTT
+// gradient and loss rate, and moves the rate along the utility gradient.
+// Random loss that does not come with a rising RTT costs little utility, so
+// PCC keeps its rate on lossy links where loss-based senders collapse.
+//
+// PCC is rate based and relies on pacing; the congestion window only bounds
+// the bytes in flight to a few bandwidth-delay products.
+class QUIC_EXPORT_PRIVATE PccSender
+    : public SendAlgorithmInterface,
+      public PccMonitorIntervalQueueDelegateInterface {
+ public:
+  enum SenderMode {
+    // Doubles the rate every MI until the utility drops.
+    STARTING,
+    // Compares the utilities of a slightly higher and a slightly lower rate,
+    // twice each, to find the direction to move in.
+    PROBING,
+    // Moves the rate in the direction found, by steps proportional to the
+    // utility gradient.
+    DECISION_MADE,
+  };
+
+  PccSender(const RttStats* rtt_stats,
+            QuicPacketCount initial_congestion_window,
+            QuicPacketCount max_congestion_window,
+            QuicRandom* random);
+  ~PccSender() override;
+
+  // Start implementation of SendAlgorithmInterface.
+  bool InSlowStart() const override;
+  bool InRecovery() const override;
+
+  void SetFromConfig(const QuicConfig& config,
+                     Perspective perspective) override {}
+  void AdjustNetworkParameters(QuicBandwidth bandwidth,
+                               QuicTime::Delta rtt) override;
+  void SetNumEmulatedConnections(int num_connections) override {}
+  void OnCongestionEvent(bool rtt_updated,
+                         QuicByteCount prior_in_flight,
+                         QuicTime event_time,
+                         const CongestionVector& acked_packets,
+                         const CongestionVector& lost_packets) override;
+  bool OnPacketSent(QuicTime sent_time,
+                    QuicByteCount bytes_in_flight,
+                    QuicPacketNumber packet_number,
+                    QuicByteCount bytes,
+                    HasRetransmittableData is_retransmittable) override;
+  void OnRetransmissionTimeout(bool packets_retransmitted) override;
+  void OnConnectionMigration() override;
+  QuicTime::Delta TimeUntilSend(QuicTime now,
+                                QuicByteCount bytes_in_flight) override;
+  QuicBandwidth PacingRate(QuicByteCount bytes_in_flight) const override;
+  QuicBandwidth BandwidthEstimate() const override;
+  QuicByteCount GetCongestionWindow() const override;
+  QuicByteCount GetSlowStartThreshold() const override;
+  CongestionControlType GetCongestionControlType() const override;
+  std::string GetDebugState() const override;
+  void OnApplicationLimited(QuicByteCount bytes_in_flight) override {}
+  // End implementation of SendAlgorithmInterface.
+
+  // Implementation of PccMonitorIntervalQueueDelegateInterface.
+  void OnUtilityAvailable(const MonitorInterval& interval) override;
+
+  SenderMode mode() const { return mode_; }
+
+ private:
+  // Returns the RTT MIs and the congestion window are sized by.
+  QuicTime::Delta GetRtt() const;
+  // Starts the MI that the packet sent at |sent_time| goes into.
+  void StartMonitorInterval(QuicTime sent_time);
+  // Chooses the rates of the four probing MIs around |sending_rate_|.
+  void EnterProbing();
+  // Moves |sending_rate_| by |rate_change_mbps|, clipped to the dynamic
+  // change boundary.
+  void ChangeSendingRate(double rate_change_mbps);
+  // Decides on a direction once the four probing utilities are in.
+  void OnProbingComplete();
+
+  const RttStats* rtt_stats_;
+  QuicRandom* random_;
+
+  SenderMode mode_;
+
+  // The rate new MIs are sent at, apart from probing MIs.
+  QuicBandwidth sending_rate_;
+  QuicBandwidth initial_sending_rate_;
+
+  QuicByteCount max_congestion_window_;
+
+  PccMonitorIntervalQueue interval_queue_;
+
+  // STARTING: the best utility so far and the rate that achieved it.
+  float best_utility_;
+  QuicBandwidth best_rate_;
+
+  // PROBING: the rates of the probing MIs not sent yet, in sending order,
+  // and the utilities of those already complete.
+  std::vector<QuicBandwidth> probing_rates_;
+  std::vector<MonitorInterval> probing_results_;
+
+  // DECISION_MADE: +1 to increase the rate, -1 to decrease it.
+  int direction_;
+  // Consecutive steps taken in |direction_|; amplifies the step size.
+  int rounds_;
+  // Times in a row a step was clipped by the dynamic change boundary.
+  int boundary_hits_;
+  // Rate and utility of the previous useful MI, for the gradient.
+  QuicBandwidth previous_rate_;
+  float previous_utility_;
+
+  DISALLOW_COPY_AND_ASSIGN(PccSender);
+};
+
+QUIC_EXPORT_PRIVATE std::ostream& operator<<(std::ostream& os,
+                                             const PccSender::SenderMode& mode);
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_CONGESTION_CONTROL_PCC_SENDER_H_
@@ -25,20 +25,18 @@ SendAlgorithmInterface* SendAlgorithmInterface::Create(
     CongestionControlType congestion_control_type,
     QuicRandom* random,
     QuicConnectionStats* stats,
-    QuicPacketCount initial_congestion_window) {
-  QuicPacketCount max_congestion_window = kDefaultMaxCongestionWindowPackets;
+    QuicPacketCount initial_congestion_window,
+    QuicPacketCount max_congestion_window) {
   switch (congestion_control_type) {
     case kBBR:
       return new BbrSender(rtt_stats, unacked_packets,
                            initial_congestion_window, max_congestion_window,
                            random);
     case kPCC:
-      if (FLAGS_quic_reloadable_flag_quic_enable_pcc) {
-        return CreatePccSender(clock, rtt_stats, unacked_packets, random, stats,
-                               initial_congestion_window,
-                               max_congestion_window);
-      }
-    // Fall back to CUBIC if PCC is disabled.
+      // FLAGS_quic_reloadable_flag_quic_enable_pcc only gates the TPCC
+      // connection option, so that PCC is never chosen by the peer alone.
+      return CreatePccSender(clock, rtt_stats, unacked_packets, random, stats,
+                             initial_congestion_window, max_congestion_window);
     case kCubic:
       if (!FLAGS_quic_reloadable_flag_quic_disable_packets_based_cc) {
         return new TcpCubicSenderPackets(
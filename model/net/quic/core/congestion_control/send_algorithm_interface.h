@@ -40,7 +40,9 @@ class QUIC_EXPORT_PRIVATE SendAlgorithmInterface {
       CongestionControlType type,
       QuicRandom* random,
       QuicConnectionStats* stats,
-      QuicPacketCount initial_congestion_window);
+      QuicPacketCount initial_congestion_window,
+      QuicPacketCount max_congestion_window =
+          kDefaultMaxCongestionWindowPackets);
 
   virtual ~SendAlgorithmInterface() {}
 
@@ -45,6 +45,9 @@ const QuicTag kC255 = TAG('C', '2', '5', '5');   // ECDH, Curve25519
 // AEAD algorithms
 const QuicTag kAESG = TAG('A', 'E', 'S', 'G');   // AES128 + GCM-12
 const QuicTag kCC20 = TAG('C', 'C', '2', '0');   // ChaCha20 + Poly1305 RFC7539
+const QuicTag kNULN = TAG('N', 'U', 'L', 'N');   // No encryption, 12 byte
+                                                 // header hash. Simulation
+                                                 // only.
 
 // Socket receive buffer
 const QuicTag kSRBF = TAG('S', 'R', 'B', 'F');   // Socket receive buffer
@@ -157,6 +160,7 @@ const QuicTag kBWS2 = TAG('B', 'W', 'S', '2');  // Server bw resumption v2.
 // Enable path MTU discovery experiment.
 const QuicTag kMTUH = TAG('M', 'T', 'U', 'H');  // High-target MTU discovery.
 const QuicTag kMTUL = TAG('M', 'T', 'U', 'L');  // Low-target MTU discovery.
+const QuicTag kMTUJ = TAG('M', 'T', 'U', 'J');  // Jumbo-target MTU discovery.
 
 // Tags for async signing experiments
 const QuicTag kASYN = TAG('A', 'S', 'Y', 'N');  // Perform asynchronous signing
@@ -280,6 +284,11 @@ const char kProofSignatureLabel[] = "QUIC CHLO and server config signature";
 // rejection message.
 const size_t kClientHelloMinimumSize = 1024;
 
+// Rough estimate of the packet and frame headers around a padded client
+// hello. A client hello only fits in packets of at least
+// kClientHelloMinimumSize + kClientHelloFramingOverhead bytes.
+const size_t kClientHelloFramingOverhead = 50;
+
 }  // namespace net
 
 #endif  // NET_QUIC_CORE_CRYPTO_CRYPTO_PROTOCOL_H_
@@ -9,6 +9,8 @@
 #include "crypto/hkdf.h"
 #include "net/quic/core/crypto/crypto_handshake.h"
 #include "net/quic/core/crypto/crypto_protocol.h"
+#include "net/quic/core/crypto/null_decrypter.h"
+#include "net/quic/core/crypto/null_encrypter.h"
 #include "net/quic/core/crypto/quic_decrypter.h"
 #include "net/quic/core/crypto/quic_encrypter.h"
 #include "net/quic/core/crypto/quic_random.h"
@@ -59,8 +61,14 @@ bool CryptoUtils::DeriveKeys(QuicStringPiece premaster_secret,
                              Diversification diversification,
                              CrypterPair* crypters,
                              string* subkey_secret) {
-  crypters->encrypter.reset(QuicEncrypter::Create(aead));
-  crypters->decrypter.reset(QuicDecrypter::Create(aead));
+  if (aead == kNULN) {
+    // The null crypters need to know which side's label to hash with.
+    crypters->encrypter.reset(new NullEncrypter(perspective, false));
+    crypters->decrypter.reset(new NullDecrypter(perspective, false));
+  } else {
+    crypters->encrypter.reset(QuicEncrypter::Create(aead));
+    crypters->decrypter.reset(QuicDecrypter::Create(aead));
+  }
   size_t key_bytes = crypters->encrypter->GetKeySize();
   size_t nonce_prefix_bytes = crypters->encrypter->GetNoncePrefixSize();
   size_t subkey_secret_bytes =
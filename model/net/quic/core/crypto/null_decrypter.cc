@@ -16,7 +16,10 @@ using std::string;
 namespace net {
 
 NullDecrypter::NullDecrypter(Perspective perspective)
-    : perspective_(perspective) {}
+    : NullDecrypter(perspective, true) {}
+
+NullDecrypter::NullDecrypter(Perspective perspective, bool hash_payload)
+    : perspective_(perspective), hash_payload_(hash_payload) {}
 
 bool NullDecrypter::SetKey(QuicStringPiece key) {
   return key.empty();
@@ -27,11 +30,19 @@ bool NullDecrypter::SetNoncePrefix(QuicStringPiece nonce_prefix) {
 }
 
 bool NullDecrypter::SetPreliminaryKey(QuicStringPiece key) {
+  // A negotiated kNULN decrypter goes through key diversification like any
+  // other AEAD, with an empty key.
+  if (!hash_payload_) {
+    return key.empty();
+  }
   QUIC_BUG << "Should not be called";
   return false;
 }
 
 bool NullDecrypter::SetDiversificationNonce(const DiversificationNonce& nonce) {
+  if (!hash_payload_) {
+    return true;
+  }
   QUIC_BUG << "Should not be called";
   return true;
 }
@@ -56,7 +67,8 @@ bool NullDecrypter::DecryptPacket(QuicVersion version,
     QUIC_BUG << "Output buffer must be larger than the plaintext.";
     return false;
   }
-  if (hash != ComputeHash(version, associated_data, plaintext)) {
+  if (hash != ComputeHash(version, associated_data,
+                          hash_payload_ ? plaintext : QuicStringPiece())) {
     return false;
   }
   // Copy the plaintext to output.
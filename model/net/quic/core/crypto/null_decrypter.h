@@ -23,9 +23,13 @@ class QuicDataReader;
 // A NullDecrypter is a QuicDecrypter used before a crypto negotiation
 // has occurred.  It does not actually decrypt the payload, but does
 // verify a hash (fnv128) over both the payload and associated data.
+//
+// When negotiated as the kNULN AEAD the hash only covers the associated
+// data; see NullEncrypter.
 class QUIC_EXPORT_PRIVATE NullDecrypter : public QuicDecrypter {
  public:
   explicit NullDecrypter(Perspective perspective);
+  NullDecrypter(Perspective perspective, bool hash_payload);
   ~NullDecrypter() override {}
 
   // QuicDecrypter implementation
@@ -53,6 +57,7 @@ class QUIC_EXPORT_PRIVATE NullDecrypter : public QuicDecrypter {
                       QuicStringPiece data2) const;
 
   Perspective perspective_;
+  bool hash_payload_;
 
   DISALLOW_COPY_AND_ASSIGN(NullDecrypter);
 };
@@ -14,7 +14,10 @@ namespace net {
 const size_t kHashSizeShort = 12;  // size of uint128 serialized short
 
 NullEncrypter::NullEncrypter(Perspective perspective)
-    : perspective_(perspective) {}
+    : NullEncrypter(perspective, true) {}
+
+NullEncrypter::NullEncrypter(Perspective perspective, bool hash_payload)
+    : perspective_(perspective), hash_payload_(hash_payload) {}
 
 bool NullEncrypter::SetKey(QuicStringPiece key) {
   return key.empty();
@@ -35,17 +38,19 @@ bool NullEncrypter::EncryptPacket(QuicVersion version,
   if (max_output_length < len) {
     return false;
   }
+  QuicStringPiece hashed_plaintext =
+      hash_payload_ ? plaintext : QuicStringPiece();
   uint128 hash;
   if (version > QUIC_VERSION_36) {
     if (perspective_ == Perspective::IS_SERVER) {
-      hash =
-          QuicUtils::FNV1a_128_Hash_Three(associated_data, plaintext, "Server");
+      hash = QuicUtils::FNV1a_128_Hash_Three(associated_data, hashed_plaintext,
+                                             "Server");
     } else {
-      hash =
-          QuicUtils::FNV1a_128_Hash_Three(associated_data, plaintext, "Client");
+      hash = QuicUtils::FNV1a_128_Hash_Three(associated_data, hashed_plaintext,
+                                             "Client");
     }
   } else {
-    hash = QuicUtils::FNV1a_128_Hash_Two(associated_data, plaintext);
+    hash = QuicUtils::FNV1a_128_Hash_Two(associated_data, hashed_plaintext);
   }
   // TODO(ianswett): memmove required for in place encryption.  Placing the
   // hash at the end would allow use of memcpy, doing nothing for in place.
@@ -19,9 +19,14 @@ namespace net {
 // A NullEncrypter is a QuicEncrypter used before a crypto negotiation
 // has occurred.  It does not actually encrypt the payload, but does
 // generate a MAC (fnv128) over both the payload and associated data.
+//
+// When negotiated as the kNULN AEAD the MAC only covers the associated
+// data, so that packets keep the size of AEAD-protected ones without
+// paying for a per-byte hash of the payload.
 class QUIC_EXPORT_PRIVATE NullEncrypter : public QuicEncrypter {
  public:
   explicit NullEncrypter(Perspective perspective);
+  NullEncrypter(Perspective perspective, bool hash_payload);
   ~NullEncrypter() override {}
 
   // QuicEncrypter implementation
@@ -45,6 +50,7 @@ class QUIC_EXPORT_PRIVATE NullEncrypter : public QuicEncrypter {
   size_t GetHashLength() const;
 
   Perspective perspective_;
+  bool hash_payload_;
 
   DISALLOW_COPY_AND_ASSIGN(NullEncrypter);
 };
@@ -141,7 +141,8 @@ ProcessClientHelloResultCallback::~ProcessClientHelloResultCallback() {}
 QuicCryptoServerConfig::ConfigOptions::ConfigOptions()
     : expiry_time(QuicWallTime::Zero()),
       channel_id_enabled(false),
-      p256(false) {}
+      p256(false),
+      null_encryption(false) {}
 
 QuicCryptoServerConfig::ConfigOptions::ConfigOptions(
     const ConfigOptions& other) = default;
@@ -228,7 +229,11 @@ QuicCryptoServerConfig::GenerateConfig(QuicRandom* rand,
   } else {
     msg.SetVector(kKEXS, QuicTagVector{kC255});
   }
-  msg.SetVector(kAEAD, QuicTagVector{kAESG, kCC20});
+  if (options.null_encryption) {
+    msg.SetVector(kAEAD, QuicTagVector{kAESG, kCC20, kNULN});
+  } else {
+    msg.SetVector(kAEAD, QuicTagVector{kAESG, kCC20});
+  }
   msg.SetStringPiece(kPUBS, encoded_public_values);
 
   if (options.expiry_time.IsZero()) {
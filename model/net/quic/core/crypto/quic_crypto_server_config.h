@@ -184,6 +184,10 @@ class QUIC_EXPORT_PRIVATE QuicCryptoServerConfig {
     // generation since P-256 key generation doesn't use the QuicRandom given
     // to DefaultConfig().
     bool p256;
+    // null_encryption adds the kNULN AEAD to the server config, letting
+    // clients that ask for it skip packet encryption. Only meant for
+    // simulations.
+    bool null_encryption;
   };
 
   // |source_address_token_secret|: secret key material used for encrypting and
@@ -51,11 +51,20 @@ void DefaultRandom::Reseed(const void* additional_entropy, size_t entropy_len) {
   // No such function exists in crypto/random.h.
 }
 
+QuicRandom* g_instance_override = nullptr;
+
 }  // namespace
 
 // static
 QuicRandom* QuicRandom::GetInstance() {
+  if (g_instance_override)
+    return g_instance_override;
   return DefaultRandom::GetInstance();
 }
 
+// static
+void QuicRandom::SetInstance(QuicRandom* random) {
+  g_instance_override = random;
+}
+
 }  // namespace net
@@ -21,6 +21,11 @@ class QUIC_EXPORT_PRIVATE QuicRandom {
   // secure and thread-safe.
   static QuicRandom* GetInstance();
 
+  // Makes GetInstance() return |random| instead of the default generator,
+  // or the default again if |random| is null. |random| is not owned and
+  // must outlive every use of GetInstance().
+  static void SetInstance(QuicRandom* random);
+
   // Generates |len| random bytes in the |data| buffer.
   virtual void RandBytes(void* data, size_t len) = 0;
 
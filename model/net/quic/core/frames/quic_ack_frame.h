@@ -12,7 +12,6 @@
 #include "net/quic/core/quic_types.h"
 #include "net/quic/platform/api/quic_containers.h"
 #include "net/quic/platform/api/quic_export.h"
-#include "net/quic/platform/api/quic_flags.h"
 
 namespace net {
 
@@ -29,169 +28,10 @@ class QUIC_EXPORT_PRIVATE PacketNumberQueue {
   PacketNumberQueue& operator=(const PacketNumberQueue& other);
   PacketNumberQueue& operator=(PacketNumberQueue&& other);
 
-  class QUIC_EXPORT_PRIVATE const_iterator {
-   public:
-    const_iterator(const const_iterator& other);
-    const_iterator(const_iterator&& other);
-    ~const_iterator();
-
-    explicit const_iterator(
-        typename QuicIntervalSet<QuicPacketNumber>::const_iterator it);
-
-    explicit const_iterator(
-        typename std::deque<Interval<QuicPacketNumber>>::const_iterator it);
-
-    typedef std::input_iterator_tag iterator_category;
-    typedef Interval<QuicPacketNumber> value_type;
-    typedef value_type& reference;
-    typedef value_type* pointer;
-    typedef typename std::vector<value_type>::iterator::difference_type
-        difference_type;
-
-    inline const Interval<QuicPacketNumber>& operator*() {
-      if (use_deque_it_) {
-        return *deque_it_;
-      } else {
-        return *vector_it_;
-      }
-    }
-
-    inline const_iterator& operator++() {
-      if (use_deque_it_) {
-        deque_it_++;
-      } else {
-        vector_it_++;
-      }
-      return *this;
-    }
-
-    inline const_iterator& operator--() {
-      if (use_deque_it_) {
-        deque_it_--;
-      } else {
-        vector_it_--;
-      }
-      return *this;
-    }
-
-    inline const_iterator& operator++(int) {
-      if (use_deque_it_) {
-        ++deque_it_;
-      } else {
-        ++vector_it_;
-      }
-      return *this;
-    }
-
-    inline bool operator==(const const_iterator& other) {
-      if (use_deque_it_ != other.use_deque_it_) {
-        return false;
-      }
-
-      if (use_deque_it_) {
-        return deque_it_ == other.deque_it_;
-      } else {
-        return vector_it_ == other.vector_it_;
-      }
-    }
-
-    inline bool operator!=(const const_iterator& other) {
-      return !(*this == other);
-    }
-
-   private:
-    typename QuicIntervalSet<QuicPacketNumber>::const_iterator vector_it_;
-    typename std::deque<Interval<QuicPacketNumber>>::const_iterator deque_it_;
-    const bool use_deque_it_;
-  };
-
-  class QUIC_EXPORT_PRIVATE const_reverse_iterator {
-   public:
-    const_reverse_iterator(const const_reverse_iterator& other);
-    const_reverse_iterator(const_reverse_iterator&& other);
-    ~const_reverse_iterator();
-
-    explicit const_reverse_iterator(
-        const typename QuicIntervalSet<
-            QuicPacketNumber>::const_reverse_iterator& it);
-
-    explicit const_reverse_iterator(
-        const typename std::deque<
-            Interval<QuicPacketNumber>>::const_reverse_iterator& it);
-
-    typedef std::input_iterator_tag iterator_category;
-    typedef Interval<QuicPacketNumber> value_type;
-    typedef value_type& reference;
-    typedef value_type* pointer;
-    typedef typename std::vector<value_type>::iterator::difference_type
-        difference_type;
-
-    inline const Interval<QuicPacketNumber>& operator*() {
-      if (use_deque_it_) {
-        return *deque_it_;
-      } else {
-        return *vector_it_;
-      }
-    }
-
-    inline const Interval<QuicPacketNumber>* operator->() {
-      if (use_deque_it_) {
-        return &*deque_it_;
-      } else {
-        return &*vector_it_;
-      }
-    }
-
-    inline const_reverse_iterator& operator++() {
-      if (use_deque_it_) {
-        deque_it_++;
-      } else {
-        vector_it_++;
-      }
-      return *this;
-    }
-
-    inline const_reverse_iterator& operator--() {
-      if (use_deque_it_) {
-        deque_it_--;
-      } else {
-        vector_it_--;
-      }
-      return *this;
-    }
-
-    inline const_reverse_iterator& operator++(int) {
-      if (use_deque_it_) {
-        ++deque_it_;
-      } else {
-        ++vector_it_;
-      }
-      return *this;
-    }
-
-    inline bool operator==(const const_reverse_iterator& other) {
-      if (use_deque_it_ != other.use_deque_it_) {
-        return false;
-      }
-
-      if (use_deque_it_) {
-        return deque_it_ == other.deque_it_;
-      } else {
-        return vector_it_ == other.vector_it_;
-      }
-    }
-
-    inline bool operator!=(const const_reverse_iterator& other) {
-      return !(*this == other);
-    }
-
-   private:
-    typename QuicIntervalSet<QuicPacketNumber>::const_reverse_iterator
-        vector_it_;
-    typename std::deque<Interval<QuicPacketNumber>>::const_reverse_iterator
-        deque_it_;
-    const bool use_deque_it_;
-  };
+  typedef std::deque<Interval<QuicPacketNumber>>::const_iterator
+      const_iterator;
+  typedef std::deque<Interval<QuicPacketNumber>>::const_reverse_iterator
+      const_reverse_iterator;
 
   // Adds |packet_number| to the set of packets in the queue.
   void Add(QuicPacketNumber packet_number);
@@ -200,14 +40,24 @@ class QUIC_EXPORT_PRIVATE PacketNumberQueue {
   // is undefined behavior to call this with |higher| < |lower|.
   void AddRange(QuicPacketNumber lower, QuicPacketNumber higher);
 
+  // Number of AddRange() calls, over all queues, that took the slow path and
+  // added their range one packet at a time. Logging is compiled out, so tests
+  // watch this instead of the QUIC_BUG.
+  static uint64_t NumSlowAddRanges();
+
   // Removes packets with values less than |higher| from the set of packets in
   // the queue. Returns true if packets were removed.
   bool RemoveUpTo(QuicPacketNumber higher);
 
+  // Removes packets with values greater than or equal to |lower| from the set
+  // of packets in the queue.
+  void RemoveFrom(QuicPacketNumber lower);
+
   // Removes the smallest interval in the queue.
   void RemoveSmallestInterval();
 
-  // Returns true if the queue contains |packet_number|.
+  // Returns true if the queue contains |packet_number|.  Logarithmic in the
+  // number of intervals.
   bool Contains(QuicPacketNumber packet_number) const;
 
   // Returns true if the queue is empty.
@@ -243,11 +93,8 @@ class QUIC_EXPORT_PRIVATE PacketNumberQueue {
       const PacketNumberQueue& q);
 
  private:
-  // TODO(lilika): Remove QuicIntervalSet<QuicPacketNumber>
-  // once FLAGS_quic_reloadable_flag_quic_frames_deque2 is removed
-  QuicIntervalSet<QuicPacketNumber> packet_number_intervals_;
+  // Disjoint, non adjacent intervals in increasing order.
   std::deque<Interval<QuicPacketNumber>> packet_number_deque_;
-  bool use_deque_;
 };
 
 struct QUIC_EXPORT_PRIVATE QuicAckFrame {
@@ -4,6 +4,8 @@
 
 #include "net/quic/core/quic_alarm.h"
 
+#include "utils/quic-profiler.h"
+
 #include<iostream>
 using std::cerr;
 using std::endl;
@@ -54,6 +56,7 @@ bool QuicAlarm::IsSet() const {
 }
 
 void QuicAlarm::Fire() {
+  QUIC_PROFILE_SCOPE(ALARMS);
   if (!IsSet()) {
     return;
   }
@@ -324,6 +324,11 @@ QuicConfig::QuicConfig()
     : max_time_before_crypto_handshake_(QuicTime::Delta::Zero()),
       max_idle_time_before_crypto_handshake_(QuicTime::Delta::Zero()),
       max_undecryptable_packets_(0),
+      has_congestion_control_type_(false),
+      congestion_control_type_(kCubic),
+      initial_congestion_window_(0),
+      max_congestion_window_(0),
+      pacing_enabled_(true),
       connection_options_(kCOPT, PRESENCE_OPTIONAL),
       client_connection_options_(kCLOP, PRESENCE_OPTIONAL),
       idle_network_timeout_seconds_(kICSL, PRESENCE_REQUIRED),
@@ -306,6 +306,49 @@ class QUIC_EXPORT_PRIVATE QuicConfig {
     return max_undecryptable_packets_;
   }
 
+  // Congestion controller of this endpoint.  Takes precedence over the one
+  // selected by connection options.
+  void set_congestion_control_type(CongestionControlType type) {
+    has_congestion_control_type_ = true;
+    congestion_control_type_ = type;
+  }
+
+  bool has_congestion_control_type() const {
+    return has_congestion_control_type_;
+  }
+
+  CongestionControlType congestion_control_type() const {
+    return congestion_control_type_;
+  }
+
+  // Congestion window, in packets, the congestion controller of this
+  // endpoint starts with.  0 keeps the default.
+  void set_initial_congestion_window(QuicPacketCount packets) {
+    initial_congestion_window_ = packets;
+  }
+
+  QuicPacketCount initial_congestion_window() const {
+    return initial_congestion_window_;
+  }
+
+  // Largest congestion window, in packets, of this endpoint.  0 keeps the
+  // default.
+  void set_max_congestion_window(QuicPacketCount packets) {
+    max_congestion_window_ = packets;
+  }
+
+  QuicPacketCount max_congestion_window() const {
+    return max_congestion_window_;
+  }
+
+  // Whether this endpoint paces its packets.  Rate based controllers, BBR
+  // and PCC, rely on pacing.
+  void set_pacing_enabled(bool pacing_enabled) {
+    pacing_enabled_ = pacing_enabled;
+  }
+
+  bool pacing_enabled() const { return pacing_enabled_; }
+
   bool HasSetBytesForConnectionIdToSend() const;
 
   // Sets the peer's connection id length, in bytes.
@@ -388,6 +431,12 @@ class QUIC_EXPORT_PRIVATE QuicConfig {
   QuicTime::Delta max_idle_time_before_crypto_handshake_;
   // Maximum number of undecryptable packets stored before CHLO/SHLO.
   size_t max_undecryptable_packets_;
+  // Congestion control of this endpoint.
+  bool has_congestion_control_type_;
+  CongestionControlType congestion_control_type_;
+  QuicPacketCount initial_congestion_window_;
+  QuicPacketCount max_congestion_window_;
+  bool pacing_enabled_;
 
   // Connection options which affect the server side.  May also affect the
   // client side in cases when identical behavior is desirable.
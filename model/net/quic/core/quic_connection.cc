@@ -34,6 +34,7 @@
 #include "net/quic/platform/api/quic_map_util.h"
 #include "net/quic/platform/api/quic_str_cat.h"
 #include "net/quic/platform/api/quic_text_utils.h"
+#include "utils/quic-profiler.h"
 
 using std::string;
 
@@ -338,6 +339,9 @@ void QuicConnection::SetFromConfig(const QuicConfig& config) {
   if (config.HasClientSentConnectionOption(kMTUL, perspective_)) {
     SetMtuDiscoveryTarget(kMtuDiscoveryTargetPacketSizeLow);
   }
+  if (config.HasClientSentConnectionOption(kMTUJ, perspective_)) {
+    SetMtuDiscoveryTarget(kMtuDiscoveryTargetPacketSizeJumbo);
+  }
   if (debug_visitor_ != nullptr) {
     debug_visitor_->OnSetFromConfig(config);
   }
@@ -1192,6 +1196,7 @@ const QuicConnectionStats& QuicConnection::GetStats() {
 void QuicConnection::ProcessUdpPacket(const QuicSocketAddress& self_address,
                                       const QuicSocketAddress& peer_address,
                                       const QuicReceivedPacket& packet) {
+  QUIC_PROFILE_SCOPE(CONNECTION);
   if (!connected_) {
     return;
   }
@@ -1257,6 +1262,7 @@ void QuicConnection::ProcessUdpPacket(const QuicSocketAddress& self_address,
 }
 
 void QuicConnection::OnCanWrite() {
+  QUIC_PROFILE_SCOPE(CONNECTION);
   DCHECK(!writer_->IsWriteBlocked());
 
   WriteQueuedPackets();
@@ -1411,8 +1417,15 @@ void QuicConnection::WritePendingRetransmissions() {
     // TODO(ianswett): Implement ReserializeAllFrames as a separate path that
     // does not require the creator to be flushed.
     packet_generator_.FlushAllQueuedFrames();
-    char buffer[kMaxPacketSize];
-    packet_generator_.ReserializeAllFrames(pending, buffer, kMaxPacketSize);
+    if (packet_generator_.GetCurrentMaxPacketLength() > kMaxPacketSize) {
+      // Jumbo packets are rare enough to be reserialized on the heap.
+      std::unique_ptr<char[]> buffer(new char[kMaxJumboPacketSize]);
+      packet_generator_.ReserializeAllFrames(pending, buffer.get(),
+                                             kMaxJumboPacketSize);
+    } else {
+      char buffer[kMaxPacketSize];
+      packet_generator_.ReserializeAllFrames(pending, buffer, kMaxPacketSize);
+    }
   }
 }
 
@@ -1478,6 +1491,7 @@ bool QuicConnection::CanWrite(HasRetransmittableData retransmittable) {
 }
 
 bool QuicConnection::WritePacket(SerializedPacket* packet) {
+  QUIC_PROFILE_SCOPE(CONNECTION);
   if (packet->packet_number < sent_packet_manager_.GetLargestSentPacket()) {
     QUIC_BUG << "Attempt to write packet:" << packet->packet_number
              << " after:" << sent_packet_manager_.GetLargestSentPacket();
@@ -1517,7 +1531,7 @@ bool QuicConnection::WritePacket(SerializedPacket* packet) {
     }
   }
 
-  DCHECK_LE(encrypted_length, kMaxPacketSize);
+  DCHECK_LE(encrypted_length, kMaxJumboPacketSize);
   DCHECK_LE(encrypted_length, packet_generator_.GetCurrentMaxPacketLength());
   QUIC_DVLOG(1) << ENDPOINT << "Sending packet " << packet_number << " : "
                 << (IsRetransmittable(*packet) == HAS_RETRANSMITTABLE_DATA
@@ -2310,8 +2324,8 @@ QuicByteCount QuicConnection::GetLimitedMaxPacketSize(
   if (max_packet_size > writer_limit) {
     max_packet_size = writer_limit;
   }
-  if (max_packet_size > kMaxPacketSize) {
-    max_packet_size = kMaxPacketSize;
+  if (max_packet_size > kMaxJumboPacketSize) {
+    max_packet_size = kMaxJumboPacketSize;
   }
   return max_packet_size;
 }
@@ -78,11 +78,15 @@ static_assert(kPacketsBetweenMtuProbesBase < (1 << 8),
 // The incresed packet size targeted when doing path MTU discovery.
 const QuicByteCount kMtuDiscoveryTargetPacketSizeHigh = 1450;
 const QuicByteCount kMtuDiscoveryTargetPacketSizeLow = 1430;
+// The target of path MTU discovery on links with jumbo frames.
+const QuicByteCount kMtuDiscoveryTargetPacketSizeJumbo = kMaxJumboPacketSize;
 
 static_assert(kMtuDiscoveryTargetPacketSizeLow <= kMaxPacketSize,
               "MTU discovery target is too large");
 static_assert(kMtuDiscoveryTargetPacketSizeHigh <= kMaxPacketSize,
               "MTU discovery target is too large");
+static_assert(kMtuDiscoveryTargetPacketSizeJumbo <= kMaxJumboPacketSize,
+              "MTU discovery target is too large");
 
 static_assert(kMtuDiscoveryTargetPacketSizeLow > kDefaultMaxPacketSize,
               "MTU discovery target does not exceed the default packet size");
@@ -34,6 +34,11 @@ const QuicByteCount kDefaultServerMaxPacketSize = 1000;
 // additional 8 bytes.  This is a total overhead of 48 bytes.  Ethernet's
 // max packet size is 1500 bytes,  1500 - 48 = 1452.
 const QuicByteCount kMaxPacketSize = 1452;
+// The maximum packet size on simulated links with 9000 byte jumbo frames,
+// 9000 - 48 = 8952.  Packets only grow beyond kMaxPacketSize through path
+// MTU discovery with MTUJ, so only the buffers that serialize, write and
+// read those packets are sized for it.
+const QuicByteCount kMaxJumboPacketSize = 8952;
 // Default maximum packet size used in the Linux TCP implementation.
 // Used in QUIC for congestion window computations in bytes.
 const QuicByteCount kDefaultTCPMSS = 1460;
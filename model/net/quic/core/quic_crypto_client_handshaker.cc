@@ -323,7 +323,7 @@ void QuicCryptoClientHandshaker::DoSendCHLO(
         cached, session()->connection()->random_generator(),
         /* demand_x509_proof= */ true, crypto_negotiated_params_, &out);
     // Pad the inchoate client hello to fill up a packet.
-    const QuicByteCount kFramingOverhead = 50;  // A rough estimate.
+    const QuicByteCount kFramingOverhead = kClientHelloFramingOverhead;
     const QuicByteCount max_packet_size =
         session()->connection()->max_packet_length();
     if (max_packet_size <= kFramingOverhead) {
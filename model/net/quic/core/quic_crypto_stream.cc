@@ -14,6 +14,7 @@
 #include "net/quic/platform/api/quic_flag_utils.h"
 #include "net/quic/platform/api/quic_flags.h"
 #include "net/quic/platform/api/quic_logging.h"
+#include "utils/quic-profiler.h"
 
 using std::string;
 
@@ -42,6 +43,7 @@ QuicByteCount QuicCryptoStream::CryptoMessageFramingOverhead(
 }
 
 void QuicCryptoStream::OnDataAvailable() {
+  QUIC_PROFILE_SCOPE(CRYPTO);
   struct iovec iov;
   while (true) {
     if (sequencer()->GetReadableRegions(&iov, 1) != 1) {
@@ -119,9 +119,18 @@ QUIC_FLAG(bool, FLAGS_quic_reloadable_flag_quic_account_handshake, false)
 // 3RTOs if there are no open streams.
 QUIC_FLAG(bool, FLAGS_quic_reloadable_flag_quic_enable_3rtos, false)
 
-// If true, enable experiment for testing PCC congestion-control.
+// If true, enable experiment for testing PCC congestion-control through the
+// TPCC connection option. An endpoint's own congestion control type selects
+// PCC regardless.
 QUIC_FLAG(bool, FLAGS_quic_reloadable_flag_quic_enable_pcc, false)
 
+// Weight of the RTT gradient in the utility of QUIC PCC.
+QUIC_FLAG(double, FLAGS_quic_pcc_latency_coefficient, 900.0f)
+
+// Weight of the loss rate in the utility of QUIC PCC.  Random loss below
+// about 0.9 / (coefficient * rate_mbps^0.1) does not make PCC back off.
+QUIC_FLAG(double, FLAGS_quic_pcc_loss_coefficient, 11.35f)
+
 // If true, enable QUIC v40.
 QUIC_FLAG(bool, FLAGS_quic_enable_version_40, false)
 
@@ -149,9 +158,6 @@ QUIC_FLAG(bool, FLAGS_quic_reloadable_flag_quic_disable_version_36, true)
 // algorithms.
 QUIC_FLAG(bool, FLAGS_quic_reloadable_flag_quic_disable_packets_based_cc, false)
 
-// When enabled, ack frame uses a deque internally instead of a set.
-QUIC_FLAG(bool, FLAGS_quic_reloadable_flag_quic_frames_deque2, false)
-
 // If true, QUIC packet creator passes a stack allocated SerializedPacket to the
 // connection.
 QUIC_FLAG(bool,
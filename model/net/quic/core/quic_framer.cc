@@ -27,6 +27,7 @@
 #include "net/quic/platform/api/quic_logging.h"
 #include "net/quic/platform/api/quic_map_util.h"
 #include "net/quic/platform/api/quic_ptr_util.h"
+#include "utils/quic-profiler.h"
 
 using std::string;
 
@@ -360,6 +361,7 @@ size_t QuicFramer::BuildDataPacket(const QuicPacketHeader& header,
                                    const QuicFrames& frames,
                                    char* buffer,
                                    size_t packet_length) {
+  QUIC_PROFILE_SCOPE(FRAMER);
   QuicDataWriter writer(packet_length, buffer, perspective_, endianness());
   if (!AppendPacketHeader(header, &writer)) {
     QUIC_BUG << "AppendPacketHeader failed";
@@ -534,6 +536,7 @@ std::unique_ptr<QuicEncryptedPacket> QuicFramer::BuildVersionNegotiationPacket(
 }
 
 bool QuicFramer::ProcessPacket(const QuicEncryptedPacket& packet) {
+  QUIC_PROFILE_SCOPE(FRAMER);
   QuicDataReader reader(packet.data(), packet.length(), perspective_,
                         endianness());
 
@@ -579,8 +582,9 @@ bool QuicFramer::ProcessPacket(const QuicEncryptedPacket& packet) {
     std::unique_ptr<char[]> large_buffer(new char[packet.length()]);
     rv = ProcessDataPacket(&reader, public_header, packet, large_buffer.get(),
                            packet.length());
-    QUIC_BUG_IF(rv) << "QUIC should never successfully process packets larger"
-                    << "than kMaxPacketSize. packet size:" << packet.length();
+    QUIC_BUG_IF(rv && packet.length() > kMaxJumboPacketSize)
+        << "QUIC should never successfully process packets larger"
+        << "than kMaxJumboPacketSize. packet size:" << packet.length();
   }
 
   return rv;
@@ -638,7 +642,7 @@ bool QuicFramer::ProcessDataPacket(QuicDataReader* encrypted_reader,
     return true;
   }
 
-  if (packet.length() > kMaxPacketSize) {
+  if (packet.length() > kMaxJumboPacketSize) {
     // If the packet has gotten this far, it should not be too large.
     QUIC_BUG << "Packet too large:" << packet.length();
     return RaiseError(QUIC_PACKET_TOO_LARGE);
@@ -1642,6 +1646,7 @@ size_t QuicFramer::EncryptInPlace(EncryptionLevel level,
                                   size_t total_len,
                                   size_t buffer_len,
                                   char* buffer) {
+  QUIC_PROFILE_SCOPE(CRYPTO);
   size_t output_length = 0;
   if (!encrypter_[level]->EncryptPacket(
           quic_version_, packet_number,
@@ -1661,6 +1666,7 @@ size_t QuicFramer::EncryptPayload(EncryptionLevel level,
                                   const QuicPacket& packet,
                                   char* buffer,
                                   size_t buffer_len) {
+  QUIC_PROFILE_SCOPE(CRYPTO);
   DCHECK(encrypter_[level].get() != nullptr);
 
   QuicStringPiece associated_data = packet.AssociatedData(quic_version_);
@@ -1704,6 +1710,7 @@ bool QuicFramer::DecryptPayload(QuicDataReader* encrypted_reader,
                                 char* decrypted_buffer,
                                 size_t buffer_length,
                                 size_t* decrypted_length) {
+  QUIC_PROFILE_SCOPE(CRYPTO);
   QuicStringPiece encrypted = encrypted_reader->ReadRemainingPayload();
   DCHECK(decrypter_.get() != nullptr);
   QuicStringPiece associated_data = GetAssociatedDataFromEncryptedPacket(
@@ -269,6 +269,14 @@ void QuicPacketCreator::Flush() {
     return;
   }
 
+  if (max_packet_length_ > kMaxPacketSize) {
+    // Jumbo packets, after path MTU discovery, are serialized on the heap so
+    // that the stack buffer of the common case stays small.
+    std::unique_ptr<char[]> jumbo_buffer(new char[kMaxJumboPacketSize]);
+    SerializePacket(jumbo_buffer.get(), kMaxJumboPacketSize);
+    OnSerializedPacket();
+    return;
+  }
   QUIC_CACHELINE_ALIGNED char serialized_packet_buffer[kMaxPacketSize];
   SerializePacket(serialized_packet_buffer, kMaxPacketSize);
   OnSerializedPacket();
@@ -322,8 +330,16 @@ void QuicPacketCreator::CreateAndSerializeStreamFrame(
   // Write out the packet header
   QuicPacketHeader header;
   FillPacketHeader(&header);
-  QUIC_CACHELINE_ALIGNED char encrypted_buffer[kMaxPacketSize];
-  QuicDataWriter writer(arraysize(encrypted_buffer), encrypted_buffer,
+  QUIC_CACHELINE_ALIGNED char stack_buffer[kMaxPacketSize];
+  char* encrypted_buffer = stack_buffer;
+  size_t encrypted_buffer_len = kMaxPacketSize;
+  std::unique_ptr<char[]> jumbo_buffer;
+  if (max_packet_length_ > kMaxPacketSize) {
+    jumbo_buffer.reset(new char[kMaxJumboPacketSize]);
+    encrypted_buffer = jumbo_buffer.get();
+    encrypted_buffer_len = kMaxJumboPacketSize;
+  }
+  QuicDataWriter writer(encrypted_buffer_len, encrypted_buffer,
                         framer_->perspective(), framer_->endianness());
   if (!framer_->AppendPacketHeader(header, &writer)) {
     QUIC_BUG << "AppendPacketHeader failed";
@@ -372,7 +388,7 @@ void QuicPacketCreator::CreateAndSerializeStreamFrame(
   size_t encrypted_length = framer_->EncryptInPlace(
       packet_.encryption_level, packet_.packet_number,
       GetStartOfEncryptedData(framer_->version(), header), writer.length(),
-      arraysize(encrypted_buffer), encrypted_buffer);
+      encrypted_buffer_len, encrypted_buffer);
   if (encrypted_length == 0) {
     QUIC_BUG << "Failed to encrypt packet number " << header.packet_number;
     return;
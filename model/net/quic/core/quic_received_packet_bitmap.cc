@@ -0,0 +1,156 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_received_packet_bitmap.h"
+
+#include <algorithm>
+
+#include "base/bits.h"
+#include "base/logging.h"
+
+namespace net {
+
+namespace {
+
+const uint64_t kAllOnes = ~uint64_t(0);
+
+// Returns the index of the least significant set bit of |word|, which must not
+// be zero.
+size_t LowestSetBit(uint64_t word) {
+  DCHECK_NE(0u, word);
+  return 63 - base::bits::CountLeadingZeroBits64(word & (0 - word));
+}
+
+}  // namespace
+
+const QuicPacketNumber QuicReceivedPacketBitmap::kWindowSize;
+const size_t QuicReceivedPacketBitmap::kBitsPerWord;
+const size_t QuicReceivedPacketBitmap::kNumWords;
+
+QuicReceivedPacketBitmap::QuicReceivedPacketBitmap() : head_(0), base_(0) {
+  static_assert((kNumWords & (kNumWords - 1)) == 0,
+                "The number of words must be a power of two");
+  std::fill(words_, words_ + kNumWords, 0);
+}
+
+QuicReceivedPacketBitmap::~QuicReceivedPacketBitmap() {}
+
+void QuicReceivedPacketBitmap::AdvanceTo(QuicPacketNumber packet_number) {
+  if (packet_number < base_ + kWindowSize) {
+    return;
+  }
+  const QuicPacketNumber new_base =
+      (packet_number / kBitsPerWord + 1) * kBitsPerWord - kWindowSize;
+  const size_t num_dropped = static_cast<size_t>(
+      std::min<QuicPacketNumber>((new_base - base_) / kBitsPerWord, kNumWords));
+  for (size_t i = 0; i < num_dropped; ++i) {
+    words_[head_] = 0;
+    head_ = (head_ + 1) & (kNumWords - 1);
+  }
+  base_ = new_base;
+}
+
+void QuicReceivedPacketBitmap::Add(QuicPacketNumber packet_number) {
+  DCHECK_NE(0u, packet_number);
+  DCHECK(InWindow(packet_number)) << packet_number;
+  const QuicPacketNumber offset = packet_number - base_;
+  word(offset / kBitsPerWord) |= uint64_t(1) << (offset % kBitsPerWord);
+}
+
+bool QuicReceivedPacketBitmap::Contains(QuicPacketNumber packet_number) const {
+  DCHECK(InWindow(packet_number)) << packet_number;
+  const QuicPacketNumber offset = packet_number - base_;
+  return (word(offset / kBitsPerWord) >> (offset % kBitsPerWord)) & 1;
+}
+
+bool QuicReceivedPacketBitmap::RemoveUpTo(QuicPacketNumber packet_number) {
+  if (packet_number <= base_) {
+    return false;
+  }
+  const QuicPacketNumber num_removed =
+      std::min(packet_number - base_, kWindowSize);
+  bool removed = false;
+  for (size_t k = 0; k * kBitsPerWord < num_removed; ++k) {
+    const QuicPacketNumber num_bits = num_removed - k * kBitsPerWord;
+    const uint64_t mask = num_bits >= kBitsPerWord
+                              ? kAllOnes
+                              : (uint64_t(1) << num_bits) - 1;
+    removed |= (word(k) & mask) != 0;
+    word(k) &= ~mask;
+  }
+  return removed;
+}
+
+QuicPacketNumber QuicReceivedPacketBitmap::RunLength(
+    QuicPacketNumber packet_number) const {
+  DCHECK(InWindow(packet_number)) << packet_number;
+  const QuicPacketNumber offset = packet_number - base_;
+  size_t k = offset / kBitsPerWord;
+  const size_t bit = offset % kBitsPerWord;
+  // Moves |packet_number| to the top bit, so the run is the leading ones.
+  // The zeros shifted in stop it at the bottom of the word.
+  QuicPacketNumber run =
+      base::bits::CountLeadingZeroBits64(~(word(k) << (63 - bit)));
+  if (run <= bit) {
+    return run;
+  }
+  while (k > 0) {
+    const uint64_t previous = word(--k);
+    if (previous != kAllOnes) {
+      return run + base::bits::CountLeadingZeroBits64(~previous);
+    }
+    run += kBitsPerWord;
+  }
+  return run;
+}
+
+void QuicReceivedPacketBitmap::AppendFrom(QuicPacketNumber packet_number,
+                                          PacketNumberQueue* packets) const {
+  DCHECK(InWindow(packet_number)) << packet_number;
+  // Packet 0 is never recorded, so 0 means no run is open.
+  QuicPacketNumber run_start = 0;
+  size_t k = (packet_number - base_) / kBitsPerWord;
+  QuicPacketNumber word_base = base_ + k * kBitsPerWord;
+  // Leaves out the packets below |packet_number| in its word.
+  uint64_t bits = word(k) & (kAllOnes << (packet_number - word_base));
+  while (true) {
+    if (bits == kAllOnes) {
+      if (run_start == 0) {
+        run_start = word_base;
+      }
+    } else if (bits == 0) {
+      if (run_start != 0) {
+        packets->AddRange(run_start, word_base);
+        run_start = 0;
+      }
+    } else {
+      // Jumps from one range boundary to the next: the next missing packet
+      // inside a run, the next received one outside.
+      size_t bit = 0;
+      while (bit < kBitsPerWord) {
+        const uint64_t boundaries = (run_start != 0 ? ~bits : bits) >> bit;
+        if (boundaries == 0) {
+          break;
+        }
+        bit += LowestSetBit(boundaries);
+        if (run_start != 0) {
+          packets->AddRange(run_start, word_base + bit);
+          run_start = 0;
+        } else {
+          run_start = word_base + bit;
+        }
+      }
+    }
+    word_base += kBitsPerWord;
+    if (++k == kNumWords) {
+      break;
+    }
+    bits = word(k);
+  }
+  if (run_start != 0) {
+    packets->AddRange(run_start, word_base);
+  }
+}
+
+}  // namespace net
@@ -0,0 +1,91 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_QUIC_RECEIVED_PACKET_BITMAP_H_
+#define NET_QUIC_CORE_QUIC_RECEIVED_PACKET_BITMAP_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "base/macros.h"
+#include "net/quic/core/frames/quic_ack_frame.h"
+#include "net/quic/core/quic_types.h"
+#include "net/quic/platform/api/quic_export.h"
+
+namespace net {
+
+// The packets received in a window of kWindowSize consecutive packet numbers,
+// one bit per packet in a ring of 64 bit words.  Recording a packet and
+// looking one up are a bit operation, however many gaps loss leaves behind,
+// and ack ranges are extracted a word at a time: words of only received or
+// only missing packets cost one comparison, and the others one count of
+// leading zeros per range boundary.
+//
+// The window only moves forward, when a packet beyond it is recorded.
+class QUIC_EXPORT_PRIVATE QuicReceivedPacketBitmap {
+ public:
+  // Number of packet numbers in the window.
+  static const QuicPacketNumber kWindowSize = 1024;
+
+  QuicReceivedPacketBitmap();
+  ~QuicReceivedPacketBitmap();
+
+  // Least packet number in the window, a multiple of 64.
+  QuicPacketNumber base() const { return base_; }
+
+  // Returns true if |packet_number| is in the window.
+  bool InWindow(QuicPacketNumber packet_number) const {
+    return packet_number >= base_ && packet_number - base_ < kWindowSize;
+  }
+
+  // Moves the window forward until it ends with the word of |packet_number|,
+  // if |packet_number| is beyond it.  The packets that leave the window are
+  // forgotten.
+  void AdvanceTo(QuicPacketNumber packet_number);
+
+  // Records |packet_number|, which must be in the window and not 0.
+  void Add(QuicPacketNumber packet_number);
+
+  // Returns true if |packet_number|, which must be in the window, was
+  // recorded.
+  bool Contains(QuicPacketNumber packet_number) const;
+
+  // Forgets the packets below |packet_number|.  Returns true if any of them
+  // was recorded.
+  bool RemoveUpTo(QuicPacketNumber packet_number);
+
+  // Appends the recorded packets from |packet_number| on, which must be in
+  // the window, to |packets|, one range per run of consecutive packets, in
+  // increasing order.
+  void AppendFrom(QuicPacketNumber packet_number,
+                  PacketNumberQueue* packets) const;
+
+  // Returns the number of consecutive recorded packets ending with
+  // |packet_number|, which must be in the window.  The run is cut at base().
+  QuicPacketNumber RunLength(QuicPacketNumber packet_number) const;
+
+ private:
+  static const size_t kBitsPerWord = 64;
+  static const size_t kNumWords = kWindowSize / kBitsPerWord;
+
+  // The |index|th word from the front of the window.
+  uint64_t word(size_t index) const {
+    return words_[(head_ + index) & (kNumWords - 1)];
+  }
+  uint64_t& word(size_t index) {
+    return words_[(head_ + index) & (kNumWords - 1)];
+  }
+
+  // Bit i of word(k) is packet base_ + 64 * k + i.
+  uint64_t words_[kNumWords];
+  // Slot of word(0) in |words_|.
+  size_t head_;
+  QuicPacketNumber base_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicReceivedPacketBitmap);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_QUIC_RECEIVED_PACKET_BITMAP_H_
@@ -25,6 +25,7 @@ const size_t kMaxPacketsAfterNewMissing = 4;
 
 QuicReceivedPacketManager::QuicReceivedPacketManager(QuicConnectionStats* stats)
     : peer_least_packet_awaiting_ack_(0),
+      least_packet_not_in_ack_frame_(0),
       ack_frame_updated_(false),
       max_ack_ranges_(0),
       time_largest_observed_(QuicTime::Zero()),
@@ -43,7 +44,20 @@ void QuicReceivedPacketManager::RecordPacketReceived(
     ack_frame_.received_packet_times.clear();
   }
   ack_frame_updated_ = true;
-  ack_frame_.packets.Add(header.packet_number);
+  if (packet_number < recent_packets_.base()) {
+    ack_frame_.packets.Add(packet_number);
+  } else {
+    if (!recent_packets_.InWindow(packet_number)) {
+      // The packets leaving the window must be in the ack frame first.
+      UpdateAckFramePackets();
+      recent_packets_.AdvanceTo(packet_number);
+    }
+    recent_packets_.Add(packet_number);
+    if (least_packet_not_in_ack_frame_ == 0 ||
+        packet_number < least_packet_not_in_ack_frame_) {
+      least_packet_not_in_ack_frame_ = packet_number;
+    }
+  }
 
   if (ack_frame_.largest_observed > packet_number) {
     // Record how out of order stats.
@@ -67,13 +81,13 @@ void QuicReceivedPacketManager::RecordPacketReceived(
 
 bool QuicReceivedPacketManager::IsMissing(QuicPacketNumber packet_number) {
   return packet_number < ack_frame_.largest_observed &&
-         !ack_frame_.packets.Contains(packet_number);
+         !IsReceived(packet_number);
 }
 
 bool QuicReceivedPacketManager::IsAwaitingPacket(
     QuicPacketNumber packet_number) {
-  return net::IsAwaitingPacket(ack_frame_, packet_number,
-                               peer_least_packet_awaiting_ack_);
+  return packet_number >= peer_least_packet_awaiting_ack_ &&
+         !IsReceived(packet_number);
 }
 
 const QuicFrame QuicReceivedPacketManager::GetUpdatedAckFrame(
@@ -88,6 +102,7 @@ const QuicFrame QuicReceivedPacketManager::GetUpdatedAckFrame(
                                     ? QuicTime::Delta::Zero()
                                     : approximate_now - time_largest_observed_;
   }
+  UpdateAckFramePackets();
   while (max_ack_ranges_ > 0 &&
          ack_frame_.packets.NumIntervals() > max_ack_ranges_) {
     ack_frame_.packets.RemoveSmallestInterval();
@@ -115,6 +130,14 @@ void QuicReceivedPacketManager::DontWaitForPacketsBefore(
   if (least_unacked > peer_least_packet_awaiting_ack_) {
     peer_least_packet_awaiting_ack_ = least_unacked;
     bool packets_updated = ack_frame_.packets.RemoveUpTo(least_unacked);
+    // Evaluated on its own: both must drop the packets.
+    if (recent_packets_.RemoveUpTo(least_unacked)) {
+      packets_updated = true;
+    }
+    if (least_packet_not_in_ack_frame_ != 0 &&
+        least_packet_not_in_ack_frame_ < least_unacked) {
+      least_packet_not_in_ack_frame_ = least_unacked;
+    }
     if (packets_updated) {
       // Ack frame gets updated because packets set is updated because of stop
       // waiting frame.
@@ -126,15 +149,16 @@ void QuicReceivedPacketManager::DontWaitForPacketsBefore(
 }
 
 bool QuicReceivedPacketManager::HasMissingPackets() const {
-  return ack_frame_.packets.NumIntervals() > 1 ||
-         (!ack_frame_.packets.Empty() &&
-          ack_frame_.packets.Min() >
-              std::max(QuicPacketNumber(1), peer_least_packet_awaiting_ack_));
+  // Every packet from the least awaited one up to the largest observed one
+  // was received unless the run ending with the largest starts above it.
+  QuicPacketNumber run_start =
+      ack_frame_.largest_observed + 1 - LastRunLength();
+  return run_start >
+         std::max(QuicPacketNumber(1), peer_least_packet_awaiting_ack_);
 }
 
 bool QuicReceivedPacketManager::HasNewMissingPackets() const {
-  return HasMissingPackets() &&
-         ack_frame_.packets.LastIntervalLength() <= kMaxPacketsAfterNewMissing;
+  return HasMissingPackets() && LastRunLength() <= kMaxPacketsAfterNewMissing;
 }
 
 bool QuicReceivedPacketManager::ack_frame_updated() const {
@@ -145,4 +169,49 @@ QuicPacketNumber QuicReceivedPacketManager::GetLargestObserved() const {
   return ack_frame_.largest_observed;
 }
 
+bool QuicReceivedPacketManager::IsReceived(
+    QuicPacketNumber packet_number) const {
+  if (packet_number < recent_packets_.base()) {
+    return ack_frame_.packets.Contains(packet_number);
+  }
+  return recent_packets_.InWindow(packet_number) &&
+         recent_packets_.Contains(packet_number);
+}
+
+void QuicReceivedPacketManager::UpdateAckFramePackets() {
+  if (least_packet_not_in_ack_frame_ == 0) {
+    return;
+  }
+  // Only the ranges from the least new packet on can have changed.
+  ack_frame_.packets.RemoveFrom(least_packet_not_in_ack_frame_);
+  if (recent_packets_.InWindow(least_packet_not_in_ack_frame_)) {
+    recent_packets_.AppendFrom(least_packet_not_in_ack_frame_,
+                               &ack_frame_.packets);
+  }
+  least_packet_not_in_ack_frame_ = 0;
+}
+
+QuicPacketNumber QuicReceivedPacketManager::LastRunLength() const {
+  const QuicPacketNumber largest_observed = ack_frame_.largest_observed;
+  if (largest_observed == 0) {
+    return 0;
+  }
+  const QuicPacketNumber base = recent_packets_.base();
+  QuicPacketNumber run = recent_packets_.RunLength(largest_observed);
+  if (run < largest_observed + 1 - base) {
+    return run;
+  }
+  // The run reaches the bottom of the window and may go on below it.
+  for (auto it = ack_frame_.packets.rbegin(); it != ack_frame_.packets.rend();
+       ++it) {
+    if (it->min() < base) {
+      if (it->max() >= base) {
+        run += base - it->min();
+      }
+      break;
+    }
+  }
+  return run;
+}
+
 }  // namespace net
@@ -9,6 +9,7 @@
 #include "net/quic/core/quic_config.h"
 #include "net/quic/core/quic_framer.h"
 #include "net/quic/core/quic_packets.h"
+#include "net/quic/core/quic_received_packet_bitmap.h"
 #include "net/quic/platform/api/quic_export.h"
 
 namespace net {
@@ -62,7 +63,8 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacketManager {
 
   QuicPacketNumber GetLargestObserved() const;
 
-  // For logging purposes.
+  // For logging purposes.  The packets of the frame are only brought up to
+  // date by GetUpdatedAckFrame.
   const QuicAckFrame& ack_frame() const { return ack_frame_; }
 
   void set_max_ack_ranges(size_t max_ack_ranges) {
@@ -72,13 +74,35 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacketManager {
  private:
   friend class test::QuicConnectionPeer;
 
+  // Returns true if |packet_number| was received and is still tracked.
+  bool IsReceived(QuicPacketNumber packet_number) const;
+
+  // Brings the packets of |ack_frame_| up to date with |recent_packets_|.
+  void UpdateAckFramePackets();
+
+  // Returns the number of consecutive received packets ending with the
+  // largest observed one.
+  QuicPacketNumber LastRunLength() const;
+
   // Least packet number of the the packet sent by the peer for which it
   // hasn't received an ack.
   QuicPacketNumber peer_least_packet_awaiting_ack_;
 
-  // Received packet information used to produce acks.
+  // Received packet information used to produce acks.  Its packets below
+  // the window of |recent_packets_| are the received packets; those in the
+  // window are copied from |recent_packets_| by UpdateAckFramePackets.
   QuicAckFrame ack_frame_;
 
+  // The received packets in the window that ends with the largest observed
+  // one.  Only packets reordered by more than the window miss it and go to
+  // |ack_frame_| directly.
+  QuicReceivedPacketBitmap recent_packets_;
+
+  // Least packet recorded in |recent_packets_| since UpdateAckFramePackets
+  // was last called, or 0 if none.  The ack frame ranges from there on are
+  // out of date.
+  QuicPacketNumber least_packet_not_in_ack_frame_;
+
   // True if |ack_frame_| has been updated since UpdateReceivedPacketInfo was
   // last called.
   bool ack_frame_updated_;
@@ -0,0 +1,207 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_QUIC_RING_BUFFER_H_
+#define NET_QUIC_CORE_QUIC_RING_BUFFER_H_
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/macros.h"
+
+namespace net {
+
+// A double ended queue of |T| in one contiguous array of power of two
+// capacity, used as a ring.  Elements are only added at the back and removed
+// from the front, which is how packets enter and leave a QUIC packet map, so
+// sequential scans touch contiguous memory and indexing is a mask.
+//
+// Unlike std::deque, removed elements are not destroyed: a slot keeps its
+// value, and whatever heap storage that value owns, until push_back assigns
+// a new element to it.  Element types holding buffers, e.g. vectors, hand
+// their capacity on to the next element in the slot instead of freeing it.
+// Growing moves the elements to an array of twice the capacity, which
+// invalidates pointers and references into the buffer.  Iterators hold a
+// position from the front instead, so they survive growing but shift with
+// pop_front.
+template <typename T>
+class QuicRingBuffer {
+ private:
+  template <typename Value, typename Ring>
+  class Iterator {
+   public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef Value value_type;
+    typedef ptrdiff_t difference_type;
+    typedef Value* pointer;
+    typedef Value& reference;
+
+    Iterator() : ring_(nullptr), index_(0) {}
+    Iterator(Ring* ring, size_t index) : ring_(ring), index_(index) {}
+    // Converts an iterator into a const_iterator.
+    template <typename OtherValue, typename OtherRing>
+    Iterator(const Iterator<OtherValue, OtherRing>& other)
+        : ring_(other.ring_), index_(other.index_) {}
+
+    reference operator*() const { return (*ring_)[index_]; }
+    pointer operator->() const { return &(*ring_)[index_]; }
+    reference operator[](difference_type n) const {
+      return (*ring_)[index_ + n];
+    }
+
+    Iterator& operator++() {
+      ++index_;
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator result = *this;
+      ++index_;
+      return result;
+    }
+    Iterator& operator--() {
+      --index_;
+      return *this;
+    }
+    Iterator operator--(int) {
+      Iterator result = *this;
+      --index_;
+      return result;
+    }
+    Iterator& operator+=(difference_type n) {
+      index_ += n;
+      return *this;
+    }
+    Iterator& operator-=(difference_type n) {
+      index_ -= n;
+      return *this;
+    }
+    Iterator operator+(difference_type n) const {
+      return Iterator(ring_, index_ + n);
+    }
+    Iterator operator-(difference_type n) const {
+      return Iterator(ring_, index_ - n);
+    }
+    difference_type operator-(const Iterator& other) const {
+      return static_cast<difference_type>(index_) -
+             static_cast<difference_type>(other.index_);
+    }
+
+    bool operator==(const Iterator& other) const {
+      return index_ == other.index_;
+    }
+    bool operator!=(const Iterator& other) const {
+      return index_ != other.index_;
+    }
+    bool operator<(const Iterator& other) const {
+      return index_ < other.index_;
+    }
+    bool operator>(const Iterator& other) const {
+      return index_ > other.index_;
+    }
+    bool operator<=(const Iterator& other) const {
+      return index_ <= other.index_;
+    }
+    bool operator>=(const Iterator& other) const {
+      return index_ >= other.index_;
+    }
+
+   private:
+    template <typename OtherValue, typename OtherRing>
+    friend class Iterator;
+
+    Ring* ring_;
+    // Position from the front of the ring.
+    size_t index_;
+  };
+
+ public:
+  typedef T value_type;
+  typedef Iterator<T, QuicRingBuffer> iterator;
+  typedef Iterator<const T, const QuicRingBuffer> const_iterator;
+  typedef std::reverse_iterator<iterator> reverse_iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  QuicRingBuffer() : head_(0), size_(0) {}
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+  size_t capacity() const { return slots_.size(); }
+
+  // |index| counts from the front.
+  T& operator[](size_t index) {
+    DCHECK_LT(index, size_);
+    return slots_[(head_ + index) & (slots_.size() - 1)];
+  }
+  const T& operator[](size_t index) const {
+    DCHECK_LT(index, size_);
+    return slots_[(head_ + index) & (slots_.size() - 1)];
+  }
+
+  T& front() { return (*this)[0]; }
+  const T& front() const { return (*this)[0]; }
+  T& back() { return (*this)[size_ - 1]; }
+  const T& back() const { return (*this)[size_ - 1]; }
+
+  // Assigns |value| to the slot after the back, growing first if the ring is
+  // full.
+  void push_back(const T& value) {
+    if (size_ == slots_.size()) {
+      Grow();
+    }
+    ++size_;
+    back() = value;
+  }
+
+  // Removes the front element, which stays in its slot until overwritten.
+  void pop_front() {
+    DCHECK_LT(0u, size_);
+    head_ = (head_ + 1) & (slots_.size() - 1);
+    --size_;
+  }
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, size_); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, size_); }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+ private:
+  static const size_t kInitialCapacity = 64;
+
+  // Doubles the capacity, moving the elements to the front of the new array.
+  void Grow() {
+    std::vector<T> slots(slots_.empty() ? kInitialCapacity
+                                        : 2 * slots_.size());
+    for (size_t i = 0; i < size_; ++i) {
+      std::swap(slots[i], (*this)[i]);
+    }
+    slots_.swap(slots);
+    head_ = 0;
+  }
+
+  // Always empty or a power of two in size.
+  std::vector<T> slots_;
+  // Slot of the front element.
+  size_t head_;
+  size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicRingBuffer);
+};
+
+template <typename T>
+const size_t QuicRingBuffer<T>::kInitialCapacity;
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_QUIC_RING_BUFFER_H_
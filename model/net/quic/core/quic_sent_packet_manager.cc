@@ -19,6 +19,7 @@
 #include "net/quic/platform/api/quic_flags.h"
 #include "net/quic/platform/api/quic_logging.h"
 #include "net/quic/platform/api/quic_map_util.h"
+#include "utils/quic-profiler.h"
 
 namespace net {
 
@@ -67,6 +68,7 @@ QuicSentPacketManager::QuicSentPacketManager(
       debug_delegate_(nullptr),
       network_change_visitor_(nullptr),
       initial_congestion_window_(kInitialCongestionWindow),
+      max_congestion_window_(kDefaultMaxCongestionWindowPackets),
       loss_algorithm_(&general_loss_algorithm_),
       general_loss_algorithm_(loss_type),
       n_connection_simulation_(false),
@@ -124,8 +126,25 @@ void QuicSentPacketManager::SetFromConfig(const QuicConfig& config) {
              config.HasClientRequestedIndependentOption(kTPCC, perspective_)) {
     SetSendAlgorithm(kPCC);
   }
+  // The endpoint's own settings take precedence over connection options.
+  if (config.has_congestion_control_type() ||
+      config.initial_congestion_window() > 0 ||
+      config.max_congestion_window() > 0) {
+    if (config.max_congestion_window() > 0) {
+      max_congestion_window_ = config.max_congestion_window();
+    }
+    if (config.initial_congestion_window() > 0) {
+      initial_congestion_window_ = config.initial_congestion_window();
+    }
+    initial_congestion_window_ =
+        std::min(initial_congestion_window_, max_congestion_window_);
+    SetSendAlgorithm(config.has_congestion_control_type()
+                         ? config.congestion_control_type()
+                         : send_algorithm_->GetCongestionControlType());
+  }
 
-  using_pacing_ = !FLAGS_quic_disable_pacing_for_perf_tests;
+  using_pacing_ =
+      !FLAGS_quic_disable_pacing_for_perf_tests && config.pacing_enabled();
 
   if (config.HasClientSentConnectionOption(k1CON, perspective_)) {
     send_algorithm_->SetNumEmulatedConnections(1);
@@ -203,6 +222,7 @@ void QuicSentPacketManager::SetHandshakeConfirmed() {
 
 void QuicSentPacketManager::OnIncomingAck(const QuicAckFrame& ack_frame,
                                           QuicTime ack_receive_time) {
+  QUIC_PROFILE_SCOPE(CONGESTION_CONTROL);
   DCHECK_LE(ack_frame.largest_observed, unacked_packets_.largest_sent_packet());
   QuicByteCount prior_in_flight = unacked_packets_.bytes_in_flight();
   UpdatePacketInformationReceivedByPeer(ack_frame);
@@ -215,6 +235,8 @@ void QuicSentPacketManager::OnIncomingAck(const QuicAckFrame& ack_frame,
   // Ignore losses in RTO mode.
   if (consecutive_rto_count_ > 0 && !use_new_rto_) {
     packets_lost_.clear();
+    // The loss algorithm must not skip the packets whose losses were ignored.
+    general_loss_algorithm_.ResetLeastInFlight();
   }
   MaybeInvokeCongestionEvent(rtt_updated, prior_in_flight, ack_receive_time);
   unacked_packets_.RemoveObsoletePackets();
@@ -471,28 +493,32 @@ void QuicSentPacketManager::MarkPacketHandled(QuicPacketNumber packet_number,
 
   // The AckListener needs to be notified about the most recent
   // transmission, since that's the one only one it tracks.
+  // Listeners and the stream notifier may send packets, and a send may grow
+  // |unacked_packets_| and move its records, |info| included: records are
+  // looked up again by packet number after every notification.
   if (newest_transmission == packet_number) {
     unacked_packets_.NotifyStreamFramesAcked(*info, ack_delay_time);
-    unacked_packets_.NotifyAndClearListeners(&info->ack_listeners,
-                                             ack_delay_time);
+    unacked_packets_.NotifyAndClearListeners(packet_number, ack_delay_time);
   } else {
     unacked_packets_.NotifyAndClearListeners(newest_transmission,
                                              ack_delay_time);
-    RecordSpuriousRetransmissions(*info, packet_number);
+    RecordSpuriousRetransmissions(
+        unacked_packets_.GetTransmissionInfo(packet_number), packet_number);
     // Remove the most recent packet from flight if it's a crypto handshake
     // packet, since they won't be acked now that one has been processed.
     // Other crypto handshake packets won't be in flight, only the newest
     // transmission of a crypto packet is in flight at once.
     // TODO(ianswett): Instead of handling all crypto packets special,
     // only handle nullptr encrypted packets in a special way.
-    const QuicTransmissionInfo& newest_transmission_info =
-        unacked_packets_.GetTransmissionInfo(newest_transmission);
-    unacked_packets_.NotifyStreamFramesAcked(newest_transmission_info,
-                                             ack_delay_time);
-    if (HasCryptoHandshake(newest_transmission_info)) {
+    unacked_packets_.NotifyStreamFramesAcked(
+        unacked_packets_.GetTransmissionInfo(newest_transmission),
+        ack_delay_time);
+    if (HasCryptoHandshake(
+            unacked_packets_.GetTransmissionInfo(newest_transmission))) {
       unacked_packets_.RemoveFromInFlight(newest_transmission);
     }
   }
+  info = unacked_packets_.GetMutableTransmissionInfo(packet_number);
 
   if (network_change_visitor_ != nullptr &&
       info->bytes_sent > largest_mtu_acked_) {
@@ -518,6 +544,7 @@ bool QuicSentPacketManager::OnPacketSent(
     QuicTime sent_time,
     TransmissionType transmission_type,
     HasRetransmittableData has_retransmittable_data) {
+  QUIC_PROFILE_SCOPE(CONGESTION_CONTROL);
   QuicPacketNumber packet_number = serialized_packet->packet_number;
   DCHECK_LT(0u, packet_number);
   DCHECK(!unacked_packets_.IsUnacked(packet_number));
@@ -550,6 +577,7 @@ bool QuicSentPacketManager::OnPacketSent(
 }
 
 void QuicSentPacketManager::OnRetransmissionTimeout() {
+  QUIC_PROFILE_SCOPE(CONGESTION_CONTROL);
   DCHECK(unacked_packets_.HasInFlightPackets());
   DCHECK_EQ(0u, pending_timer_transmission_count_);
   // Handshake retransmission, timer based loss detection, TLP, and RTO are
@@ -908,7 +936,8 @@ void QuicSentPacketManager::SetSendAlgorithm(
     CongestionControlType congestion_control_type) {
   SetSendAlgorithm(SendAlgorithmInterface::Create(
       clock_, &rtt_stats_, &unacked_packets_, congestion_control_type,
-      QuicRandom::GetInstance(), stats_, initial_congestion_window_));
+      QuicRandom::GetInstance(), stats_, initial_congestion_window_,
+      max_congestion_window_));
 }
 
 void QuicSentPacketManager::SetSendAlgorithm(
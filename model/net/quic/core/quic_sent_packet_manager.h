@@ -352,7 +352,8 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
 
   DebugDelegate* debug_delegate_;
   NetworkChangeVisitor* network_change_visitor_;
-  const QuicPacketCount initial_congestion_window_;
+  QuicPacketCount initial_congestion_window_;
+  QuicPacketCount max_congestion_window_;
   RttStats rtt_stats_;
   std::unique_ptr<SendAlgorithmInterface> send_algorithm_;
   // Not owned. Always points to |general_loss_algorithm_| outside of tests.
@@ -7,17 +7,18 @@
 namespace net {
 
 QuicTransmissionInfo::QuicTransmissionInfo()
-    : encryption_level(ENCRYPTION_NONE),
-      packet_number_length(PACKET_1BYTE_PACKET_NUMBER),
+    : sent_time(QuicTime::Zero()),
+      retransmission(0),
+      largest_acked(0),
       bytes_sent(0),
-      sent_time(QuicTime::Zero()),
+      num_padding_bytes(0),
+      encryption_level(ENCRYPTION_NONE),
+      packet_number_length(PACKET_1BYTE_PACKET_NUMBER),
       transmission_type(NOT_RETRANSMISSION),
       in_flight(false),
       is_unackable(false),
       has_crypto_handshake(false),
-      num_padding_bytes(0),
-      retransmission(0),
-      largest_acked(0) {}
+      ack_listeners(0) {}
 
 QuicTransmissionInfo::QuicTransmissionInfo(
     EncryptionLevel level,
@@ -27,21 +28,25 @@ QuicTransmissionInfo::QuicTransmissionInfo(
     QuicPacketLength bytes_sent,
     bool has_crypto_handshake,
     int num_padding_bytes)
-    : encryption_level(level),
-      packet_number_length(packet_number_length),
+    : sent_time(sent_time),
+      retransmission(0),
+      largest_acked(0),
       bytes_sent(bytes_sent),
-      sent_time(sent_time),
+      num_padding_bytes(num_padding_bytes),
+      encryption_level(level),
+      packet_number_length(packet_number_length),
       transmission_type(transmission_type),
       in_flight(false),
       is_unackable(false),
       has_crypto_handshake(has_crypto_handshake),
-      num_padding_bytes(num_padding_bytes),
-      retransmission(0),
-      largest_acked(0) {}
+      ack_listeners(0) {}
 
 QuicTransmissionInfo::QuicTransmissionInfo(const QuicTransmissionInfo& other) =
     default;
 
+QuicTransmissionInfo& QuicTransmissionInfo::operator=(
+    const QuicTransmissionInfo& other) = default;
+
 QuicTransmissionInfo::~QuicTransmissionInfo() {}
 
 }  // namespace net
@@ -5,8 +5,6 @@
 #ifndef NET_QUIC_CORE_QUIC_TRANSMISSION_INFO_H_
 #define NET_QUIC_CORE_QUIC_TRANSMISSION_INFO_H_
 
-#include <list>
-
 #include "net/quic/core/frames/quic_frame.h"
 #include "net/quic/core/quic_ack_listener_interface.h"
 #include "net/quic/core/quic_types.h"
@@ -31,13 +29,26 @@ struct QUIC_EXPORT_PRIVATE QuicTransmissionInfo {
 
   QuicTransmissionInfo(const QuicTransmissionInfo& other);
 
+  // Used by QuicUnackedPacketMap to reuse the slots of removed packets.
+  QuicTransmissionInfo& operator=(const QuicTransmissionInfo& other);
+
   ~QuicTransmissionInfo();
 
+  // Swapped in from the SerializedPacket.  The vector stays in the slot of
+  // the QuicUnackedPacketMap once the packet is removed, so its capacity is
+  // reused by later packets.
   QuicFrames retransmittable_frames;
+  QuicTime sent_time;
+  // Stores the packet number of the next retransmission of this packet.
+  // Zero if the packet has not been retransmitted.
+  QuicPacketNumber retransmission;
+  // The largest_acked in the ack frame, if the packet contains an ack.
+  QuicPacketNumber largest_acked;
+  QuicPacketLength bytes_sent;
+  // Non-zero if the packet needs padding if it's retransmitted.
+  int16_t num_padding_bytes;
   EncryptionLevel encryption_level;
   QuicPacketNumberLength packet_number_length;
-  QuicPacketLength bytes_sent;
-  QuicTime sent_time;
   // Reason why this packet was transmitted.
   TransmissionType transmission_type;
   // In flight packets have not been abandoned or lost.
@@ -48,21 +59,17 @@ struct QUIC_EXPORT_PRIVATE QuicTransmissionInfo {
   bool is_unackable;
   // True if the packet contains stream data from the crypto stream.
   bool has_crypto_handshake;
-  // Non-zero if the packet needs padding if it's retransmitted.
-  int16_t num_padding_bytes;
-  // Stores the packet number of the next retransmission of this packet.
-  // Zero if the packet has not been retransmitted.
-  QuicPacketNumber retransmission;
-  // Non-empty if there is a listener for this packet.
-  std::list<AckListenerWrapper> ack_listeners;
-  // The largest_acked in the ack frame, if the packet contains an ack.
-  QuicPacketNumber largest_acked;
+  // Non-zero if there are listeners for this packet: identifies them in the
+  // side storage of the QuicUnackedPacketMap, which keeps the rare listeners
+  // out of the records.
+  uint32_t ack_listeners;
 };
-// TODO(ianswett): Add static_assert when size of this struct is reduced below
-// 64 bytes.
-// NOTE(vlovich): Existing static_assert removed because padding differences on
-// 64-bit iOS resulted in an 88-byte struct that is greater than the 84-byte
-// limit on other platforms.  Removing per ianswett's request.
+// Records are scanned linearly on every ack: keep the fields besides the
+// frames vector within 40 bytes, which makes a record one 64 byte cache line
+// where the vector takes 24 bytes, as in 64-bit release builds of the usual
+// standard libraries.
+static_assert(sizeof(QuicTransmissionInfo) <= sizeof(QuicFrames) + 40,
+              "QuicTransmissionInfo grew");
 
 }  // namespace net
 
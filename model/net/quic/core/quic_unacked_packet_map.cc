@@ -4,6 +4,8 @@
 
 #include "net/quic/core/quic_unacked_packet_map.h"
 
+#include <utility>
+
 #include "net/quic/core/quic_connection_stats.h"
 #include "net/quic/core/quic_utils.h"
 #include "net/quic/platform/api/quic_bug_tracker.h"
@@ -56,9 +58,12 @@ void QuicUnackedPacketMap::AddSentPacket(SerializedPacket* packet,
     info.in_flight = true;
     largest_sent_retransmittable_packet_ = packet_number;
   }
+  if (old_packet_number == 0 && !packet->listeners.empty()) {
+    info.ack_listeners = StoreAckListeners(&packet->listeners);
+  }
   unacked_packets_.push_back(info);
-  // Swap the ack listeners and retransmittable frames to avoid allocations.
-  // TODO(ianswett): Could use emplace_back when Chromium can.
+  // Swap the retransmittable frames to avoid allocations: the packet gets
+  // the empty vector left in the slot by the packet removed from it.
   if (old_packet_number == 0) {
     if (has_crypto_handshake) {
       ++pending_crypto_packet_count_;
@@ -66,21 +71,47 @@ void QuicUnackedPacketMap::AddSentPacket(SerializedPacket* packet,
 
     packet->retransmittable_frames.swap(
         unacked_packets_.back().retransmittable_frames);
-    unacked_packets_.back().ack_listeners.swap(packet->listeners);
   }
 }
 
 void QuicUnackedPacketMap::RemoveObsoletePackets() {
   while (!unacked_packets_.empty()) {
-    if (!IsPacketUseless(least_unacked_, unacked_packets_.front())) {
+    QuicTransmissionInfo& info = unacked_packets_.front();
+    if (!IsPacketUseless(least_unacked_, info)) {
       break;
     }
 
+    if (info.ack_listeners != 0) {
+      ReleaseAckListeners(info.ack_listeners);
+      info.ack_listeners = 0;
+    }
     unacked_packets_.pop_front();
     ++least_unacked_;
   }
 }
 
+uint32_t QuicUnackedPacketMap::StoreAckListeners(
+    std::list<AckListenerWrapper>* listeners) {
+  uint32_t index;
+  if (free_ack_listeners_.empty()) {
+    index = ack_listeners_.size();
+    ack_listeners_.emplace_back();
+  } else {
+    index = free_ack_listeners_.back();
+    free_ack_listeners_.pop_back();
+  }
+  ack_listeners_[index].assign(listeners->begin(), listeners->end());
+  listeners->clear();
+  return index + 1;
+}
+
+void QuicUnackedPacketMap::ReleaseAckListeners(uint32_t ack_listeners) {
+  DCHECK_LT(0u, ack_listeners);
+  DCHECK_LE(ack_listeners, ack_listeners_.size());
+  ack_listeners_[ack_listeners - 1].clear();
+  free_ack_listeners_.push_back(ack_listeners - 1);
+}
+
 void QuicUnackedPacketMap::TransferRetransmissionInfo(
     QuicPacketNumber old_packet_number,
     QuicPacketNumber new_packet_number,
@@ -101,18 +132,8 @@ void QuicUnackedPacketMap::TransferRetransmissionInfo(
   DCHECK_NE(NOT_RETRANSMISSION, transmission_type);
 
   QuicTransmissionInfo* transmission_info =
-      &unacked_packets_.at(old_packet_number - least_unacked_);
+      &unacked_packets_[old_packet_number - least_unacked_];
   QuicFrames* frames = &transmission_info->retransmittable_frames;
-  if (stream_notifier_ != nullptr) {
-    for (const QuicFrame& frame : *frames) {
-      if (frame.type == STREAM_FRAME) {
-        stream_notifier_->OnStreamFrameRetransmitted(*frame.stream_frame);
-      }
-    }
-  }
-  for (AckListenerWrapper& wrapper : transmission_info->ack_listeners) {
-    wrapper.ack_listener->OnPacketRetransmitted(wrapper.length);
-  }
 
   // Swap the frames and preserve num_padding_bytes and has_crypto_handshake.
   frames->swap(info->retransmittable_frames);
@@ -121,7 +142,7 @@ void QuicUnackedPacketMap::TransferRetransmissionInfo(
   info->num_padding_bytes = transmission_info->num_padding_bytes;
 
   // Transfer the AckListeners if any are present.
-  info->ack_listeners.swap(transmission_info->ack_listeners);
+  std::swap(info->ack_listeners, transmission_info->ack_listeners);
   QUIC_BUG_IF(frames == nullptr)
       << "Attempt to retransmit packet with no "
       << "retransmittable frames: " << old_packet_number;
@@ -134,6 +155,25 @@ void QuicUnackedPacketMap::TransferRetransmissionInfo(
   } else {
     transmission_info->retransmission = new_packet_number;
   }
+
+  // Notified once the transfer is done, from |info|, which is not in the map
+  // yet: the notifications may send packets, which may grow the map and the
+  // listener storage and move what |transmission_info| points to.
+  if (stream_notifier_ != nullptr) {
+    for (const QuicFrame& frame : info->retransmittable_frames) {
+      if (frame.type == STREAM_FRAME) {
+        stream_notifier_->OnStreamFrameRetransmitted(*frame.stream_frame);
+      }
+    }
+  }
+  if (info->ack_listeners != 0) {
+    const std::vector<AckListenerWrapper> ack_listeners(
+        ack_listeners_[info->ack_listeners - 1]);
+    for (const AckListenerWrapper& wrapper : ack_listeners) {
+      wrapper.ack_listener->OnPacketRetransmitted(wrapper.length);
+    }
+  }
+
   // Proactively remove obsolete packets so the least unacked can be raised.
   RemoveObsoletePackets();
 }
@@ -219,12 +259,23 @@ bool QuicUnackedPacketMap::IsUnacked(QuicPacketNumber packet_number) const {
 }
 
 void QuicUnackedPacketMap::NotifyAndClearListeners(
-    std::list<AckListenerWrapper>* ack_listeners,
+    QuicTransmissionInfo* info,
     QuicTime::Delta ack_delay_time) {
-  for (const AckListenerWrapper& wrapper : *ack_listeners) {
+  if (info->ack_listeners == 0) {
+    return;
+  }
+  const uint32_t index = info->ack_listeners - 1;
+  info->ack_listeners = 0;
+  // Listeners may send packets, which may store listeners and move the
+  // lists: notify from a local list and only then release the slot.
+  std::vector<AckListenerWrapper> ack_listeners;
+  ack_listeners.swap(ack_listeners_[index]);
+  for (const AckListenerWrapper& wrapper : ack_listeners) {
     wrapper.ack_listener->OnPacketAcked(wrapper.length, ack_delay_time);
   }
-  ack_listeners->clear();
+  ack_listeners.clear();
+  ack_listeners_[index].swap(ack_listeners);
+  free_ack_listeners_.push_back(index);
 }
 
 void QuicUnackedPacketMap::NotifyAndClearListeners(
@@ -234,7 +285,7 @@ void QuicUnackedPacketMap::NotifyAndClearListeners(
   DCHECK_LT(packet_number, least_unacked_ + unacked_packets_.size());
   QuicTransmissionInfo* info =
       &unacked_packets_[packet_number - least_unacked_];
-  NotifyAndClearListeners(&info->ack_listeners, ack_delay_time);
+  NotifyAndClearListeners(info, ack_delay_time);
 }
 
 void QuicUnackedPacketMap::RemoveFromInFlight(QuicTransmissionInfo* info) {
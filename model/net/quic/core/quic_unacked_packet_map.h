@@ -6,10 +6,12 @@
 #define NET_QUIC_CORE_QUIC_UNACKED_PACKET_MAP_H_
 
 #include <cstddef>
-#include <deque>
+#include <list>
+#include <vector>
 
 #include "base/macros.h"
 #include "net/quic/core/quic_packets.h"
+#include "net/quic/core/quic_ring_buffer.h"
 #include "net/quic/core/quic_transmission_info.h"
 #include "net/quic/core/stream_notifier_interface.h"
 #include "net/quic/platform/api/quic_export.h"
@@ -31,8 +33,8 @@ class QUIC_EXPORT_PRIVATE QuicUnackedPacketMap {
   // don't arrive, indicating the need for retransmission.
   // |old_packet_number| is the packet number of the previous transmission,
   // or 0 if there was none.
-  // Any AckNotifierWrappers in |serialized_packet| are swapped from the
-  // serialized packet into the QuicTransmissionInfo.
+  // Any AckNotifierWrappers in |serialized_packet| are moved from the
+  // serialized packet into the side storage of the map.
   void AddSentPacket(SerializedPacket* serialized_packet,
                      QuicPacketNumber old_packet_number,
                      TransmissionType transmission_type,
@@ -44,7 +46,7 @@ class QUIC_EXPORT_PRIVATE QuicUnackedPacketMap {
 
   // Notifies all the AckListeners attached to the |info| and
   // clears them to ensure they're not notified again.
-  void NotifyAndClearListeners(std::list<AckListenerWrapper>* ack_listeners,
+  void NotifyAndClearListeners(QuicTransmissionInfo* info,
                                QuicTime::Delta delta_largest_observed);
 
   // Notifies all the AckListeners attached to |newest_transmission|.
@@ -99,7 +101,7 @@ class QUIC_EXPORT_PRIVATE QuicUnackedPacketMap {
   // been acked by the peer.  If there are no unacked packets, returns 0.
   QuicPacketNumber GetLeastUnacked() const;
 
-  typedef std::deque<QuicTransmissionInfo> UnackedPacketMap;
+  typedef QuicRingBuffer<QuicTransmissionInfo> UnackedPacketMap;
 
   typedef UnackedPacketMap::const_iterator const_iterator;
   typedef UnackedPacketMap::iterator iterator;
@@ -180,6 +182,13 @@ class QUIC_EXPORT_PRIVATE QuicUnackedPacketMap {
   bool IsPacketUseless(QuicPacketNumber packet_number,
                        const QuicTransmissionInfo& info) const;
 
+  // Moves |listeners| to a free list of |ack_listeners_| and returns the
+  // QuicTransmissionInfo::ack_listeners identifying it.
+  uint32_t StoreAckListeners(std::list<AckListenerWrapper>* listeners);
+
+  // Releases the list of |ack_listeners_| identified by |ack_listeners|.
+  void ReleaseAckListeners(uint32_t ack_listeners);
+
   QuicPacketNumber largest_sent_packet_;
   // The largest sent packet we expect to receive an ack for.
   QuicPacketNumber largest_sent_retransmittable_packet_;
@@ -193,6 +202,8 @@ class QUIC_EXPORT_PRIVATE QuicUnackedPacketMap {
   // If the old packet is acked before the new packet, then the old entry will
   // be removed from the map and the new entry's retransmittable frames will be
   // set to nullptr.
+  // The records are kept in a ring, so removing packets from the front and
+  // scanning them on acks walk contiguous memory.
   UnackedPacketMap unacked_packets_;
   // The packet at the 0th index of unacked_packets_.
   QuicPacketNumber least_unacked_;
@@ -205,6 +216,12 @@ class QUIC_EXPORT_PRIVATE QuicUnackedPacketMap {
   // acknowledged.
   StreamNotifierInterface* stream_notifier_;
 
+  // Ack listeners of the packets that have any; list i belongs to the packet
+  // whose QuicTransmissionInfo::ack_listeners is i + 1.  Released lists keep
+  // their capacity and are listed in |free_ack_listeners_| for reuse.
+  std::vector<std::vector<AckListenerWrapper>> ack_listeners_;
+  std::vector<uint32_t> free_ack_listeners_;
+
   DISALLOW_COPY_AND_ASSIGN(QuicUnackedPacketMap);
 };
 
@@ -5,14 +5,13 @@
 #ifndef NET_QUIC_PLATFORM_IMPL_QUIC_PCC_SENDER_IMPL_H_
 #define NET_QUIC_PLATFORM_IMPL_QUIC_PCC_SENDER_IMPL_H_
 
+#include "net/quic/core/congestion_control/pcc_sender.h"
 #include "net/quic/core/congestion_control/send_algorithm_interface.h"
-#include "net/quic/core/congestion_control/tcp_cubic_sender_bytes.h"
 
 namespace net {
 
-// Interface for creating a PCC SendAlgorithmInterface.  For chromium,
-// this implementation is currently a stub that passes through to
-// cubic bytes.
+// Interface for creating a PCC SendAlgorithmInterface.  The sender is the
+// rate-based PCC Vivace; QuicSentPacketManager paces it like BBR.
 SendAlgorithmInterface* CreatePccSenderImpl(
     const QuicClock* clock,
     const RttStats* rtt_stats,
@@ -21,9 +20,8 @@ SendAlgorithmInterface* CreatePccSenderImpl(
     QuicConnectionStats* stats,
     QuicPacketCount initial_congestion_window,
     QuicPacketCount max_congestion_window) {
-  return new TcpCubicSenderBytes(clock, rtt_stats, false /* don't use Reno */,
-                                 initial_congestion_window,
-                                 max_congestion_window, stats);
+  return new PccSender(rtt_stats, initial_congestion_window,
+                       max_congestion_window, random);
 }
 
 }  // namespace net
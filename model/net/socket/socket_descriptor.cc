@@ -43,7 +43,7 @@ SocketDescriptor CreatePlatformSocket(int family, int type, int protocol) {
   if (result != kInvalidSocket) {
     int value = 1;
     if (setsockopt_ns3(result, SOL_SOCKET, SO_NOSIGPIPE, &value, sizeof(value))) {
-      close(result);
+      close_ns3(result);
       return kInvalidSocket;
     }
   }
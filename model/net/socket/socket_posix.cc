@@ -383,7 +383,7 @@ void SocketPosix::Close() {
   StopWatchingAndCleanUp();
 
   if (socket_fd_ != kInvalidSocket) {
-    if (IGNORE_EINTR(close(socket_fd_)) < 0)
+    if (IGNORE_EINTR(close_ns3(socket_fd_)) < 0)
       PLOG(ERROR) << "close() returned an error, errno=" << errno;
     socket_fd_ = kInvalidSocket;
   }
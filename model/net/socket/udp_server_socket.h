@@ -60,6 +60,7 @@ class NET_EXPORT UDPServerSocket : public DatagramServerSocket {
   bool allow_broadcast_;
   DISALLOW_COPY_AND_ASSIGN(UDPServerSocket);
   friend class net::QuicSimpleServer;
+  friend class net::QuicSimpleServerPacketWriter;
 };
 
 }  // namespace net
@@ -287,7 +287,7 @@ void UDPSocketPosix::Close() {
 #if defined(OS_MACOSX) && !defined(OS_IOS)
   PCHECK(IGNORE_EINTR(guarded_close_np(socket_, &kSocketFdGuard)) == 0);
 #else
-  PCHECK(IGNORE_EINTR(close(socket_)) == 0);
+  PCHECK(IGNORE_EINTR(close_ns3(socket_)) == 0);
 #endif  // defined(OS_MACOSX) && !defined(OS_IOS)
 
   socket_ = kInvalidSocket;
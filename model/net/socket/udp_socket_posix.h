@@ -33,6 +33,8 @@ namespace net {
 
 class IPAddress;
 class NetLog;
+class QuicChromiumPacketWriter;
+class QuicSimpleServerPacketWriter;
 struct NetLogSource;
 
 class NET_EXPORT UDPSocketPosix {
@@ -379,6 +381,8 @@ class NET_EXPORT UDPSocketPosix {
 
   friend class net::QuicSimpleServer;
   friend class net::QuicChromiumPacketReader;
+  friend class net::QuicSimpleServerPacketWriter;
+  friend class net::QuicChromiumPacketWriter;
 };
 
 }  // namespace net
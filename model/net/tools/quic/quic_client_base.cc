@@ -29,7 +29,31 @@ namespace net {
     initialized_(false),
     local_port_(0),
     config_(config),
-    crypto_config_(std::move(proof_verifier)),
+    owned_crypto_config_(
+        new QuicCryptoClientConfig(std::move(proof_verifier))),
+    crypto_config_(owned_crypto_config_.get()),
+    helper_(helper),
+    alarm_factory_(alarm_factory),
+    supported_versions_(supported_versions),
+    initial_max_packet_length_(0),
+    num_stateless_rejects_received_(0),
+    num_sent_client_hellos_(0),
+    connection_error_(QUIC_NO_ERROR),
+    connected_or_attempting_connect_(false),
+    network_helper_(std::move(network_helper)) {}
+
+  QuicClientBase::QuicClientBase(const QuicServerId& server_id,
+      const QuicVersionVector& supported_versions,
+      const QuicConfig& config,
+      QuicConnectionHelperInterface* helper,
+      QuicAlarmFactory* alarm_factory,
+      std::unique_ptr<NetworkHelper> network_helper,
+      QuicCryptoClientConfig* crypto_config)
+    : server_id_(server_id),
+    initialized_(false),
+    local_port_(0),
+    config_(config),
+    crypto_config_(crypto_config),
     helper_(helper),
     alarm_factory_(alarm_factory),
     supported_versions_(supported_versions),
@@ -160,7 +184,7 @@ namespace net {
   }
 
   ProofVerifier* QuicClientBase::proof_verifier() const {
-    return crypto_config_.proof_verifier();
+    return crypto_config_->proof_verifier();
   }
 
   bool QuicClientBase::EncryptionBeingEstablished() {
@@ -296,7 +320,7 @@ namespace net {
 
   QuicConnectionId QuicClientBase::GetNextServerDesignatedConnectionId() {
     QuicCryptoClientConfig::CachedState* cached =
-      crypto_config_.LookupOrCreate(server_id_);
+      crypto_config_->LookupOrCreate(server_id_);
     // If the cached state indicates that we should use a server-designated
     // connection ID, then return that connection ID.
     CHECK(cached != nullptr) << "QuicClientCryptoConfig::LookupOrCreate returned "
@@ -66,6 +66,18 @@ class QuicClientBase {
                  std::unique_ptr<NetworkHelper> network_helper,
                  std::unique_ptr<ProofVerifier> proof_verifier);
 
+  // As above, but uses a |crypto_config| owned by the caller, which must
+  // outlive the client. Clients sharing a config share its cached server
+  // configs and source-address tokens, so a connection can resume with
+  // 0-RTT to any server another one has already talked to.
+  QuicClientBase(const QuicServerId& server_id,
+                 const QuicVersionVector& supported_versions,
+                 const QuicConfig& config,
+                 QuicConnectionHelperInterface* helper,
+                 QuicAlarmFactory* alarm_factory,
+                 std::unique_ptr<NetworkHelper> network_helper,
+                 QuicCryptoClientConfig* crypto_config);
+
   virtual ~QuicClientBase();
 
   // Initializes the client to create a connection. Should be called exactly
@@ -120,7 +132,7 @@ class QuicClientBase {
   void set_server_id(const QuicServerId& server_id) { server_id_ = server_id; }
 
   void SetUserAgentID(const std::string& user_agent_id) {
-    crypto_config_.set_user_agent_id(user_agent_id);
+    crypto_config_->set_user_agent_id(user_agent_id);
   }
 
   // SetChannelIDSource sets a ChannelIDSource that will be called, when the
@@ -128,7 +140,7 @@ class QuicClientBase {
   // proving possession of the channel ID. This object takes ownership of
   // |source|.
   void SetChannelIDSource(ChannelIDSource* source) {
-    crypto_config_.SetChannelIDSource(source);
+    crypto_config_->SetChannelIDSource(source);
   }
 
   // UseTokenBinding enables token binding negotiation in the client.  This
@@ -139,7 +151,7 @@ class QuicClientBase {
   // found on the QuicCryptoNegotiatedParameters object in
   // token_binding_key_param.
   void UseTokenBinding() {
-    crypto_config_.tb_key_params = QuicTagVector{kTB10};
+    crypto_config_->tb_key_params = QuicTagVector{kTB10};
   }
 
   const QuicVersionVector& supported_versions() const {
@@ -152,7 +164,7 @@ class QuicClientBase {
 
   QuicConfig* config() { return &config_; }
 
-  QuicCryptoClientConfig* crypto_config() { return &crypto_config_; }
+  QuicCryptoClientConfig* crypto_config() { return crypto_config_; }
 
   // Change the initial maximum packet size of the connection.  Has to be called
   // before Connect()/StartConnect() in order to have any effect.
@@ -310,8 +322,11 @@ class QuicClientBase {
 
   // config_ and crypto_config_ contain configuration and cached state about
   // servers.
+  // |crypto_config_| points either to |owned_crypto_config_| or to a config
+  // shared with other clients.
   QuicConfig config_;
-  QuicCryptoClientConfig crypto_config_;
+  std::unique_ptr<QuicCryptoClientConfig> owned_crypto_config_;
+  QuicCryptoClientConfig* crypto_config_;
 
   // Helper to be used by created connections. Must outlive |session_|.
   std::unique_ptr<QuicConnectionHelperInterface> helper_;
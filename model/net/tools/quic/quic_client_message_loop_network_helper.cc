@@ -74,6 +74,10 @@ bool QuicClientMessageLooplNetworkHelper::CreateUDPSocketAndBind(
     return false;
   }
 
+  // MTU probes must be lost, not fragmented, when they exceed the path MTU.
+  // SetDoNotFragment is not implemented on all platforms, so ignore errors.
+  socket->SetDoNotFragment();
+
   IPEndPoint address;
   rc = socket->GetLocalAddress(&address);
   if (rc != OK) {
@@ -0,0 +1,103 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_client_ns3_network_helper.h"
+
+#include "base/logging.h"
+#include "net/quic/core/quic_connection.h"
+#include "net/quic/core/quic_packets.h"
+#include "net/tools/quic/quic_ns3_packet_writer.h"
+
+#include "ns3/boolean.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/quic-socket-factory.h"
+
+namespace net {
+
+QuicClientNs3NetworkHelper::QuicClientNs3NetworkHelper(
+    QuicChromiumClock* clock,
+    QuicClientBase* client,
+    ns3::Ptr<ns3::Node> node)
+    : node_(node), clock_(clock), client_(client) {}
+
+QuicClientNs3NetworkHelper::~QuicClientNs3NetworkHelper() {
+  CleanUpAllUDPSockets();
+}
+
+bool QuicClientNs3NetworkHelper::CreateUDPSocketAndBind(
+    QuicSocketAddress server_address,
+    QuicIpAddress bind_to_address,
+    int bind_to_port) {
+  if (node_->GetObject<ns3::QuicSocketFactory>() == nullptr) {
+    LOG(ERROR) << "No ns3::QuicL4Protocol on node " << node_->GetId()
+               << ", install one with ns3::QuicHelper";
+    return false;
+  }
+  ns3::Ptr<ns3::Socket> socket =
+      ns3::Socket::CreateSocket(node_, ns3::QuicSocketFactory::GetTypeId());
+
+  ns3::Address local;
+  if (bind_to_address.IsInitialized()) {
+    local = Ns3AddressFromQuic(
+        QuicSocketAddress(bind_to_address, client_->local_port()));
+  } else if (server_address.host().address_family() ==
+             IpAddressFamily::IP_V4) {
+    local = ns3::InetSocketAddress(ns3::Ipv4Address::GetAny(), bind_to_port);
+  } else {
+    local = ns3::Inet6SocketAddress(ns3::Ipv6Address::GetAny(), bind_to_port);
+  }
+  if (socket->Bind(local) < 0 ||
+      socket->Connect(Ns3AddressFromQuic(server_address)) < 0) {
+    LOG(ERROR) << "Bind or Connect failed with ns-3 socket error "
+               << socket->GetErrno();
+    socket->Close();
+    return false;
+  }
+
+  // MTU probes must be lost, not fragmented, when they exceed the path MTU.
+  socket->SetAttribute("MtuDiscover", ns3::BooleanValue(true));
+
+  ns3::Address address;
+  socket->GetSockName(address);
+  client_address_ = QuicSocketAddressFromNs3(address);
+
+  CleanUpAllUDPSockets();
+  socket_ = socket;
+  return true;
+}
+
+void QuicClientNs3NetworkHelper::CleanUpAllUDPSockets() {
+  if (socket_ == nullptr)
+    return;
+  socket_->SetRecvCallback(
+      ns3::MakeNullCallback<void, ns3::Ptr<ns3::Socket>>());
+  socket_->Close();
+  socket_ = nullptr;
+}
+
+void QuicClientNs3NetworkHelper::RunEventLoop() {
+  // Datagrams are pushed to ProcessPacket() by the socket owner.
+}
+
+QuicPacketWriter* QuicClientNs3NetworkHelper::CreateQuicPacketWriter() {
+  return new QuicNs3PacketWriter(socket_);
+}
+
+QuicSocketAddress QuicClientNs3NetworkHelper::GetLatestClientAddress() const {
+  return client_address_;
+}
+
+bool QuicClientNs3NetworkHelper::ProcessPacket(
+    ns3::Ptr<ns3::Packet> packet,
+    const ns3::Address& peer_address) {
+  uint32_t length = packet->CopyData(
+      reinterpret_cast<uint8_t*>(read_buffer_), sizeof(read_buffer_));
+  QuicReceivedPacket received(read_buffer_, length, clock_->Now());
+  client_->session()->connection()->ProcessUdpPacket(
+      client_address_, QuicSocketAddressFromNs3(peer_address), received);
+  return client_->session()->connection()->connected();
+}
+
+}  // namespace net
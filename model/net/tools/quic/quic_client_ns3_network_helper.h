@@ -0,0 +1,75 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// A QuicClientBase::NetworkHelper on a native ns-3 QUIC socket, created by
+// the ns3::QuicL4Protocol of a node.
+
+#ifndef NET_TOOLS_QUIC_QUIC_CLIENT_NS3_NETWORK_HELPER_H_
+#define NET_TOOLS_QUIC_QUIC_CLIENT_NS3_NETWORK_HELPER_H_
+
+#include <stddef.h>
+
+#include "base/macros.h"
+#include "net/quic/core/quic_constants.h"
+#include "net/quic/platform/impl/quic_chromium_clock.h"
+#include "net/tools/quic/quic_client_base.h"
+
+#include "ns3/address.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+#include "ns3/socket.h"
+
+namespace net {
+
+// The socket is not read by the helper: its owner reads the datagrams, e.g.
+// from the socket's receive callback, and hands them to ProcessPacket().
+class QuicClientNs3NetworkHelper : public QuicClientBase::NetworkHelper {
+ public:
+  // Sockets are created on |node|, which must have an ns3::QuicL4Protocol.
+  QuicClientNs3NetworkHelper(QuicChromiumClock* clock,
+                             QuicClientBase* client,
+                             ns3::Ptr<ns3::Node> node);
+
+  ~QuicClientNs3NetworkHelper() override;
+
+  // From NetworkHelper.
+  void RunEventLoop() override;
+  bool CreateUDPSocketAndBind(QuicSocketAddress server_address,
+                              QuicIpAddress bind_to_address,
+                              int bind_to_port) override;
+  void CleanUpAllUDPSockets() override;
+  QuicSocketAddress GetLatestClientAddress() const override;
+  QuicPacketWriter* CreateQuicPacketWriter() override;
+
+  // Processes a datagram read from socket(). Returns false if the connection
+  // is closed afterwards.
+  bool ProcessPacket(ns3::Ptr<ns3::Packet> packet,
+                     const ns3::Address& peer_address);
+
+  // The socket connected to the server, or null before
+  // CreateUDPSocketAndBind().
+  ns3::Ptr<ns3::Socket> socket() const { return socket_; }
+
+ private:
+  // Address of the client if the client is connected to the server.
+  QuicSocketAddress client_address_;
+
+  // Socket connected to the server.
+  ns3::Ptr<ns3::Socket> socket_;
+
+  ns3::Ptr<ns3::Node> node_;
+
+  QuicChromiumClock* clock_;
+  QuicClientBase* client_;
+
+  // QuicReceivedPacket needs the datagram in contiguous memory.
+  char read_buffer_[kMaxJumboPacketSize];
+
+  DISALLOW_COPY_AND_ASSIGN(QuicClientNs3NetworkHelper);
+};
+
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_CLIENT_NS3_NETWORK_HELPER_H_
@@ -227,7 +227,8 @@ void QuicHttpResponseCache::AddSpecialResponse(
                   SpdyHeaderBlock());
 }
 
-QuicHttpResponseCache::QuicHttpResponseCache() {}
+QuicHttpResponseCache::QuicHttpResponseCache()
+    : synthetic_body_type_(PATTERN_BODY) {}
 
 void QuicHttpResponseCache::InitializeFromDirectory(
     const string& cache_directory) {
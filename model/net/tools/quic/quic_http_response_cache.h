@@ -47,6 +47,12 @@ class QuicHttpResponseCache {
     IGNORE_REQUEST,    // Do nothing, expect the client to time out.
   };
 
+  // How the body of a synthetic "max_bytes" response is generated.
+  enum SyntheticBodyType {
+    PATTERN_BODY,  // A fixed repeating byte pattern.
+    RANDOM_BODY,   // Bytes from QuicRandom::GetInstance().
+  };
+
   // Container for response header/body pairs.
   class Response {
    public:
@@ -181,6 +187,11 @@ class QuicHttpResponseCache {
   // Find all the server push resources associated with |request_url|.
   std::list<ServerPushInfo> GetServerPushResources(std::string request_url);
 
+  SyntheticBodyType synthetic_body_type() const { return synthetic_body_type_; }
+  void set_synthetic_body_type(SyntheticBodyType type) {
+    synthetic_body_type_ = type;
+  }
+
  private:
   void AddResponseImpl(QuicStringPiece host,
                        QuicStringPiece path,
@@ -217,6 +228,8 @@ class QuicHttpResponseCache {
   // server threads accessing those responses.
   mutable QuicMutex response_mutex_;
 
+  SyntheticBodyType synthetic_body_type_;
+
   DISALLOW_COPY_AND_ASSIGN(QuicHttpResponseCache);
 };
 
@@ -0,0 +1,88 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_ns3_packet_writer.h"
+
+#include "base/logging.h"
+#include "net/base/ip_address.h"
+#include "net/base/ip_endpoint.h"
+#include "net/base/net_errors.h"
+
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/packet.h"
+
+#include "utils/quic-profiler.h"
+
+namespace net {
+
+QuicSocketAddress QuicSocketAddressFromNs3(const ns3::Address& address) {
+  if (ns3::InetSocketAddress::IsMatchingType(address)) {
+    ns3::InetSocketAddress inet = ns3::InetSocketAddress::ConvertFrom(address);
+    uint32_t ip = inet.GetIpv4().Get();
+    IPAddress host(ip >> 24, (ip >> 16) & 0xff, (ip >> 8) & 0xff, ip & 0xff);
+    return QuicSocketAddress(
+        QuicSocketAddressImpl(IPEndPoint(host, inet.GetPort())));
+  }
+  DCHECK(ns3::Inet6SocketAddress::IsMatchingType(address));
+  ns3::Inet6SocketAddress inet6 = ns3::Inet6SocketAddress::ConvertFrom(address);
+  uint8_t bytes[IPAddress::kIPv6AddressSize];
+  inet6.GetIpv6().GetBytes(bytes);
+  return QuicSocketAddress(QuicSocketAddressImpl(
+      IPEndPoint(IPAddress(bytes), inet6.GetPort())));
+}
+
+ns3::Address Ns3AddressFromQuic(const QuicSocketAddress& address) {
+  const IPEndPoint& endpoint = address.impl().socket_address();
+  const uint8_t* bytes = endpoint.address().bytes().data();
+  if (endpoint.address().IsIPv4()) {
+    uint32_t ip = (uint32_t(bytes[0]) << 24) | (uint32_t(bytes[1]) << 16) |
+                  (uint32_t(bytes[2]) << 8) | uint32_t(bytes[3]);
+    return ns3::InetSocketAddress(ns3::Ipv4Address(ip), endpoint.port());
+  }
+  return ns3::Inet6SocketAddress(
+      ns3::Ipv6Address(const_cast<uint8_t*>(bytes)), endpoint.port());
+}
+
+QuicNs3PacketWriter::QuicNs3PacketWriter(ns3::Ptr<ns3::Socket> socket)
+    : socket_(socket) {}
+
+QuicNs3PacketWriter::~QuicNs3PacketWriter() {}
+
+WriteResult QuicNs3PacketWriter::WritePacket(
+    const char* buffer,
+    size_t buf_len,
+    const QuicIpAddress& self_address,
+    const QuicSocketAddress& peer_address,
+    PerPacketOptions* options) {
+  QUIC_PROFILE_SCOPE(NS3_SOCKET);
+  // The Packet copies |buffer|, which the connection reuses for the next
+  // packet. ns-3 sockets never block, so every write completes right away.
+  ns3::Ptr<ns3::Packet> packet = ns3::Create<ns3::Packet>(
+      reinterpret_cast<const uint8_t*>(buffer), buf_len);
+  int rv = socket_->SendTo(packet, 0, Ns3AddressFromQuic(peer_address));
+  if (rv < 0) {
+    DVLOG(1) << "SendTo failed with ns-3 socket error "
+             << socket_->GetErrno();
+    return WriteResult(WRITE_STATUS_ERROR, ERR_FAILED);
+  }
+  return WriteResult(WRITE_STATUS_OK, rv);
+}
+
+bool QuicNs3PacketWriter::IsWriteBlockedDataBuffered() const {
+  return false;
+}
+
+bool QuicNs3PacketWriter::IsWriteBlocked() const {
+  return false;
+}
+
+void QuicNs3PacketWriter::SetWritable() {}
+
+QuicByteCount QuicNs3PacketWriter::GetMaxPacketSize(
+    const QuicSocketAddress& peer_address) const {
+  return kMaxJumboPacketSize;
+}
+
+}  // namespace net
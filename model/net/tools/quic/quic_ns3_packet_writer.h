@@ -0,0 +1,54 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// A packet writer that sends straight through an ns-3 socket, typically an
+// ns3::QuicSocketBase, with no descriptor, IOBuffer or sockaddr in between.
+
+#ifndef NET_TOOLS_QUIC_QUIC_NS3_PACKET_WRITER_H_
+#define NET_TOOLS_QUIC_QUIC_NS3_PACKET_WRITER_H_
+
+#include <stddef.h>
+
+#include "base/macros.h"
+#include "net/quic/core/quic_packet_writer.h"
+#include "net/quic/core/quic_packets.h"
+#include "net/quic/platform/api/quic_socket_address.h"
+
+#include "ns3/address.h"
+#include "ns3/ptr.h"
+#include "ns3/socket.h"
+
+namespace net {
+
+// Converts between ns-3 socket addresses (InetSocketAddress or
+// Inet6SocketAddress) and QUIC ones by copying the address bytes.
+QuicSocketAddress QuicSocketAddressFromNs3(const ns3::Address& address);
+ns3::Address Ns3AddressFromQuic(const QuicSocketAddress& address);
+
+class QuicNs3PacketWriter : public QuicPacketWriter {
+ public:
+  explicit QuicNs3PacketWriter(ns3::Ptr<ns3::Socket> socket);
+  ~QuicNs3PacketWriter() override;
+
+  // QuicPacketWriter implementation:
+  WriteResult WritePacket(const char* buffer,
+                          size_t buf_len,
+                          const QuicIpAddress& self_address,
+                          const QuicSocketAddress& peer_address,
+                          PerPacketOptions* options) override;
+  bool IsWriteBlockedDataBuffered() const override;
+  bool IsWriteBlocked() const override;
+  void SetWritable() override;
+  QuicByteCount GetMaxPacketSize(
+      const QuicSocketAddress& peer_address) const override;
+
+ private:
+  ns3::Ptr<ns3::Socket> socket_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicNs3PacketWriter);
+};
+
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_NS3_PACKET_WRITER_H_
@@ -28,6 +28,7 @@
 #include "net/socket/udp_client_socket.h"
 #include "net/spdy/chromium/spdy_http_utils.h"
 #include "net/spdy/core/spdy_header_block.h"
+#include "net/tools/quic/quic_client_ns3_network_helper.h"
 
 using std::string;
 
@@ -52,6 +53,70 @@ QuicSimpleClient::QuicSimpleClient(
   set_server_address(server_address);
 }
 
+QuicSimpleClient::QuicSimpleClient(
+    QuicSocketAddress server_address,
+    const QuicServerId& server_id,
+    const QuicVersionVector& supported_versions,
+    std::unique_ptr<ProofVerifier> proof_verifier,
+    QuicConnectionHelperInterface* helper,
+    QuicAlarmFactory* alarm_factory,
+    QuicChromiumClock* clock)
+    : QuicSpdyClientBase(
+          server_id,
+          supported_versions,
+          QuicConfig(),
+          helper,
+          alarm_factory,
+          QuicWrapUnique(new QuicClientMessageLooplNetworkHelper(clock, this)),
+          std::move(proof_verifier)),
+      initialized_(false),
+      weak_factory_(this) {
+  set_server_address(server_address);
+}
+
+QuicSimpleClient::QuicSimpleClient(
+    QuicSocketAddress server_address,
+    const QuicServerId& server_id,
+    const QuicVersionVector& supported_versions,
+    QuicCryptoClientConfig* crypto_config,
+    QuicConnectionHelperInterface* helper,
+    QuicAlarmFactory* alarm_factory,
+    QuicChromiumClock* clock)
+    : QuicSpdyClientBase(
+          server_id,
+          supported_versions,
+          QuicConfig(),
+          helper,
+          alarm_factory,
+          QuicWrapUnique(new QuicClientMessageLooplNetworkHelper(clock, this)),
+          crypto_config),
+      initialized_(false),
+      weak_factory_(this) {
+  set_server_address(server_address);
+}
+
+QuicSimpleClient::QuicSimpleClient(
+    QuicSocketAddress server_address,
+    const QuicServerId& server_id,
+    const QuicVersionVector& supported_versions,
+    QuicCryptoClientConfig* crypto_config,
+    QuicConnectionHelperInterface* helper,
+    QuicAlarmFactory* alarm_factory,
+    QuicChromiumClock* clock,
+    ns3::Ptr<ns3::Node> node)
+    : QuicSpdyClientBase(
+          server_id,
+          supported_versions,
+          QuicConfig(),
+          helper,
+          alarm_factory,
+          QuicWrapUnique(new QuicClientNs3NetworkHelper(clock, this, node)),
+          crypto_config),
+      initialized_(false),
+      weak_factory_(this) {
+  set_server_address(server_address);
+}
+
 QuicSimpleClient::~QuicSimpleClient() {
   if (connected()) {
     session()->connection()->CloseConnection(
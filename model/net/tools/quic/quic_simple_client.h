@@ -26,6 +26,9 @@
 #include "net/tools/quic/quic_client_message_loop_network_helper.h"
 #include "net/tools/quic/quic_spdy_client_base.h"
 
+#include "ns3/node.h"
+#include "ns3/ptr.h"
+
 namespace net {
 
 class QuicChromiumAlarmFactory;
@@ -43,6 +46,39 @@ class QuicSimpleClient : public QuicSpdyClientBase {
                    const QuicVersionVector& supported_versions,
                    std::unique_ptr<ProofVerifier> proof_verifier);
 
+  // Create a quic client whose alarms and buffers come from the caller,
+  // typically a per-node ns3::QuicContext. Takes ownership of |helper| and
+  // |alarm_factory|; |clock| must outlive the client.
+  QuicSimpleClient(QuicSocketAddress server_address,
+                   const QuicServerId& server_id,
+                   const QuicVersionVector& supported_versions,
+                   std::unique_ptr<ProofVerifier> proof_verifier,
+                   QuicConnectionHelperInterface* helper,
+                   QuicAlarmFactory* alarm_factory,
+                   QuicChromiumClock* clock);
+
+  // As above, but with a |crypto_config| shared with other clients, which
+  // must outlive this one. Used to pool many connections on one node.
+  QuicSimpleClient(QuicSocketAddress server_address,
+                   const QuicServerId& server_id,
+                   const QuicVersionVector& supported_versions,
+                   QuicCryptoClientConfig* crypto_config,
+                   QuicConnectionHelperInterface* helper,
+                   QuicAlarmFactory* alarm_factory,
+                   QuicChromiumClock* clock);
+
+  // As above, but the connection runs on a socket of the ns3::QuicL4Protocol
+  // of |node| instead of a socket_ns3 descriptor. Its network helper is a
+  // QuicClientNs3NetworkHelper.
+  QuicSimpleClient(QuicSocketAddress server_address,
+                   const QuicServerId& server_id,
+                   const QuicVersionVector& supported_versions,
+                   QuicCryptoClientConfig* crypto_config,
+                   QuicConnectionHelperInterface* helper,
+                   QuicAlarmFactory* alarm_factory,
+                   QuicChromiumClock* clock,
+                   ns3::Ptr<ns3::Node> node);
+
   ~QuicSimpleClient() override;
 
  private:
@@ -22,7 +22,8 @@ QuicSimpleDispatcher::QuicSimpleDispatcher(
                      std::move(helper),
                      std::move(session_helper),
                      std::move(alarm_factory)),
-      response_cache_(response_cache) {}
+      response_cache_(response_cache),
+      connection_observer_(nullptr) {}
 
 QuicSimpleDispatcher::~QuicSimpleDispatcher() {}
 
@@ -46,6 +47,19 @@ void QuicSimpleDispatcher::OnRstStreamReceived(
   }
 }
 
+void QuicSimpleDispatcher::OnConnectionClosed(QuicConnectionId connection_id,
+                                              QuicErrorCode error,
+                                              const std::string& error_details) {
+  if (connection_observer_ != nullptr) {
+    auto it = session_map().find(connection_id);
+    if (it != session_map().end()) {
+      connection_observer_->OnConnectionClosed(it->second->connection(),
+                                               error);
+    }
+  }
+  QuicDispatcher::OnConnectionClosed(connection_id, error, error_details);
+}
+
 QuicServerSessionBase* QuicSimpleDispatcher::CreateQuicSession(
     QuicConnectionId connection_id,
     const QuicSocketAddress& client_address,
@@ -13,6 +13,17 @@ namespace net {
 
 class QuicSimpleDispatcher : public QuicDispatcher {
  public:
+  // Observes the connections the dispatcher closes.
+  class ConnectionObserver {
+   public:
+    virtual ~ConnectionObserver() {}
+
+    // Called when |connection| closes, while its stats are still final
+    // and before its session is deleted.
+    virtual void OnConnectionClosed(QuicConnection* connection,
+                                    QuicErrorCode error) = 0;
+  };
+
   QuicSimpleDispatcher(
       const QuicConfig& config,
       const QuicCryptoServerConfig* crypto_config,
@@ -28,6 +39,17 @@ class QuicSimpleDispatcher : public QuicDispatcher {
 
   void OnRstStreamReceived(const QuicRstStreamFrame& frame) override;
 
+  // QuicSession::Visitor interface implementation.
+  void OnConnectionClosed(QuicConnectionId connection_id,
+                          QuicErrorCode error,
+                          const std::string& error_details) override;
+
+  // Does not take ownership; |observer| must outlive the dispatcher or be
+  // reset to null first.
+  void set_connection_observer(ConnectionObserver* observer) {
+    connection_observer_ = observer;
+  }
+
  protected:
   QuicServerSessionBase* CreateQuicSession(
       QuicConnectionId connection_id,
@@ -39,6 +61,8 @@ class QuicSimpleDispatcher : public QuicDispatcher {
  private:
   QuicHttpResponseCache* response_cache_;  // Unowned.
 
+  ConnectionObserver* connection_observer_;  // Unowned.
+
   // The map of the reset error code with its counter.
   std::map<QuicRstStreamErrorCode, int> rst_error_map_;
 };
@@ -18,6 +18,7 @@
 #include "net/quic/core/quic_data_reader.h"
 #include "net/quic/core/quic_packets.h"
 #include "net/socket/udp_server_socket.h"
+#include "net/tools/quic/quic_ns3_packet_writer.h"
 #include "net/tools/quic/quic_simple_dispatcher.h"
 #include "net/tools/quic/quic_simple_per_connection_packet_writer.h"
 #include "net/tools/quic/quic_simple_server_packet_writer.h"
@@ -36,7 +37,7 @@ namespace net {
 
     // Allocate some extra space so we can send an error if the client goes over
     // the limit.
-    const int kReadBufferSize = 2 * kMaxPacketSize;
+    const int kReadBufferSize = 2 * kMaxJumboPacketSize;
 
   }  // namespace
 
@@ -54,9 +55,55 @@ namespace net {
           &clock_)),
     config_(config),
     crypto_config_options_(crypto_config_options),
-    crypto_config_(kSourceAddressTokenSecret,
+    crypto_config_(new QuicCryptoServerConfig(kSourceAddressTokenSecret,
         QuicRandom::GetInstance(),
-        std::move(proof_source)),
+        std::move(proof_source))),
+    read_pending_(false),
+    synchronous_read_count_(0),
+    read_buffer_(new IOBufferWithSize(kReadBufferSize)),
+    response_cache_(response_cache),
+    weak_factory_(this) {
+      Initialize();
+      AddDefaultCryptoConfig();
+    }
+
+  QuicSimpleServer::QuicSimpleServer(
+      std::unique_ptr<ProofSource> proof_source,
+      const QuicConfig& config,
+      const QuicCryptoServerConfig::ConfigOptions& crypto_config_options,
+      const QuicVersionVector& supported_versions,
+      QuicHttpResponseCache* response_cache,
+      QuicConnectionHelperInterface* helper,
+      QuicAlarmFactory* alarm_factory)
+    : version_manager_(supported_versions),
+    helper_(helper),
+    alarm_factory_(alarm_factory),
+    config_(config),
+    crypto_config_options_(crypto_config_options),
+    crypto_config_(new QuicCryptoServerConfig(kSourceAddressTokenSecret,
+        QuicRandom::GetInstance(),
+        std::move(proof_source))),
+    read_pending_(false),
+    synchronous_read_count_(0),
+    read_buffer_(new IOBufferWithSize(kReadBufferSize)),
+    response_cache_(response_cache),
+    weak_factory_(this) {
+      Initialize();
+      AddDefaultCryptoConfig();
+    }
+
+  QuicSimpleServer::QuicSimpleServer(
+      std::shared_ptr<QuicCryptoServerConfig> crypto_config,
+      const QuicConfig& config,
+      const QuicVersionVector& supported_versions,
+      QuicHttpResponseCache* response_cache,
+      QuicConnectionHelperInterface* helper,
+      QuicAlarmFactory* alarm_factory)
+    : version_manager_(supported_versions),
+    helper_(helper),
+    alarm_factory_(alarm_factory),
+    config_(config),
+    crypto_config_(std::move(crypto_config)),
     read_pending_(false),
     synchronous_read_count_(0),
     read_buffer_(new IOBufferWithSize(kReadBufferSize)),
@@ -84,13 +131,19 @@ namespace net {
       config_.SetInitialSessionFlowControlWindowToSend(
           kInitialSessionFlowControlWindow);
     }
+  }
 
-    std::unique_ptr<CryptoHandshakeMessage> scfg(crypto_config_.AddDefaultConfig(
+  void QuicSimpleServer::AddDefaultCryptoConfig() {
+    std::unique_ptr<CryptoHandshakeMessage> scfg(crypto_config_->AddDefaultConfig(
           helper_->GetRandomGenerator(), helper_->GetClock(),
           crypto_config_options_));
   }
 
-  QuicSimpleServer::~QuicSimpleServer() {}
+  QuicSimpleServer::~QuicSimpleServer() {
+    ns3::Simulator::Cancel(yield_event_);
+    // The dispatcher's writer sends on |socket_|, so it has to go first.
+    dispatcher_.reset();
+  }
 
   int QuicSimpleServer::Listen(const IPEndPoint& address) {
     std::unique_ptr<UDPServerSocket> socket(
@@ -114,12 +167,16 @@ namespace net {
       return rc;
     }
 
-    rc = socket->SetSendBufferSize(20 * kMaxPacketSize);
+    rc = socket->SetSendBufferSize(20 * kMaxJumboPacketSize);
     if (rc < 0) {
       LOG(ERROR) << "SetSendBufferSize() failed: " << ErrorToString(rc);
       return rc;
     }
 
+    // MTU probes must be lost, not fragmented, when they exceed the path MTU.
+    // SetDoNotFragment is not implemented on all platforms, so ignore errors.
+    socket->SetDoNotFragment();
+
     rc = socket->GetLocalAddress(&server_address_);
     if (rc < 0) {
       LOG(ERROR) << "GetLocalAddress() failed: " << ErrorToString(rc);
@@ -130,12 +187,7 @@ namespace net {
 
     socket_.swap(socket);
 
-    dispatcher_.reset(new QuicSimpleDispatcher(
-          config_, &crypto_config_, &version_manager_,
-          std::unique_ptr<QuicConnectionHelperInterface>(helper_),
-          std::unique_ptr<QuicCryptoServerStream::Helper>(
-            new QuicSimpleServerSessionHelper(QuicRandom::GetInstance())),
-          std::unique_ptr<QuicAlarmFactory>(alarm_factory_), response_cache_));
+    CreateDispatcher();
     QuicSimpleServerPacketWriter* writer =
       new QuicSimpleServerPacketWriter(socket_.get(), dispatcher_.get());
     dispatcher_->InitializeWithWriter(writer);
@@ -145,16 +197,58 @@ namespace net {
     return OK;
   }
 
+  int QuicSimpleServer::Listen(ns3::Ptr<ns3::Socket> socket) {
+    ns3::Address address;
+    if (socket->GetSockName(address) < 0) {
+      LOG(ERROR) << "GetSockName() failed with ns-3 socket error "
+                 << socket->GetErrno();
+      return ERR_FAILED;
+    }
+    server_address_ = QuicSocketAddressFromNs3(address).impl().socket_address();
+
+    DVLOG(1) << "Listening on " << server_address_.ToString();
+
+    ns3_socket_ = socket;
+
+    CreateDispatcher();
+    dispatcher_->InitializeWithWriter(new QuicNs3PacketWriter(ns3_socket_));
+
+    return OK;
+  }
+
+  void QuicSimpleServer::CreateDispatcher() {
+    dispatcher_.reset(new QuicSimpleDispatcher(
+          config_, crypto_config_.get(), &version_manager_,
+          std::unique_ptr<QuicConnectionHelperInterface>(helper_),
+          std::unique_ptr<QuicCryptoServerStream::Helper>(
+            new QuicSimpleServerSessionHelper(QuicRandom::GetInstance())),
+          std::unique_ptr<QuicAlarmFactory>(alarm_factory_), response_cache_));
+  }
+
   void QuicSimpleServer::Shutdown() {
+    if (!dispatcher_)
+      return;
+    ns3::Simulator::Cancel(yield_event_);
     // Before we shut down the epoll server, give all active sessions a chance to
     // notify clients that they're closing.
     dispatcher_->Shutdown();
+    // Deleting the writer sends the close packets it still holds, which
+    // needs the socket.
+    dispatcher_.reset();
 
-    socket_->Close();
-    socket_.reset();
+    if (socket_) {
+      socket_->Close();
+      socket_.reset();
+    }
+    if (ns3_socket_) {
+      ns3_socket_->Close();
+      ns3_socket_ = nullptr;
+    }
   }
 
   void QuicSimpleServer::StartReading() {
+    if (!dispatcher_)
+      return;
     if (synchronous_read_count_ == 0) {
       // Only process buffered packets once per message loop.
       dispatcher_->ProcessBufferedChlos(kNumSessionsToCreatePerSocketEvent);
@@ -168,7 +262,7 @@ namespace net {
     synchronous_read_count_ = 0;
     if (dispatcher_->HasChlosBuffered()) {
       // No more packets to read, so yield before processing buffered packets.
-      ns3::Simulator::ScheduleNow(&QuicSimpleServer::StartReading, weak_factory_.GetWeakPtr().get());
+      YieldTo(&QuicSimpleServer::StartReading);
     }
   }
 
@@ -230,4 +324,32 @@ namespace net {
     StartReading();
   }
 
+  void QuicSimpleServer::ProcessPacket(ns3::Ptr<ns3::Packet> packet,
+                                       const ns3::Address& client_address) {
+    // QuicReceivedPacket needs the datagram in contiguous memory.
+    uint32_t length = packet->CopyData(
+        reinterpret_cast<uint8_t*>(read_buffer_->data()), read_buffer_->size());
+    QuicReceivedPacket received(read_buffer_->data(), length,
+                                helper_->GetClock()->Now(), false);
+    dispatcher_->ProcessPacket(
+        QuicSocketAddress(QuicSocketAddressImpl(server_address_)),
+        QuicSocketAddressFromNs3(client_address), received);
+
+    ProcessBufferedChlos();
+  }
+
+  void QuicSimpleServer::ProcessBufferedChlos() {
+    if (!dispatcher_)
+      return;
+    dispatcher_->ProcessBufferedChlos(kNumSessionsToCreatePerSocketEvent);
+    if (dispatcher_->HasChlosBuffered()) {
+      YieldTo(&QuicSimpleServer::ProcessBufferedChlos);
+    }
+  }
+
+  void QuicSimpleServer::YieldTo(void (QuicSimpleServer::*method)()) {
+    ns3::Simulator::Cancel(yield_event_);
+    yield_event_ = ns3::Simulator::ScheduleNow(method, this);
+  }
+
 }  // namespace net
@@ -22,6 +22,12 @@
 #include "net/quic/platform/impl/quic_chromium_clock.h"
 #include "net/tools/quic/quic_http_response_cache.h"
 
+#include "ns3/address.h"
+#include "ns3/event-id.h"
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+#include "ns3/socket.h"
+
 namespace ns3 {
 class QuicServer;
 } // namespace ns3
@@ -47,12 +53,45 @@ class QuicSimpleServer {
       const QuicVersionVector& supported_versions,
       QuicHttpResponseCache* response_cache);
 
+  // Uses |helper| and |alarm_factory|, typically created by a per-node
+  // ns3::QuicContext, instead of server-owned ones. Takes ownership of both.
+  QuicSimpleServer(
+      std::unique_ptr<ProofSource> proof_source,
+      const QuicConfig& config,
+      const QuicCryptoServerConfig::ConfigOptions& crypto_config_options,
+      const QuicVersionVector& supported_versions,
+      QuicHttpResponseCache* response_cache,
+      QuicConnectionHelperInterface* helper,
+      QuicAlarmFactory* alarm_factory);
+
+  // Like the above, but serves handshakes from |crypto_config|, which
+  // already holds a primary server config and may be shared with other
+  // servers.
+  QuicSimpleServer(
+      std::shared_ptr<QuicCryptoServerConfig> crypto_config,
+      const QuicConfig& config,
+      const QuicVersionVector& supported_versions,
+      QuicHttpResponseCache* response_cache,
+      QuicConnectionHelperInterface* helper,
+      QuicAlarmFactory* alarm_factory);
+
   virtual ~QuicSimpleServer();
 
   // Start listening on the specified address. Returns an error code.
   int Listen(const IPEndPoint& address);
 
-  // Server deletion is imminent. Start cleaning up.
+  // Start serving on |socket|, an ns-3 socket already bound to the server
+  // address, typically a socket of the ns3::QuicL4Protocol. The caller
+  // reads the socket and hands every datagram to ProcessPacket(). Returns an
+  // error code.
+  int Listen(ns3::Ptr<ns3::Socket> socket);
+
+  // Dispatches a datagram read from the socket given to Listen().
+  void ProcessPacket(ns3::Ptr<ns3::Packet> packet,
+                     const ns3::Address& client_address);
+
+  // Server deletion is imminent. Start cleaning up: closes every session and
+  // the socket. Does nothing once the server is shut down.
   void Shutdown();
 
   // Start reading on the socket. On asynchronous reads, this registers
@@ -64,6 +103,7 @@ class QuicSimpleServer {
   // continues the read loop.
   void OnReadComplete(int result);
 
+  // Null once the server is shut down.
   QuicDispatcher* dispatcher() { return dispatcher_.get(); }
 
   IPEndPoint server_address() const { return server_address_; }
@@ -82,6 +122,21 @@ class QuicSimpleServer {
   // Initialize the internal state of the server.
   void Initialize();
 
+  // Adds a freshly generated primary config to a server-owned
+  // |crypto_config_|.
+  void AddDefaultCryptoConfig();
+
+  // Creates |dispatcher_|, which still has to be given a writer.
+  void CreateDispatcher();
+
+  // Creates sessions for the CHLOs buffered by the dispatcher, yielding to
+  // the simulator between batches.
+  void ProcessBufferedChlos();
+
+  // Schedules |method| to run once the simulator has handled the events
+  // already due, replacing any pending yield.
+  void YieldTo(void (QuicSimpleServer::*method)());
+
   QuicVersionManager version_manager_;
 
   // Accepts data from the framer and demuxes clients to sessions.
@@ -91,22 +146,26 @@ class QuicSimpleServer {
   QuicChromiumClock clock_;
 
   // Used to manage the message loop. Owned by dispatcher_.
-  QuicChromiumConnectionHelper* helper_;
+  QuicConnectionHelperInterface* helper_;
 
   // Used to manage the message loop. Owned by dispatcher_.
-  QuicChromiumAlarmFactory* alarm_factory_;
+  QuicAlarmFactory* alarm_factory_;
 
   // Listening socket. Also used for outbound client communication.
   std::unique_ptr<UDPServerSocket> socket_;
 
+  // Socket given to Listen() instead of |socket_|, if any.
+  ns3::Ptr<ns3::Socket> ns3_socket_;
+
   // config_ contains non-crypto parameters that are negotiated in the crypto
   // handshake.
   QuicConfig config_;
   // crypto_config_ contains crypto parameters that are negotiated in the crypto
   // handshake.
   QuicCryptoServerConfig::ConfigOptions crypto_config_options_;
-  // crypto_config_ contains crypto parameters for the handshake.
-  QuicCryptoServerConfig crypto_config_;
+  // crypto_config_ contains crypto parameters for the handshake. It is
+  // shared between servers built from the same cached config.
+  std::shared_ptr<QuicCryptoServerConfig> crypto_config_;
 
   // The address that the server listens on.
   IPEndPoint server_address_;
@@ -124,6 +183,11 @@ class QuicSimpleServer {
 
   QuicHttpResponseCache* response_cache_;
 
+  // The StartReading() or ProcessBufferedChlos() scheduled by YieldTo().
+  // Cancelled on shutdown, since the event holds a raw pointer to the
+  // server.
+  ns3::EventId yield_event_;
+
   base::WeakPtrFactory<QuicSimpleServer> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(QuicSimpleServer);
@@ -4,6 +4,8 @@
 
 #include "net/tools/quic/quic_simple_server_packet_writer.h"
 
+#include <algorithm>
+
 #include "base/callback_helpers.h"
 #include "base/location.h"
 #include "base/logging.h"
@@ -18,11 +20,30 @@ QuicSimpleServerPacketWriter::QuicSimpleServerPacketWriter(
     UDPServerSocket* socket,
     QuicBlockedWriterInterface* blocked_writer)
     : socket_(socket),
+      batch_(new QuicChromiumPacketBatch(
+          socket->socket_.socket_,
+          base::Bind(&QuicSimpleServerPacketWriter::OnFlushError,
+                     base::Unretained(this)))),
+      max_batched_packet_size_(kDefaultMaxPacketSize),
+      write_error_(OK),
       blocked_writer_(blocked_writer),
       write_blocked_(false),
       weak_factory_(this) {}
 
-QuicSimpleServerPacketWriter::~QuicSimpleServerPacketWriter() {}
+QuicSimpleServerPacketWriter::~QuicSimpleServerPacketWriter() {
+  batch_->Flush();
+}
+
+void QuicSimpleServerPacketWriter::Flush() {
+  int rv = batch_->Flush();
+  if (rv != OK)
+    OnFlushError(rv);
+}
+
+void QuicSimpleServerPacketWriter::OnFlushError(int error_code) {
+  UMA_HISTOGRAM_SPARSE_SLOWLY("Net.QuicSession.WriteError", -error_code);
+  write_error_ = error_code;
+}
 
 WriteResult QuicSimpleServerPacketWriter::WritePacketWithCallback(
     const char* buffer,
@@ -70,6 +91,26 @@ WriteResult QuicSimpleServerPacketWriter::WritePacket(
     const QuicIpAddress& self_address,
     const QuicSocketAddress& peer_address,
     PerPacketOptions* options) {
+  if (write_error_ != OK)
+    return WriteResult(WRITE_STATUS_ERROR, write_error_);
+  // The batch takes the packet and sends it, together with everything else
+  // written in this simulated instant, from a ScheduleNow() event. The ns-3
+  // socket never blocks, so the write is reported as complete right away.
+  if (buf_len <= max_batched_packet_size_) {
+    DCHECK(!IsWriteBlocked());
+    const IPEndPoint& address = peer_address.impl().socket_address();
+    int rv = batch_->Add(buffer, buf_len, &address);
+    if (rv != OK)
+      return WriteResult(WRITE_STATUS_ERROR, rv);
+    return WriteResult(WRITE_STATUS_OK, static_cast<int>(buf_len));
+  }
+  // Keeps the packets in order.
+  int flush_rv = batch_->Flush();
+  if (flush_rv != OK) {
+    write_error_ = flush_rv;
+    return WriteResult(WRITE_STATUS_ERROR, flush_rv);
+  }
+
   scoped_refptr<StringIOBuffer> buf(
       new StringIOBuffer(std::string(buffer, buf_len)));
   DCHECK(!IsWriteBlocked());
@@ -93,12 +134,14 @@ WriteResult QuicSimpleServerPacketWriter::WritePacket(
       write_blocked_ = true;
     }
   }
+  if (status == WRITE_STATUS_OK)
+    max_batched_packet_size_ = std::max(max_batched_packet_size_, buf_len);
   return WriteResult(status, rv);
 }
 
 QuicByteCount QuicSimpleServerPacketWriter::GetMaxPacketSize(
     const QuicSocketAddress& peer_address) const {
-  return kMaxPacketSize;
+  return kMaxJumboPacketSize;
 }
 
 }  // namespace net
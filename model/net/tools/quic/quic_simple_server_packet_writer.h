@@ -7,9 +7,12 @@
 
 #include <stddef.h>
 
+#include <memory>
+
 #include "base/callback.h"
 #include "base/macros.h"
 #include "base/memory/weak_ptr.h"
+#include "net/quic/chromium/quic_chromium_packet_batch.h"
 #include "net/quic/core/quic_connection.h"
 #include "net/quic/core/quic_packet_writer.h"
 #include "net/quic/core/quic_packets.h"
@@ -54,9 +57,30 @@ class QuicSimpleServerPacketWriter : public QuicPacketWriter {
   QuicByteCount GetMaxPacketSize(
       const QuicSocketAddress& peer_address) const override;
 
+  // Sends every packet written so far in the current simulated instant. A
+  // failure is reported like the failure of a scheduled flush.
+  void Flush();
+
+  const QuicChromiumPacketBatch* batch() const { return batch_.get(); }
+
  private:
+  // Called when the batch fails to send packets already reported as
+  // written. Puts the writer in error.
+  void OnFlushError(int error_code);
+
   UDPServerSocket* socket_;
 
+  // Packets written in the current simulated instant, sent together by one
+  // sendpackets_ns3() call.
+  std::unique_ptr<QuicChromiumPacketBatch> batch_;
+  // Largest packet the socket has taken so far, for any peer. Larger
+  // packets, such as MTU probes, are written synchronously so that their
+  // connection sees a packet that is too big fail on its own write.
+  size_t max_batched_packet_size_;
+  // Error of a failed flush; every later write fails with it, as the
+  // socket is shared by every connection.
+  int write_error_;
+
   // To be notified after every successful asynchronous write.
   QuicBlockedWriterInterface* blocked_writer_;
 
@@ -4,9 +4,11 @@
 
 #include "net/tools/quic/quic_simple_server_stream.h"
 
+#include <algorithm>
 #include <list>
 #include <utility>
 
+#include "net/quic/core/crypto/quic_random.h"
 #include "net/quic/core/quic_spdy_stream.h"
 #include "net/quic/core/spdy_utils.h"
 #include "net/quic/platform/api/quic_bug_tracker.h"
@@ -18,19 +20,43 @@
 #include "net/tools/quic/quic_http_response_cache.h"
 #include "net/tools/quic/quic_simple_server_session.h"
 
-#include <iostream>
-using std::cerr;
-using std::endl;
-
 using std::string;
 
 namespace net {
 
+  namespace {
+
+    // Size of the pieces a synthetic body is handed to the stream in.
+    const size_t kSyntheticBodyChunkSize = 16 * 1024;
+
+    // The pattern body repeats the low byte of seed * 47^i, whose period
+    // divides 64 since the unit group mod 256 has exponent 64.
+    const size_t kSyntheticPatternPeriod = 64;
+
+    // One chunk of pattern plus a period, so that a chunk can start at any
+    // phase of the pattern.
+    const char* SyntheticPattern() {
+      static char* pattern = [] {
+        char* bytes = new char[kSyntheticBodyChunkSize + kSyntheticPatternPeriod];
+        unsigned seed = 48151623;
+        for (size_t i = 0;
+            i < kSyntheticBodyChunkSize + kSyntheticPatternPeriod; i++) {
+          bytes[i] = static_cast<char>(seed % 256);
+          seed = (seed * 47u); // overflow is % 2^32
+        }
+        return bytes;
+      }();
+      return pattern;
+    }
+
+  }  // namespace
+
   QuicSimpleServerStream::QuicSimpleServerStream(
       QuicStreamId id,
       QuicSpdySession* session, QuicHttpResponseCache* response_cache) :
     QuicSpdyServerStreamBase(id, session), content_length_(-1), response_cache_(
-        response_cache) {
+        response_cache), synthetic_body_remaining_(0),
+    synthetic_body_offset_(0) {
     }
 
   QuicSimpleServerStream::~QuicSimpleServerStream() {
@@ -121,22 +147,18 @@ namespace net {
       SendErrorResponse();
       return;
     }
-    { // WE DID THIS
-      uint32_t n;
-      assert(QuicTextUtils::StringToUint32(request_headers_.find("max_bytes")->second, &n));
-      unsigned seed = 48151623;
-      SpdyHeaderBlock headers;
-      string s;
-      for(int i = 0; i < n; i++) {
-        s.push_back(seed % 256);
-        seed = (seed * 47u); // overflow is % 2^32
+    auto max_bytes = request_headers_.find("max_bytes");
+    if (max_bytes != request_headers_.end()) { // WE DID THIS
+      uint64_t n;
+      if (!QuicTextUtils::StringToUint64(max_bytes->second, &n)) {
+        QUIC_DVLOG(1) << "Invalid max_bytes: " << max_bytes->second;
+        SendErrorResponse();
+        return;
       }
-      headers["content-length"] = QuicTextUtils::Uint64ToString(n);
-      headers[":status"] = "200";
 
-      cerr << "Sending packet of size " << n << endl;
+      QUIC_DVLOG(1) << "Sending synthetic response of " << n << " bytes";
 
-      SendHeadersAndBody(std::move(headers), s);
+      SendSyntheticResponse(n);
       return;
     }
 
@@ -227,6 +249,46 @@ namespace net {
         response->trailers().Clone());
   }
 
+  void QuicSimpleServerStream::SendSyntheticResponse(uint64_t length) {
+    SpdyHeaderBlock headers;
+    headers["content-length"] = QuicTextUtils::Uint64ToString(length);
+    headers[":status"] = "200";
+    WriteHeaders(std::move(headers), length == 0, nullptr);
+    synthetic_body_remaining_ = length;
+    synthetic_body_offset_ = 0;
+    WriteSyntheticBody();
+  }
+
+  void QuicSimpleServerStream::OnCanWrite() {
+    QuicSpdyServerStreamBase::OnCanWrite();
+    WriteSyntheticBody();
+  }
+
+  void QuicSimpleServerStream::WriteSyntheticBody() {
+    // Only hand over a new chunk once the previous one has been consumed,
+    // so at most one chunk is ever buffered in the stream. When a write is
+    // not fully consumed the stream is marked write blocked, and
+    // OnCanWrite() brings us back here once it has drained.
+    while (synthetic_body_remaining_ > 0 && !write_side_closed() &&
+        queued_data_bytes() == 0) {
+      size_t length = static_cast<size_t>(std::min<uint64_t>(
+            synthetic_body_remaining_, kSyntheticBodyChunkSize));
+      QuicStringPiece chunk;
+      if (response_cache_->synthetic_body_type() ==
+          QuicHttpResponseCache::RANDOM_BODY) {
+        synthetic_chunk_.resize(length);
+        QuicRandom::GetInstance()->RandBytes(&synthetic_chunk_[0], length);
+        chunk = synthetic_chunk_;
+      } else {
+        chunk = QuicStringPiece(SyntheticPattern() +
+            synthetic_body_offset_ % kSyntheticPatternPeriod, length);
+      }
+      synthetic_body_remaining_ -= length;
+      synthetic_body_offset_ += length;
+      WriteOrBufferData(chunk, synthetic_body_remaining_ == 0, nullptr);
+    }
+  }
+
   void QuicSimpleServerStream::SendNotFoundResponse() {
     QUIC_DVLOG(1) << "Stream " << id() << " sending not found response.";
     SpdyHeaderBlock headers;
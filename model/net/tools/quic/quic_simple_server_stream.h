@@ -42,6 +42,9 @@ class QuicSimpleServerStream : public QuicSpdyServerStreamBase {
   // data (or a FIN) to be read.
   void OnDataAvailable() override;
 
+  // QuicStream
+  void OnCanWrite() override;
+
   // Make this stream start from as if it just finished parsing an incoming
   // request whose headers are equivalent to |push_request_headers|.
   // Doing so will trigger this toy stream to fetch response and send it back.
@@ -70,6 +73,11 @@ class QuicSimpleServerStream : public QuicSpdyServerStreamBase {
                                      QuicStringPiece body,
                                      SpdyHeaderBlock response_trailers);
 
+  // Sends a 200 response with a |length| byte synthetic body. The body is
+  // generated in chunks as the stream drains, so memory use does not
+  // depend on |length|.
+  void SendSyntheticResponse(uint64_t length);
+
   SpdyHeaderBlock* request_headers() { return &request_headers_; }
 
   const std::string& body() { return body_; }
@@ -84,6 +92,17 @@ class QuicSimpleServerStream : public QuicSpdyServerStreamBase {
 
   QuicHttpResponseCache* response_cache_;  // Not owned.
 
+  // Writes synthetic body chunks until the stream stops consuming them
+  // or the body is complete.
+  void WriteSyntheticBody();
+
+  // Bytes of the synthetic body not yet handed to the stream.
+  uint64_t synthetic_body_remaining_;
+  // Offset of the next synthetic body byte.
+  uint64_t synthetic_body_offset_;
+  // Scratch space for RANDOM_BODY chunks.
+  std::string synthetic_chunk_;
+
   DISALLOW_COPY_AND_ASSIGN(QuicSimpleServerStream);
 };
 
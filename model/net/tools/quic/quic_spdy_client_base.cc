@@ -22,7 +22,16 @@ using std::endl;
 namespace net {
 
   void QuicSpdyClientBase::ClientQuicDataToResend::Resend() {
-    client_->SendRequest(*headers_, body_, fin_);
+    if (stream_id_ == 0) {
+      client_->SendRequest(*headers_, body_, fin_);
+    } else {
+      // The new session numbers its streams afresh, so the listener learns
+      // where the request went.
+      QuicSpdyClientStream* stream =
+        client_->SendRequestOnNewStream(*headers_, body_, fin_);
+      if (stream != nullptr)
+        client_->resent_streams_.push_back(std::make_pair(stream_id_, stream));
+    }
     headers_ = nullptr;
   }
 
@@ -52,6 +61,24 @@ namespace net {
     store_response_(false),
     latest_response_code_(-1) {}
 
+  QuicSpdyClientBase::QuicSpdyClientBase(
+      const QuicServerId& server_id,
+      const QuicVersionVector& supported_versions,
+      const QuicConfig& config,
+      QuicConnectionHelperInterface* helper,
+      QuicAlarmFactory* alarm_factory,
+      std::unique_ptr<NetworkHelper> network_helper,
+      QuicCryptoClientConfig* crypto_config)
+    : QuicClientBase(server_id,
+        supported_versions,
+        config,
+        helper,
+        alarm_factory,
+        std::move(network_helper),
+        crypto_config),
+    store_response_(false),
+    latest_response_code_(-1) {}
+
   QuicSpdyClientBase::~QuicSpdyClientBase() {
     // We own the push promise index. We need to explicitly kill
     // the session before the push promise index goes out of scope.
@@ -74,6 +101,7 @@ namespace net {
 
     const SpdyHeaderBlock& response_headers = client_stream->response_headers();
     if (response_listener_ != nullptr) {
+      response_listener_->OnStreamClosed(client_stream);
       response_listener_->OnCompleteResponse(stream->id(), response_headers,
           client_stream->data());
     }
@@ -133,7 +161,20 @@ namespace net {
     }
     stream->SendRequest(headers.Clone(), body, fin);
     // Record this in case we need to resend.
-    MaybeAddDataToResend(headers, body, fin);
+    MaybeAddDataToResend(stream->id(), headers, body, fin);
+  }
+
+  QuicSpdyClientStream* QuicSpdyClientBase::SendRequestOnNewStream(
+      const SpdyHeaderBlock& headers,
+      QuicStringPiece body,
+      bool fin) {
+    QuicSpdyClientStream* stream = CreateClientStream();
+    if (stream == nullptr) {
+      return nullptr;
+    }
+    stream->SendRequest(headers.Clone(), body, fin);
+    MaybeAddDataToResend(stream->id(), headers, body, fin);
+    return stream;
   }
 
   bool QuicSpdyClientBase::SendRequestAndWaitForResponse(
@@ -181,7 +222,8 @@ namespace net {
     return client_session()->GetNumReceivedServerConfigUpdates();
   }
 
-  void QuicSpdyClientBase::MaybeAddDataToResend(const SpdyHeaderBlock& headers,
+  void QuicSpdyClientBase::MaybeAddDataToResend(QuicStreamId stream_id,
+      const SpdyHeaderBlock& headers,
       QuicStringPiece body,
       bool fin) {
     if (!FLAGS_quic_reloadable_flag_enable_quic_stateless_reject_support) {
@@ -200,7 +242,8 @@ namespace net {
     std::unique_ptr<SpdyHeaderBlock> new_headers(
         new SpdyHeaderBlock(headers.Clone()));
     std::unique_ptr<QuicDataToResend> data_to_resend(
-        new ClientQuicDataToResend(std::move(new_headers), body, fin, this));
+        new ClientQuicDataToResend(std::move(new_headers), body, fin,
+          stream_id, this));
     MaybeAddQuicDataToResend(std::move(data_to_resend));
   }
 
@@ -221,6 +264,10 @@ namespace net {
     for (const auto& data : old_data) {
       data->Resend();
     }
+    if (response_listener_ != nullptr && !resent_streams_.empty()) {
+      response_listener_->OnRequestsResent(resent_streams_);
+    }
+    resent_streams_.clear();
   }
 
   void QuicSpdyClientBase::AddPromiseDataToResend(const SpdyHeaderBlock& headers,
@@ -229,7 +276,7 @@ namespace net {
     std::unique_ptr<SpdyHeaderBlock> new_headers(
         new SpdyHeaderBlock(headers.Clone()));
     push_promise_data_to_resend_.reset(
-        new ClientQuicDataToResend(std::move(new_headers), body, fin, this));
+        new ClientQuicDataToResend(std::move(new_headers), body, fin, 0, this));
   }
 
   bool QuicSpdyClientBase::CheckVary(const SpdyHeaderBlock& client_request,
@@ -9,6 +9,8 @@
 #define NET_TOOLS_QUIC_QUIC_SPDY_CLIENT_BASE_H_
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "base/macros.h"
 #include "net/quic/core/crypto/crypto_handshake.h"
@@ -37,6 +39,15 @@ class QuicSpdyClientBase : public QuicClientBase,
     virtual void OnCompleteResponse(QuicStreamId id,
                                     const SpdyHeaderBlock& response_headers,
                                     const std::string& response_body) = 0;
+    // Called just before OnCompleteResponse with the closing stream, for
+    // listeners that need more than the stored body.
+    virtual void OnStreamClosed(QuicSpdyClientStream* stream) {}
+    // Called after a stateless reject once the saved requests have been sent
+    // again on the new session, with the stream id each was first sent on
+    // and its new stream.
+    virtual void OnRequestsResent(
+        const std::vector<std::pair<QuicStreamId, QuicSpdyClientStream*>>&
+            streams) {}
   };
 
   // The client uses these objects to keep track of any data to resend upon
@@ -76,6 +87,16 @@ class QuicSpdyClientBase : public QuicClientBase,
                      std::unique_ptr<NetworkHelper> network_helper,
                      std::unique_ptr<ProofVerifier> proof_verifier);
 
+  // As above, but with a |crypto_config| shared with other clients; see
+  // QuicClientBase.
+  QuicSpdyClientBase(const QuicServerId& server_id,
+                     const QuicVersionVector& supported_versions,
+                     const QuicConfig& config,
+                     QuicConnectionHelperInterface* helper,
+                     QuicAlarmFactory* alarm_factory,
+                     std::unique_ptr<NetworkHelper> network_helper,
+                     QuicCryptoClientConfig* crypto_config);
+
   ~QuicSpdyClientBase() override;
 
   // QuicSpdyStream::Visitor
@@ -90,6 +111,12 @@ class QuicSpdyClientBase : public QuicClientBase,
                    QuicStringPiece body,
                    bool fin);
 
+  // Like SendRequest(), but skips server push lookup and returns the stream
+  // the request went out on, or null if no stream could be opened.
+  QuicSpdyClientStream* SendRequestOnNewStream(const SpdyHeaderBlock& headers,
+                                               QuicStringPiece body,
+                                               bool fin);
+
   // Sends an HTTP request and waits for response before returning.
   bool SendRequestAndWaitForResponse(const SpdyHeaderBlock& headers,
                                      QuicStringPiece body,
@@ -142,10 +169,11 @@ class QuicSpdyClientBase : public QuicClientBase,
   std::unique_ptr<QuicSession> CreateQuicClientSession(
       QuicConnection* connection) override;
 
-  // If the crypto handshake has not yet been confirmed, adds the data to the
-  // queue of data to resend if the client receives a stateless reject.
-  // Otherwise, deletes the data.
-  void MaybeAddDataToResend(const SpdyHeaderBlock& headers,
+  // If the crypto handshake has not yet been confirmed, adds the data, sent
+  // on |stream_id|, to the queue of data to resend if the client receives a
+  // stateless reject. Otherwise, deletes the data.
+  void MaybeAddDataToResend(QuicStreamId stream_id,
+                            const SpdyHeaderBlock& headers,
                             QuicStringPiece body,
                             bool fin);
 
@@ -161,11 +189,16 @@ class QuicSpdyClientBase : public QuicClientBase,
   // Specific QuicClient class for storing data to resend.
   class ClientQuicDataToResend : public QuicDataToResend {
    public:
+    // |stream_id| is the stream the data was sent on, or 0 if it was not
+    // sent yet.
     ClientQuicDataToResend(std::unique_ptr<SpdyHeaderBlock> headers,
                            QuicStringPiece body,
                            bool fin,
+                           QuicStreamId stream_id,
                            QuicSpdyClientBase* client)
-        : QuicDataToResend(std::move(headers), body, fin), client_(client) {
+        : QuicDataToResend(std::move(headers), body, fin),
+          stream_id_(stream_id),
+          client_(client) {
       DCHECK(headers_);
       DCHECK(client);
     }
@@ -175,6 +208,7 @@ class QuicSpdyClientBase : public QuicClientBase,
     void Resend() override;
 
    private:
+    QuicStreamId stream_id_;
     QuicSpdyClientBase* client_;
 
     DISALLOW_COPY_AND_ASSIGN(ClientQuicDataToResend);
@@ -205,6 +239,10 @@ class QuicSpdyClientBase : public QuicClientBase,
   // connection, in case the client receives a stateless reject.
   std::vector<std::unique_ptr<QuicDataToResend>> data_to_resend_on_connect_;
 
+  // Requests ResendSavedData() sent again, by the stream id they were first
+  // sent on, for the response listener.
+  std::vector<std::pair<QuicStreamId, QuicSpdyClientStream*>> resent_streams_;
+
   std::unique_ptr<ClientQuicDataToResend> push_promise_data_to_resend_;
 
   DISALLOW_COPY_AND_ASSIGN(QuicSpdyClientBase);
@@ -22,6 +22,8 @@ QuicSpdyClientStream::QuicSpdyClientStream(QuicStreamId id,
     : QuicSpdyStream(id, session),
       content_length_(-1),
       response_code_(0),
+      body_bytes_received_(0),
+      store_body_(true),
       header_bytes_read_(0),
       header_bytes_written_(0),
       session_(session),
@@ -109,12 +111,15 @@ void QuicSpdyClientStream::OnDataAvailable() {
     }
     QUIC_DVLOG(1) << "Client processed " << iov.iov_len << " bytes for stream "
                   << id();
-    data_.append(static_cast<char*>(iov.iov_base), iov.iov_len);
+    if (store_body_) {
+      data_.append(static_cast<char*>(iov.iov_base), iov.iov_len);
+    }
+    body_bytes_received_ += iov.iov_len;
 
     if (content_length_ >= 0 &&
-        data_.size() > static_cast<uint64_t>(content_length_)) {
+        body_bytes_received_ > static_cast<uint64_t>(content_length_)) {
       QUIC_DLOG(ERROR) << "Invalid content length (" << content_length_
-                       << ") with data of size " << data_.size();
+                       << ") with data of size " << body_bytes_received_;
       Reset(QUIC_BAD_APPLICATION_PAYLOAD);
       return;
     }
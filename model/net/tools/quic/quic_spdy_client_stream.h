@@ -51,6 +51,13 @@ class QuicSpdyClientStream : public QuicSpdyStream {
   // Returns the response data.
   const std::string& data() { return data_; }
 
+  // Number of body bytes received, whether or not they were stored.
+  uint64_t body_bytes_received() const { return body_bytes_received_; }
+
+  // When false, the body is counted but not kept in data(), so that large
+  // responses do not accumulate in memory. Defaults to true.
+  void set_store_body(bool store_body) { store_body_ = store_body; }
+
   // Returns whatever headers have been received for this stream.
   const SpdyHeaderBlock& response_headers() { return response_headers_; }
 
@@ -74,6 +81,8 @@ class QuicSpdyClientStream : public QuicSpdyStream {
   int64_t content_length_;
   int response_code_;
   std::string data_;
+  uint64_t body_bytes_received_;
+  bool store_body_;
   size_t header_bytes_read_;
   size_t header_bytes_written_;
 
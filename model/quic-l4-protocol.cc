@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/object-factory.h"
+#include "ns3/udp-l4-protocol.h"
+
+#include "quic-l4-protocol.h"
+#include "quic-socket-base.h"
+#include "quic-socket-factory.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QuicL4Protocol");
+
+NS_OBJECT_ENSURE_REGISTERED (QuicL4Protocol);
+
+const uint8_t QuicL4Protocol::PROT_NUMBER = UdpL4Protocol::PROT_NUMBER;
+
+TypeId
+QuicL4Protocol::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuicL4Protocol")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<QuicL4Protocol> ()
+    .AddAttribute ("SocketType",
+                   "Socket type of QUIC objects.",
+                   TypeIdValue (QuicSocketBase::GetTypeId ()),
+                   MakeTypeIdAccessor (&QuicL4Protocol::m_socketTypeId),
+                   MakeTypeIdChecker ())
+  ;
+  return tid;
+}
+
+QuicL4Protocol::QuicL4Protocol ()
+  : m_node (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+QuicL4Protocol::~QuicL4Protocol ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+QuicL4Protocol::SetNode (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  m_node = node;
+}
+
+void
+QuicL4Protocol::NotifyNewAggregate ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_node == 0)
+    {
+      Ptr<Node> node = this->GetObject<Node> ();
+      if (node != 0)
+        {
+          this->SetNode (node);
+          Ptr<QuicSocketFactory> quicFactory = CreateObject<QuicSocketFactory> ();
+          quicFactory->SetQuicL4 (this);
+          node->AggregateObject (quicFactory);
+        }
+    }
+  Object::NotifyNewAggregate ();
+}
+
+int
+QuicL4Protocol::GetProtocolNumber (void) const
+{
+  return PROT_NUMBER;
+}
+
+void
+QuicL4Protocol::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Closing a socket removes it from m_sockets, so work on a copy.
+  std::vector<Ptr<QuicSocketBase> > sockets;
+  sockets.swap (m_sockets);
+  for (Ptr<QuicSocketBase> socket : sockets)
+    {
+      socket->Dispose ();
+    }
+  m_node = 0;
+  Object::DoDispose ();
+}
+
+Ptr<Socket>
+QuicL4Protocol::CreateSocket (void)
+{
+  return CreateSocket (m_socketTypeId);
+}
+
+Ptr<Socket>
+QuicL4Protocol::CreateSocket (TypeId socketTypeId)
+{
+  NS_LOG_FUNCTION (this << socketTypeId);
+  NS_ASSERT_MSG (m_node != 0, "QuicL4Protocol is not aggregated to a node");
+  ObjectFactory socketFactory;
+  socketFactory.SetTypeId (socketTypeId);
+  Ptr<QuicSocketBase> socket = socketFactory.Create<QuicSocketBase> ();
+  socket->SetNode (m_node);
+  socket->SetQuicL4 (this);
+  AddSocket (socket);
+  return socket;
+}
+
+void
+QuicL4Protocol::AddSocket (Ptr<QuicSocketBase> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  if (std::find (m_sockets.begin (), m_sockets.end (), socket) == m_sockets.end ())
+    {
+      m_sockets.push_back (socket);
+    }
+}
+
+bool
+QuicL4Protocol::RemoveSocket (Ptr<QuicSocketBase> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  auto it = std::find (m_sockets.begin (), m_sockets.end (), socket);
+  if (it == m_sockets.end ())
+    {
+      return false;
+    }
+  m_sockets.erase (it);
+  return true;
+}
+
+uint32_t
+QuicL4Protocol::GetNSockets (void) const
+{
+  return m_sockets.size ();
+}
+
+} // namespace ns3
@@ -22,25 +22,17 @@
 #define QUIC_L4_PROTOCOL_H
 
 #include <stdint.h>
+#include <vector>
 
-#include "ns3/ipv4-address.h"
-#include "ns3/ipv6-address.h"
-#include "ns3/sequence-number.h"
-#include "ns3/udp-l4-protocol.h"
+#include "ns3/object.h"
+#include "ns3/ptr.h"
 
 
 namespace ns3 {
 
 class Node;
 class Socket;
-class QuicHeader;
-class Ipv4EndPointDemux;
-class Ipv6EndPointDemux;
-class Ipv4Interface;
 class QuicSocketBase;
-class Ipv4EndPoint;
-class Ipv6EndPoint;
-class NetDevice;
 
 
 /**
@@ -51,34 +43,35 @@ class NetDevice;
 
 /**
  * \ingroup quic
- * \brief QUIC socket creation and multiplexing/demultiplexing
+ * \brief QUIC socket creation and bookkeeping
  *
- * A single instance of this class is held by one instance of class Node.
+ * A single instance of this class is held by one instance of class Node,
+ * aggregated by QuicHelper on top of an installed Internet stack.
  *
- * The creation of QuicSocket are handled in the method CreateSocket, which is
- * called by QuicSocketFactory. Upon creation, this class is responsible to
- * the socket initialization and handle multiplexing/demultiplexing of data
- * between node's QUIC sockets. Demultiplexing is done by receiving
- * packets from IP, and forwards them up to the right socket. Multiplexing
- * is done through the SendPacket function, which sends the packet down the stack.
+ * QUIC runs over UDP, so this class does not register with the IP layer:
+ * every QuicSocket it creates carries its datagrams on a socket of the
+ * node's UdpL4Protocol, which demultiplexes them by port. Demultiplexing
+ * by connection ID is left to the QUIC endpoints, e.g. the dispatcher of
+ * QuicServer. The sockets hand ns3::Packet objects to their users as they
+ * are, so QuicClient and QuicServer feed them to the QUIC connections
+ * without going through the socket_ns3 descriptor layer.
  *
- * Moreover, this class allocates "endpoint" objects (ns3::Ipv4EndPoint) for QUIC,
- * and SHOULD checksum packets its receives from the socket layer going down
- * the stack, but currently checksumming is disabled.
+ * Upon aggregation, a QuicSocketFactory is aggregated to the node too, so
+ * sockets can be created with Socket::CreateSocket and the
+ * ns3::QuicSocketFactory TypeId.
  *
  * \see CreateSocket
  * \see NotifyNewAggregate
- * \see SendPacket
-*/
+ */
 
-class QuicL4Protocol : public UdpL4Protocol {
+class QuicL4Protocol : public Object {
 public:
   /**
    * \brief Get the type ID.
    * \return the object TypeId
    */
   static TypeId GetTypeId (void);
-  static const uint8_t PROT_NUMBER; //!< protocol number (0x6)
+  static const uint8_t PROT_NUMBER; //!< protocol number of UDP (0x11)
 
   QuicL4Protocol ();
   virtual ~QuicL4Protocol ();
@@ -98,102 +91,18 @@ public:
   Ptr<Socket> CreateSocket (void);
 
   /**
-   * \brief Create a QUIC socket using the specified congestion control algorithm TypeId
+   * \brief Create a QUIC socket of the specified TypeId
    *
+   * \param socketTypeId the TypeId of a QuicSocketBase subclass
    * \return A smart Socket pointer to a QuicSocket allocated by this instance
    * of the QUIC protocol
-   *
-   * \warning using a congestionTypeId other than QUIC is a bad idea.
-   *
-   * \param congestionTypeId the congestion control algorithm TypeId
-   */
-  Ptr<Socket> CreateSocket (TypeId congestionTypeId);
-
-  /**
-   * \brief Allocate an IPv4 Endpoint
-   * \return the Endpoint
-   */
-  Ipv4EndPoint *Allocate (void);
-  /**
-   * \brief Allocate an IPv4 Endpoint
-   * \param address address to use
-   * \return the Endpoint
-   */
-  Ipv4EndPoint *Allocate (Ipv4Address address);
-  /**
-   * \brief Allocate an IPv4 Endpoint
-   * \param port port to use
-   * \return the Endpoint
-   */
-  Ipv4EndPoint *Allocate (uint16_t port);
-  /**
-   * \brief Allocate an IPv4 Endpoint
-   * \param address address to use
-   * \param port port to use
-   * \return the Endpoint
-   */
-  Ipv4EndPoint *Allocate (Ipv4Address address, uint16_t port);
-  /**
-   * \brief Allocate an IPv4 Endpoint
-   * \param localAddress local address to use
-   * \param localPort local port to use
-   * \param peerAddress remote address to use
-   * \param peerPort remote port to use
-   * \return the Endpoint
-   */
-  Ipv4EndPoint *Allocate (Ipv4Address localAddress, uint16_t localPort,
-                          Ipv4Address peerAddress, uint16_t peerPort);
-  /**
-   * \brief Allocate an IPv6 Endpoint
-   * \return the Endpoint
-   */
-  Ipv6EndPoint *Allocate6 (void);
-  /**
-   * \brief Allocate an IPv6 Endpoint
-   * \param address address to use
-   * \return the Endpoint
-   */
-  Ipv6EndPoint *Allocate6 (Ipv6Address address);
-  /**
-   * \brief Allocate an IPv6 Endpoint
-   * \param port port to use
-   * \return the Endpoint
-   */
-  Ipv6EndPoint *Allocate6 (uint16_t port);
-  /**
-   * \brief Allocate an IPv6 Endpoint
-   * \param address address to use
-   * \param port port to use
-   * \return the Endpoint
    */
-  Ipv6EndPoint *Allocate6 (Ipv6Address address, uint16_t port);
-  /**
-   * \brief Allocate an IPv6 Endpoint
-   * \param localAddress local address to use
-   * \param localPort local port to use
-   * \param peerAddress remote address to use
-   * \param peerPort remote port to use
-   * \return the Endpoint
-   */
-  Ipv6EndPoint *Allocate6 (Ipv6Address localAddress, uint16_t localPort,
-                           Ipv6Address peerAddress, uint16_t peerPort);
-  /**
-   * \brief Send a packet via QUIC (IP-agnostic)
-   *
-   * \param pkt The packet to send
-   * \param outgoing The packet header
-   * \param saddr The source Ipv4Address
-   * \param daddr The destination Ipv4Address
-   * \param oif The output interface bound. Defaults to null (unspecified).
-   */
-  void SendPacket (Ptr<Packet> pkt, const QuicHeader &outgoing,
-                   const Address &saddr, const Address &daddr,
-                   Ptr<NetDevice> oif = 0);
+  Ptr<Socket> CreateSocket (TypeId socketTypeId);
 
   /**
-   * \brief Make a socket fully operational
+   * \brief Keep track of a socket
    *
-   * Called after a socket has been bound, it is inserted in an internal vector.
+   * Called by CreateSocket, so that the sockets are disposed with the node.
    *
    * \param socket Socket to be added
    */
@@ -206,39 +115,31 @@ public:
    * \return true if the socket has been removed
    */
   bool RemoveSocket (Ptr<QuicSocketBase> socket);
+
   /**
-   * \brief Remove an IPv4 Endpoint.
-   * \param endPoint the end point to remove
+   * \return the number of sockets open on this stack
    */
-  void DeAllocate (Ipv4EndPoint *endPoint);
+  uint32_t GetNSockets (void) const;
+
   /**
-   * \brief Remove an IPv6 Endpoint.
-   * \param endPoint the end point to remove
+   * \return the protocol number of UDP, which carries QUIC
    */
-  void DeAllocate (Ipv6EndPoint *endPoint);
-
   virtual int GetProtocolNumber (void) const;
 
 protected:
   virtual void DoDispose (void);
 
   /**
-   * \brief Setup socket factory and callbacks when aggregated to a node
+   * \brief Setup socket factory when aggregated to a node
    *
-   * This function will notify other components connected to the node that a
-   * new stack member is now connected. This will be used to notify Layer 3
-   * protocol of layer 4 protocol stack to connect them together.
-   * The aggregation is completed by setting the node in the QUIC stack, link
-   * it to the ipv4 or ipv6 stack and adding QUIC socket factory to the node.
+   * The aggregation is completed by setting the node in the QUIC stack and
+   * adding a QUIC socket factory to the node.
    */
   virtual void NotifyNewAggregate ();
 
 private:
   Ptr<Node> m_node;                //!< the node this stack is associated with
-  Ipv4EndPointDemux *m_endPoints;  //!< A list of IPv4 end points.
-  Ipv6EndPointDemux *m_endPoints6; //!< A list of IPv6 end points.
-  TypeId m_rttTypeId;              //!< The RTT Estimator TypeId
-  TypeId m_congestionTypeId;       //!< The socket TypeId
+  TypeId m_socketTypeId;           //!< The socket TypeId
   std::vector<Ptr<QuicSocketBase> > m_sockets;      //!< list of sockets
 
   /**
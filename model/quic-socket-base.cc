@@ -0,0 +1,522 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/assert.h"
+#include "ns3/boolean.h"
+#include "ns3/integer.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/udp-socket-factory.h"
+
+#include "quic-l4-protocol.h"
+#include "quic-socket-base.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QuicSocketBase");
+
+NS_OBJECT_ENSURE_REGISTERED (QuicSocketBase);
+
+TypeId
+QuicSocketBase::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuicSocketBase")
+    .SetParent<QuicSocket> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<QuicSocketBase> ()
+  ;
+  return tid;
+}
+
+QuicSocketBase::QuicSocketBase (void)
+  : m_node (0),
+    m_quic (0),
+    m_udp (0),
+    m_rcvBufSize (0),
+    m_ipMulticastTtl (0),
+    m_ipMulticastIf (-1),
+    m_ipMulticastLoop (false),
+    m_mtuDiscover (false),
+    m_sndBufSize (0),
+    m_segmentSize (0),
+    m_initialSsThresh (0),
+    m_initialCwnd (0),
+    m_synRetries (0),
+    m_dataRetries (0),
+    m_delAckMaxCount (0),
+    m_noDelay (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+QuicSocketBase::~QuicSocketBase (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+QuicSocketBase::SetNode (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  NS_ASSERT_MSG (node->GetObject<UdpSocketFactory> () != 0,
+                 "QUIC runs over UDP; install the Internet stack before QUIC");
+  m_node = node;
+  m_udp = Socket::CreateSocket (node, UdpSocketFactory::GetTypeId ());
+  m_udp->SetAttribute ("RcvBufSize", UintegerValue (m_rcvBufSize));
+  m_udp->SetAttribute ("IpMulticastTtl", UintegerValue (m_ipMulticastTtl));
+  m_udp->SetAttribute ("IpMulticastIf", IntegerValue (m_ipMulticastIf));
+  m_udp->SetAttribute ("IpMulticastLoop", BooleanValue (m_ipMulticastLoop));
+  m_udp->SetAttribute ("MtuDiscover", BooleanValue (m_mtuDiscover));
+  m_udp->SetConnectCallback (
+    MakeCallback (&QuicSocketBase::ForwardConnectionSucceeded, this),
+    MakeCallback (&QuicSocketBase::ForwardConnectionFailed, this));
+  m_udp->SetDataSentCallback (MakeCallback (&QuicSocketBase::ForwardDataSent, this));
+  m_udp->SetSendCallback (MakeCallback (&QuicSocketBase::ForwardSend, this));
+  m_udp->SetRecvCallback (MakeCallback (&QuicSocketBase::ForwardRecv, this));
+}
+
+void
+QuicSocketBase::SetQuicL4 (Ptr<QuicL4Protocol> quic)
+{
+  NS_LOG_FUNCTION (this << quic);
+  m_quic = quic;
+}
+
+void
+QuicSocketBase::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_udp != 0)
+    {
+      m_udp->SetConnectCallback (MakeNullCallback<void, Ptr<Socket> > (),
+                                 MakeNullCallback<void, Ptr<Socket> > ());
+      m_udp->SetDataSentCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t> ());
+      m_udp->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t> ());
+      m_udp->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      m_udp = 0;
+    }
+  m_node = 0;
+  m_quic = 0;
+  QuicSocket::DoDispose ();
+}
+
+void
+QuicSocketBase::SetUdpAttribute (std::string name, const AttributeValue &value)
+{
+  if (m_udp != 0)
+    {
+      m_udp->SetAttribute (name, value);
+    }
+}
+
+void
+QuicSocketBase::ForwardConnectionSucceeded (Ptr<Socket> udp)
+{
+  NotifyConnectionSucceeded ();
+}
+
+void
+QuicSocketBase::ForwardConnectionFailed (Ptr<Socket> udp)
+{
+  NotifyConnectionFailed ();
+}
+
+void
+QuicSocketBase::ForwardDataSent (Ptr<Socket> udp, uint32_t bytes)
+{
+  NotifyDataSent (bytes);
+}
+
+void
+QuicSocketBase::ForwardSend (Ptr<Socket> udp, uint32_t available)
+{
+  NotifySend (available);
+}
+
+void
+QuicSocketBase::ForwardRecv (Ptr<Socket> udp)
+{
+  NotifyDataRecv ();
+}
+
+enum Socket::SocketErrno
+QuicSocketBase::GetErrno (void) const
+{
+  return m_udp != 0 ? m_udp->GetErrno () : ERROR_NOTCONN;
+}
+
+enum Socket::SocketType
+QuicSocketBase::GetSocketType (void) const
+{
+  return NS3_SOCK_DGRAM;
+}
+
+Ptr<Node>
+QuicSocketBase::GetNode (void) const
+{
+  return m_node;
+}
+
+int
+QuicSocketBase::Bind (void)
+{
+  NS_LOG_FUNCTION (this);
+  return m_udp->Bind ();
+}
+
+int
+QuicSocketBase::Bind6 (void)
+{
+  NS_LOG_FUNCTION (this);
+  return m_udp->Bind6 ();
+}
+
+int
+QuicSocketBase::Bind (const Address &address)
+{
+  NS_LOG_FUNCTION (this << address);
+  return m_udp->Bind (address);
+}
+
+int
+QuicSocketBase::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  int ret = m_udp->Close ();
+  if (m_quic != 0)
+    {
+      m_quic->RemoveSocket (this);
+    }
+  return ret;
+}
+
+int
+QuicSocketBase::ShutdownSend (void)
+{
+  NS_LOG_FUNCTION (this);
+  return m_udp->ShutdownSend ();
+}
+
+int
+QuicSocketBase::ShutdownRecv (void)
+{
+  NS_LOG_FUNCTION (this);
+  return m_udp->ShutdownRecv ();
+}
+
+int
+QuicSocketBase::Connect (const Address &address)
+{
+  NS_LOG_FUNCTION (this << address);
+  return m_udp->Connect (address);
+}
+
+int
+QuicSocketBase::Listen (void)
+{
+  // Datagram sockets do not listen; QuicServer dispatches every datagram.
+  return -1;
+}
+
+uint32_t
+QuicSocketBase::GetTxAvailable (void) const
+{
+  return m_udp->GetTxAvailable ();
+}
+
+int
+QuicSocketBase::Send (Ptr<Packet> p, uint32_t flags)
+{
+  NS_LOG_FUNCTION (this << p << flags);
+  return m_udp->Send (p, flags);
+}
+
+int
+QuicSocketBase::SendTo (Ptr<Packet> p, uint32_t flags, const Address &address)
+{
+  NS_LOG_FUNCTION (this << p << flags << address);
+  return m_udp->SendTo (p, flags, address);
+}
+
+uint32_t
+QuicSocketBase::GetRxAvailable (void) const
+{
+  return m_udp->GetRxAvailable ();
+}
+
+Ptr<Packet>
+QuicSocketBase::Recv (uint32_t maxSize, uint32_t flags)
+{
+  NS_LOG_FUNCTION (this << maxSize << flags);
+  return m_udp->Recv (maxSize, flags);
+}
+
+Ptr<Packet>
+QuicSocketBase::RecvFrom (uint32_t maxSize, uint32_t flags, Address &fromAddress)
+{
+  NS_LOG_FUNCTION (this << maxSize << flags);
+  return m_udp->RecvFrom (maxSize, flags, fromAddress);
+}
+
+int
+QuicSocketBase::GetSockName (Address &address) const
+{
+  return m_udp->GetSockName (address);
+}
+
+int
+QuicSocketBase::GetPeerName (Address &address) const
+{
+  return m_udp->GetPeerName (address);
+}
+
+void
+QuicSocketBase::BindToNetDevice (Ptr<NetDevice> netdevice)
+{
+  NS_LOG_FUNCTION (this << netdevice);
+  m_udp->BindToNetDevice (netdevice);
+}
+
+bool
+QuicSocketBase::SetAllowBroadcast (bool allowBroadcast)
+{
+  return m_udp->SetAllowBroadcast (allowBroadcast);
+}
+
+bool
+QuicSocketBase::GetAllowBroadcast (void) const
+{
+  return m_udp->GetAllowBroadcast ();
+}
+
+int
+QuicSocketBase::MulticastJoinGroup (uint32_t interfaceIndex,
+                                    const Address &groupAddress)
+{
+  return DynamicCast<UdpSocket> (m_udp)->MulticastJoinGroup (interfaceIndex,
+                                                             groupAddress);
+}
+
+int
+QuicSocketBase::MulticastLeaveGroup (uint32_t interfaceIndex,
+                                     const Address &groupAddress)
+{
+  return DynamicCast<UdpSocket> (m_udp)->MulticastLeaveGroup (interfaceIndex,
+                                                              groupAddress);
+}
+
+void
+QuicSocketBase::SetRcvBufSize (uint32_t size)
+{
+  m_rcvBufSize = size;
+  SetUdpAttribute ("RcvBufSize", UintegerValue (size));
+}
+
+uint32_t
+QuicSocketBase::GetRcvBufSize (void) const
+{
+  return m_rcvBufSize;
+}
+
+void
+QuicSocketBase::SetIpMulticastTtl (uint8_t ipTtl)
+{
+  m_ipMulticastTtl = ipTtl;
+  SetUdpAttribute ("IpMulticastTtl", UintegerValue (ipTtl));
+}
+
+uint8_t
+QuicSocketBase::GetIpMulticastTtl (void) const
+{
+  return m_ipMulticastTtl;
+}
+
+void
+QuicSocketBase::SetIpMulticastIf (int32_t ipIf)
+{
+  m_ipMulticastIf = ipIf;
+  SetUdpAttribute ("IpMulticastIf", IntegerValue (ipIf));
+}
+
+int32_t
+QuicSocketBase::GetIpMulticastIf (void) const
+{
+  return m_ipMulticastIf;
+}
+
+void
+QuicSocketBase::SetIpMulticastLoop (bool loop)
+{
+  m_ipMulticastLoop = loop;
+  SetUdpAttribute ("IpMulticastLoop", BooleanValue (loop));
+}
+
+bool
+QuicSocketBase::GetIpMulticastLoop (void) const
+{
+  return m_ipMulticastLoop;
+}
+
+void
+QuicSocketBase::SetMtuDiscover (bool discover)
+{
+  m_mtuDiscover = discover;
+  SetUdpAttribute ("MtuDiscover", BooleanValue (discover));
+}
+
+bool
+QuicSocketBase::GetMtuDiscover (void) const
+{
+  return m_mtuDiscover;
+}
+
+void
+QuicSocketBase::SetSndBufSize (uint32_t size)
+{
+  m_sndBufSize = size;
+}
+
+uint32_t
+QuicSocketBase::GetSndBufSize (void) const
+{
+  return m_sndBufSize;
+}
+
+void
+QuicSocketBase::SetSegSize (uint32_t size)
+{
+  m_segmentSize = size;
+}
+
+uint32_t
+QuicSocketBase::GetSegSize (void) const
+{
+  return m_segmentSize;
+}
+
+void
+QuicSocketBase::SetInitialSSThresh (uint32_t threshold)
+{
+  m_initialSsThresh = threshold;
+}
+
+uint32_t
+QuicSocketBase::GetInitialSSThresh (void) const
+{
+  return m_initialSsThresh;
+}
+
+void
+QuicSocketBase::SetInitialCwnd (uint32_t cwnd)
+{
+  m_initialCwnd = cwnd;
+}
+
+uint32_t
+QuicSocketBase::GetInitialCwnd (void) const
+{
+  return m_initialCwnd;
+}
+
+void
+QuicSocketBase::SetConnTimeout (Time timeout)
+{
+  m_connTimeout = timeout;
+}
+
+Time
+QuicSocketBase::GetConnTimeout (void) const
+{
+  return m_connTimeout;
+}
+
+void
+QuicSocketBase::SetSynRetries (uint32_t count)
+{
+  m_synRetries = count;
+}
+
+uint32_t
+QuicSocketBase::GetSynRetries (void) const
+{
+  return m_synRetries;
+}
+
+void
+QuicSocketBase::SetDataRetries (uint32_t retries)
+{
+  m_dataRetries = retries;
+}
+
+uint32_t
+QuicSocketBase::GetDataRetries (void) const
+{
+  return m_dataRetries;
+}
+
+void
+QuicSocketBase::SetDelAckTimeout (Time timeout)
+{
+  m_delAckTimeout = timeout;
+}
+
+Time
+QuicSocketBase::GetDelAckTimeout (void) const
+{
+  return m_delAckTimeout;
+}
+
+void
+QuicSocketBase::SetDelAckMaxCount (uint32_t count)
+{
+  m_delAckMaxCount = count;
+}
+
+uint32_t
+QuicSocketBase::GetDelAckMaxCount (void) const
+{
+  return m_delAckMaxCount;
+}
+
+void
+QuicSocketBase::SetTcpNoDelay (bool noDelay)
+{
+  m_noDelay = noDelay;
+}
+
+bool
+QuicSocketBase::GetTcpNoDelay (void) const
+{
+  return m_noDelay;
+}
+
+void
+QuicSocketBase::SetPersistTimeout (Time timeout)
+{
+  m_persistTimeout = timeout;
+}
+
+Time
+QuicSocketBase::GetPersistTimeout (void) const
+{
+  return m_persistTimeout;
+}
+
+} // namespace ns3
@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUIC_SOCKET_BASE_H
+#define QUIC_SOCKET_BASE_H
+
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "quic-socket.h"
+
+namespace ns3 {
+
+class Node;
+class Packet;
+class QuicL4Protocol;
+
+/**
+ * \ingroup quic
+ *
+ * \brief The QuicSocket created by QuicL4Protocol
+ *
+ * A datagram socket for the endpoints of QUIC connections. Its datagrams
+ * travel on a UDP socket of the node, so Bind, Connect, Send and RecvFrom
+ * behave like those of a UdpSocket and the UdpSocket attributes (RcvBufSize,
+ * MtuDiscover, ...) apply to it. Unlike the sockets behind the socket_ns3
+ * descriptors, it is meant to be read and written by the QUIC endpoints
+ * directly: QuicClient and QuicServer pass the ns3::Packet it returns
+ * straight to their connections, and send what the connections write
+ * through QuicNs3PacketWriter.
+ *
+ * The TCP-like attributes of QuicSocket are stored but not used by the
+ * QUIC connections, which take their transport settings from the
+ * applications.
+ */
+class QuicSocketBase : public QuicSocket
+{
+public:
+  /**
+   * Get the type ID.
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  QuicSocketBase (void);
+  virtual ~QuicSocketBase (void);
+
+  /**
+   * \brief Set the associated node, creating the underlying UDP socket.
+   * \param node the node
+   */
+  virtual void SetNode (Ptr<Node> node);
+
+  /**
+   * \brief Set the associated QUIC L4 protocol.
+   * \param quic the QUIC L4 protocol
+   */
+  virtual void SetQuicL4 (Ptr<QuicL4Protocol> quic);
+
+  // Inherited from Socket
+  virtual enum SocketErrno GetErrno (void) const;
+  virtual enum SocketType GetSocketType (void) const;
+  virtual Ptr<Node> GetNode (void) const;
+  virtual int Bind (void);
+  virtual int Bind6 (void);
+  virtual int Bind (const Address &address);
+  virtual int Close (void);
+  virtual int ShutdownSend (void);
+  virtual int ShutdownRecv (void);
+  virtual int Connect (const Address &address);
+  virtual int Listen (void);
+  virtual uint32_t GetTxAvailable (void) const;
+  virtual int Send (Ptr<Packet> p, uint32_t flags);
+  virtual int SendTo (Ptr<Packet> p, uint32_t flags, const Address &address);
+  virtual uint32_t GetRxAvailable (void) const;
+  virtual Ptr<Packet> Recv (uint32_t maxSize, uint32_t flags);
+  virtual Ptr<Packet> RecvFrom (uint32_t maxSize, uint32_t flags,
+                                Address &fromAddress);
+  virtual int GetSockName (Address &address) const;
+  virtual int GetPeerName (Address &address) const;
+  virtual void BindToNetDevice (Ptr<NetDevice> netdevice);
+  virtual bool SetAllowBroadcast (bool allowBroadcast);
+  virtual bool GetAllowBroadcast (void) const;
+
+  // Inherited from UdpSocket
+  virtual int MulticastJoinGroup (uint32_t interfaceIndex,
+                                  const Address &groupAddress);
+  virtual int MulticastLeaveGroup (uint32_t interfaceIndex,
+                                   const Address &groupAddress);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  // Inherited from UdpSocket, applied to the UDP socket
+  virtual void SetRcvBufSize (uint32_t size);
+  virtual uint32_t GetRcvBufSize (void) const;
+  virtual void SetIpMulticastTtl (uint8_t ipTtl);
+  virtual uint8_t GetIpMulticastTtl (void) const;
+  virtual void SetIpMulticastIf (int32_t ipIf);
+  virtual int32_t GetIpMulticastIf (void) const;
+  virtual void SetIpMulticastLoop (bool loop);
+  virtual bool GetIpMulticastLoop (void) const;
+  virtual void SetMtuDiscover (bool discover);
+  virtual bool GetMtuDiscover (void) const;
+
+  // Inherited from QuicSocket
+  virtual void SetSndBufSize (uint32_t size);
+  virtual uint32_t GetSndBufSize (void) const;
+  virtual void SetSegSize (uint32_t size);
+  virtual uint32_t GetSegSize (void) const;
+  virtual void SetInitialSSThresh (uint32_t threshold);
+  virtual uint32_t GetInitialSSThresh (void) const;
+  virtual void SetInitialCwnd (uint32_t cwnd);
+  virtual uint32_t GetInitialCwnd (void) const;
+  virtual void SetConnTimeout (Time timeout);
+  virtual Time GetConnTimeout (void) const;
+  virtual void SetSynRetries (uint32_t count);
+  virtual uint32_t GetSynRetries (void) const;
+  virtual void SetDataRetries (uint32_t retries);
+  virtual uint32_t GetDataRetries (void) const;
+  virtual void SetDelAckTimeout (Time timeout);
+  virtual Time GetDelAckTimeout (void) const;
+  virtual void SetDelAckMaxCount (uint32_t count);
+  virtual uint32_t GetDelAckMaxCount (void) const;
+  virtual void SetTcpNoDelay (bool noDelay);
+  virtual bool GetTcpNoDelay (void) const;
+  virtual void SetPersistTimeout (Time timeout);
+  virtual Time GetPersistTimeout (void) const;
+
+  /**
+   * \brief Apply a UdpSocket attribute to the UDP socket, if it exists yet.
+   * \param name the attribute name
+   * \param value the attribute value
+   */
+  void SetUdpAttribute (std::string name, const AttributeValue &value);
+
+  /// \name Forward the notifications of the UDP socket as our own
+  /// \{
+  void ForwardConnectionSucceeded (Ptr<Socket> udp);
+  void ForwardConnectionFailed (Ptr<Socket> udp);
+  void ForwardDataSent (Ptr<Socket> udp, uint32_t bytes);
+  void ForwardSend (Ptr<Socket> udp, uint32_t available);
+  void ForwardRecv (Ptr<Socket> udp);
+  /// \}
+
+  Ptr<Node> m_node;              //!< the associated node
+  Ptr<QuicL4Protocol> m_quic;    //!< the associated QUIC L4 protocol
+  Ptr<Socket> m_udp;             //!< the UDP socket carrying the datagrams
+
+  // UdpSocket attributes, kept until the UDP socket exists
+  uint32_t m_rcvBufSize;         //!< Receive buffer size
+  uint8_t m_ipMulticastTtl;      //!< Multicast TTL
+  int32_t m_ipMulticastIf;       //!< Multicast interface
+  bool m_ipMulticastLoop;        //!< Multicast loopback
+  bool m_mtuDiscover;            //!< Set the DF flag on outgoing packets
+
+  // QuicSocket attributes
+  uint32_t m_sndBufSize;         //!< Send buffer size
+  uint32_t m_segmentSize;        //!< Segment size
+  uint32_t m_initialSsThresh;    //!< Initial slow start threshold
+  uint32_t m_initialCwnd;        //!< Initial congestion window, in segments
+  Time m_connTimeout;            //!< Connection timeout
+  uint32_t m_synRetries;         //!< Connection attempts
+  uint32_t m_dataRetries;        //!< Data retransmission attempts
+  Time m_delAckTimeout;          //!< Delayed ack timeout
+  uint32_t m_delAckMaxCount;     //!< Packets before an immediate ack
+  bool m_noDelay;                //!< Nagle's algorithm disabled
+  Time m_persistTimeout;         //!< Persist timeout
+};
+
+} // namespace ns3
+
+#endif /* QUIC_SOCKET_BASE_H */
@@ -0,0 +1,76 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/socket.h"
+
+#include "quic-l4-protocol.h"
+#include "quic-socket-factory.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QuicSocketFactory");
+
+NS_OBJECT_ENSURE_REGISTERED (QuicSocketFactory);
+
+TypeId
+QuicSocketFactory::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuicSocketFactory")
+    .SetParent<SocketFactory> ()
+    .SetGroupName ("Internet")
+  ;
+  return tid;
+}
+
+QuicSocketFactory::QuicSocketFactory ()
+  : m_quic (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+QuicSocketFactory::~QuicSocketFactory ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_quic == 0);
+}
+
+void
+QuicSocketFactory::SetQuicL4 (Ptr<QuicL4Protocol> quic)
+{
+  NS_LOG_FUNCTION (this << quic);
+  m_quic = quic;
+}
+
+Ptr<Socket>
+QuicSocketFactory::CreateSocket (void)
+{
+  NS_LOG_FUNCTION (this);
+  return m_quic->CreateSocket ();
+}
+
+void
+QuicSocketFactory::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_quic = 0;
+  SocketFactory::DoDispose ();
+}
+
+} // namespace ns3
@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUIC_SOCKET_FACTORY_H
+#define QUIC_SOCKET_FACTORY_H
+
+#include "ns3/ptr.h"
+#include "ns3/socket-factory.h"
+
+namespace ns3 {
+
+class Socket;
+class QuicL4Protocol;
+
+/**
+ * \ingroup socket
+ * \ingroup quic
+ *
+ * \brief API to create QUIC socket instances
+ *
+ * Aggregated to a node by its QuicL4Protocol. Applications create sockets
+ * through Socket::CreateSocket with the ns3::QuicSocketFactory TypeId,
+ * which QuicClient and QuicServer take through their Protocol attribute.
+ */
+class QuicSocketFactory : public SocketFactory
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  QuicSocketFactory ();
+  virtual ~QuicSocketFactory ();
+
+  /**
+   * \brief Set the associated QUIC L4 protocol.
+   * \param quic the QUIC L4 protocol
+   */
+  void SetQuicL4 (Ptr<QuicL4Protocol> quic);
+
+  /**
+   * \brief Implements a method to create a QUIC socket and return
+   * a base class smart pointer to the socket.
+   *
+   * \return smart pointer to Socket
+   */
+  virtual Ptr<Socket> CreateSocket (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  Ptr<QuicL4Protocol> m_quic; //!< the associated QUIC L4 protocol
+};
+
+} // namespace ns3
+
+#endif /* QUIC_SOCKET_FACTORY_H */
@@ -0,0 +1,975 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+
+#include "net/quic/core/congestion_control/general_loss_algorithm.h"
+#include "net/quic/core/congestion_control/pcc_monitor_interval_queue.h"
+#include "net/quic/core/congestion_control/pcc_sender.h"
+#include "net/quic/core/congestion_control/rtt_stats.h"
+#include "net/quic/core/crypto/quic_random.h"
+#include "net/quic/core/quic_connection_stats.h"
+#include "net/quic/core/quic_received_packet_bitmap.h"
+#include "net/quic/core/quic_received_packet_manager.h"
+#include "net/quic/core/quic_ring_buffer.h"
+#include "net/quic/core/quic_unacked_packet_map.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+// Do not put your test classes in namespace ns3.  You may find it useful
+// to use the using directive to access the ns3 namespace directly
+using namespace ns3;
+
+namespace {
+
+// Packets of the unit cases are all this long.
+const net::QuicByteCount kPacketBytes = 1000;
+
+net::QuicTime
+At (double seconds)
+{
+  return net::QuicTime::Zero ()
+    + net::QuicTime::Delta::FromMicroseconds (int64_t (seconds * 1e6));
+}
+
+net::QuicBandwidth
+Mbps (double rate)
+{
+  return net::QuicBandwidth::FromBitsPerSecond (int64_t (rate * 1e6));
+}
+
+double
+ToMbps (net::QuicBandwidth rate)
+{
+  return rate.ToBitsPerSecond () / 1e6;
+}
+
+// A complete MI of |rate| with the given utility.
+net::MonitorInterval
+Interval (net::QuicBandwidth rate, float utility)
+{
+  net::MonitorInterval interval (rate, true, At (0), At (0.1));
+  interval.utility = utility;
+  return interval;
+}
+
+// Runs of consecutive packets, each from first up to, not including, second.
+typedef std::vector<std::pair<net::QuicPacketNumber, net::QuicPacketNumber> > Ranges;
+
+// The runs of the packets from |begin| to |end| of a set.
+Ranges
+RangesOf (std::set<net::QuicPacketNumber>::const_iterator begin,
+          std::set<net::QuicPacketNumber>::const_iterator end)
+{
+  Ranges ranges;
+  for (std::set<net::QuicPacketNumber>::const_iterator it = begin; it != end; it++)
+    {
+      if (!ranges.empty () && ranges.back ().second == *it)
+        {
+          ranges.back ().second++;
+        }
+      else
+        {
+          ranges.push_back (std::make_pair (*it, *it + 1));
+        }
+    }
+  return ranges;
+}
+
+// The runs listed in |packets|.
+Ranges
+RangesOf (const net::PacketNumberQueue &packets)
+{
+  Ranges ranges;
+  for (const auto &interval : packets)
+    {
+      ranges.push_back (std::make_pair (interval.min (), interval.max ()));
+    }
+  return ranges;
+}
+
+} // namespace
+
+/**
+ * \ingroup quic-test
+ *
+ * The Vivace utility of an MI rewards its rate, and charges for loss and
+ * for an RTT that rises faster than the tolerance.
+ */
+class PccUtilityTestCase : public TestCase
+{
+public:
+  PccUtilityTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PccUtilityTestCase::PccUtilityTestCase ()
+  : TestCase ("PCC utility of a monitor interval")
+{
+}
+
+void
+PccUtilityTestCase::DoRun (void)
+{
+  using net::PccMonitorIntervalQueue;
+  const double latency = 900, loss = 11.35, tolerance = 1e-3;
+
+  net::MonitorInterval interval (Mbps (10), true, At (0), At (0.1));
+  NS_TEST_ASSERT_MSG_EQ (PccMonitorIntervalQueue::ComputeUtility (interval, latency, loss),
+                         0, "An MI without packets has no utility");
+
+  interval.bytes_sent = 10 * kPacketBytes;
+  interval.bytes_acked = 10 * kPacketBytes;
+  double throughput = std::pow (10, 0.9);
+  NS_TEST_ASSERT_MSG_EQ_TOL (PccMonitorIntervalQueue::ComputeUtility (interval, latency, loss),
+                             throughput, tolerance, "Wrong throughput reward");
+
+  interval.bytes_acked = 9 * kPacketBytes;
+  interval.bytes_lost = kPacketBytes;
+  NS_TEST_ASSERT_MSG_EQ_TOL (PccMonitorIntervalQueue::ComputeUtility (interval, latency, loss),
+                             throughput - loss * 10 * 0.1, tolerance,
+                             "Wrong loss penalty");
+
+  // 5 ms more over a second is below the 0.01 tolerance.
+  interval.bytes_acked = 10 * kPacketBytes;
+  interval.bytes_lost = 0;
+  interval.packet_rtt_samples.emplace_back (At (1), net::QuicTime::Delta::FromMilliseconds (100));
+  interval.packet_rtt_samples.emplace_back (At (2), net::QuicTime::Delta::FromMilliseconds (105));
+  NS_TEST_ASSERT_MSG_EQ_TOL (PccMonitorIntervalQueue::ComputeUtility (interval, latency, loss),
+                             throughput, tolerance, "RTT noise was penalized");
+
+  // 100 ms more over a second is a gradient of 0.1.
+  interval.packet_rtt_samples.clear ();
+  interval.packet_rtt_samples.emplace_back (At (1), net::QuicTime::Delta::FromMilliseconds (100));
+  interval.packet_rtt_samples.emplace_back (At (1.5), net::QuicTime::Delta::FromMilliseconds (150));
+  interval.packet_rtt_samples.emplace_back (At (2), net::QuicTime::Delta::FromMilliseconds (200));
+  NS_TEST_ASSERT_MSG_EQ_TOL (PccMonitorIntervalQueue::ComputeUtility (interval, latency, loss),
+                             throughput - latency * 10 * 0.1, tolerance,
+                             "Wrong latency penalty");
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * Acked and lost packets count towards the MI they were sent in, the RTT
+ * sample towards the MI of the largest acked packet, and MIs complete in
+ * order once all their packets are accounted for or they time out.
+ */
+class PccMonitorIntervalTestCase : public TestCase,
+                                   public net::PccMonitorIntervalQueueDelegateInterface
+{
+public:
+  PccMonitorIntervalTestCase ();
+
+  virtual void OnUtilityAvailable (const net::MonitorInterval &interval);
+
+private:
+  virtual void DoRun (void);
+
+  std::vector<net::MonitorInterval> m_completed; //!< MIs reported, in order
+};
+
+PccMonitorIntervalTestCase::PccMonitorIntervalTestCase ()
+  : TestCase ("PCC monitor interval attribution")
+{
+}
+
+void
+PccMonitorIntervalTestCase::OnUtilityAvailable (const net::MonitorInterval &interval)
+{
+  m_completed.push_back (interval);
+}
+
+void
+PccMonitorIntervalTestCase::DoRun (void)
+{
+  typedef net::SendAlgorithmInterface::CongestionVector CongestionVector;
+  const net::QuicTime::Delta timeout = net::QuicTime::Delta::FromSeconds (1);
+  const net::QuicTime::Delta rtt = net::QuicTime::Delta::FromMilliseconds (100);
+  net::PccMonitorIntervalQueue queue (this);
+
+  // Packets 1-3, 4-6 and 7-8, the last MI not useful.
+  queue.EnqueueNewMonitorInterval (Mbps (1), true, At (0), At (0.1));
+  for (net::QuicPacketNumber packet = 1; packet <= 3; packet++)
+    {
+      queue.OnPacketSent (At (0.01 * packet), packet, kPacketBytes);
+    }
+  queue.EnqueueNewMonitorInterval (Mbps (2), true, At (0.1), At (0.2));
+  for (net::QuicPacketNumber packet = 4; packet <= 6; packet++)
+    {
+      queue.OnPacketSent (At (0.1 + 0.01 * packet), packet, kPacketBytes);
+    }
+  queue.EnqueueNewMonitorInterval (Mbps (2), false, At (0.2), At (0.3));
+  for (net::QuicPacketNumber packet = 7; packet <= 8; packet++)
+    {
+      queue.OnPacketSent (At (0.2 + 0.01 * packet), packet, kPacketBytes);
+    }
+  NS_TEST_ASSERT_MSG_EQ (queue.size (), 3, "Expected three MIs");
+  NS_TEST_ASSERT_MSG_EQ (queue.num_useful_intervals (), 2, "Expected two useful MIs");
+
+  CongestionVector acked = {{1, kPacketBytes}, {2, kPacketBytes}, {4, kPacketBytes}};
+  CongestionVector lost = {{3, kPacketBytes}};
+  queue.OnCongestionEvent (acked, lost, true, rtt, At (0.3), timeout);
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), 1, "Only the first MI is complete");
+  if (m_completed.size () == 1)
+    {
+      const net::MonitorInterval &first = m_completed[0];
+      NS_TEST_ASSERT_MSG_EQ (first.bytes_acked, 2 * kPacketBytes, "Wrong bytes acked");
+      NS_TEST_ASSERT_MSG_EQ (first.bytes_lost, kPacketBytes, "Wrong bytes lost");
+      NS_TEST_ASSERT_MSG_EQ (first.packet_rtt_samples.size (), 0,
+                             "The RTT of packet 4 went to the first MI");
+    }
+
+  // The newest MI never completes, as it may still get packets.
+  acked = {{5, kPacketBytes}, {6, kPacketBytes}, {7, kPacketBytes}, {8, kPacketBytes}};
+  queue.OnCongestionEvent (acked, CongestionVector (), true, rtt, At (0.4), timeout);
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), 2, "The second MI is complete");
+  if (m_completed.size () == 2)
+    {
+      const net::MonitorInterval &second = m_completed[1];
+      NS_TEST_ASSERT_MSG_EQ (second.bytes_acked, 3 * kPacketBytes, "Wrong bytes acked");
+      NS_TEST_ASSERT_MSG_EQ (second.bytes_lost, 0, "Wrong bytes lost");
+      NS_TEST_ASSERT_MSG_EQ (second.packet_rtt_samples.size (), 1,
+                             "Expected the RTT of packet 4 only");
+      NS_TEST_ASSERT_MSG_EQ (second.sending_rate, Mbps (2), "Wrong MI reported");
+    }
+  NS_TEST_ASSERT_MSG_EQ (queue.size (), 1, "Only the newest MI should be left");
+  NS_TEST_ASSERT_MSG_EQ (queue.num_useful_intervals (), 0, "No useful MI is left");
+
+  // Once newer MIs exist, the MI that is not useful completes silently, and
+  // an MI whose packets are never reported completes after the timeout.
+  queue.EnqueueNewMonitorInterval (Mbps (3), true, At (0.4), At (0.5));
+  queue.OnPacketSent (At (0.45), 9, kPacketBytes);
+  queue.EnqueueNewMonitorInterval (Mbps (3), true, At (0.5), At (0.6));
+  queue.OnPacketSent (At (0.55), 10, kPacketBytes);
+  queue.OnCongestionEvent (CongestionVector (), CongestionVector (), false, rtt,
+                           At (1.4), timeout);
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), 2, "Completed an MI before its timeout");
+  queue.OnCongestionEvent (CongestionVector (), CongestionVector (), false, rtt,
+                           At (1.5), timeout);
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), 3, "The MI did not time out");
+  if (m_completed.size () == 3)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_completed[2].sending_rate, Mbps (3), "Wrong MI timed out");
+    }
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * The sender doubles its rate while the utility grows, probes around the
+ * best rate when it stops growing, moves in the direction both probing
+ * pairs agree on and probes again once a step stops paying off.
+ */
+class PccModeTestCase : public TestCase
+{
+public:
+  PccModeTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PccModeTestCase::PccModeTestCase ()
+  : TestCase ("PCC sender mode transitions")
+{
+}
+
+void
+PccModeTestCase::DoRun (void)
+{
+  net::RttStats rttStats;
+  net::PccSender sender (&rttStats, 10, 1000, net::QuicRandom::GetInstance ());
+  NS_TEST_ASSERT_MSG_EQ (sender.mode (), net::PccSender::STARTING, "Expected STARTING");
+
+  sender.OnUtilityAvailable (Interval (Mbps (1), 1));
+  sender.OnUtilityAvailable (Interval (Mbps (2), 2));
+  NS_TEST_ASSERT_MSG_EQ (sender.mode (), net::PccSender::STARTING,
+                         "Left STARTING while the utility grew");
+  sender.OnUtilityAvailable (Interval (Mbps (4), 1.5));
+  NS_TEST_ASSERT_MSG_EQ (sender.mode (), net::PccSender::PROBING, "Expected PROBING");
+  NS_TEST_ASSERT_MSG_EQ (sender.BandwidthEstimate (), Mbps (2),
+                         "Probing must start from the best rate");
+
+  // The pairs disagree: probe again.
+  sender.OnUtilityAvailable (Interval (Mbps (2.1), 3));
+  sender.OnUtilityAvailable (Interval (Mbps (1.9), 2));
+  sender.OnUtilityAvailable (Interval (Mbps (1.9), 3));
+  sender.OnUtilityAvailable (Interval (Mbps (2.1), 2));
+  NS_TEST_ASSERT_MSG_EQ (sender.mode (), net::PccSender::PROBING,
+                         "Decided although the pairs disagreed");
+
+  // Both pairs favour the higher rate.
+  sender.OnUtilityAvailable (Interval (Mbps (2.1), 3));
+  sender.OnUtilityAvailable (Interval (Mbps (1.9), 2));
+  sender.OnUtilityAvailable (Interval (Mbps (1.9), 2));
+  sender.OnUtilityAvailable (Interval (Mbps (2.1), 3));
+  NS_TEST_ASSERT_MSG_EQ (sender.mode (), net::PccSender::DECISION_MADE,
+                         "Expected DECISION_MADE");
+  NS_TEST_ASSERT_MSG_GT (sender.BandwidthEstimate (), Mbps (2.1),
+                         "Expected the rate to move up");
+
+  // A higher rate with a higher utility keeps the direction.
+  net::QuicBandwidth rate = sender.BandwidthEstimate ();
+  sender.OnUtilityAvailable (Interval (rate, 4));
+  NS_TEST_ASSERT_MSG_EQ (sender.mode (), net::PccSender::DECISION_MADE,
+                         "Left DECISION_MADE while the utility grew");
+  NS_TEST_ASSERT_MSG_GT (sender.BandwidthEstimate (), rate,
+                         "Expected the rate to keep moving up");
+
+  // A higher rate with a lower utility ends it.
+  sender.OnUtilityAvailable (Interval (sender.BandwidthEstimate (), 3.5));
+  NS_TEST_ASSERT_MSG_EQ (sender.mode (), net::PccSender::PROBING,
+                         "Expected PROBING once the utility dropped");
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * A rate change is bounded by 5% of the rate, and by 10% more for every
+ * step in a row that hit the bound; a step within the bound resets it.
+ */
+class PccRateBoundaryTestCase : public TestCase
+{
+public:
+  PccRateBoundaryTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Run STARTING and PROBING into DECISION_MADE around 10 Mbps,
+   * with \p gain more utility at 10.5 Mbps than at 9.5 Mbps.
+   */
+  void Decide (net::PccSender *sender, float gain);
+};
+
+PccRateBoundaryTestCase::PccRateBoundaryTestCase ()
+  : TestCase ("PCC rate change boundary")
+{
+}
+
+void
+PccRateBoundaryTestCase::Decide (net::PccSender *sender, float gain)
+{
+  sender->OnUtilityAvailable (Interval (Mbps (10), 1));
+  sender->OnUtilityAvailable (Interval (Mbps (20), 0));
+  for (int pair = 0; pair < 2; pair++)
+    {
+      sender->OnUtilityAvailable (Interval (Mbps (10.5), 1 + gain));
+      sender->OnUtilityAvailable (Interval (Mbps (9.5), 1));
+    }
+  NS_TEST_ASSERT_MSG_EQ (sender->mode (), net::PccSender::DECISION_MADE,
+                         "Expected DECISION_MADE");
+}
+
+void
+PccRateBoundaryTestCase::DoRun (void)
+{
+  const double tolerance = 1e-3;
+  net::RttStats rttStats;
+  {
+    // A gradient of 0.01 per Mbps moves 0.01 Mbps, within the bound.
+    net::PccSender sender (&rttStats, 10, 1000, net::QuicRandom::GetInstance ());
+    Decide (&sender, 0.01);
+    NS_TEST_ASSERT_MSG_EQ_TOL (ToMbps (sender.BandwidthEstimate ()), 10.5 + 0.01,
+                               tolerance, "A small step was clipped");
+  }
+
+  net::PccSender sender (&rttStats, 10, 1000, net::QuicRandom::GetInstance ());
+  // A gradient of 10 per Mbps is clipped to 5% of the rate.
+  Decide (&sender, 10);
+  double rate = 10.5 * 1.05;
+  NS_TEST_ASSERT_MSG_EQ_TOL (ToMbps (sender.BandwidthEstimate ()), rate, tolerance,
+                             "Expected a step of 5%");
+
+  // Clipped again: the bound grows to 15%, then 25%.
+  sender.OnUtilityAvailable (Interval (sender.BandwidthEstimate (), 20));
+  rate *= 1.15;
+  NS_TEST_ASSERT_MSG_EQ_TOL (ToMbps (sender.BandwidthEstimate ()), rate, tolerance,
+                             "Expected a step of 15%");
+  sender.OnUtilityAvailable (Interval (sender.BandwidthEstimate (), 40));
+  rate *= 1.25;
+  NS_TEST_ASSERT_MSG_EQ_TOL (ToMbps (sender.BandwidthEstimate ()), rate, tolerance,
+                             "Expected a step of 25%");
+
+  // A gradient of 0.001 per Mbps, three rounds in, moves 0.003 Mbps: within
+  // the bound, which drops back to 5%.
+  double step = ToMbps (sender.BandwidthEstimate ()) - rate / 1.25;
+  sender.OnUtilityAvailable (Interval (sender.BandwidthEstimate (), 40 + 0.001 * step));
+  rate += 4 * 0.001;
+  NS_TEST_ASSERT_MSG_EQ_TOL (ToMbps (sender.BandwidthEstimate ()), rate, tolerance,
+                             "A small step was clipped");
+  sender.OnUtilityAvailable (Interval (sender.BandwidthEstimate (), 1000));
+  rate *= 1.05;
+  NS_TEST_ASSERT_MSG_EQ_TOL (ToMbps (sender.BandwidthEstimate ()), rate, tolerance,
+                             "The bound did not drop back to 5%");
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * The ring keeps its elements in order across the end of its array and
+ * across growing from any head, iterators hold their position when it
+ * grows, and a slot keeps its value, and the value's storage, until
+ * push_back reuses it.
+ */
+class QuicRingBufferTestCase : public TestCase
+{
+public:
+  QuicRingBufferTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// Check that \p ring holds \p first, \p first + 1, ... in order.
+  void CheckOrder (const net::QuicRingBuffer<int> &ring, int first);
+};
+
+QuicRingBufferTestCase::QuicRingBufferTestCase ()
+  : TestCase ("Ring buffer of the unacked packet map")
+{
+}
+
+void
+QuicRingBufferTestCase::CheckOrder (const net::QuicRingBuffer<int> &ring, int first)
+{
+  int expected = first;
+  for (int value : ring)
+    {
+      NS_TEST_ASSERT_MSG_EQ (value, expected, "Out of order while iterating");
+      expected++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (expected - first, int (ring.size ()), "Iterated the wrong count");
+  for (size_t i = 0; i < ring.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (ring[i], first + int (i), "Out of order when indexed");
+    }
+  if (!ring.empty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (ring.front (), first, "Wrong front");
+      NS_TEST_ASSERT_MSG_EQ (ring.back (), first + int (ring.size ()) - 1, "Wrong back");
+    }
+}
+
+void
+QuicRingBufferTestCase::DoRun (void)
+{
+  net::QuicRingBuffer<int> ring;
+  NS_TEST_ASSERT_MSG_EQ (ring.empty (), true, "A new ring is not empty");
+  NS_TEST_ASSERT_MSG_EQ (ring.capacity (), 0, "A new ring allocated");
+
+  // Fills the first array, then wraps around its end.
+  int next = 0;
+  while (ring.size () < 64)
+    {
+      ring.push_back (next++);
+    }
+  size_t capacity = ring.capacity ();
+  NS_TEST_ASSERT_MSG_EQ (capacity, 64, "Expected the initial capacity");
+  for (int i = 0; i < 10; i++)
+    {
+      ring.pop_front ();
+    }
+  for (int i = 0; i < 10; i++)
+    {
+      ring.push_back (next++);
+    }
+  NS_TEST_ASSERT_MSG_EQ (ring.capacity (), capacity, "Grew although slots were free");
+  CheckOrder (ring, 10);
+
+  // Grows while the front is in the middle of the array; an iterator keeps
+  // its position.
+  net::QuicRingBuffer<int>::iterator it = ring.begin () + 5;
+  ring.push_back (next++);
+  NS_TEST_ASSERT_MSG_EQ (ring.capacity (), 2 * capacity, "Expected the ring to grow");
+  NS_TEST_ASSERT_MSG_EQ (*it, 15, "The iterator moved when the ring grew");
+  CheckOrder (ring, 10);
+
+  // Runs through the grown array a few times.
+  for (int i = 0; i < 1000; i++)
+    {
+      ring.pop_front ();
+      ring.push_back (next++);
+    }
+  NS_TEST_ASSERT_MSG_EQ (ring.capacity (), 2 * capacity, "Grew at a constant size");
+  CheckOrder (ring, 1010);
+  while (!ring.empty ())
+    {
+      ring.pop_front ();
+    }
+  ring.push_back (next);
+  CheckOrder (ring, next);
+
+  // A popped slot keeps its vector until push_back assigns to it, and the
+  // assigned vector reuses the storage.
+  net::QuicRingBuffer<std::vector<int> > vectors;
+  vectors.push_back (std::vector<int> (100, 1));
+  const std::vector<int> *slot = &vectors.front ();
+  const int *storage = slot->data ();
+  vectors.pop_front ();
+  NS_TEST_ASSERT_MSG_EQ (slot->size (), 100, "pop_front destroyed the value");
+  for (size_t i = 0; i < vectors.capacity (); i++)
+    {
+      vectors.push_back (std::vector<int> (1, 2));
+    }
+  NS_TEST_ASSERT_MSG_EQ (&vectors.back (), slot, "Expected the popped slot to be reused");
+  NS_TEST_ASSERT_MSG_EQ (vectors.back ().size (), 1, "Wrong value in the reused slot");
+  NS_TEST_ASSERT_MSG_EQ (vectors.back ().data (), storage,
+                         "The reused slot did not keep its storage");
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * The loss algorithm starts each scan where the previous one left the
+ * least packet in flight, so losses the sent packet manager ignores in RTO
+ * mode are only reported again once it resets the algorithm.
+ */
+class QuicLossIndexTestCase : public TestCase
+{
+public:
+  QuicLossIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// Check that \p lost holds the packets \p first to \p last, in order.
+  void CheckLost (const net::SendAlgorithmInterface::CongestionVector &lost,
+                  net::QuicPacketNumber first, net::QuicPacketNumber last);
+};
+
+QuicLossIndexTestCase::QuicLossIndexTestCase ()
+  : TestCase ("Loss algorithm rescans the losses its caller ignored")
+{
+}
+
+void
+QuicLossIndexTestCase::CheckLost (const net::SendAlgorithmInterface::CongestionVector &lost,
+                                  net::QuicPacketNumber first, net::QuicPacketNumber last)
+{
+  NS_TEST_ASSERT_MSG_EQ (lost.size (), last + 1 - first, "Wrong number of losses");
+  for (size_t i = 0; i < lost.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (lost[i].first, first + i, "Wrong packet lost");
+    }
+}
+
+void
+QuicLossIndexTestCase::DoRun (void)
+{
+  net::QuicUnackedPacketMap unacked;
+  net::RttStats rtt;
+  net::GeneralLossAlgorithm loss (net::kNack);
+  net::SendAlgorithmInterface::CongestionVector lost;
+
+  // Packets 1 to 6 leave together, and 6 is acked first: FACK loses 1 to 3,
+  // and 4 and 5 are within the reordering window.
+  for (net::QuicPacketNumber packet_number = 1; packet_number <= 6; packet_number++)
+    {
+      net::SerializedPacket packet (packet_number, net::PACKET_6BYTE_PACKET_NUMBER,
+                                    nullptr, kPacketBytes, false, false);
+      unacked.AddSentPacket (&packet, 0, net::NOT_RETRANSMISSION, At (0), true);
+    }
+  unacked.IncreaseLargestObserved (6);
+  unacked.RemoveFromInFlight (6);
+  loss.DetectLosses (unacked, At (0.1), rtt, 6, &lost);
+  CheckLost (lost, 1, 3);
+
+  // The losses are ignored, as in RTO mode, so 1 to 3 stay in flight below
+  // where the next scan starts.
+  lost.clear ();
+  loss.DetectLosses (unacked, At (0.1), rtt, 6, &lost);
+  CheckLost (lost, 1, 0);
+
+  // After a reset the scan finds them again, and once they are applied the
+  // index skips them.
+  loss.ResetLeastInFlight ();
+  loss.DetectLosses (unacked, At (0.1), rtt, 6, &lost);
+  CheckLost (lost, 1, 3);
+  for (const auto &pair : lost)
+    {
+      unacked.RemoveFromInFlight (pair.first);
+    }
+  lost.clear ();
+  loss.ResetLeastInFlight ();
+  loss.DetectLosses (unacked, At (0.1), rtt, 6, &lost);
+  CheckLost (lost, 1, 0);
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * The received packet bitmap answers as a std::set of the packets in its
+ * window would, through random adds in, past and far past the window,
+ * removals, run lengths and range extraction from any packet.
+ */
+class QuicReceivedPacketBitmapTestCase : public TestCase
+{
+public:
+  QuicReceivedPacketBitmapTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+QuicReceivedPacketBitmapTestCase::QuicReceivedPacketBitmapTestCase ()
+  : TestCase ("Received packet bitmap against a set")
+{
+}
+
+void
+QuicReceivedPacketBitmapTestCase::DoRun (void)
+{
+  const net::QuicPacketNumber window = net::QuicReceivedPacketBitmap::kWindowSize;
+  std::mt19937_64 rng (25);
+  net::QuicReceivedPacketBitmap bitmap;
+  std::set<net::QuicPacketNumber> model;
+
+  for (int i = 0; i < 100000; i++)
+    {
+      const net::QuicPacketNumber base = bitmap.base ();
+      const uint32_t op = rng () % 100;
+      if (op < 70)
+        {
+          // Mostly in the window, sometimes just past it, and rarely so far
+          // past it that the window empties.
+          net::QuicPacketNumber packet = base + rng () % window;
+          const uint32_t jump = rng () % 1000;
+          if (jump == 0)
+            {
+              packet = base + 3 * window + rng () % window;
+            }
+          else if (jump < 50)
+            {
+              packet = base + window + rng () % 256;
+            }
+          if (packet == 0)
+            {
+              continue;
+            }
+          bitmap.AdvanceTo (packet);
+          NS_TEST_ASSERT_MSG_EQ (bitmap.InWindow (packet), true,
+                                 "Packet " << packet << " is not in the window");
+          NS_TEST_ASSERT_MSG_EQ (bitmap.base () % 64, 0, "The window base is not a word");
+          if (packet < base + window)
+            {
+              NS_TEST_ASSERT_MSG_EQ (bitmap.base (), base,
+                                     "The window moved for packet " << packet);
+            }
+          else
+            {
+              NS_TEST_ASSERT_MSG_LT_OR_EQ (bitmap.base () + window, packet + 64,
+                                           "The window moved past packet " << packet);
+            }
+          model.erase (model.begin (), model.lower_bound (bitmap.base ()));
+          bitmap.Add (packet);
+          model.insert (packet);
+        }
+      else if (op < 75)
+        {
+          const net::QuicPacketNumber packet = base + rng () % (window + 128);
+          const bool expected = model.begin () != model.lower_bound (packet);
+          const bool removed = bitmap.RemoveUpTo (packet);
+          NS_TEST_ASSERT_MSG_EQ (removed, expected,
+                                 "Wrong result removing up to " << packet);
+          model.erase (model.begin (), model.lower_bound (packet));
+        }
+      else if (op < 90)
+        {
+          const net::QuicPacketNumber packet = base + rng () % window;
+          NS_TEST_ASSERT_MSG_EQ (bitmap.Contains (packet), model.count (packet) == 1,
+                                 "Wrong membership of " << packet);
+          net::QuicPacketNumber run = 0;
+          while (run <= packet && model.count (packet - run) == 1)
+            {
+              run++;
+            }
+          NS_TEST_ASSERT_MSG_EQ (bitmap.RunLength (packet), run,
+                                 "Wrong run length at " << packet);
+        }
+      else
+        {
+          const net::QuicPacketNumber packet = base + rng () % window;
+          net::PacketNumberQueue packets;
+          bitmap.AppendFrom (packet, &packets);
+          NS_TEST_ASSERT_MSG_EQ (RangesOf (packets) == RangesOf (model.lower_bound (packet), model.end ()),
+                                 true, "Wrong ranges from " << packet);
+        }
+    }
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * The received packet manager answers as a std::set of the packets it was
+ * not told to stop waiting for would, through loss, reordering and packets
+ * that arrive more than a bitmap window late.
+ */
+class QuicReceivedPacketManagerTestCase : public TestCase
+{
+public:
+  QuicReceivedPacketManagerTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+QuicReceivedPacketManagerTestCase::QuicReceivedPacketManagerTestCase ()
+  : TestCase ("Received packet manager against a set")
+{
+}
+
+void
+QuicReceivedPacketManagerTestCase::DoRun (void)
+{
+  std::mt19937_64 rng (25);
+
+  // 10% of the packets are lost, 1% arrive 1500 to 2500 packets late and 5%
+  // swap with the packet before them.
+  std::vector<net::QuicPacketNumber> arrivals;
+  std::vector<std::pair<size_t, net::QuicPacketNumber> > late;
+  for (net::QuicPacketNumber packet = 1; packet <= 30000; packet++)
+    {
+      const uint32_t fate = rng () % 1000;
+      if (fate < 100)
+        {
+          continue;
+        }
+      if (fate < 110)
+        {
+          late.push_back (std::make_pair (arrivals.size () + 1500 + rng () % 1000, packet));
+        }
+      else if (fate < 160 && !arrivals.empty ())
+        {
+          arrivals.insert (arrivals.end () - 1, packet);
+        }
+      else
+        {
+          arrivals.push_back (packet);
+        }
+    }
+  std::sort (late.begin (), late.end ());
+  std::vector<net::QuicPacketNumber> order;
+  size_t nextLate = 0;
+  for (size_t i = 0; i < arrivals.size (); i++)
+    {
+      while (nextLate < late.size () && late[nextLate].first <= i)
+        {
+          order.push_back (late[nextLate++].second);
+        }
+      order.push_back (arrivals[i]);
+    }
+
+  net::QuicConnectionStats stats;
+  net::QuicReceivedPacketManager manager (&stats);
+  std::set<net::QuicPacketNumber> model;
+  net::QuicPacketNumber leastAwaited = 0;
+  net::QuicPacketNumber largest = 0;
+  for (size_t i = 0; i < order.size (); i++)
+    {
+      const net::QuicPacketNumber packet = order[i];
+      if (!manager.IsAwaitingPacket (packet))
+        {
+          NS_TEST_ASSERT_MSG_EQ (packet < leastAwaited || model.count (packet) == 1, true,
+                                 "Packet " << packet << " is awaited");
+          continue;
+        }
+      NS_TEST_ASSERT_MSG_EQ (manager.IsMissing (packet), packet < largest,
+                             "Wrong missing state of " << packet);
+      net::QuicPacketHeader header;
+      header.packet_number = packet;
+      manager.RecordPacketReceived (header, At (i * 1e-6));
+      model.insert (packet);
+      largest = std::max (largest, packet);
+
+      // Missing packets are those below the largest; new ones are those
+      // the last few packets passed over.
+      const Ranges ranges = RangesOf (model.begin (), model.end ());
+      const bool missing = ranges.size () > 1
+        || ranges[0].first > std::max<net::QuicPacketNumber> (1, leastAwaited);
+      const bool newMissing = missing
+        && ranges.back ().second - ranges.back ().first <= 4;
+      NS_TEST_ASSERT_MSG_EQ (manager.HasMissingPackets (), missing,
+                             "Wrong missing packets after " << packet);
+      NS_TEST_ASSERT_MSG_EQ (manager.HasNewMissingPackets (), newMissing,
+                             "Wrong new missing packets after " << packet);
+
+      if (i % 7 == 0)
+        {
+          const net::QuicFrame frame = manager.GetUpdatedAckFrame (At (i * 1e-6));
+          NS_TEST_ASSERT_MSG_EQ (RangesOf (frame.ack_frame->packets) == ranges, true,
+                                 "Wrong ack ranges after " << packet);
+          for (int k = 0; k < 5; k++)
+            {
+              const net::QuicPacketNumber other = largest > 3000
+                ? largest - rng () % 3000 : 1 + rng () % largest;
+              NS_TEST_ASSERT_MSG_EQ (manager.IsAwaitingPacket (other),
+                                     other >= leastAwaited && model.count (other) == 0,
+                                     "Wrong awaiting state of " << other);
+            }
+        }
+      // The peer stops waiting for acks about 4000 packets back, beyond the
+      // bitmap window.
+      if (i % 500 == 0 && largest > 4000)
+        {
+          const net::QuicPacketNumber least = largest - 4000 + rng () % 100;
+          if (least > leastAwaited)
+            {
+              leastAwaited = least;
+              model.erase (model.begin (), model.lower_bound (least));
+              manager.DontWaitForPacketsBefore (least);
+            }
+        }
+    }
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * Packets that arrive after the bitmap window moved past them are added to
+ * the middle of the ack frame's PacketNumberQueue one by one, while the
+ * window keeps appending its runs at the back. Neither takes the slow path
+ * of AddRange, which walks a range packet by packet.
+ */
+class QuicPacketNumberQueueTestCase : public TestCase
+{
+public:
+  QuicPacketNumberQueueTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+QuicPacketNumberQueueTestCase::QuicPacketNumberQueueTestCase ()
+  : TestCase ("Packet number queue takes late packets without the AddRange slow path")
+{
+}
+
+void
+QuicPacketNumberQueueTestCase::DoRun (void)
+{
+  std::mt19937_64 rng (26);
+  const uint64_t slowAddRanges = net::PacketNumberQueue::NumSlowAddRanges ();
+
+  // Every 10th packet is held back until the largest packet is two windows
+  // past it, so each one lands between two ranges of the queue.
+  const net::QuicPacketNumber window = net::QuicReceivedPacketBitmap::kWindowSize;
+  net::QuicConnectionStats stats;
+  net::QuicReceivedPacketManager manager (&stats);
+  std::set<net::QuicPacketNumber> model;
+  std::vector<net::QuicPacketNumber> held;
+  net::QuicPacketNumber lateAdds = 0;
+  for (net::QuicPacketNumber packet = 1; packet <= 20000; packet++)
+    {
+      if (packet % 10 == 0)
+        {
+          held.push_back (packet);
+        }
+      else
+        {
+          net::QuicPacketHeader header;
+          header.packet_number = packet;
+          manager.RecordPacketReceived (header, At (packet * 1e-6));
+          model.insert (packet);
+        }
+      // Releases the held packets below the window in a random order.
+      std::shuffle (held.begin (), held.end (), rng);
+      for (size_t i = 0; i < held.size ();)
+        {
+          if (held[i] + 2 * window > packet)
+            {
+              i++;
+              continue;
+            }
+          NS_TEST_ASSERT_MSG_EQ (manager.IsAwaitingPacket (held[i]), true,
+                                 "Packet " << held[i] << " is not awaited");
+          net::QuicPacketHeader header;
+          header.packet_number = held[i];
+          manager.RecordPacketReceived (header, At (packet * 1e-6));
+          model.insert (held[i]);
+          held.erase (held.begin () + i);
+          lateAdds++;
+        }
+      if (packet % 97 == 0)
+        {
+          const net::QuicFrame frame = manager.GetUpdatedAckFrame (At (packet * 1e-6));
+          NS_TEST_ASSERT_MSG_EQ (RangesOf (frame.ack_frame->packets)
+                                 == RangesOf (model.begin (), model.end ()), true,
+                                 "Wrong ack ranges after " << packet);
+        }
+    }
+  NS_TEST_ASSERT_MSG_GT (lateAdds, 1000, "Too few packets arrived late");
+
+  // The same directly on a queue: single packets into gaps between ranges,
+  // in a random order, and ranges after the largest packet.
+  net::PacketNumberQueue packets;
+  std::vector<net::QuicPacketNumber> gaps;
+  for (net::QuicPacketNumber start = 1; start < 2000; start += 10)
+    {
+      packets.AddRange (start, start + 9);
+      gaps.push_back (start + 9);
+    }
+  std::shuffle (gaps.begin (), gaps.end (), rng);
+  for (size_t i = 0; i < gaps.size (); i++)
+    {
+      packets.Add (gaps[i]);
+      packets.AddRange (2001 + 10 * i, 2009 + 10 * i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (packets.NumIntervals (), gaps.size (),
+                         "The gaps between the first ranges were not merged");
+  NS_TEST_ASSERT_MSG_EQ (packets.Min (), 1u, "Wrong smallest packet");
+  NS_TEST_ASSERT_MSG_EQ (net::PacketNumberQueue::NumSlowAddRanges (), slowAddRanges,
+                         "AddRange took its slow path");
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * Unit cases of the vendored QUIC core changes, which run without a
+ * simulation.
+ */
+class QuicCoreTestSuite : public TestSuite
+{
+public:
+  QuicCoreTestSuite ();
+};
+
+QuicCoreTestSuite::QuicCoreTestSuite ()
+  : TestSuite ("quic-core", UNIT)
+{
+  AddTestCase (new PccUtilityTestCase, TestCase::QUICK);
+  AddTestCase (new PccMonitorIntervalTestCase, TestCase::QUICK);
+  AddTestCase (new PccModeTestCase, TestCase::QUICK);
+  AddTestCase (new PccRateBoundaryTestCase, TestCase::QUICK);
+  AddTestCase (new QuicRingBufferTestCase, TestCase::QUICK);
+  AddTestCase (new QuicLossIndexTestCase, TestCase::QUICK);
+  AddTestCase (new QuicReceivedPacketBitmapTestCase, TestCase::QUICK);
+  AddTestCase (new QuicReceivedPacketManagerTestCase, TestCase::QUICK);
+  AddTestCase (new QuicPacketNumberQueueTestCase, TestCase::QUICK);
+}
+
+// Do not forget to allocate an instance of this TestSuite
+static QuicCoreTestSuite quicCoreTestSuite;
@@ -0,0 +1,152 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/assert.h"
+#include "quic-loss-benchmark.h"
+
+#include "net/quic/core/congestion_control/general_loss_algorithm.h"
+#include "net/quic/core/congestion_control/rtt_stats.h"
+#include "net/quic/core/frames/quic_frame.h"
+#include "net/quic/core/quic_packets.h"
+#include "net/quic/core/quic_unacked_packet_map.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+/// A lost packet whose retransmission is acked at a later ack.
+struct PendingRetransmission
+{
+  uint64_t dueAck;                 //!< Ack that acks the retransmission
+  net::QuicPacketNumber packet;    //!< The lost packet
+};
+
+/**
+ * Replay the acks on a fresh map.
+ *
+ * \param window packets in flight
+ * \param acks acks to process
+ * \param lossInterval one packet of every lossInterval is lost
+ * \param reset whether to reset the loss algorithm before every call
+ * \param lost the packets declared lost, in order
+ * \return the wall-clock time spent in DetectLosses
+ */
+Clock::duration
+Replay (uint32_t window, uint64_t acks, uint32_t lossInterval, bool reset,
+        std::vector<net::QuicPacketNumber> *lost)
+{
+  const net::QuicPacketLength kPacketSize = 1350;
+  const net::QuicTime::Delta kRtt = net::QuicTime::Delta::FromMilliseconds (200);
+  const net::QuicTime::Delta kTick =
+    net::QuicTime::Delta::FromMicroseconds (std::max<int64_t> (kRtt.ToMicroseconds () / window, 1));
+
+  net::QuicUnackedPacketMap unacked;
+  net::RttStats rttStats;
+  net::GeneralLossAlgorithm loss (net::kNack);
+  net::QuicTime now = net::QuicTime::Zero () + net::QuicTime::Delta::FromSeconds (1);
+  rttStats.UpdateRtt (kRtt, net::QuicTime::Delta::Zero (), now);
+
+  net::QuicPacketNumber nextSent = 1;
+  auto send = [&] () {
+    net::SerializedPacket packet (nextSent++, net::PACKET_4BYTE_PACKET_NUMBER,
+                                  nullptr, kPacketSize, false, false);
+    packet.retransmittable_frames.push_back (net::QuicFrame (net::QuicPingFrame ()));
+    unacked.AddSentPacket (&packet, 0, net::NOT_RETRANSMISSION, now, true);
+  };
+  for (uint32_t i = 0; i < window; ++i)
+    {
+      send ();
+    }
+
+  std::deque<PendingRetransmission> pending;
+  net::SendAlgorithmInterface::CongestionVector packetsLost;
+  Clock::duration spent = Clock::duration::zero ();
+  net::QuicPacketNumber nextAcked = 1;
+  for (uint64_t ack = 0; ack < acks; ++ack)
+    {
+      if (nextAcked % lossInterval == 0)
+        {
+          // The skipped packet is replaced so the window stays full.
+          ++nextAcked;
+          send ();
+        }
+      net::QuicTransmissionInfo *info = unacked.GetMutableTransmissionInfo (nextAcked);
+      unacked.RemoveFromInFlight (info);
+      unacked.RemoveRetransmittability (info);
+      unacked.IncreaseLargestObserved (nextAcked);
+
+      if (reset)
+        {
+          loss.ResetLeastInFlight ();
+        }
+      packetsLost.clear ();
+      Clock::time_point start = Clock::now ();
+      loss.DetectLosses (unacked, now, rttStats, nextAcked, &packetsLost);
+      spent += Clock::now () - start;
+
+      for (const auto &packet : packetsLost)
+        {
+          lost->push_back (packet.first);
+          unacked.RemoveFromInFlight (packet.first);
+          pending.push_back ({ack + window, packet.first});
+        }
+      while (!pending.empty () && pending.front ().dueAck <= ack)
+        {
+          unacked.RemoveRetransmittability (pending.front ().packet);
+          pending.pop_front ();
+        }
+      unacked.RemoveObsoletePackets ();
+
+      ++nextAcked;
+      now = now + kTick;
+      send ();
+    }
+  return spent;
+}
+
+} // namespace
+
+QuicLossDetectionBenchmark::Result
+QuicLossDetectionBenchmark::Run (uint32_t window, uint64_t acks,
+                                 uint32_t lossInterval)
+{
+  NS_ASSERT_MSG (window > 0 && acks > 0 && lossInterval > 1,
+                 "Invalid benchmark parameters");
+  std::vector<net::QuicPacketNumber> indexedLost;
+  std::vector<net::QuicPacketNumber> scanLost;
+  Clock::duration indexed = Replay (window, acks, lossInterval, false, &indexedLost);
+  Clock::duration scan = Replay (window, acks, lossInterval, true, &scanLost);
+
+  Result result;
+  result.acks = acks;
+  result.lost = indexedLost.size ();
+  result.indexedNs = std::chrono::duration<double, std::nano> (indexed).count () / acks;
+  result.scanNs = std::chrono::duration<double, std::nano> (scan).count () / acks;
+  result.agree = indexedLost == scanLost;
+  return result;
+}
+
+} // namespace ns3
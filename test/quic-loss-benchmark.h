@@ -0,0 +1,69 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUIC_LOSS_BENCHMARK_H
+#define QUIC_LOSS_BENCHMARK_H
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup quic-test
+ *
+ * \brief Microbenchmark of the loss detection of the sent packet manager.
+ *
+ * Replays the acks of a bulk transfer with a constant window of packets in
+ * flight straight on a net::QuicUnackedPacketMap, without connections or
+ * a simulator. Every LossInterval-th packet is never acked; the
+ * retransmission of a lost packet is taken to be acked one window later,
+ * which keeps the lost packet, and every packet sent after it, in the
+ * map until then, as in a real recovery.
+ *
+ * net::GeneralLossAlgorithm with NACK based detection runs twice on the
+ * same acks: once as it is, starting each call from the least packet it
+ * left in flight, and once reset before every call, which makes it scan
+ * from the least unacked packet like the algorithm did before it kept
+ * that index.
+ */
+class QuicLossDetectionBenchmark
+{
+public:
+  /// Outcome of a run.
+  struct Result
+  {
+    uint64_t acks;        //!< Acks processed
+    uint64_t lost;        //!< Packets declared lost
+    double indexedNs;     //!< Wall-clock ns per ack, with the index
+    double scanNs;        //!< Wall-clock ns per ack, scanning
+    bool agree;           //!< Whether both declared the same packets lost
+  };
+
+  /**
+   * \param window packets in flight
+   * \param acks acks to process, each for one packet
+   * \param lossInterval one packet of every lossInterval is lost, at
+   *        least 2
+   * \return the timings of both variants
+   */
+  static Result Run (uint32_t window, uint64_t acks, uint32_t lossInterval);
+};
+
+} // namespace ns3
+
+#endif /* QUIC_LOSS_BENCHMARK_H */
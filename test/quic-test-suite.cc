@@ -1,55 +1,1202 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
 
-// Include a header file from your module to test.
-#include "ns3/quic.h"
-
-// An essential include is test.h
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/quic-helper.h"
+#include "ns3/quic-utils.h"
+#include "ns3/quic-context.h"
 #include "ns3/test.h"
+#include "helper/socket_ns3.h"
+#include "utils/quic-random.h"
+#include "quic-loss-benchmark.h"
+
+#include "net/quic/chromium/quic_chromium_alarm_factory.h"
+#include "third_party/zlib/zlib.h"
+
+#include <arpa/inet.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
 using namespace ns3;
 
-// This is an example TestCase.
-class QuicTestCase1 : public TestCase
+/**
+ * \ingroup quic-test
+ *
+ * The default scheduler, counting the events scheduled, so performance
+ * cases can report events per wall-clock second.
+ */
+class QuicCountingSimulatorImpl : public DefaultSimulatorImpl
+{
+public:
+  static TypeId GetTypeId (void);
+
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay,
+                                    EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+
+  static uint64_t s_events; //!< Events scheduled since the last reset
+};
+
+uint64_t QuicCountingSimulatorImpl::s_events = 0;
+
+NS_OBJECT_ENSURE_REGISTERED (QuicCountingSimulatorImpl);
+
+TypeId
+QuicCountingSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuicCountingSimulatorImpl")
+    .SetParent<DefaultSimulatorImpl> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<QuicCountingSimulatorImpl> ()
+  ;
+  return tid;
+}
+
+EventId
+QuicCountingSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  s_events++;
+  return DefaultSimulatorImpl::Schedule (delay, event);
+}
+
+void
+QuicCountingSimulatorImpl::ScheduleWithContext (uint32_t context,
+                                                Time const &delay,
+                                                EventImpl *event)
+{
+  s_events++;
+  DefaultSimulatorImpl::ScheduleWithContext (context, delay, event);
+}
+
+EventId
+QuicCountingSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  s_events++;
+  return DefaultSimulatorImpl::ScheduleNow (event);
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * Base of the end-to-end cases: a QuicClient and a QuicServer on the two
+ * ends of a rate-limited link, with the client traces recorded.
+ */
+class QuicEndToEndTestCase : public TestCase
+{
+public:
+  /**
+   * \param name case name
+   * \param dataRate link rate
+   * \param delay one-way link delay
+   */
+  QuicEndToEndTestCase (std::string name, DataRate dataRate, Time delay);
+
+protected:
+  /**
+   * \brief Build the topology and install the applications.
+   *
+   * Every request asks for \p responseBytes bytes.
+   *
+   * \param responseBytes response body size
+   * \param requests requests the client generates
+   * \param maxConnections connections the client may open
+   * \param maxStreams requests in flight per connection
+   * \param interArrival seconds between two requests
+   * \return the client
+   */
+  Ptr<QuicClient> Setup (uint64_t responseBytes, uint32_t requests,
+                         uint32_t maxConnections, uint32_t maxStreams,
+                         double interArrival);
+
+  /**
+   * \brief Run the simulation until \p stop, timing it if \p timed.
+   *
+   * Timed runs count events and print the simulated seconds per
+   * wall-clock second and the events per wall-clock second.
+   *
+   * \param stop simulation stop time
+   * \param timed whether to time the run
+   */
+  void Run (Time stop, bool timed);
+
+  /**
+   * \brief Destroy the simulation and restore the default simulator, even
+   * when DoRun() returned early on a failed assertion.
+   */
+  virtual void DoTeardown (void);
+
+  DataRate m_dataRate;        //!< Link rate
+  Time     m_delay;           //!< One-way link delay
+  double   m_lossRate;        //!< Random loss rate towards the client
+  std::string m_protocol;     //!< Socket factory of both applications
+  std::vector<bool> m_handshakes;  //!< zeroRtt of every handshake
+  std::vector<uint64_t> m_bytes;   //!< Bytes of every completed request
+  std::vector<Time> m_latencies;   //!< Latency of every completed request
+  uint64_t m_rxBytes;              //!< Bytes of the packets the client read
+  uint32_t m_rxMaxPacket;          //!< Largest packet the client read
+
+private:
+  /// Record a packet read by the client.
+  void Rx (Ptr<const Packet> packet, const Address &from);
+  /// Record a confirmed handshake.
+  void Handshake (Time duration, bool zeroRtt);
+  /// Record a completed request.
+  void RequestComplete (uint64_t requestId, uint64_t bytes, Time latency);
+};
+
+QuicEndToEndTestCase::QuicEndToEndTestCase (std::string name,
+                                            DataRate dataRate, Time delay)
+  : TestCase (name),
+    m_dataRate (dataRate),
+    m_delay (delay),
+    m_lossRate (0),
+    m_protocol ("ns3::UdpSocketFactory"),
+    m_rxBytes (0),
+    m_rxMaxPacket (0)
+{
+}
+
+Ptr<QuicClient>
+QuicEndToEndTestCase::Setup (uint64_t responseBytes, uint32_t requests,
+                             uint32_t maxConnections, uint32_t maxStreams,
+                             double interArrival)
+{
+  m_handshakes.clear ();
+  m_bytes.clear ();
+  m_latencies.clear ();
+  m_rxBytes = 0;
+  m_rxMaxPacket = 0;
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  // SimpleNetDevice keeps the suite within the dependencies of the module.
+  SimpleNetDeviceHelper link;
+  link.SetDeviceAttribute ("DataRate", DataRateValue (m_dataRate));
+  link.SetChannelAttribute ("Delay", TimeValue (m_delay));
+  NetDeviceContainer devices = link.Install (nodes);
+  if (m_lossRate > 0)
+    {
+      Ptr<RateErrorModel> errors = CreateObject<RateErrorModel> ();
+      errors->SetAttribute ("ErrorRate", DoubleValue (m_lossRate));
+      errors->SetAttribute ("ErrorUnit", StringValue ("ERROR_UNIT_PACKET"));
+      devices.Get (0)->SetAttribute ("ReceiveErrorModel", PointerValue (errors));
+    }
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  if (m_protocol == "ns3::QuicSocketFactory")
+    {
+      QuicHelper quic;
+      quic.Install (nodes);
+    }
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  uint16_t port = 6121;
+  InetSocketAddress serverAddress (interfaces.GetAddress (1), port);
+
+  QuicServerHelper serverHelper (m_protocol, serverAddress, 0);
+  serverHelper.SetAttribute ("DeterministicRandom", BooleanValue (true));
+  serverHelper.SetAttribute ("NullEncryption", BooleanValue (true));
+  ApplicationContainer serverApps = serverHelper.Install (nodes.Get (1));
+  serverApps.Start (Seconds (0.0));
+
+  QuicClientHelper clientHelper (m_protocol, serverAddress,
+                                 true, responseBytes);
+  clientHelper.SetAttribute ("DeterministicRandom", BooleanValue (true));
+  clientHelper.SetAttribute ("NullEncryption", BooleanValue (true));
+  clientHelper.SetAttribute ("NumRequests", UintegerValue (requests));
+  clientHelper.SetAttribute ("MaxConnections", UintegerValue (maxConnections));
+  clientHelper.SetAttribute ("MaxStreams", UintegerValue (maxStreams));
+  std::ostringstream interArrivalValue;
+  interArrivalValue << "ns3::ConstantRandomVariable[Constant=" << interArrival << "]";
+  clientHelper.SetAttribute ("InterArrival", StringValue (interArrivalValue.str ()));
+  ApplicationContainer clientApps = clientHelper.Install (nodes.Get (0));
+  clientApps.Start (Seconds (0.0));
+
+  Ptr<QuicClient> client = DynamicCast<QuicClient> (clientApps.Get (0));
+  client->TraceConnectWithoutContext (
+    "Handshake", MakeCallback (&QuicEndToEndTestCase::Handshake, this));
+  client->TraceConnectWithoutContext (
+    "RequestComplete", MakeCallback (&QuicEndToEndTestCase::RequestComplete, this));
+  client->TraceConnectWithoutContext (
+    "Rx", MakeCallback (&QuicEndToEndTestCase::Rx, this));
+  return client;
+}
+
+void
+QuicEndToEndTestCase::Run (Time stop, bool timed)
+{
+  Simulator::Stop (stop);
+  if (!timed)
+    {
+      Simulator::Run ();
+      return;
+    }
+
+  QuicCountingSimulatorImpl::s_events = 0;
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  double wallSeconds = std::max<int64_t> (clock.End (), 1) / 1000.0;
+  double simSeconds = Simulator::Now ().GetSeconds ();
+  std::cout << GetName () << ": " << simSeconds << " simulated s in "
+            << wallSeconds << " wall s, " << simSeconds / wallSeconds
+            << " simulated s per wall s, "
+            << QuicCountingSimulatorImpl::s_events << " events, "
+            << QuicCountingSimulatorImpl::s_events / wallSeconds
+            << " events per wall s" << std::endl;
+}
+
+void
+QuicEndToEndTestCase::DoTeardown (void)
+{
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SimulatorImplementationType",
+                     StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+void
+QuicEndToEndTestCase::Handshake (Time duration, bool zeroRtt)
+{
+  m_handshakes.push_back (zeroRtt);
+}
+
+void
+QuicEndToEndTestCase::Rx (Ptr<const Packet> packet, const Address &from)
+{
+  m_rxBytes += packet->GetSize ();
+  m_rxMaxPacket = std::max (m_rxMaxPacket, packet->GetSize ());
+}
+
+void
+QuicEndToEndTestCase::RequestComplete (uint64_t requestId, uint64_t bytes,
+                                       Time latency)
+{
+  m_bytes.push_back (bytes);
+  m_latencies.push_back (latency);
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * A single request over a fresh connection: every byte is delivered, the
+ * handshake is a full one, and the request completes within a tolerance
+ * of the time the link needs.
+ */
+class QuicTransferTestCase : public QuicEndToEndTestCase
+{
+public:
+  /**
+   * \param bytes response size
+   * \param dataRate link rate
+   * \param delay one-way link delay
+   * \param timed whether to time the run
+   */
+  QuicTransferTestCase (uint64_t bytes, DataRate dataRate, Time delay,
+                        bool timed);
+
+private:
+  virtual void DoRun (void);
+
+  uint64_t m_transferBytes; //!< Response size
+  bool     m_timed;         //!< Whether to time the run
+};
+
+QuicTransferTestCase::QuicTransferTestCase (uint64_t bytes, DataRate dataRate,
+                                            Time delay, bool timed)
+  : QuicEndToEndTestCase ("Transfer of " + std::to_string (bytes) + " bytes over "
+                          + std::to_string (dataRate.GetBitRate ()) + " bps, "
+                          + std::to_string (delay.GetMilliSeconds ()) + " ms",
+                          dataRate, delay),
+    m_transferBytes (bytes),
+    m_timed (timed)
+{
+}
+
+void
+QuicTransferTestCase::DoRun (void)
+{
+  if (m_timed)
+    {
+      GlobalValue::Bind ("SimulatorImplementationType",
+                         StringValue ("ns3::QuicCountingSimulatorImpl"));
+    }
+  Ptr<QuicClient> client = Setup (m_transferBytes, 1, 1, 1, 0);
+  Run (Seconds (1000), m_timed);
+
+  NS_TEST_ASSERT_MSG_EQ (client->GetTotalRx (), m_transferBytes,
+                         "Not every byte was delivered");
+  NS_TEST_ASSERT_MSG_GT (m_rxBytes, m_transferBytes,
+                         "The Rx trace missed packets carrying the response");
+  NS_TEST_ASSERT_MSG_EQ (client->GetRequestsCompleted (), 1,
+                         "The request did not complete");
+  NS_TEST_ASSERT_MSG_EQ (m_handshakes.size (), 1, "Expected one handshake");
+  if (m_handshakes.size () == 1)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_handshakes[0], false,
+                             "The first connection cannot be 0-RTT");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_latencies.size (), 1, "Expected one completed request");
+  if (m_latencies.size () == 1)
+    {
+      // The link bounds the transfer from below; slow start, headers and
+      // queue losses may add a few round trips and as much again.
+      Time serialization = Seconds (m_transferBytes * 8.0 / m_dataRate.GetBitRate ());
+      Time rtt = 2 * m_delay;
+      NS_TEST_ASSERT_MSG_GT (m_latencies[0], serialization + rtt,
+                             "Faster than the link allows");
+      NS_TEST_ASSERT_MSG_LT (m_latencies[0], 3 * serialization + 20 * rtt,
+                             "Took too long to complete");
+    }
+
+  // The connection's alarms share the events of the client node.
+  const net::QuicChromiumAlarmFactory::EventStats &alarms =
+    QuicContext::Get (client->GetNode ())->GetAlarmFactory ()->event_stats ();
+  NS_TEST_ASSERT_MSG_GT (alarms.alarms_fired, 0, "No alarm fired");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (alarms.events_fired, alarms.events_scheduled,
+                               "Fired more events than were scheduled");
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * A transfer over a link that drops 10% of the packets towards the client
+ * at random, which leaves the client acking around many gaps.
+ */
+class QuicLossyTransferTestCase : public QuicEndToEndTestCase
+{
+public:
+  QuicLossyTransferTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+QuicLossyTransferTestCase::QuicLossyTransferTestCase ()
+  : QuicEndToEndTestCase ("Transfer with 10% random loss",
+                          DataRate ("10Mbps"), MilliSeconds (10))
+{
+  m_lossRate = 0.1;
+}
+
+void
+QuicLossyTransferTestCase::DoRun (void)
+{
+  uint64_t bytes = 500000;
+  Ptr<QuicClient> client = Setup (bytes, 1, 1, 1, 0);
+  Run (Seconds (1000), false);
+
+  NS_TEST_ASSERT_MSG_EQ (client->GetTotalRx (), bytes,
+                         "Not every byte was delivered");
+  NS_TEST_ASSERT_MSG_EQ (client->GetRequestsCompleted (), 1,
+                         "The request did not complete");
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * A second connection to a server whose config the client has cached
+ * resumes with a 0-RTT handshake.
+ */
+class QuicZeroRttTestCase : public QuicEndToEndTestCase
+{
+public:
+  QuicZeroRttTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+QuicZeroRttTestCase::QuicZeroRttTestCase ()
+  : QuicEndToEndTestCase ("Second connection resumes with 0-RTT",
+                          DataRate ("10Mbps"), MilliSeconds (10))
+{
+}
+
+void
+QuicZeroRttTestCase::DoRun (void)
+{
+  // The first response keeps the only stream of the first connection busy
+  // when the second request comes, so it opens a second connection.
+  uint64_t bytes = 1000000;
+  Ptr<QuicClient> client = Setup (bytes, 2, 2, 1, 0.1);
+  Run (Seconds (100), false);
+
+  NS_TEST_ASSERT_MSG_EQ (client->GetConnectionsOpened (), 2,
+                         "Expected a second connection");
+  NS_TEST_ASSERT_MSG_EQ (m_handshakes.size (), 2, "Expected two handshakes");
+  if (m_handshakes.size () == 2)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_handshakes[0], false,
+                             "The first connection cannot be 0-RTT");
+      NS_TEST_ASSERT_MSG_EQ (m_handshakes[1], true,
+                             "The second connection should be 0-RTT");
+    }
+  NS_TEST_ASSERT_MSG_EQ (client->GetTotalRx (), 2 * bytes,
+                         "Not every byte was delivered");
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * Many connections at once, one request each, all of them complete.
+ */
+class QuicConcurrentConnectionsTestCase : public QuicEndToEndTestCase
+{
+public:
+  /**
+   * \param connections connections opened at once
+   * \param bytes response size of each request
+   * \param timed whether to time the run
+   */
+  QuicConcurrentConnectionsTestCase (uint32_t connections, uint64_t bytes,
+                                     bool timed);
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_connections; //!< Connections opened at once
+  uint64_t m_requestBytes; //!< Response size of each request
+  bool     m_timed;        //!< Whether to time the run
+};
+
+QuicConcurrentConnectionsTestCase::QuicConcurrentConnectionsTestCase (
+  uint32_t connections, uint64_t bytes, bool timed)
+  : QuicEndToEndTestCase (std::to_string (connections) + " concurrent connections of "
+                          + std::to_string (bytes) + " bytes",
+                          DataRate ("100Mbps"), MilliSeconds (5)),
+    m_connections (connections),
+    m_requestBytes (bytes),
+    m_timed (timed)
+{
+}
+
+void
+QuicConcurrentConnectionsTestCase::DoRun (void)
+{
+  if (m_timed)
+    {
+      GlobalValue::Bind ("SimulatorImplementationType",
+                         StringValue ("ns3::QuicCountingSimulatorImpl"));
+    }
+  Ptr<QuicClient> client = Setup (m_requestBytes, m_connections,
+                                  m_connections, 1, 0);
+  Run (Seconds (1000), m_timed);
+
+  NS_TEST_ASSERT_MSG_EQ (client->GetConnectionsOpened (), m_connections,
+                         "Expected one connection per request");
+  NS_TEST_ASSERT_MSG_EQ (client->GetRequestsCompleted (), m_connections,
+                         "Not every request completed");
+  NS_TEST_ASSERT_MSG_EQ (client->GetTotalRx (), m_connections * m_requestBytes,
+                         "Not every byte was delivered");
+  for (uint64_t bytes : m_bytes)
+    {
+      NS_TEST_ASSERT_MSG_EQ (bytes, m_requestBytes, "Short response");
+    }
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * The quantile sketch stays within its relative error bound.
+ */
+class QuicQuantileSketchTestCase : public TestCase
+{
+public:
+  QuicQuantileSketchTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+QuicQuantileSketchTestCase::QuicQuantileSketchTestCase ()
+  : TestCase ("Quantile sketch accuracy")
+{
+}
+
+void
+QuicQuantileSketchTestCase::DoRun (void)
+{
+  QuicQuantileSketch sketch (6);
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetQuantile (0.5), 0, "Empty sketch");
+
+  // 1 .. 100000: the q quantile is q * 100000.
+  for (int i = 1; i <= 100000; i++)
+    {
+      sketch.Add (i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetCount (), 100000, "Wrong count");
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetMin (), 1, "Wrong min");
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetMax (), 100000, "Wrong max");
+  NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetMean (), 50000.5, 1e-6, "Wrong mean");
+  double error = 1.0 / 128;
+  for (double q : {0.5, 0.99, 0.999})
+    {
+      double exact = q * 100000;
+      NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetQuantile (q), exact, exact * error,
+                                 "Quantile " << q << " out of bounds");
+    }
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetQuantile (1), 100000, "Wrong p100");
+
+  QuicQuantileSketch other (6);
+  other.Add (0);
+  sketch.Merge (other);
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetCount (), 100001, "Wrong merged count");
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetQuantile (0), 0, "Wrong merged min");
+
+  sketch.Reset ();
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetCount (), 0, "Reset kept samples");
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * A results file reads back, header and values, with and without
+ * compression. The reader follows the layout documented in
+ * QuicResultsWriter, independently of the writer.
+ */
+class QuicResultsWriterTestCase : public TestCase
+{
+public:
+  /**
+   * \param compress whether the blocks are deflated
+   */
+  QuicResultsWriterTestCase (bool compress);
+
+private:
+  virtual void DoRun (void);
+
+  /// A column as read from the header.
+  struct Column
+  {
+    std::string name;  //!< Column name
+    int type;          //!< Column type
+  };
+
+  /**
+   * \brief Read a results file back.
+   * \param filename path of the file
+   * \return whether the whole file parsed
+   */
+  bool Read (std::string filename);
+
+  bool m_compress;                          //!< Deflate the blocks
+  uint32_t m_version;                       //!< Version of the file read
+  uint32_t m_flags;                         //!< Flags of the file read
+  std::vector<Column> m_columns;            //!< Columns of the file read
+  std::vector<uint32_t> m_blocks;           //!< Records of every block read
+  std::vector<std::vector<uint64_t> > m_values; //!< Values read, by column
+};
+
+QuicResultsWriterTestCase::QuicResultsWriterTestCase (bool compress)
+  : TestCase (std::string ("Results file round trip")
+              + (compress ? ", compressed" : "")),
+    m_compress (compress),
+    m_version (0),
+    m_flags (0)
+{
+}
+
+namespace {
+
+uint32_t
+ReadUint32 (std::ifstream &in)
+{
+  unsigned char bytes[4] = {0, 0, 0, 0};
+  in.read (reinterpret_cast<char *> (bytes), sizeof (bytes));
+  return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (uint32_t (bytes[3]) << 24);
+}
+
+} // namespace
+
+bool
+QuicResultsWriterTestCase::Read (std::string filename)
+{
+  std::ifstream in (filename.c_str (), std::ios::binary);
+  char magic[4];
+  if (!in.read (magic, sizeof (magic)) || std::memcmp (magic, "QRES", 4) != 0)
+    {
+      return false;
+    }
+  m_version = ReadUint32 (in);
+  uint32_t columns = ReadUint32 (in);
+  m_flags = ReadUint32 (in);
+  for (uint32_t i = 0; i < columns; i++)
+    {
+      Column column;
+      column.type = in.get ();
+      column.name.resize (in.get ());
+      in.read (&column.name[0], column.name.size ());
+      m_columns.push_back (column);
+    }
+  m_values.assign (columns, std::vector<uint64_t> ());
+  while (in && in.peek () != std::ifstream::traits_type::eof ())
+    {
+      uint32_t records = ReadUint32 (in);
+      uint32_t payloadBytes = ReadUint32 (in);
+      std::vector<char> payload (payloadBytes);
+      if (!in.read (payload.data (), payloadBytes))
+        {
+          return false;
+        }
+      // Every column in turn, records values each.
+      std::vector<uint64_t> block (columns * records);
+      uLongf blockBytes = block.size () * sizeof (uint64_t);
+      if (m_flags & 1)
+        {
+          if (uncompress (reinterpret_cast<Bytef *> (block.data ()), &blockBytes,
+                          reinterpret_cast<const Bytef *> (payload.data ()),
+                          payloadBytes) != Z_OK
+              || blockBytes != block.size () * sizeof (uint64_t))
+            {
+              return false;
+            }
+        }
+      else if (payloadBytes != blockBytes)
+        {
+          return false;
+        }
+      else
+        {
+          std::memcpy (block.data (), payload.data (), payloadBytes);
+        }
+      m_blocks.push_back (records);
+      for (uint32_t column = 0; column < columns; column++)
+        {
+          m_values[column].insert (m_values[column].end (),
+                                   block.begin () + column * records,
+                                   block.begin () + (column + 1) * records);
+        }
+    }
+  return bool (in);
+}
+
+void
+QuicResultsWriterTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename (m_compress ? "compressed.qres"
+                                                           : "plain.qres");
+  Ptr<QuicResultsWriter> writer = CreateObject<QuicResultsWriter> ();
+  writer->SetAttribute ("Compress", BooleanValue (m_compress));
+  writer->SetAttribute ("BlockRecords", UintegerValue (4));
+  writer->AddColumn ("time", QuicResultsWriter::INT64);
+  writer->AddColumn ("rate", QuicResultsWriter::DOUBLE);
+  writer->Open (filename);
+  // Two full blocks and a partial one.
+  for (int i = 0; i < 10; i++)
+    {
+      writer->Write (-1000 * i, i / 4.0);
+    }
+  writer->Close ();
+  NS_TEST_ASSERT_MSG_EQ (writer->GetRecords (), 10, "Wrong record count");
+
+  NS_TEST_ASSERT_MSG_EQ (Read (filename), true, "Cannot read back " << filename);
+  NS_TEST_ASSERT_MSG_EQ (m_version, 1, "Wrong version");
+  NS_TEST_ASSERT_MSG_EQ (m_flags, m_compress ? 1 : 0, "Wrong flags");
+  NS_TEST_ASSERT_MSG_EQ (m_columns.size (), 2, "Wrong column count");
+  NS_TEST_ASSERT_MSG_EQ (m_columns[0].name, "time", "Wrong first column");
+  NS_TEST_ASSERT_MSG_EQ (m_columns[0].type, QuicResultsWriter::INT64,
+                         "Wrong type of the first column");
+  NS_TEST_ASSERT_MSG_EQ (m_columns[1].name, "rate", "Wrong second column");
+  NS_TEST_ASSERT_MSG_EQ (m_columns[1].type, QuicResultsWriter::DOUBLE,
+                         "Wrong type of the second column");
+  NS_TEST_ASSERT_MSG_EQ (m_blocks.size (), 3, "Wrong block count");
+  NS_TEST_ASSERT_MSG_EQ (m_blocks[0], 4, "Wrong size of the first block");
+  NS_TEST_ASSERT_MSG_EQ (m_blocks[1], 4, "Wrong size of the second block");
+  NS_TEST_ASSERT_MSG_EQ (m_blocks[2], 2, "Wrong size of the partial block");
+  for (int i = 0; i < 10; i++)
+    {
+      int64_t time;
+      double rate;
+      std::memcpy (&time, &m_values[0][i], sizeof (time));
+      std::memcpy (&rate, &m_values[1][i], sizeof (rate));
+      NS_TEST_ASSERT_MSG_EQ (time, -1000 * i, "Wrong time of record " << i);
+      NS_TEST_ASSERT_MSG_EQ (rate, i / 4.0, "Wrong rate of record " << i);
+    }
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * The installed QUIC random generator follows the seed and run it was last
+ * installed with, and goes away with the simulation.
+ */
+class QuicRandomTestCase : public TestCase
+{
+public:
+  QuicRandomTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Uninstall the generator.
+  virtual void DoTeardown (void);
+};
+
+QuicRandomTestCase::QuicRandomTestCase ()
+  : TestCase ("QUIC random generator seeding")
+{
+}
+
+void
+QuicRandomTestCase::DoRun (void)
+{
+  QuicRngStreamRandom::Install (1, 1);
+  net::QuicRandom *random = net::QuicRandom::GetInstance ();
+  uint64_t first = random->RandUint64 ();
+
+  QuicRngStreamRandom::Install (1, 1);
+  NS_TEST_ASSERT_MSG_NE (random->RandUint64 (), first,
+                         "The same seed and run restarted the stream");
+
+  QuicRngStreamRandom::Install (2, 1);
+  NS_TEST_ASSERT_MSG_EQ (net::QuicRandom::GetInstance (), random,
+                         "The generator was replaced instead of re-seeded");
+  QuicRngStreamRandom expected (2, 1);
+  NS_TEST_ASSERT_MSG_EQ (random->RandUint64 (), expected.RandUint64 (),
+                         "A new seed did not restart the stream");
+
+  Simulator::Destroy ();
+  QuicRngStreamRandom::Install (1, 1);
+  NS_TEST_ASSERT_MSG_EQ (net::QuicRandom::GetInstance ()->RandUint64 (), first,
+                         "The generator outlived the simulation");
+}
+
+void
+QuicRandomTestCase::DoTeardown (void)
+{
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * Requests between applications on native QuicL4Protocol sockets, which
+ * bypass the packet reader and the fd-based writers.
+ */
+class QuicNativeSocketTestCase : public QuicEndToEndTestCase
+{
+public:
+  QuicNativeSocketTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+QuicNativeSocketTestCase::QuicNativeSocketTestCase ()
+  : QuicEndToEndTestCase ("Requests over native QUIC sockets",
+                          DataRate ("10Mbps"), MilliSeconds (10))
+{
+  m_protocol = "ns3::QuicSocketFactory";
+}
+
+void
+QuicNativeSocketTestCase::DoRun (void)
+{
+  uint64_t bytes = 100000;
+  Ptr<QuicClient> client = Setup (bytes, 3, 1, 1, 0.1);
+  Run (Seconds (1000), false);
+
+  NS_TEST_ASSERT_MSG_EQ (client->GetTotalRx (), 3 * bytes,
+                         "Not every byte was delivered");
+  NS_TEST_ASSERT_MSG_EQ (client->GetRequestsCompleted (), 3,
+                         "Not every request completed");
+  NS_TEST_ASSERT_MSG_EQ (m_handshakes.size (), 1, "Expected one handshake");
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * A transfer with tuned transport attributes on both ends: a PCC server
+ * with a small initial and maximum congestion window, and a client with
+ * small flow control windows and ack decimation.
+ */
+class QuicTransportAttributesTestCase : public QuicEndToEndTestCase
+{
+public:
+  QuicTransportAttributesTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+QuicTransportAttributesTestCase::QuicTransportAttributesTestCase ()
+  : QuicEndToEndTestCase ("Transfer with tuned transport attributes",
+                          DataRate ("10Mbps"), MilliSeconds (10))
+{
+}
+
+void
+QuicTransportAttributesTestCase::DoRun (void)
+{
+  uint64_t bytes = 1000000;
+  Ptr<QuicClient> client = Setup (bytes, 1, 1, 1, 0);
+  // The applications read their attributes when they start.
+  Config::Set ("/NodeList/1/ApplicationList/0/$ns3::QuicServer/CongestionControl",
+               EnumValue (QUIC_CC_PCC));
+  Config::Set ("/NodeList/1/ApplicationList/0/$ns3::QuicServer/InitialCongestionWindow",
+               UintegerValue (10));
+  Config::Set ("/NodeList/1/ApplicationList/0/$ns3::QuicServer/MaxCongestionWindow",
+               UintegerValue (100));
+  client->SetAttribute ("StreamFlowControlWindow", UintegerValue (64 * 1024));
+  client->SetAttribute ("SessionFlowControlWindow", UintegerValue (128 * 1024));
+  client->SetAttribute ("AckDecimation", StringValue ("EighthRtt"));
+  Run (Seconds (1000), false);
+
+  NS_TEST_ASSERT_MSG_EQ (client->GetTotalRx (), bytes,
+                         "Not every byte was delivered");
+  NS_TEST_ASSERT_MSG_EQ (client->GetRequestsCompleted (), 1,
+                         "The request did not complete");
+  NS_TEST_ASSERT_MSG_EQ (m_latencies.size (), 1, "Expected one completed request");
+  if (m_latencies.size () == 1)
+    {
+      Time serialization = Seconds (bytes * 8.0 / m_dataRate.GetBitRate ());
+      NS_TEST_ASSERT_MSG_GT (m_latencies[0], serialization,
+                             "Faster than the link allows");
+    }
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * A transfer with the smallest packets a client hello fits in, which the
+ * server adopts too, optionally growing them by path MTU discovery.
+ */
+class QuicMaxPacketSizeTestCase : public QuicEndToEndTestCase
 {
 public:
-  QuicTestCase1 ();
-  virtual ~QuicTestCase1 ();
+  /**
+   * \param mtuDiscovery whether to probe for larger packets
+   */
+  QuicMaxPacketSizeTestCase (bool mtuDiscovery);
 
 private:
   virtual void DoRun (void);
+
+  bool m_mtuDiscovery; //!< Whether to probe for larger packets
 };
 
-// Add some help text to this case to describe what it is intended to test
-QuicTestCase1::QuicTestCase1 ()
-  : TestCase ("Quic test case (does nothing)")
+QuicMaxPacketSizeTestCase::QuicMaxPacketSizeTestCase (bool mtuDiscovery)
+  : QuicEndToEndTestCase (mtuDiscovery ? "Transfer growing small packets by MTU discovery"
+                                       : "Transfer with the smallest packets",
+                          DataRate ("10Mbps"), MilliSeconds (10)),
+    m_mtuDiscovery (mtuDiscovery)
 {
 }
 
-// This destructor does nothing but we include it as a reminder that
-// the test case should clean up after itself
-QuicTestCase1::~QuicTestCase1 ()
+void
+QuicMaxPacketSizeTestCase::DoRun (void)
+{
+  // The client hello is padded to the packet size minus a 50 byte
+  // estimate of the headers, and must be at least 1024 bytes long.
+  const uint64_t smallest = 1074;
+  uint64_t bytes = 1000000;
+  Ptr<QuicClient> client = Setup (bytes, 1, 1, 1, 0);
+  NS_TEST_ASSERT_MSG_EQ (client->SetAttributeFailSafe ("maxPacketSize",
+                                                       UintegerValue (smallest - 1)),
+                         false, "Accepted packets too small for a client hello");
+  client->SetAttribute ("maxPacketSize", UintegerValue (smallest));
+  if (m_mtuDiscovery)
+    {
+      client->SetAttribute ("MtuDiscovery", StringValue ("High"));
+    }
+  Run (Seconds (1000), false);
+
+  NS_TEST_ASSERT_MSG_EQ (client->GetTotalRx (), bytes,
+                         "Not every byte was delivered");
+  NS_TEST_ASSERT_MSG_EQ (client->GetRequestsCompleted (), 1,
+                         "The request did not complete");
+  if (m_mtuDiscovery)
+    {
+      // The 1500 byte link MTU leaves room for the 1450 byte target.
+      NS_TEST_ASSERT_MSG_GT (m_rxMaxPacket, smallest,
+                             "The server did not grow its packets");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (m_rxMaxPacket, smallest,
+                                   "The server sent packets above maxPacketSize");
+    }
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * The socket shim turns every datagram into exactly one ns3::Packet, so
+ * its send counters match what was sent through sendto_ns3 and
+ * sendmmsg_ns3, scattered messages included.
+ */
+class QuicSocketNs3StatsTestCase : public TestCase
+{
+public:
+  QuicSocketNs3StatsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Close the descriptors and destroy the simulation.
+  virtual void DoTeardown (void);
+
+  int m_sender;    //!< Descriptor sending the datagrams
+  int m_receiver;  //!< Descriptor receiving them
+};
+
+QuicSocketNs3StatsTestCase::QuicSocketNs3StatsTestCase ()
+  : TestCase ("Send counters of the socket shim"),
+    m_sender (-1),
+    m_receiver (-1)
 {
 }
 
-//
-// This method is the pure virtual method from class TestCase that every
-// TestCase must implement
-//
 void
-QuicTestCase1::DoRun (void)
+QuicSocketNs3StatsTestCase::DoRun (void)
 {
-  // A wide variety of test macros are available in src/core/test.h
-  NS_TEST_ASSERT_MSG_EQ (true, true, "true doesn't equal true for some reason");
-  // Use this one for floating point comparisons
-  NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper link;
+  NetDeviceContainer devices = link.Install (nodes);
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  sockaddr_in to;
+  memset (&to, 0, sizeof (to));
+  to.sin_family = AF_INET;
+  to.sin_port = htons (9);
+  to.sin_addr.s_addr = htonl (interfaces.GetAddress (1).Get ());
+
+  {
+    QuicContext::Scope scope (QuicContext::Get (nodes.Get (1)));
+    m_receiver = socket_ns3 (AF_INET, SOCK_DGRAM, 0);
+  }
+  sockaddr_in any = to;
+  any.sin_addr.s_addr = htonl (INADDR_ANY);
+  NS_TEST_ASSERT_MSG_EQ (bind_ns3 (m_receiver, (sockaddr *) &any, sizeof (any)), 0,
+                         "Cannot bind the receiver");
+  {
+    QuicContext::Scope scope (QuicContext::Get (nodes.Get (0)));
+    m_sender = socket_ns3 (AF_INET, SOCK_DGRAM, 0);
+  }
+
+  // ARP holds only a few datagrams while it resolves the receiver, so a
+  // first datagram resolves it before the counted ones are sent.
+  uint8_t buffer[1200] = {};
+  sendto_ns3 (m_sender, buffer, 1, 0, (sockaddr *) &to, sizeof (to));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (recvfrom_ns3 (m_receiver, buffer, sizeof (buffer), 0,
+                                       nullptr, nullptr),
+                         1, "The first datagram was not delivered");
+
+  reset_socket_ns3_stats ();
+  uint64_t bytes = 0;
+  for (size_t size : {100, 500, 1200})
+    {
+      NS_TEST_ASSERT_MSG_EQ (sendto_ns3 (m_sender, buffer, size, 0,
+                                         (sockaddr *) &to, sizeof (to)),
+                             ssize_t (size), "sendto_ns3 failed");
+      bytes += size;
+    }
+
+  // Two single buffer messages and one made of two iovecs.
+  iovec iov[4] = {{buffer, 300}, {buffer, 400}, {buffer, 200}, {buffer, 50}};
+  mmsghdr messages[3];
+  memset (messages, 0, sizeof (messages));
+  messages[0].msg_hdr.msg_iov = &iov[0];
+  messages[0].msg_hdr.msg_iovlen = 1;
+  messages[1].msg_hdr.msg_iov = &iov[1];
+  messages[1].msg_hdr.msg_iovlen = 1;
+  messages[2].msg_hdr.msg_iov = &iov[2];
+  messages[2].msg_hdr.msg_iovlen = 2;
+  for (mmsghdr &message : messages)
+    {
+      message.msg_hdr.msg_name = &to;
+      message.msg_hdr.msg_namelen = sizeof (to);
+    }
+  NS_TEST_ASSERT_MSG_EQ (sendmmsg_ns3 (m_sender, messages, 3, 0), 3,
+                         "sendmmsg_ns3 did not send the whole batch");
+  bytes += 300 + 400 + 200 + 50;
+
+  const SocketNs3Stats &stats = get_socket_ns3_stats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.packets_created, 6,
+                         "Expected one packet per datagram");
+  NS_TEST_ASSERT_MSG_EQ (stats.bytes_copied, bytes,
+                         "Expected every byte to be copied once");
+  NS_TEST_ASSERT_MSG_EQ (stats.batches_sent, 1, "Expected one batch");
+
+  Simulator::Run ();
+  size_t received = 0;
+  uint64_t receivedBytes = 0;
+  ssize_t n;
+  while ((n = recvfrom_ns3 (m_receiver, buffer, sizeof (buffer), 0,
+                            nullptr, nullptr)) >= 0)
+    {
+      received++;
+      receivedBytes += n;
+    }
+  NS_TEST_ASSERT_MSG_EQ (received, 6, "Not every datagram was delivered");
+  NS_TEST_ASSERT_MSG_EQ (receivedBytes, bytes, "Not every byte was delivered");
 }
 
-// The TestSuite class names the TestSuite, identifies what type of TestSuite,
-// and enables the TestCases to be run.  Typically, only the constructor for
-// this class must be defined
-//
+void
+QuicSocketNs3StatsTestCase::DoTeardown (void)
+{
+  close_ns3 (m_sender);
+  close_ns3 (m_receiver);
+  m_sender = -1;
+  m_receiver = -1;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * Descriptors opened through the socket shim stay with the node that was
+ * current when they were created and can be closed per node, while those
+ * of the applications are closed by the applications themselves when they
+ * are disposed.
+ */
+class QuicSocketNs3TeardownTestCase : public QuicEndToEndTestCase
+{
+public:
+  QuicSocketNs3TeardownTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+QuicSocketNs3TeardownTestCase::QuicSocketNs3TeardownTestCase ()
+  : QuicEndToEndTestCase ("Per-node descriptors of the socket shim",
+                          DataRate ("10Mbps"), MilliSeconds (10))
+{
+}
+
+void
+QuicSocketNs3TeardownTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  InternetStackHelper stack;
+  stack.Install (nodes);
+
+  size_t before = open_sockets_ns3 ();
+  {
+    QuicContext::Scope scope (QuicContext::Get (nodes.Get (0)));
+    socket_ns3 (AF_INET, SOCK_DGRAM, 0);
+    socket_ns3 (AF_INET, SOCK_DGRAM, 0);
+  }
+  {
+    QuicContext::Scope scope (QuicContext::Get (nodes.Get (1)));
+    socket_ns3 (AF_INET, SOCK_DGRAM, 0);
+  }
+  NS_TEST_ASSERT_MSG_EQ (open_sockets_ns3 (), before + 3,
+                         "Expected three more open descriptors");
+
+  NS_TEST_ASSERT_MSG_EQ (close_node_sockets_ns3 (nodes.Get (1)), 1,
+                         "Expected the descriptor of the second node to close");
+  NS_TEST_ASSERT_MSG_EQ (open_sockets_ns3 (), before + 2,
+                         "Closed the descriptors of the wrong node");
+  NS_TEST_ASSERT_MSG_EQ (close_node_sockets_ns3 (nodes.Get (0)), 2,
+                         "Expected the descriptors of the first node to close");
+  Simulator::Destroy ();
+
+  // The server's listening socket and the client's connection socket are
+  // only closed by their owners.
+  Setup (10000, 1, 1, 1, 0.1);
+  Run (Seconds (5), false);
+  NS_TEST_ASSERT_MSG_EQ (m_bytes.size (), 1, "Expected the request to complete");
+  NS_TEST_ASSERT_MSG_GT (open_sockets_ns3 (), before,
+                         "Expected the applications to hold descriptors");
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (open_sockets_ns3 (), before,
+                         "Descriptors outlived their applications");
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * Loss detection from the least packet in flight declares the same packets
+ * lost as a full scan of the unacked packets, at a cost per ack that does
+ * not grow with the window.
+ */
+class QuicLossDetectionBenchmarkTestCase : public TestCase
+{
+public:
+  /**
+   * \param window packets in flight
+   * \param acks acks to process
+   */
+  QuicLossDetectionBenchmarkTestCase (uint32_t window, uint64_t acks);
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_window;
+  uint64_t m_acks;
+};
+
+QuicLossDetectionBenchmarkTestCase::QuicLossDetectionBenchmarkTestCase (uint32_t window,
+                                                                        uint64_t acks)
+  : TestCase ("Loss detection with " + std::to_string (window) + " packets in flight"),
+    m_window (window),
+    m_acks (acks)
+{
+}
+
+void
+QuicLossDetectionBenchmarkTestCase::DoRun (void)
+{
+  QuicLossDetectionBenchmark::Result result =
+    QuicLossDetectionBenchmark::Run (m_window, m_acks, 100);
+  NS_TEST_ASSERT_MSG_GT (result.lost, 0, "No packet was declared lost");
+  NS_TEST_ASSERT_MSG_EQ (result.agree, true,
+                         "The index and the scan declared different packets lost");
+  std::cout << GetName () << ": " << result.acks << " acks, " << result.lost
+            << " lost, " << result.indexedNs << " ns per ack from the least in flight, "
+            << result.scanNs << " ns per ack scanning" << std::endl;
+}
+
+/**
+ * \ingroup quic-test
+ *
+ * End-to-end regression cases run QUICK; the timed performance cases,
+ * which print simulated seconds and events per wall-clock second, and the
+ * loss detection benchmarks, which print ns per ack, run EXTENSIVE:
+ *
+ * \verbatim
+   ./test.py -s quic -f EXTENSIVE -v
+   \endverbatim
+ */
 class QuicTestSuite : public TestSuite
 {
 public:
@@ -57,12 +1204,42 @@ public:
 };
 
 QuicTestSuite::QuicTestSuite ()
-  : TestSuite ("quic", UNIT)
+  : TestSuite ("quic", SYSTEM)
 {
-  // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
-  AddTestCase (new QuicTestCase1, TestCase::QUICK);
+  AddTestCase (new QuicQuantileSketchTestCase, TestCase::QUICK);
+  AddTestCase (new QuicResultsWriterTestCase (false), TestCase::QUICK);
+  AddTestCase (new QuicResultsWriterTestCase (true), TestCase::QUICK);
+  AddTestCase (new QuicRandomTestCase, TestCase::QUICK);
+  AddTestCase (new QuicTransferTestCase (100000, DataRate ("10Mbps"),
+                                         MilliSeconds (10), false),
+               TestCase::QUICK);
+  AddTestCase (new QuicTransferTestCase (1000000, DataRate ("100Mbps"),
+                                         MilliSeconds (1), false),
+               TestCase::QUICK);
+  AddTestCase (new QuicLossyTransferTestCase, TestCase::QUICK);
+  AddTestCase (new QuicZeroRttTestCase, TestCase::QUICK);
+  AddTestCase (new QuicConcurrentConnectionsTestCase (10, 10000, false),
+               TestCase::QUICK);
+  AddTestCase (new QuicNativeSocketTestCase, TestCase::QUICK);
+  AddTestCase (new QuicTransportAttributesTestCase, TestCase::QUICK);
+  AddTestCase (new QuicMaxPacketSizeTestCase (false), TestCase::QUICK);
+  AddTestCase (new QuicMaxPacketSizeTestCase (true), TestCase::QUICK);
+  AddTestCase (new QuicSocketNs3StatsTestCase, TestCase::QUICK);
+  AddTestCase (new QuicSocketNs3TeardownTestCase, TestCase::QUICK);
+
+  // Performance
+  AddTestCase (new QuicTransferTestCase (100000000, DataRate ("1Gbps"),
+                                         MilliSeconds (1), true),
+               TestCase::EXTENSIVE);
+  AddTestCase (new QuicConcurrentConnectionsTestCase (100, 100000, true),
+               TestCase::EXTENSIVE);
+  AddTestCase (new QuicLossDetectionBenchmarkTestCase (1000, 100000),
+               TestCase::EXTENSIVE);
+  AddTestCase (new QuicLossDetectionBenchmarkTestCase (10000, 100000),
+               TestCase::EXTENSIVE);
+  AddTestCase (new QuicLossDetectionBenchmarkTestCase (50000, 20000),
+               TestCase::EXTENSIVE);
 }
 
 // Do not forget to allocate an instance of this TestSuite
 static QuicTestSuite quicTestSuite;
-
@@ -31,7 +31,7 @@
 namespace ns3 {
 
 QuicClientHelper::QuicClientHelper (std::string protocol, Address address, 
-bool zeroRtt, int maxBytes, uint64_t maxPacketSize)
+bool zeroRtt, uint64_t maxBytes, uint64_t maxPacketSize)
 {
   m_factory.SetTypeId ("ns3::QuicClient");
   m_factory.Set ("Protocol", StringValue (protocol));
@@ -41,7 +41,7 @@ bool zeroRtt, int maxBytes, uint64_t maxPacketSize)
   m_factory.Set ("maxPacketSize", UintegerValue(maxPacketSize));
 }
 
-QuicClientHelper::QuicClientHelper (std::string protocol, Address address, bool zeroRtt, int maxBytes)
+QuicClientHelper::QuicClientHelper (std::string protocol, Address address, bool zeroRtt, uint64_t maxBytes)
 {
   m_factory.SetTypeId ("ns3::QuicClient");
   m_factory.Set ("Protocol", StringValue (protocol));
@@ -52,9 +52,9 @@ public:
    * \param zeroRtt a flag to indicate whether or not to start a 0-RTT
    *        connection with the server.
    */
-  QuicClientHelper (std::string protocol, Address address, bool zeroRtt, int maxBytes, uint64_t maxPacketSize);
+  QuicClientHelper (std::string protocol, Address address, bool zeroRtt, uint64_t maxBytes, uint64_t maxPacketSize);
   
-  QuicClientHelper (std::string protocol, Address address, bool zeroRtt, int maxBytes);
+  QuicClientHelper (std::string protocol, Address address, bool zeroRtt, uint64_t maxBytes);
 
   /**
    * Helper function used to set the underlying application attributes,
@@ -33,17 +33,32 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/integer.h"
+#include "ns3/enum.h"
+#include "ns3/pointer.h"
+#include "ns3/string.h"
 #include "ns3/udp-socket-factory.h"
 #include "ns3/quic-header.h"
+#include "ns3/quic-socket-factory.h"
 #include "ns3/quic-stream-frame.h"
 #include "quic-client.h"
+#include "quic-profiler.h"
+#include "quic-random.h"
+#include "helper/socket_ns3.h"
 #include "net/spdy/core/spdy_header_block.h"
+#include "net/quic/core/crypto/crypto_protocol.h"
+#include "net/quic/core/crypto/quic_crypto_client_config.h"
+#include "net/quic/core/quic_connection.h"
 #include "net/quic/platform/api/quic_text_utils.h"
 
 #include "net/tools/quic/quic_simple_client.h"
+#include "net/tools/quic/quic_spdy_client_stream.h"
 
 #include "net/tools/quic/quic_client_message_loop_network_helper.h"
+#include "net/tools/quic/quic_client_ns3_network_helper.h"
+#include "net/quic/chromium/quic_chromium_packet_reader.h"
 using std::string;
+#include <algorithm>
+#include <fstream>
 #include <iostream>
 using std::cout;
 using std::cerr;
@@ -51,7 +66,20 @@ using std::endl;
 using std::stringstream;
 
 namespace ns3 {
-  Time QuicClient::last_time;
+  struct QuicClient::Connection
+  {
+    net::QuicSimpleClient *client;          //!< The connection, owned
+    net::QuicChromiumPacketReader *reader;  //!< Packet reader of client
+    net::QuicClientNs3NetworkHelper *native; //!< Or its native QUIC helper
+    Ptr<Socket> socket;                     //!< Socket read by reader
+    size_t server;                          //!< Index of the server
+    state cur_state;                        //!< Connection state machine
+    std::map<uint32_t, Request> inFlight;   //!< Requests by stream id
+    Time opened;                            //!< Time the connection was opened
+    bool handshakeConfirmed;                //!< Whether Handshake was traced
+    QuicQuantileSketch latency;             //!< Stream latencies, in ns
+    std::unique_ptr<net::QuicConnectionDebugVisitor> tracer; //!< Feeds the traces
+  };
 
   namespace {
 
@@ -85,6 +113,67 @@ namespace ns3 {
         }
     };
 
+    // Hands closed request streams back to the client application.
+    class WorkloadListener : public net::QuicSpdyClientBase::ResponseListener {
+      public:
+        WorkloadListener(QuicClient* app, QuicClient::Connection* connection)
+            : app_(app), connection_(connection) {}
+
+        void OnStreamClosed(net::QuicSpdyClientStream* stream) override {
+          app_->OnRequestClosed(connection_, stream->id(),
+                                stream->response_code(),
+                                stream->body_bytes_received());
+        }
+
+        void OnCompleteResponse(
+            net::QuicStreamId /*id*/,
+            const net::SpdyHeaderBlock& /*response_headers*/,
+            const std::string& /*response_body*/) override {}
+
+        void OnRequestsResent(
+            const std::vector<std::pair<net::QuicStreamId,
+                                        net::QuicSpdyClientStream*>>& streams)
+            override {
+          app_->OnRequestsResent(connection_, streams);
+        }
+
+      private:
+        QuicClient* app_;
+        QuicClient::Connection* connection_;
+    };
+
+    // Feeds the stream frames and the close of one pooled connection to the
+    // trace sources of the client application.
+    class ConnectionTracer : public net::QuicConnectionDebugVisitor {
+      public:
+        ConnectionTracer(QuicClient* app, QuicClient::Connection* connection)
+            : app_(app), connection_(connection) {}
+
+        void OnStreamFrame(const net::QuicStreamFrame& frame) override {
+          app_->OnStreamFrame(connection_, frame.stream_id,
+                              frame.offset + frame.data_length);
+        }
+
+        void OnConnectionClosed(net::QuicErrorCode /*error*/,
+                                const std::string& /*error_details*/,
+                                net::ConnectionCloseSource /*source*/) override {
+          app_->OnConnectionClosed(connection_);
+        }
+
+      private:
+        QuicClient* app_;
+        QuicClient::Connection* connection_;
+    };
+
+    // Connect() may replace the session, and with it the QuicConnection,
+    // so the tracer is attached again after every call.
+    void AttachTracer(QuicClient::Connection* connection) {
+      if (connection->client->session() != nullptr) {
+        connection->client->session()->connection()->set_debug_visitor(
+            connection->tracer.get());
+      }
+    }
+
   } // namespace
 
   NS_LOG_COMPONENT_DEFINE ("QuicClient");
@@ -99,7 +188,10 @@ namespace ns3 {
         .SetGroupName("Applications")
         .AddConstructor<QuicClient> ()
         .AddAttribute ("Protocol",
-            "The type id of the protocol to use for the rx socket.",
+            "The type id of the protocol to use for the rx socket: "
+            "ns3::UdpSocketFactory, or ns3::QuicSocketFactory to hand the "
+            "datagrams to the connections straight from the native QUIC "
+            "sockets of the node's QuicL4Protocol.",
             TypeIdValue (UdpSocketFactory::GetTypeId ()),
             MakeTypeIdAccessor (&QuicClient::m_tid),
             MakeTypeIdChecker ())
@@ -114,19 +206,212 @@ namespace ns3 {
             MakeBooleanAccessor (&QuicClient::m_zeroRtt),
             MakeBooleanChecker ())
         .AddTraceSource ("Rx",
-            "A packet has been received",
+            "A packet has been received, before it is handed to its "
+            "connection",
             MakeTraceSourceAccessor (&QuicClient::m_rxTrace),
             "ns3::Packet::AddressTracedCallback")
         .AddAttribute  ("MaxBytes",
             "Number of bytes to send.",
             UintegerValue (10),
             ns3::MakeUintegerAccessor (&QuicClient::m_maxBytes),
-            ns3::MakeUintegerChecker<unsigned> (uint64_t(1)))
-         .AddAttribute ("maxPacketSize",
-           "MaximumPacketSize in QUIC Protocol",
-            UintegerValue (10),
-            ns3::MakeUintegerAccessor (&QuicClient::m_maxPacketSize),
-            ns3::MakeUintegerChecker<unsigned> ())
+            ns3::MakeUintegerChecker<uint64_t> (1))
+        .AddAttribute ("maxPacketSize",
+            "Initial maximum size of the QUIC packets, UDP payload, of each "
+            "connection. The server adopts it from the first client packet. "
+            "It must fit the path MTU minus the IP and UDP headers; use "
+            "MtuDiscovery to grow packets safely. The client hello needs "
+            "at least 1074 bytes.",
+            UintegerValue (net::kDefaultMaxPacketSize),
+            MakeUintegerAccessor (&QuicClient::m_maxPacketSize),
+            MakeUintegerChecker<uint64_t> (net::kClientHelloMinimumSize
+                                           + net::kClientHelloFramingOverhead,
+                                           net::kMaxPacketSize))
+        .AddAttribute ("MtuDiscovery",
+            "Target of path MTU discovery. Both ends of each connection "
+            "probe with padded packets, which are dropped rather than "
+            "fragmented when larger than the path MTU, and grow their "
+            "packets to the largest probe acknowledged.",
+            EnumValue (MTU_DISCOVERY_NONE),
+            MakeEnumAccessor (&QuicClient::m_mtuDiscovery),
+            MakeEnumChecker (MTU_DISCOVERY_NONE, "None",
+                             MTU_DISCOVERY_LOW, "Low",
+                             MTU_DISCOVERY_HIGH, "High",
+                             MTU_DISCOVERY_JUMBO, "Jumbo"))
+        .AddAttribute ("AckDecimation",
+            "Ack decimation requested from both ends of each connection: "
+            "acks are sent every 1/4 RTT, or 1/8 RTT with the EighthRtt "
+            "modes, or every 10 packets, instead of every second packet. "
+            "The Reordering modes still ack out of order packets at once.",
+            EnumValue (ACK_DECIMATION_NONE),
+            MakeEnumAccessor (&QuicClient::m_ackDecimation),
+            MakeEnumChecker (ACK_DECIMATION_NONE, "None",
+                             ACK_DECIMATION, "Decimation",
+                             ACK_DECIMATION_REORDERING, "DecimationReordering",
+                             ACK_DECIMATION_EIGHTH_RTT, "EighthRtt",
+                             ACK_DECIMATION_EIGHTH_RTT_REORDERING,
+                             "EighthRttReordering"))
+        .AddAttribute ("CongestionControl",
+            "Congestion controller of the client side of each connection. "
+            "Default keeps Cubic, or the one selected by connection "
+            "options.",
+            EnumValue (QUIC_CC_DEFAULT),
+            MakeEnumAccessor (&QuicClient::m_congestionControl),
+            MakeQuicCongestionControlChecker ())
+        .AddAttribute ("InitialCongestionWindow",
+            "Initial congestion window, in packets, of the client side of "
+            "each connection; 0 keeps the default of 32.",
+            UintegerValue (0),
+            MakeUintegerAccessor (&QuicClient::m_initialCongestionWindow),
+            MakeUintegerChecker<uint32_t> ())
+        .AddAttribute ("MaxCongestionWindow",
+            "Maximum congestion window, in packets, of the client side of "
+            "each connection; 0 keeps the default of 2000.",
+            UintegerValue (0),
+            MakeUintegerAccessor (&QuicClient::m_maxCongestionWindow),
+            MakeUintegerChecker<uint32_t> ())
+        .AddAttribute ("StreamFlowControlWindow",
+            "Receive window, in bytes, the client advertises for each "
+            "stream; 0 keeps the default of 6 MB.",
+            UintegerValue (0),
+            MakeUintegerAccessor (&QuicClient::m_streamFlowControlWindow),
+            MakeUintegerChecker<uint32_t> ())
+        .AddAttribute ("SessionFlowControlWindow",
+            "Receive window, in bytes, the client advertises for each "
+            "connection; 0 keeps the default of 15 MB.",
+            UintegerValue (0),
+            MakeUintegerAccessor (&QuicClient::m_sessionFlowControlWindow),
+            MakeUintegerChecker<uint32_t> ())
+        .AddAttribute ("Pacing",
+            "Whether the client paces its packets.",
+            BooleanValue (true),
+            MakeBooleanAccessor (&QuicClient::m_pacing),
+            MakeBooleanChecker ())
+        .AddAttribute ("DrainReads",
+            "Whether to read every queued datagram on each socket wakeup "
+            "instead of a single one.",
+            BooleanValue (true),
+            MakeBooleanAccessor (&QuicClient::m_drainReads),
+            MakeBooleanChecker ())
+        .AddAttribute ("DeterministicRandom",
+            "Whether QUIC connection IDs, nonces and keys are drawn from an "
+            "ns-3 RngStream instead of OS entropy.",
+            BooleanValue (true),
+            MakeBooleanAccessor (&QuicClient::m_deterministicRandom),
+            MakeBooleanChecker ())
+        .AddAttribute ("RandomSeed",
+            "Seed of the QUIC random stream; 0 uses the global RngSeed.",
+            UintegerValue (0),
+            MakeUintegerAccessor (&QuicClient::m_randomSeed),
+            MakeUintegerChecker<uint32_t> ())
+        .AddAttribute ("RandomRun",
+            "Run number of the QUIC random stream; 0 uses the global RngRun.",
+            UintegerValue (0),
+            MakeUintegerAccessor (&QuicClient::m_randomRun),
+            MakeUintegerChecker<uint64_t> ())
+        .AddAttribute ("NullEncryption",
+            "Whether to prefer the null AEAD, which leaves payloads "
+            "unencrypted but keeps the 12-byte tag. Falls back to real "
+            "encryption if the server does not offer it.",
+            BooleanValue (false),
+            MakeBooleanAccessor (&QuicClient::m_nullEncryption),
+            MakeBooleanChecker ())
+        .AddAttribute ("MaxConnections",
+            "Maximum number of connections to each server. New connections "
+            "are opened when the open ones have MaxStreams requests in "
+            "flight.",
+            UintegerValue (1),
+            MakeUintegerAccessor (&QuicClient::m_maxConnections),
+            MakeUintegerChecker<uint32_t> (1))
+        .AddAttribute ("MaxStreams",
+            "Maximum number of requests in flight at once on a connection, "
+            "each on its own stream. Capped by the streams the server "
+            "allows.",
+            UintegerValue (1),
+            MakeUintegerAccessor (&QuicClient::m_maxStreams),
+            MakeUintegerChecker<uint32_t> (1))
+        .AddAttribute ("NumRequests",
+            "Number of requests to generate; 0 keeps generating until the "
+            "application stops.",
+            UintegerValue (1),
+            MakeUintegerAccessor (&QuicClient::m_numRequests),
+            MakeUintegerChecker<uint32_t> ())
+        .AddAttribute ("InterArrival",
+            "A RandomVariableStream giving the seconds between two requests. "
+            "An ExponentialRandomVariable makes arrivals Poisson. Must be "
+            "positive when NumRequests is 0.",
+            StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"),
+            MakePointerAccessor (&QuicClient::m_interArrival),
+            MakePointerChecker <RandomVariableStream>())
+        .AddAttribute ("ResponseSize",
+            "A RandomVariableStream giving the response bytes of each "
+            "request. If unset, every request asks for MaxBytes.",
+            PointerValue (),
+            MakePointerAccessor (&QuicClient::m_responseSize),
+            MakePointerChecker <RandomVariableStream>())
+        .AddAttribute ("OnTime",
+            "A RandomVariableStream giving the seconds of an on period, "
+            "which must be positive. Only used together with OffTime.",
+            StringValue ("ns3::ConstantRandomVariable[Constant=1.0]"),
+            MakePointerAccessor (&QuicClient::m_onTime),
+            MakePointerChecker <RandomVariableStream>())
+        .AddAttribute ("OffTime",
+            "A RandomVariableStream giving the seconds of an off period, "
+            "during which no requests are generated. If unset, the client "
+            "is always on.",
+            PointerValue (),
+            MakePointerAccessor (&QuicClient::m_offTime),
+            MakePointerChecker <RandomVariableStream>())
+        .AddAttribute ("RequestTrace",
+            "File of \"<seconds> <bytes>\" lines, one request each, with "
+            "times relative to the end of the handshake. Overrides "
+            "NumRequests, InterArrival, ResponseSize and OnTime/OffTime.",
+            StringValue (""),
+            MakeStringAccessor (&QuicClient::m_requestTrace),
+            MakeStringChecker ())
+        .AddTraceSource ("RequestComplete",
+            "A request completed",
+            MakeTraceSourceAccessor (&QuicClient::m_requestCompleteTrace),
+            "ns3::QuicClient::RequestCompleteCallback")
+        .AddAttribute ("GoodputInterval",
+            "Period of the Goodput samples; zero disables them.",
+            TimeValue (Seconds (0)),
+            MakeTimeAccessor (&QuicClient::m_goodputInterval),
+            MakeTimeChecker ())
+        .AddTraceSource ("StreamComplete",
+            "The stream of a request closed; the latency is measured from "
+            "sending the request, so it leaves out queueing for a stream",
+            MakeTraceSourceAccessor (&QuicClient::m_streamCompleteTrace),
+            "ns3::QuicClient::RequestCompleteCallback")
+        .AddTraceSource ("FirstByte",
+            "The first response byte of a request arrived",
+            MakeTraceSourceAccessor (&QuicClient::m_firstByteTrace),
+            "ns3::QuicClient::FirstByteCallback")
+        .AddTraceSource ("Handshake",
+            "The handshake of a connection was confirmed",
+            MakeTraceSourceAccessor (&QuicClient::m_handshakeTrace),
+            "ns3::QuicClient::HandshakeCallback")
+        .AddAttribute ("PercentileInterval",
+            "Period of the Percentiles reports; zero disables them.",
+            TimeValue (Seconds (0)),
+            MakeTimeAccessor (&QuicClient::m_percentileInterval),
+            MakeTimeChecker ())
+        .AddTraceSource ("Percentiles",
+            "p50, p99 and p99.9 of the stream latencies and throughputs "
+            "over the last PercentileInterval",
+            MakeTraceSourceAccessor (&QuicClient::m_percentilesTrace),
+            "ns3::QuicClient::PercentilesCallback")
+        .AddTraceSource ("Goodput",
+            "Goodput over the last GoodputInterval, in bits/s",
+            MakeTraceSourceAccessor (&QuicClient::m_goodputTrace),
+            "ns3::QuicClient::GoodputBitRateCallback")
+        .AddTraceSource ("ConnectionClosed",
+            "A connection closed",
+            MakeTraceSourceAccessor (&QuicClient::m_connectionClosedTrace),
+            "ns3::QuicConnectionSummary::TracedCallback")
+        .AddTraceSource ("PacketsPerWakeup",
+            "Number of packets read in one socket wakeup",
+            MakeTraceSourceAccessor (&QuicClient::m_packetsPerWakeupTrace),
+            "ns3::TracedValueCallback::Uint32")
         ;
       return tid;
     }
@@ -136,6 +421,15 @@ namespace ns3 {
     NS_LOG_FUNCTION (this);
     m_socket = 0;
     m_totalRx = 0;
+    m_readWakeups = 0;
+    m_packetsRead = 0;
+    m_nextServer = 0;
+    m_connectionsOpened = 0;
+    m_workloadStarted = false;
+    m_goodputBytes = 0;
+    m_traceIndex = 0;
+    m_requestsGenerated = 0;
+    m_requestsCompleted = 0;
   }
 
   QuicClient::~QuicClient ()
@@ -149,6 +443,58 @@ namespace ns3 {
     return m_totalRx;
   }
 
+  uint64_t QuicClient::GetReadWakeups () const
+  {
+    return m_readWakeups;
+  }
+
+  uint64_t QuicClient::GetPacketsRead () const
+  {
+    return m_packetsRead;
+  }
+
+  uint64_t QuicClient::GetRequestsCompleted () const
+  {
+    return m_requestsCompleted;
+  }
+
+  uint64_t QuicClient::GetConnectionsOpened () const
+  {
+    return m_connectionsOpened;
+  }
+
+  const QuicQuantileSketch &QuicClient::GetLatencySketch () const
+  {
+    return m_latency;
+  }
+
+  const QuicQuantileSketch &QuicClient::GetThroughputSketch () const
+  {
+    return m_throughput;
+  }
+
+  void QuicClient::AddServer (Address address)
+  {
+    NS_LOG_FUNCTION (this << address);
+    m_extraServers.push_back (address);
+  }
+
+  int64_t
+    QuicClient::AssignStreams (int64_t stream)
+    {
+      NS_LOG_FUNCTION (this << stream);
+      int64_t assigned = 0;
+      for (Ptr<RandomVariableStream> rv : {m_interArrival, m_responseSize,
+                                           m_onTime, m_offTime})
+        {
+          if (rv)
+            {
+              rv->SetStream (stream + assigned++);
+            }
+        }
+      return assigned;
+    }
+
   Ptr<Socket>
     QuicClient::GetListeningSocket (void) const
     {
@@ -159,130 +505,705 @@ namespace ns3 {
   void QuicClient::DoDispose (void)
   {
     NS_LOG_FUNCTION (this);
+    // Nothing may be sent on the network any more.
+    CloseConnections (/*silent=*/true);
+    m_servers.clear ();
+    m_cryptoConfig.reset ();
     m_socket = 0;
+    m_context = 0;
+    m_interArrival = 0;
+    m_responseSize = 0;
+    m_onTime = 0;
+    m_offTime = 0;
 
     // chain up
     Application::DoDispose ();
   }
 
-  base::AtExitManager *QuicClient::exit_manager = nullptr;
-  base::MessageLoopForIO *QuicClient::message_loop = nullptr;
-
   // Application Methods
   void QuicClient::StartApplication ()    // Called at time specified by Start
   {
     NS_LOG_FUNCTION (this);
-    //cerr << "Client Start (MaxBytes " << m_maxBytes << ")" << endl;
-    cur_state = CONNECT_LOOP;
 
-    kCurNode = GetNode();
+    QuicContext::EnsureMessageLoop ();
+    if (m_deterministicRandom)
+      {
+        QuicRngStreamRandom::Install (m_randomSeed, m_randomRun);
+      }
+    m_context = QuicContext::Get (GetNode ());
 
-    if(!exit_manager) exit_manager = new base::AtExitManager;
-    if(!message_loop) message_loop = new base::MessageLoopForIO;
+    m_cryptoConfig.reset (new net::QuicCryptoClientConfig (
+        std::unique_ptr<ProofVerifier> (new FakeProofVerifier ())));
+    if (m_nullEncryption)
+      {
+        m_cryptoConfig->aead = {net::kNULN, net::kCC20, net::kAESG};
+      }
 
+    m_servers.clear ();
+    m_servers.resize (1 + m_extraServers.size ());
+    m_servers[0].address = m_serverAddress;
+    for (size_t i = 0; i < m_extraServers.size (); i++)
+      {
+        m_servers[i + 1].address = m_extraServers[i];
+      }
+    m_nextServer = 0;
 
+    if (!m_goodputInterval.IsZero ())
+      {
+        m_goodputBytes = 0;
+        m_goodputEvent = Simulator::Schedule (m_goodputInterval,
+                                              &QuicClient::SampleGoodput, this);
+      }
+    if (!m_percentileInterval.IsZero ())
+      {
+        m_intervalLatency.Reset ();
+        m_intervalThroughput.Reset ();
+        m_percentileEvent = Simulator::Schedule (m_percentileInterval,
+                                                 &QuicClient::ReportPercentiles, this);
+      }
 
-    net::QuicIpAddress ip_addr;
-    uint8_t buffer_tmp[Address::MAX_SIZE];
-    int len = m_serverAddress.CopyTo(buffer_tmp);
-    stringstream str;
-    for(int i = 0; i < 4; i++) {
-      str << int(buffer_tmp[i]);
-      if(i < 3) str << '.';
-    }
-    string buffer = str.str();
+    // The first connection is opened right away to start the handshake.
+    OpenConnection (0);
+  }
 
-    if(!ip_addr.FromString(buffer)) {
-      exit(13);
+  void QuicClient::StopApplication ()     // Called at time specified by Stop
+  {
+    NS_LOG_FUNCTION (this);
+    Simulator::Cancel (m_requestEvent);
+    Simulator::Cancel (m_goodputEvent);
+    Simulator::Cancel (m_percentileEvent);
+    for (Server &server : m_servers)
+      {
+        server.pending.clear ();
+      }
+    CloseConnections (/*silent=*/false);
+    if (m_socket)
+    {
+      m_socket->Close ();
+      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
     }
+  }
 
-    InetSocketAddress addr = InetSocketAddress::ConvertFrom(m_serverAddress);
+  void QuicClient::OpenConnection (size_t index)
+  {
+    NS_LOG_FUNCTION (this << index);
+    QuicContext::Scope scope (m_context);
+    Server &server = m_servers[index];
 
-    net::QuicServerId server_id(buffer, addr.GetPort(), net::PRIVACY_MODE_DISABLED);
+    InetSocketAddress addr = InetSocketAddress::ConvertFrom (server.address);
+    stringstream str;
+    addr.GetIpv4 ().Print (str);
+    string host = str.str ();
 
-    net::QuicVersionVector versions = net::AllSupportedVersions();
-    std::unique_ptr<ProofVerifier> proof_verifier;
-    proof_verifier.reset(new FakeProofVerifier());
+    net::QuicIpAddress ip_addr;
+    if (!ip_addr.FromString (host))
+      {
+        NS_FATAL_ERROR ("Bad server address " << host);
+      }
+    net::QuicServerId server_id (host, addr.GetPort (), net::PRIVACY_MODE_DISABLED);
 
-    client = new net::QuicSimpleClient(net::QuicSocketAddress(ip_addr, addr.GetPort()), server_id, versions, std::move(proof_verifier));
-    client->set_initial_max_packet_length(net::kDefaultMaxPacketSize); // aghax
-    std::cout<<net::kDefaultMaxPacketSize<<std::endl;
-    //client->set_initial_max_packet_length(m_maxPacketSize); // aghax
+    Connection *connection = new Connection;
+    connection->server = index;
+    connection->cur_state = CONNECT_LOOP;
+    connection->opened = Simulator::Now ();
+    connection->handshakeConfirmed = false;
+    connection->reader = nullptr;
+    connection->native = nullptr;
+    connection->tracer.reset (new ConnectionTracer (this, connection));
+    if (m_tid == QuicSocketFactory::GetTypeId ())
+      {
+        connection->client = new net::QuicSimpleClient (
+            net::QuicSocketAddress (ip_addr, addr.GetPort ()), server_id,
+            net::AllSupportedVersions (), m_cryptoConfig.get (),
+            m_context->CreateConnectionHelper (), m_context->CreateAlarmFactory (),
+            m_context->GetClock (), GetNode ());
+      }
+    else
+      {
+        connection->client = new net::QuicSimpleClient (
+            net::QuicSocketAddress (ip_addr, addr.GetPort ()), server_id,
+            net::AllSupportedVersions (), m_cryptoConfig.get (),
+            m_context->CreateConnectionHelper (), m_context->CreateAlarmFactory (),
+            m_context->GetClock ());
+      }
+    connection->client->set_initial_max_packet_length (m_maxPacketSize);
+    net::QuicTagVector options;
+    switch (m_mtuDiscovery)
+      {
+      case MTU_DISCOVERY_LOW:
+        options.push_back (net::kMTUL);
+        break;
+      case MTU_DISCOVERY_HIGH:
+        options.push_back (net::kMTUH);
+        break;
+      case MTU_DISCOVERY_JUMBO:
+        options.push_back (net::kMTUJ);
+        break;
+      default:
+        break;
+      }
+    switch (m_ackDecimation)
+      {
+      case ACK_DECIMATION:
+        options.push_back (net::kACKD);
+        break;
+      case ACK_DECIMATION_REORDERING:
+        options.push_back (net::kAKD2);
+        break;
+      case ACK_DECIMATION_EIGHTH_RTT:
+        options.push_back (net::kAKD3);
+        break;
+      case ACK_DECIMATION_EIGHTH_RTT_REORDERING:
+        options.push_back (net::kAKD4);
+        break;
+      default:
+        break;
+      }
+    if (!options.empty ())
+      {
+        connection->client->config ()->SetConnectionOptionsToSend (options);
+      }
+    QuicTransportConfig transport = {
+      m_congestionControl, m_initialCongestionWindow, m_maxCongestionWindow,
+      m_streamFlowControlWindow, m_sessionFlowControlWindow, m_pacing
+    };
+    transport.Apply (connection->client->config ());
 
-    if(!client->Initialize()) {
-      cerr << "FAIL" << endl;
-      exit(1);
-    }
-    dynamic_cast<net::QuicClientMessageLooplNetworkHelper*>(client->network_helper())->packet_reader_->client_ = this;
+    if (!connection->client->Initialize ())
+      {
+        NS_FATAL_ERROR ("Cannot initialize a QUIC connection to " << host);
+      }
+    connection->client->set_response_listener (
+        std::unique_ptr<net::QuicSpdyClientBase::ResponseListener> (
+            new WorkloadListener (this, connection)));
+    connection->native = dynamic_cast<net::QuicClientNs3NetworkHelper*>(
+        connection->client->network_helper ());
+    if (connection->native)
+      {
+        // Nobody else reads the native socket: watch it from the start.
+        connection->socket = connection->native->socket ();
+        m_sockets[connection->socket] = connection;
+        connection->socket->SetRecvCallback (MakeCallback (&QuicClient::HandleRead, this));
+      }
+    else
+      {
+        connection->reader = dynamic_cast<net::QuicClientMessageLooplNetworkHelper*>(
+            connection->client->network_helper ())->packet_reader_.get ();
+        connection->reader->client_ = this;
+        m_readers[connection->reader] = connection;
+      }
+    server.connections.push_back (connection);
+    m_connectionsOpened++;
 
+    NS_LOG_INFO ("Opening connection " << server.connections.size ()
+                 << " to " << host);
+    bool ready = connection->client->Connect ();
+    AttachTracer (connection);
+    if (ready)
+      {
+        // Resumed with a server config cached by another connection: the
+        // requests can go out in the first flight.
+        connection->client->FinishConnect ();
+        connection->cur_state = SEND_REQUEST;
+        Simulator::ScheduleNow (&QuicClient::SendRequest, this);
+      }
+  }
 
-    client->Connect();
+  void QuicClient::WatchSocket (Ptr<Socket> socket,
+                                net::QuicChromiumPacketReader *reader)
+  {
+    auto it = m_readers.find (reader);
+    NS_ASSERT (it != m_readers.end ());
+    it->second->socket = socket;
+    m_sockets[socket] = it->second;
+    socket->SetRecvCallback (MakeCallback (&QuicClient::HandleRead, this));
   }
 
-  void QuicClient::StopApplication ()     // Called at time specified by Stop
+  void QuicClient::ReapConnections ()
   {
     NS_LOG_FUNCTION (this);
-    if (m_socket)
-    {
-      m_socket->Close ();
-      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
-    }
+    QuicContext::Scope scope (m_context);
+    for (Server &server : m_servers)
+      {
+        auto &connections = server.connections;
+        for (auto it = connections.begin (); it != connections.end (); )
+          {
+            Connection *connection = *it;
+            if (connection->cur_state != AFTER)
+              {
+                ++it;
+                continue;
+              }
+            NS_LOG_INFO ("Removing closed connection to server " << connection->server);
+            m_readers.erase (connection->reader);
+            if (connection->socket)
+              {
+                connection->socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+                m_sockets.erase (connection->socket);
+              }
+            delete connection->client;
+            delete connection;
+            it = connections.erase (it);
+          }
+      }
+    // Requests that were waiting on the closed connections need new ones.
+    SendRequest ();
+  }
+
+  void QuicClient::CloseConnections (bool silent)
+  {
+    NS_LOG_FUNCTION (this << silent);
+    Simulator::Cancel (m_reapEvent);
+    if (!m_context)
+      {
+        return;
+      }
+    QuicContext::Scope scope (m_context);
+    for (Server &server : m_servers)
+      {
+        for (Connection *connection : server.connections)
+          {
+            // Closing the connection closes its streams; the requests on
+            // them are abandoned rather than reported.
+            connection->inFlight.clear ();
+            if (connection->socket)
+              {
+                connection->socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+              }
+            if (silent && connection->client->session () != nullptr)
+              {
+                // Nothing is traced while the application is disposed.
+                connection->client->session ()->connection ()->set_debug_visitor (nullptr);
+              }
+            if (silent && connection->client->connected ())
+              {
+                connection->client->session ()->connection ()->CloseConnection (
+                    net::QUIC_PEER_GOING_AWAY, "Shutting down",
+                    net::ConnectionCloseBehavior::SILENT_CLOSE);
+              }
+            delete connection->client;
+            delete connection;
+          }
+        server.connections.clear ();
+      }
+    m_readers.clear ();
+    m_sockets.clear ();
+  }
+
+  void QuicClient::LoadRequestTrace ()
+  {
+    NS_LOG_FUNCTION (this);
+    std::ifstream in (m_requestTrace.c_str ());
+    if (!in)
+      {
+        NS_FATAL_ERROR ("Cannot open request trace " << m_requestTrace);
+      }
+    m_trace.clear ();
+    double seconds;
+    uint64_t bytes;
+    while (in >> seconds >> bytes)
+      {
+        m_trace.push_back (std::make_pair (Seconds (seconds), bytes));
+      }
+    if (!in.eof ())
+      {
+        NS_FATAL_ERROR ("Malformed request trace " << m_requestTrace
+                        << " after " << m_trace.size () << " entries");
+      }
+    std::stable_sort (m_trace.begin (), m_trace.end (),
+                      [] (const std::pair<Time, uint64_t> &a,
+                          const std::pair<Time, uint64_t> &b)
+                      { return a.first < b.first; });
+  }
+
+  void QuicClient::StartWorkload ()
+  {
+    NS_LOG_FUNCTION (this);
+    m_workloadStarted = true;
+    if (!m_requestTrace.empty ())
+      {
+        LoadRequestTrace ();
+        m_traceStart = Simulator::Now ();
+        m_traceIndex = 0;
+        if (!m_trace.empty ())
+          {
+            m_requestEvent = Simulator::Schedule (m_trace.front ().first,
+                                                  &QuicClient::NextTraceRequest, this);
+          }
+        return;
+      }
+    if (m_offTime)
+      {
+        m_onEnd = Simulator::Now () + NextOnPeriod ();
+      }
+    // The first request goes out right away.
+    m_requestEvent = Simulator::ScheduleNow (&QuicClient::ScheduleNextRequest, this);
+  }
+
+  void QuicClient::ScheduleNextRequest ()
+  {
+    NS_LOG_FUNCTION (this);
+    if (m_numRequests != 0 && m_requestsGenerated >= m_numRequests)
+      {
+        return;
+      }
+    uint64_t bytes = m_maxBytes;
+    if (m_responseSize)
+      {
+        bytes = std::max<uint64_t> (1, m_responseSize->GetInteger ());
+      }
+    GenerateRequest (bytes);
+
+    double gap = m_interArrival->GetValue ();
+    if (m_numRequests == 0 && gap <= 0)
+      {
+        // Simulated time would never move past this instant.
+        NS_FATAL_ERROR ("InterArrival must be positive when NumRequests is 0, "
+                        "got " << gap);
+      }
+    Time next = Simulator::Now () + Seconds (std::max (gap, 0.0));
+    if (m_offTime)
+      {
+        // Arrivals past the end of the on period slide into the next one,
+        // keeping whatever of the gap is left over.
+        while (next > m_onEnd)
+          {
+            Time off = Seconds (std::max (m_offTime->GetValue (), 0.0));
+            next += off;
+            m_onEnd += off + NextOnPeriod ();
+          }
+      }
+    m_requestEvent = Simulator::Schedule (next - Simulator::Now (),
+                                          &QuicClient::ScheduleNextRequest, this);
+  }
+
+  Time QuicClient::NextOnPeriod ()
+  {
+    NS_LOG_FUNCTION (this);
+    double on = m_onTime->GetValue ();
+    if (on <= 0)
+      {
+        NS_FATAL_ERROR ("OnTime must be positive, got " << on);
+      }
+    // Periods shorter than the time resolution still move the end forward.
+    return std::max (Seconds (on), TimeStep (1));
+  }
+
+  void QuicClient::NextTraceRequest ()
+  {
+    NS_LOG_FUNCTION (this);
+    GenerateRequest (m_trace[m_traceIndex++].second);
+    if (m_traceIndex < m_trace.size ())
+      {
+        Time at = m_traceStart + m_trace[m_traceIndex].first;
+        m_requestEvent = Simulator::Schedule (at - Simulator::Now (),
+                                              &QuicClient::NextTraceRequest, this);
+      }
+  }
+
+  void QuicClient::GenerateRequest (uint64_t responseBytes)
+  {
+    NS_LOG_FUNCTION (this << responseBytes);
+    Request request;
+    request.id = m_requestsGenerated++;
+    request.responseBytes = responseBytes;
+    request.generated = Simulator::Now ();
+    m_servers[m_nextServer].pending.push_back (request);
+    m_nextServer = (m_nextServer + 1) % m_servers.size ();
+    SendRequest ();
   }
 
-  void QuicClient::SendRequest() {
+  void QuicClient::SendRequest ()
+  {
     using net::SpdyHeaderBlock;
-    // Construct the string body from flags, if provided.
-    string body = "";
+    QuicContext::Scope scope (m_context);
+    for (size_t index = 0; index < m_servers.size (); index++)
+      {
+        Server &server = m_servers[index];
+        size_t connecting = 0;
+        for (Connection *connection : server.connections)
+          {
+            if (connection->cur_state == CONNECT_LOOP)
+              {
+                connecting++;
+                continue;
+              }
+            if (connection->cur_state != SEND_REQUEST
+                || !connection->client->connected ())
+              {
+                continue;
+              }
+            net::QuicSimpleClient *client = connection->client;
+            size_t limit = std::min<size_t> (m_maxStreams,
+                client->session ()->max_open_outgoing_streams ());
+            while (!server.pending.empty () && connection->inFlight.size () < limit)
+              {
+                const Request &request = server.pending.front ();
+                SpdyHeaderBlock header_block;
+                header_block["max_bytes"] = net::QuicTextUtils::Uint64ToString (request.responseBytes);
 
-    // Construct a GET or POST request for supplied URL.
-    SpdyHeaderBlock header_block;
-    header_block["max_bytes"] = net::QuicTextUtils::Uint64ToString(m_maxBytes);
+                net::QuicSpdyClientStream *stream =
+                  client->SendRequestOnNewStream (header_block, "", /*fin=*/true);
+                if (stream == nullptr)
+                  {
+                    // Out of streams for now; retried when a request completes.
+                    break;
+                  }
+                // Only the size of the body matters, so do not keep it around.
+                stream->set_store_body (false);
+                Request sent = request;
+                sent.sent = Simulator::Now ();
+                sent.received = 0;
+                NS_LOG_INFO ("Request " << request.id << " for " << request.responseBytes
+                             << " bytes on stream " << stream->id ());
+                connection->inFlight[stream->id ()] = sent;
+                server.pending.pop_front ();
+              }
+          }
 
+        // Whatever the connections being set up cannot take gets new ones.
+        while (server.pending.size () > connecting * m_maxStreams
+               && server.connections.size () < m_maxConnections)
+          {
+            OpenConnection (index);
+            connecting++;
+          }
+      }
+  }
+
+  void QuicClient::OnRequestClosed (Connection *connection, uint32_t streamId,
+                                    int status, uint64_t bytes)
+  {
+    NS_LOG_FUNCTION (this << connection << streamId << status << bytes);
+    auto it = connection->inFlight.find (streamId);
+    if (it == connection->inFlight.end ())
+      {
+        return;
+      }
+    Request request = it->second;
+    connection->inFlight.erase (it);
+    m_totalRx += bytes;
+    m_requestsCompleted++;
+    if (status != 200 || bytes != request.responseBytes)
+      {
+        NS_LOG_WARN ("Request " << request.id << " closed with status " << status
+                     << " after " << bytes << " of " << request.responseBytes << " bytes");
+      }
+    Time latency = Simulator::Now () - request.sent;
+    double latencyNs = latency.GetNanoSeconds ();
+    double throughput = latency.IsStrictlyPositive ()
+      ? bytes * 8 / latency.GetSeconds () : 0;
+    connection->latency.Add (latencyNs);
+    m_latency.Add (latencyNs);
+    m_throughput.Add (throughput);
+    if (!m_percentileInterval.IsZero ())
+      {
+        m_intervalLatency.Add (latencyNs);
+        m_intervalThroughput.Add (throughput);
+      }
+    m_streamCompleteTrace (request.id, bytes, latency);
+    m_requestCompleteTrace (request.id, bytes, Simulator::Now () - request.generated);
+    // The stream is still being closed; open the next one from a fresh event.
+    if (!m_servers[connection->server].pending.empty ())
+      {
+        Simulator::ScheduleNow (&QuicClient::SendRequest, this);
+      }
+  }
 
-    // Make sure to store the response, for later output.
-    client->set_store_response(true);
+  void QuicClient::OnRequestsResent (Connection *connection,
+                                     const std::vector<std::pair<uint32_t, net::QuicSpdyClientStream *> > &streams)
+  {
+    NS_LOG_FUNCTION (this << connection << streams.size ());
+    // The new stream ids may be ids of the old session, so every request is
+    // taken out before any is put back.
+    std::map<uint32_t, Request> resent;
+    for (const auto &entry : streams)
+      {
+        auto it = connection->inFlight.find (entry.first);
+        if (it != connection->inFlight.end ())
+          {
+            resent[entry.first] = it->second;
+            connection->inFlight.erase (it);
+          }
+      }
+    for (const auto &entry : streams)
+      {
+        auto it = resent.find (entry.first);
+        if (it == resent.end ())
+          {
+            continue;
+          }
+        Request request = it->second;
+        // The old session's data is gone; the response starts over.
+        request.received = 0;
+        entry.second->set_store_body (false);
+        NS_LOG_INFO ("Request " << request.id << " resent on stream "
+                     << entry.second->id () << " instead of " << entry.first);
+        connection->inFlight[entry.second->id ()] = request;
+      }
+  }
 
-    // Send the request.
-    if(client->SendRequestAndWaitForResponse(header_block, body, /*fin=*/true))
-      cur_state = SEND_REQUEST;
-    else
-      cur_state = AFTER;
+  void QuicClient::OnStreamFrame (Connection *connection, uint32_t streamId,
+                                  uint64_t end)
+  {
+    auto it = connection->inFlight.find (streamId);
+    if (it == connection->inFlight.end ())
+      {
+        // The headers stream, or a request already accounted for.
+        return;
+      }
+    Request &request = it->second;
+    if (request.received == 0 && end > 0)
+      {
+        m_firstByteTrace (request.id, Simulator::Now () - request.sent);
+      }
+    if (end > request.received)
+      {
+        // Retransmitted data is not counted twice.
+        m_goodputBytes += end - request.received;
+        request.received = end;
+      }
+  }
+
+  void QuicClient::OnConnectionClosed (Connection *connection)
+  {
+    NS_LOG_FUNCTION (this << connection);
+    net::QuicConnection *quicConnection = connection->client->session ()->connection ();
+    QuicConnectionSummary summary = QuicConnectionSummary::FromStats (
+        quicConnection->GetStats (), m_context->GetClock ());
+    summary.streams = connection->latency.GetCount ();
+    summary.streamLatencyP50 = NanoSeconds (connection->latency.GetQuantile (0.5));
+    summary.streamLatencyP99 = NanoSeconds (connection->latency.GetQuantile (0.99));
+    summary.streamLatencyP999 = NanoSeconds (connection->latency.GetQuantile (0.999));
+    m_connectionClosedTrace (summary);
+  }
+
+  void QuicClient::SampleGoodput ()
+  {
+    m_goodputTrace (m_goodputBytes * 8 / m_goodputInterval.GetSeconds ());
+    m_goodputBytes = 0;
+    m_goodputEvent = Simulator::Schedule (m_goodputInterval,
+                                          &QuicClient::SampleGoodput, this);
+  }
+
+  void QuicClient::ReportPercentiles ()
+  {
+    m_percentilesTrace (QuicPercentiles::FromSketch (m_intervalLatency),
+                        QuicPercentiles::FromSketch (m_intervalThroughput));
+    m_intervalLatency.Reset ();
+    m_intervalThroughput.Reset ();
+    m_percentileEvent = Simulator::Schedule (m_percentileInterval,
+                                             &QuicClient::ReportPercentiles, this);
   }
 
   void QuicClient::HandleRead (Ptr<Socket> socket)
   {
-    std::default_random_engine generator;
-    std::poisson_distribution<int> distribution(m_maxPacketSize);
-    socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+    auto it = m_sockets.find (socket);
+    if (it == m_sockets.end () || socket->GetRxAvailable () == 0)
+      {
+        // A yielded wakeup whose queue was already drained, or whose
+        // connection was removed meanwhile.
+        return;
+      }
+    Connection *connection = it->second;
+    if (connection->reader)
+      {
+        // The reader watches the socket again once it is done with a packet.
+        socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+      }
     NS_LOG_FUNCTION (this << socket);
+    QUIC_PROFILE_SCOPE (APPLICATION);
     //cerr << "QuicClient::HandleRead()" << endl;
-    last_time = Simulator::Now();
+    QuicContext::Scope scope (m_context);
 
-    net::QuicChromiumPacketReader *pktrd = dynamic_cast<net::QuicClientMessageLooplNetworkHelper*>(client->network_helper())->packet_reader_.get();
+    net::QuicChromiumPacketReader *pktrd = connection->reader;
 
-    int ret = socket->Recv(reinterpret_cast<uint8_t*>(pktrd->read_buffer_->data()), pktrd->read_buffer_->size(), 0);
-    //cerr << "Read " << ret << " bytes (return val " << ret << ")" << endl;
+    // Simulated time does not advance while draining, so in practice the
+    // packet budget is what bounds a single wakeup.
+    Time yieldAfter = Simulator::Now () + MilliSeconds (net::kQuicYieldAfterDurationMilliseconds);
+    uint32_t packets = 0;
+    do
+      {
+        packets++;
+        Address from;
+        Ptr<Packet> packet;
+        {
+          QUIC_PROFILE_SCOPE (NS3_SOCKET);
+          packet = socket->RecvFrom (from);
+        }
+        m_rxTrace (packet, from);
+        if (connection->native)
+          {
+            connection->native->ProcessPacket (packet, from);
+          }
+        else
+          {
+            int ret = packet->CopyData(reinterpret_cast<uint8_t*>(pktrd->read_buffer_->data()), pktrd->read_buffer_->size());
+            //cerr << "Read " << ret << " bytes (return val " << ret << ")" << endl;
+            pktrd->OnReadComplete(ret);
+          }
+        AdvanceState (connection);
+      }
+    while (m_drainReads && socket->GetRxAvailable () > 0
+           && packets < uint32_t (net::kQuicYieldAfterPacketsRead)
+           && Simulator::Now () <= yieldAfter);
+
+    m_readWakeups++;
+    m_packetsRead += packets;
+    m_packetsPerWakeupTrace (packets);
 
+    if (m_drainReads && socket->GetRxAvailable () > 0)
+      {
+        // Out of budget: yield to the scheduler and pick up the rest of the
+        // queue in a fresh event, like the packet reader's PostTask().
+        Simulator::ScheduleNow (&QuicClient::HandleRead, this, socket);
+      }
+  }
 
-    pktrd->OnReadComplete(ret);
-    if(cur_state == CONNECT_LOOP) {
+  void QuicClient::AdvanceState (Connection *connection)
+  {
+    net::QuicSimpleClient *client = connection->client;
+    if(connection->cur_state == CONNECT_LOOP) {
       if (client->EncryptionBeingEstablished())
         client->WaitForEvents();
       else {
-        if (client->ConnectLogic())
+        if (client->ConnectLogic()) {
           client->Connect();
-        else { 
-          client->FinishConnect();
-          std::cout << m_maxPacketSize << std::endl;
-          //Simulator::Schedule(MicroSeconds(m_maxPacketSize), &QuicClient::SendRequest,  this);
-          Simulator::Schedule(MicroSeconds(distribution(generator)), &QuicClient::SendRequest,  this);
-          //SendRequest();
+          AttachTracer(connection);
         }
+        else if (client->FinishConnect()) {
+          connection->cur_state = SEND_REQUEST;
+          if (!m_workloadStarted)
+            StartWorkload();
+          else
+            SendRequest();
+        } else
+          connection->cur_state = AFTER;
       }
-    } else if(cur_state == SEND_REQUEST) {
-      if(!client->WaitForEvents())
-        cur_state = AFTER;
+    } else if(connection->cur_state == SEND_REQUEST) {
+      // Keep going while idle between requests; only a closed connection
+      // ends it.
+      if(!client->connected())
+        connection->cur_state = AFTER;
+      else
+        client->WaitForEvents();
     }
+    if (!connection->handshakeConfirmed && client->connected()
+        && client->session()->IsCryptoHandshakeConfirmed())
+      {
+        connection->handshakeConfirmed = true;
+        // A full handshake takes an inchoate and a full client hello.
+        bool zeroRtt = client->GetNumSentClientHellos() <= 1;
+        NS_LOG_INFO ("Handshake confirmed after "
+                     << (Simulator::Now () - connection->opened).As (Time::MS)
+                     << (zeroRtt ? " (0-RTT)" : " (1-RTT)"));
+        m_handshakeTrace (Simulator::Now () - connection->opened, zeroRtt);
+      }
+    if (connection->cur_state == AFTER && !m_reapEvent.IsRunning ())
+      {
+        // The connection is still on the stack; delete it from a fresh event.
+        m_reapEvent = Simulator::ScheduleNow (&QuicClient::ReapConnections, this);
+      }
   }
 
   void
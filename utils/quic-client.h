@@ -26,13 +26,25 @@
 #include "ns3/ptr.h"
 #include "ns3/traced-callback.h"
 #include "ns3/address.h"
-#include <random>
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
-#include "base/at_exit.h"
-#include "base/message_loop/message_loop.h"
+#include "quic-connection-summary.h"
+#include "quic-context.h"
+#include "quic-quantile-sketch.h"
+#include "quic-transport-config.h"
 
 namespace net {
+  class QuicChromiumPacketReader;
+  class QuicCryptoClientConfig;
   class QuicSimpleClient;
+  class QuicSpdyClientStream;
 }
 using net::QuicSimpleClient;
 
@@ -63,8 +75,31 @@ enum state {
  * \brief A client that requests bytes from a server using the QUIC protocol
  * as transport.
  *
- * TODO: Rewrite this once things are working
+ * The client runs a request workload over a pool of connections.
+ * Requests are generated with InterArrival gaps, optionally only during
+ * the on periods of an OnTime/OffTime process, or at the times listed in
+ * a RequestTrace file. Each asks for ResponseSize bytes (MaxBytes if
+ * unset) from the next server in round-robin order.
  *
+ * Each connection carries up to MaxStreams requests at once, each on its
+ * own stream. Requests go to the open connections of their server first;
+ * when those are full, new connections are opened on demand, up to
+ * MaxConnections per server, and the rest wait in order for a stream to
+ * free up. Connections stay open and are reused by later requests. All
+ * connections of the client share one crypto config, so every connection
+ * after the first to a server resumes with 0-RTT, and the node's alarm
+ * factory. The defaults issue a single MaxBytes request over a single
+ * connection.
+ *
+ * Latency and throughput are reported through trace sources: Handshake,
+ * FirstByte, StreamComplete and RequestComplete per connection and
+ * request, Goodput samples every GoodputInterval, and ConnectionClosed
+ * with the QuicConnectionStats of every connection. Stream latencies and
+ * throughputs are also kept in constant-memory QuicQuantileSketches,
+ * read at the end of the run with GetLatencySketch() and
+ * GetThroughputSketch(), reported every PercentileInterval through the
+ * Percentiles trace source, and summarized per connection in
+ * ConnectionClosed.
  */
 class QuicClient : public Application
 {
@@ -74,6 +109,26 @@ public:
    * \return the object TypeId
    */
   static TypeId GetTypeId (void);
+
+  /// Targets of path MTU discovery.
+  enum MtuDiscoveryTarget
+  {
+    MTU_DISCOVERY_NONE,   //!< No discovery
+    MTU_DISCOVERY_LOW,    //!< kMtuDiscoveryTargetPacketSizeLow, 1430 bytes
+    MTU_DISCOVERY_HIGH,   //!< kMtuDiscoveryTargetPacketSizeHigh, 1450 bytes
+    MTU_DISCOVERY_JUMBO   //!< kMtuDiscoveryTargetPacketSizeJumbo, 8952 bytes
+  };
+
+  /// Ack decimation modes, requested from both ends of each connection.
+  enum AckDecimationMode
+  {
+    ACK_DECIMATION_NONE,       //!< Ack every second packet
+    ACK_DECIMATION,            //!< kACKD, ack every 1/4 RTT or 10 packets
+    ACK_DECIMATION_REORDERING, //!< kAKD2, kACKD tolerating reordering
+    ACK_DECIMATION_EIGHTH_RTT, //!< kAKD3, ack every 1/8 RTT
+    ACK_DECIMATION_EIGHTH_RTT_REORDERING //!< kAKD4, kAKD3 tolerating reordering
+  };
+
   QuicClient ();
 
   virtual ~QuicClient ();
@@ -88,13 +143,175 @@ public:
    */
   Ptr<Socket> GetListeningSocket (void) const;
 
-  net::QuicSimpleClient *client;
+  /**
+   * \brief Add a server to send requests to, besides ServerAddress.
+   *
+   * Must be called before the application starts.
+   *
+   * \param address the server address
+   */
+  void AddServer (Address address);
+
+  /// A pooled connection, defined in quic-client.cc.
+  struct Connection;
+
+  /**
+   * \brief Deliver the datagrams of a connection socket to HandleRead.
+   *
+   * \internal Called by the packet reader of a connection when it starts
+   * reading.
+   *
+   * \param socket the connection socket
+   * \param reader the packet reader of the connection
+   */
+  void WatchSocket (Ptr<Socket> socket, net::QuicChromiumPacketReader *reader);
+
   /**
    * \brief Handle a packet received by the application
+   *
+   * When DrainReads is enabled every datagram queued on the socket is
+   * processed, up to the kQuicYieldAfterPacketsRead and
+   * kQuicYieldAfterDurationMilliseconds budgets of the packet reader.
+   *
    * \param socket the receiving socket
    */
   void HandleRead (Ptr<Socket> socket);
 
+  /**
+   * \return the number of HandleRead wakeups that read at least one packet
+   */
+  uint64_t GetReadWakeups (void) const;
+
+  /**
+   * \return the number of packets read over all wakeups
+   */
+  uint64_t GetPacketsRead (void) const;
+
+  /**
+   * \return the number of requests that completed, successfully or not
+   */
+  uint64_t GetRequestsCompleted (void) const;
+
+  /**
+   * \return the number of connections opened over the lifetime of the pool
+   */
+  uint64_t GetConnectionsOpened (void) const;
+
+  /**
+   * \return the latencies of every completed request stream, from sending
+   * the request to the stream closing, in nanoseconds
+   */
+  const QuicQuantileSketch &GetLatencySketch (void) const;
+
+  /**
+   * \return the throughputs of every completed request stream, response
+   * bits over its latency, in bits per second
+   */
+  const QuicQuantileSketch &GetThroughputSketch (void) const;
+
+  /**
+   * \brief Assign fixed random variable stream numbers to the random
+   * variables used by this model.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * \brief Account for a closed request stream.
+   *
+   * \internal Called by the response listener of the connection.
+   *
+   * \param connection the connection the request was sent on
+   * \param streamId the stream the request was sent on
+   * \param status HTTP status of the response, 0 if none was received
+   * \param bytes body bytes received on the stream
+   */
+  void OnRequestClosed (Connection *connection, uint32_t streamId, int status,
+                        uint64_t bytes);
+
+  /**
+   * \brief Follow requests sent again after a stateless reject, which
+   * replaced the session and with it the stream ids.
+   *
+   * \internal Called by the response listener of the connection.
+   *
+   * \param connection the connection the requests were sent on
+   * \param streams the stream id each request was sent on before, and its
+   * new stream
+   */
+  void OnRequestsResent (Connection *connection,
+                         const std::vector<std::pair<uint32_t, net::QuicSpdyClientStream *> > &streams);
+
+  /**
+   * TracedCallback signature for completed requests.
+   *
+   * \param [in] requestId sequence number of the request, from 0
+   * \param [in] bytes body bytes received
+   * \param [in] latency time from generating the request to its completion
+   */
+  typedef void (* RequestCompleteCallback)(uint64_t requestId, uint64_t bytes,
+                                           Time latency);
+
+  /**
+   * TracedCallback signature for completed handshakes.
+   *
+   * \param [in] duration time from opening the connection to the handshake
+   *             being confirmed
+   * \param [in] zeroRtt whether requests could be sent in the first flight
+   */
+  typedef void (* HandshakeCallback)(Time duration, bool zeroRtt);
+
+  /**
+   * TracedCallback signature for the first response byte of a request.
+   *
+   * \param [in] requestId sequence number of the request
+   * \param [in] latency time from sending the request to the first stream
+   *             frame of its response
+   */
+  typedef void (* FirstByteCallback)(uint64_t requestId, Time latency);
+
+  /**
+   * TracedCallback signature for goodput samples.
+   *
+   * \param [in] bitRate goodput over the last GoodputInterval, in bits/s:
+   *             eight times the response bytes received in the interval,
+   *             over its length
+   */
+  typedef void (* GoodputBitRateCallback)(double bitRate);
+
+  /**
+   * TracedCallback signature for percentile reports.
+   *
+   * \param [in] latency stream latencies over the last PercentileInterval,
+   *             in nanoseconds
+   * \param [in] throughput stream throughputs over the last
+   *             PercentileInterval, in bits per second
+   */
+  typedef void (* PercentilesCallback)(const QuicPercentiles &latency,
+                                       const QuicPercentiles &throughput);
+
+  /**
+   * \brief Account for a stream frame received on a connection.
+   *
+   * \internal Called by the debug visitor of the connection.
+   *
+   * \param connection the connection that received the frame
+   * \param streamId the stream of the frame
+   * \param end offset of the end of the frame data in the stream
+   */
+  void OnStreamFrame (Connection *connection, uint32_t streamId, uint64_t end);
+
+  /**
+   * \brief Report the statistics of a connection that closed.
+   *
+   * \internal Called by the debug visitor of the connection.
+   *
+   * \param connection the connection that closed
+   */
+  void OnConnectionClosed (Connection *connection);
+
 protected:
   virtual void DoDispose (void);
 private:
@@ -114,29 +331,173 @@ private:
   void HandleFailedConnection (Ptr<Socket> socket);
 
   Ptr<Socket> m_socket;         //!< Listening socket
+  Ptr<QuicContext> m_context;   //!< QUIC state of this node
 
   Address     m_serverAddress;  //!< Server address
   uint64_t    m_totalRx;        //!< Total bytes received
   TypeId      m_tid;            //!< Protocol TypeId
   bool        m_zeroRtt;        //!< 0-RTT flag
-  unsigned    m_maxBytes;
-  
-  // aghax
-  uint64_t    m_maxPacketSize;
+  uint64_t    m_maxBytes;
+  uint64_t    m_maxPacketSize;  //!< Initial maximum packet size
+  MtuDiscoveryTarget m_mtuDiscovery; //!< Path MTU discovery target
+  AckDecimationMode m_ackDecimation; //!< Ack decimation requested
+  QuicCongestionControl m_congestionControl; //!< Congestion controller
+  uint32_t    m_initialCongestionWindow; //!< Packets, 0 for the default
+  uint32_t    m_maxCongestionWindow; //!< Packets, 0 for the default
+  uint32_t    m_streamFlowControlWindow; //!< Bytes, 0 for the default
+  uint32_t    m_sessionFlowControlWindow; //!< Bytes, 0 for the default
+  bool        m_pacing;         //!< Whether packets are paced
 
+  bool        m_drainReads;     //!< Read every queued datagram per wakeup
+  uint64_t    m_readWakeups;    //!< Wakeups that read at least one packet
+  uint64_t    m_packetsRead;    //!< Packets read over all wakeups
+  bool        m_deterministicRandom; //!< Seed QuicRandom from ns-3
+  uint32_t    m_randomSeed;     //!< Seed of the QUIC random stream
+  uint64_t    m_randomRun;      //!< Run of the QUIC random stream
+  bool        m_nullEncryption; //!< Prefer the null AEAD
 
+  /// A request of the workload.
+  struct Request
+  {
+    uint64_t id;             //!< Sequence number
+    uint64_t responseBytes;  //!< Requested body size
+    Time     generated;      //!< Time the request was generated
+    Time     sent;           //!< Time the request was sent
+    uint64_t received;       //!< Highest response offset received
+  };
 
-  /// Traced Callback: received packets, source address.
-  TracedCallback<Ptr<const Packet>, const Address &> m_rxTrace;
+  /// A server of the pool.
+  struct Server
+  {
+    Address address;                       //!< Server address
+    std::deque<Request> pending;           //!< Requests waiting for a stream
+    std::vector<Connection *> connections; //!< Open connections, owned
+  };
 
-  state cur_state;
-  void SendRequest();
-public:
-  static base::AtExitManager *exit_manager;
-  static base::MessageLoopForIO *message_loop;
-  static Time last_time;
+  std::vector<Address> m_extraServers;  //!< Servers added with AddServer
+  std::vector<Server> m_servers;        //!< Servers of the pool
+  size_t      m_nextServer;     //!< Server of the next request
+  uint32_t    m_maxConnections; //!< Connections per server
+  uint64_t    m_connectionsOpened; //!< Connections opened so far
+  std::unique_ptr<net::QuicCryptoClientConfig> m_cryptoConfig; //!< Shared by the pool
+  std::map<net::QuicChromiumPacketReader *, Connection *> m_readers; //!< Connections by reader
+  std::map<Ptr<Socket>, Connection *> m_sockets; //!< Connections by socket
+  EventId     m_reapEvent;      //!< Removal of closed connections
+  bool        m_workloadStarted; //!< Whether requests are being generated
+
+  uint32_t    m_maxStreams;     //!< Requests in flight per connection
+  uint32_t    m_numRequests;    //!< Requests to generate, 0 for no limit
+  Ptr<RandomVariableStream> m_interArrival; //!< Seconds between requests
+  Ptr<RandomVariableStream> m_responseSize; //!< Response bytes, or null for MaxBytes
+  Ptr<RandomVariableStream> m_onTime;       //!< Seconds of an on period, or null
+  Ptr<RandomVariableStream> m_offTime;      //!< Seconds of an off period
+  std::string m_requestTrace;   //!< File of "<seconds> <bytes>" requests
+
+  std::vector<std::pair<Time, uint64_t> > m_trace; //!< Parsed request trace
+  size_t      m_traceIndex;     //!< Next trace entry to generate
+  Time        m_traceStart;     //!< Time the trace was started
+  Time        m_onEnd;          //!< End of the current on period
+  EventId     m_requestEvent;   //!< Generation of the next request
+  uint64_t    m_requestsGenerated; //!< Requests generated so far
+  uint64_t    m_requestsCompleted; //!< Requests completed so far
+
+  Time        m_goodputInterval; //!< Period of goodput samples, 0 for none
+  uint64_t    m_goodputBytes;   //!< Response bytes since the last sample
+  EventId     m_goodputEvent;   //!< Next goodput sample
 
+  QuicQuantileSketch m_latency;     //!< Stream latencies of the run, in ns
+  QuicQuantileSketch m_throughput;  //!< Stream throughputs of the run, in bps
+  QuicQuantileSketch m_intervalLatency;    //!< Latencies since the last report
+  QuicQuantileSketch m_intervalThroughput; //!< Throughputs since the last report
+  Time        m_percentileInterval; //!< Period of percentile reports, 0 for none
+  EventId     m_percentileEvent; //!< Next percentile report
 
+  /// Traced Callback: a request completed, latency from generation.
+  TracedCallback<uint64_t, uint64_t, Time> m_requestCompleteTrace;
+
+  /// Traced Callback: a request stream closed, latency from sending.
+  TracedCallback<uint64_t, uint64_t, Time> m_streamCompleteTrace;
+
+  /// Traced Callback: first response byte of a request.
+  TracedCallback<uint64_t, Time> m_firstByteTrace;
+
+  /// Traced Callback: a handshake was confirmed.
+  TracedCallback<Time, bool> m_handshakeTrace;
+
+  /// Traced Callback: goodput over the last GoodputInterval, in bits/s.
+  TracedCallback<double> m_goodputTrace;
+
+  /// Traced Callback: percentiles over the last PercentileInterval.
+  TracedCallback<const QuicPercentiles &, const QuicPercentiles &> m_percentilesTrace;
+
+  /// Traced Callback: a connection closed.
+  TracedCallback<const QuicConnectionSummary &> m_connectionClosedTrace;
+
+  /// Traced Callback: packets read in one HandleRead wakeup.
+  TracedCallback<uint32_t> m_packetsPerWakeupTrace;
+
+
+  /// Traced Callback: received packets, source address.
+  TracedCallback<Ptr<const Packet>, const Address &> m_rxTrace;
+
+  /**
+   * \brief Start generating requests once the connection is up
+   */
+  void StartWorkload (void);
+  /**
+   * \brief Schedule the generation of the next request, if any
+   */
+  void ScheduleNextRequest (void);
+  /**
+   * \brief Draw the length of the next on period, which must be positive
+   * for requests pushed past an on period to ever land in one
+   */
+  Time NextOnPeriod (void);
+  /**
+   * \brief Generate the next request of the trace and schedule the one after
+   */
+  void NextTraceRequest (void);
+  /**
+   * \brief Queue a new request for \p responseBytes bytes
+   */
+  void GenerateRequest (uint64_t responseBytes);
+  /**
+   * \brief Send queued requests while streams are available, opening
+   * connections as needed
+   */
+  void SendRequest (void);
+  /**
+   * \brief Open a new connection to a server of the pool
+   * \param server index of the server
+   */
+  void OpenConnection (size_t server);
+  /**
+   * \brief Delete the connections that were closed
+   */
+  void ReapConnections (void);
+  /**
+   * \brief Delete every connection
+   * \param silent whether to skip sending a CONNECTION_CLOSE to the peer
+   */
+  void CloseConnections (bool silent);
+  /**
+   * \brief Fire a goodput sample and schedule the next one
+   */
+  void SampleGoodput (void);
+  /**
+   * \brief Report the percentiles of the last interval and schedule the
+   * next report
+   */
+  void ReportPercentiles (void);
+  /**
+   * \brief Read RequestTrace into m_trace
+   */
+  void LoadRequestTrace (void);
+  /**
+   * \brief Advance the connection state machine after a packet was read
+   * \param connection the connection that read the packet
+   */
+  void AdvanceState (Connection *connection);
 };
 
 } // namespace ns3
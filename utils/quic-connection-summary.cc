@@ -0,0 +1,49 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "quic-connection-summary.h"
+
+#include "net/quic/core/quic_connection_stats.h"
+#include "net/quic/platform/api/quic_clock.h"
+
+namespace ns3 {
+
+QuicConnectionSummary
+QuicConnectionSummary::FromStats (const net::QuicConnectionStats &stats,
+                                  const net::QuicClock *clock)
+{
+  QuicConnectionSummary summary;
+  summary.lifetime = MicroSeconds (
+      (clock->ApproximateNow () - stats.connection_creation_time).ToMicroseconds ());
+  summary.bytesSent = stats.bytes_sent;
+  summary.bytesReceived = stats.bytes_received;
+  summary.streamBytesSent = stats.stream_bytes_sent;
+  summary.streamBytesReceived = stats.stream_bytes_received;
+  summary.packetsSent = stats.packets_sent;
+  summary.packetsReceived = stats.packets_received;
+  summary.packetsRetransmitted = stats.packets_retransmitted;
+  summary.packetsLost = stats.packets_lost;
+  summary.rtoCount = stats.rto_count;
+  summary.tlpCount = stats.tlp_count;
+  summary.minRtt = MicroSeconds (stats.min_rtt_us);
+  summary.smoothedRtt = MicroSeconds (stats.srtt_us);
+  summary.streams = 0;
+  return summary;
+}
+
+} // namespace ns3
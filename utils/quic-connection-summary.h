@@ -0,0 +1,83 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUIC_CONNECTION_SUMMARY_H
+#define QUIC_CONNECTION_SUMMARY_H
+
+#include "ns3/nstime.h"
+
+#include <stdint.h>
+
+namespace net {
+class QuicClock;
+struct QuicConnectionStats;
+} // namespace net
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * \brief Transport statistics of a closed QUIC connection.
+ *
+ * A copy of the QuicConnectionStats fields experiments usually look at,
+ * in ns-3 types, so trace sinks do not need the Chromium headers. The
+ * stream latency percentiles are only filled in by QuicClient, which
+ * measures them; they are zero elsewhere.
+ */
+struct QuicConnectionSummary
+{
+  Time     lifetime;            //!< Time from creation to close
+  uint64_t bytesSent;           //!< Bytes sent, retransmissions included
+  uint64_t bytesReceived;       //!< Bytes received, duplicates included
+  uint64_t streamBytesSent;     //!< Stream frame bytes sent
+  uint64_t streamBytesReceived; //!< Stream frame bytes received
+  uint64_t packetsSent;         //!< Packets sent
+  uint64_t packetsReceived;     //!< Packets received
+  uint64_t packetsRetransmitted; //!< Packets retransmitted
+  uint64_t packetsLost;         //!< Packets detected as lost
+  uint64_t rtoCount;            //!< Retransmission timeouts
+  uint64_t tlpCount;            //!< Tail loss probes
+  Time     minRtt;              //!< Minimum RTT
+  Time     smoothedRtt;         //!< Smoothed RTT at close
+  uint64_t streams;             //!< Request streams completed
+  Time     streamLatencyP50;    //!< Median request stream latency
+  Time     streamLatencyP99;    //!< 99th percentile stream latency
+  Time     streamLatencyP999;   //!< 99.9th percentile stream latency
+
+  /**
+   * \brief Summarize the statistics of a connection.
+   *
+   * \param stats the connection statistics
+   * \param clock the clock of the connection, to compute its lifetime
+   * \return the summary
+   */
+  static QuicConnectionSummary FromStats (const net::QuicConnectionStats &stats,
+                                          const net::QuicClock *clock);
+
+  /**
+   * TracedCallback signature for closed connections.
+   *
+   * \param [in] summary statistics of the connection
+   */
+  typedef void (* TracedCallback)(const QuicConnectionSummary &summary);
+};
+
+} // namespace ns3
+
+#endif /* QUIC_CONNECTION_SUMMARY_H */
@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "quic-context.h"
+#include "quic-profiler.h"
+#include "helper/socket_ns3.h"
+
+#include "base/at_exit.h"
+#include "base/message_loop/message_loop.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "net/quic/chromium/quic_chromium_alarm_factory.h"
+#include "net/quic/core/crypto/quic_random.h"
+#include "net/quic/core/quic_connection.h"
+#include "net/quic/core/quic_simple_buffer_allocator.h"
+#include "net/quic/platform/impl/quic_chromium_clock.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QuicContext");
+
+NS_OBJECT_ENSURE_REGISTERED (QuicContext);
+
+namespace {
+
+// Connection helper handing out the context's clock and buffer allocator.
+class ContextConnectionHelper : public net::QuicConnectionHelperInterface
+{
+public:
+  ContextConnectionHelper (const net::QuicClock *clock,
+                           net::QuicBufferAllocator *allocator)
+    : m_clock (clock),
+      m_allocator (allocator)
+  {
+  }
+
+  const net::QuicClock *GetClock () const override
+  {
+    return m_clock;
+  }
+  net::QuicRandom *GetRandomGenerator () override
+  {
+    return net::QuicRandom::GetInstance ();
+  }
+  net::QuicBufferAllocator *GetStreamFrameBufferAllocator () override
+  {
+    return m_allocator;
+  }
+  net::QuicBufferAllocator *GetStreamSendBufferAllocator () override
+  {
+    return m_allocator;
+  }
+
+private:
+  const net::QuicClock *m_clock;
+  net::QuicBufferAllocator *m_allocator;
+};
+
+// Owned by the caller but forwards to the context's shared factory, since
+// QuicClientBase and QuicDispatcher both insist on owning their factory.
+class ContextAlarmFactory : public net::QuicAlarmFactory
+{
+public:
+  explicit ContextAlarmFactory (net::QuicAlarmFactory *target)
+    : m_target (target)
+  {
+  }
+
+  net::QuicAlarm *CreateAlarm (net::QuicAlarm::Delegate *delegate) override
+  {
+    return m_target->CreateAlarm (delegate);
+  }
+  net::QuicArenaScopedPtr<net::QuicAlarm> CreateAlarm (
+      net::QuicArenaScopedPtr<net::QuicAlarm::Delegate> delegate,
+      net::QuicConnectionArena *arena) override
+  {
+    return m_target->CreateAlarm (std::move (delegate), arena);
+  }
+
+private:
+  net::QuicAlarmFactory *m_target;
+};
+
+} // namespace
+
+TypeId
+QuicContext::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuicContext")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<QuicContext> ()
+  ;
+  return tid;
+}
+
+QuicContext::QuicContext ()
+  : m_clock (new net::QuicChromiumClock),
+    m_bufferAllocator (new net::SimpleBufferAllocator)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+QuicContext::~QuicContext ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ptr<QuicContext>
+QuicContext::Get (Ptr<Node> node)
+{
+  Ptr<QuicContext> context = node->GetObject<QuicContext> ();
+  if (!context)
+    {
+      context = CreateObject<QuicContext> ();
+      node->AggregateObject (context);
+    }
+  return context;
+}
+
+void
+QuicContext::EnsureMessageLoop (void)
+{
+  // The AtExitManager is process-wide; Chromium keeps the message loop per
+  // thread.
+  static base::AtExitManager *exitManager = new base::AtExitManager;
+  (void) exitManager;
+  if (!base::MessageLoop::current ())
+    {
+      new base::MessageLoopForIO;
+    }
+  QuicProfiler::Start ();
+}
+
+Ptr<Node>
+QuicContext::GetNode (void) const
+{
+  return GetObject<Node> ();
+}
+
+net::QuicChromiumClock *
+QuicContext::GetClock (void) const
+{
+  return m_clock.get ();
+}
+
+net::QuicBufferAllocator *
+QuicContext::GetBufferAllocator (void) const
+{
+  return m_bufferAllocator.get ();
+}
+
+net::QuicConnectionHelperInterface *
+QuicContext::CreateConnectionHelper (void)
+{
+  return new ContextConnectionHelper (m_clock.get (), m_bufferAllocator.get ());
+}
+
+net::QuicAlarmFactory *
+QuicContext::CreateAlarmFactory (void)
+{
+  if (!m_alarmFactory)
+    {
+      EnsureMessageLoop ();
+      m_alarmFactory.reset (new net::QuicChromiumAlarmFactory (
+          base::ThreadTaskRunnerHandle::Get ().get (), m_clock.get ()));
+    }
+  return new ContextAlarmFactory (m_alarmFactory.get ());
+}
+
+net::QuicChromiumAlarmFactory *
+QuicContext::GetAlarmFactory (void) const
+{
+  return m_alarmFactory.get ();
+}
+
+void
+QuicContext::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Object::DoDispose ();
+}
+
+QuicContext::Scope::Scope (Ptr<QuicContext> context)
+  : m_previous (kCurNode)
+{
+  kCurNode = context->GetNode ();
+}
+
+QuicContext::Scope::~Scope ()
+{
+  kCurNode = m_previous;
+}
+
+} // namespace ns3
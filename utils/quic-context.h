@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUIC_CONTEXT_H
+#define QUIC_CONTEXT_H
+
+#include "ns3/object.h"
+#include "ns3/node.h"
+#include "ns3/ptr.h"
+
+#include <memory>
+
+namespace net {
+class QuicAlarmFactory;
+class QuicBufferAllocator;
+class QuicChromiumAlarmFactory;
+class QuicChromiumClock;
+class QuicConnectionHelperInterface;
+class SimpleBufferAllocator;
+} // namespace net
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * \brief Per-node state shared by the QUIC applications installed on a node.
+ *
+ * The context is aggregated to its Node and owns the clock, alarm factory
+ * and stream buffer allocator used by every QuicClient and QuicServer on
+ * that node. Sockets opened through the socket_ns3 shim while a
+ * QuicContext::Scope is alive are created on, and stay bound to, the
+ * context's node, so applications of different nodes can be started and
+ * driven in any order. Each application closes its own descriptors when
+ * it is disposed.
+ */
+class QuicContext : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  QuicContext ();
+  virtual ~QuicContext ();
+
+  /**
+   * \brief Get the context of a node, aggregating a new one on first use.
+   * \param node the node
+   * \return the node's context
+   */
+  static Ptr<QuicContext> Get (Ptr<Node> node);
+
+  /**
+   * \brief Create the Chromium message loop of the calling thread if needed,
+   * and start the QuicProfiler if it was asked for.
+   */
+  static void EnsureMessageLoop (void);
+
+  /**
+   * \return the node this context is aggregated to
+   */
+  Ptr<Node> GetNode (void) const;
+
+  /**
+   * \return the clock driving the alarms of this node
+   */
+  net::QuicChromiumClock *GetClock (void) const;
+
+  /**
+   * \return the stream buffer allocator shared by this node's connections
+   */
+  net::QuicBufferAllocator *GetBufferAllocator (void) const;
+
+  /**
+   * \brief Create a connection helper backed by this context.
+   *
+   * The caller owns the returned helper; the clock and buffer allocator
+   * it hands out stay owned by the context.
+   */
+  net::QuicConnectionHelperInterface *CreateConnectionHelper (void);
+
+  /**
+   * \brief Create an alarm factory backed by this context.
+   *
+   * The caller owns the returned factory, which forwards to the context's
+   * shared alarm factory.
+   */
+  net::QuicAlarmFactory *CreateAlarmFactory (void);
+
+  /**
+   * \return the alarm factory shared by the alarms of this node, which
+   * counts the simulator events they use; null until the first alarm
+   * factory is created
+   */
+  net::QuicChromiumAlarmFactory *GetAlarmFactory (void) const;
+
+  /**
+   * \brief Binds sockets created by the shim to a context's node.
+   *
+   * While a Scope is alive, socket_ns3 creates its sockets on the scope's
+   * node. Scopes nest; the previous node is restored on destruction.
+   */
+  class Scope
+  {
+  public:
+    explicit Scope (Ptr<QuicContext> context);
+    ~Scope ();
+
+  private:
+    Ptr<Node> m_previous; //!< Node that was current before this scope
+  };
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  std::unique_ptr<net::QuicChromiumClock> m_clock;                 //!< Clock of this node
+  std::unique_ptr<net::SimpleBufferAllocator> m_bufferAllocator;   //!< Stream buffer allocator
+  std::unique_ptr<net::QuicChromiumAlarmFactory> m_alarmFactory;   //!< Shared alarm factory
+};
+
+} // namespace ns3
+
+#endif /* QUIC_CONTEXT_H */
@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/fatal-error.h"
+#include "quic-crypto-cache.h"
+
+#include "base/files/file_path.h"
+#include "net/quic/chromium/crypto/proof_source_chromium.h"
+#include "net/quic/core/crypto/crypto_handshake.h"
+#include "net/quic/core/crypto/quic_random.h"
+
+#include <map>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QuicServerCryptoCache");
+
+namespace {
+
+// Same secret QuicSimpleServer uses for the configs it generates itself.
+const char kSourceAddressTokenSecret[] = "secret";
+
+// QuicCryptoServerConfig insists on owning its proof source; hand it one
+// that forwards to the shared instance.
+class SharedProofSource : public net::ProofSource
+{
+public:
+  explicit SharedProofSource (std::shared_ptr<net::ProofSource> target)
+    : m_target (std::move (target))
+  {
+  }
+
+  void GetProof (const net::QuicSocketAddress &serverAddress,
+                 const std::string &hostname,
+                 const std::string &serverConfig,
+                 net::QuicVersion quicVersion,
+                 net::QuicStringPiece chloHash,
+                 const net::QuicTagVector &connectionOptions,
+                 std::unique_ptr<Callback> callback) override
+  {
+    m_target->GetProof (serverAddress, hostname, serverConfig, quicVersion,
+                        chloHash, connectionOptions, std::move (callback));
+  }
+
+private:
+  std::shared_ptr<net::ProofSource> m_target;
+};
+
+std::map<std::string, std::weak_ptr<net::ProofSource> > g_proofSources;
+std::map<std::string, std::weak_ptr<net::QuicCryptoServerConfig> > g_cryptoConfigs;
+
+std::string
+ProofSourceKey (const std::string &certFile, const std::string &keyFile)
+{
+  return certFile + '\n' + keyFile;
+}
+
+std::string
+CryptoConfigKey (const std::string &certFile, const std::string &keyFile,
+                 const net::QuicCryptoServerConfig::ConfigOptions &options)
+{
+  std::ostringstream key;
+  key << ProofSourceKey (certFile, keyFile) << '\n'
+      << options.expiry_time.ToUNIXSeconds () << '\n'
+      << options.channel_id_enabled << options.p256
+      << options.null_encryption << '\n'
+      << options.id << '\n'
+      << options.orbit << '\n';
+  for (net::QuicTag tag : options.token_binding_params)
+    {
+      key << tag << ',';
+    }
+  return key.str ();
+}
+
+} // namespace
+
+std::shared_ptr<net::ProofSource>
+QuicServerCryptoCache::GetProofSource (const std::string &certFile,
+                                       const std::string &keyFile)
+{
+  std::weak_ptr<net::ProofSource> &entry =
+    g_proofSources[ProofSourceKey (certFile, keyFile)];
+  std::shared_ptr<net::ProofSource> proofSource = entry.lock ();
+  if (proofSource)
+    {
+      return proofSource;
+    }
+
+  NS_LOG_INFO ("Loading certificate " << certFile << " and key " << keyFile);
+  std::shared_ptr<net::ProofSourceChromium> chromium =
+    std::make_shared<net::ProofSourceChromium> ();
+  if (!chromium->Initialize (base::FilePath (certFile), base::FilePath (keyFile),
+                             base::FilePath ()))
+    {
+      NS_FATAL_ERROR ("Cannot load QUIC certificate " << certFile
+                      << " and key " << keyFile);
+    }
+  entry = chromium;
+  return chromium;
+}
+
+std::shared_ptr<net::QuicCryptoServerConfig>
+QuicServerCryptoCache::GetCryptoConfig (
+  const std::string &certFile, const std::string &keyFile,
+  const net::QuicCryptoServerConfig::ConfigOptions &options,
+  const net::QuicClock *clock)
+{
+  std::weak_ptr<net::QuicCryptoServerConfig> &entry =
+    g_cryptoConfigs[CryptoConfigKey (certFile, keyFile, options)];
+  std::shared_ptr<net::QuicCryptoServerConfig> cryptoConfig = entry.lock ();
+  if (cryptoConfig)
+    {
+      return cryptoConfig;
+    }
+
+  NS_LOG_INFO ("Generating server config for " << certFile);
+  std::unique_ptr<net::ProofSource> proofSource (
+    new SharedProofSource (GetProofSource (certFile, keyFile)));
+  cryptoConfig = std::make_shared<net::QuicCryptoServerConfig> (
+    kSourceAddressTokenSecret, net::QuicRandom::GetInstance (),
+    std::move (proofSource));
+  std::unique_ptr<net::CryptoHandshakeMessage> scfg (
+    cryptoConfig->AddDefaultConfig (net::QuicRandom::GetInstance (), clock,
+                                    options));
+  entry = cryptoConfig;
+  return cryptoConfig;
+}
+
+} // namespace ns3
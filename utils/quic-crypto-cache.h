@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUIC_CRYPTO_CACHE_H
+#define QUIC_CRYPTO_CACHE_H
+
+#include "net/quic/core/crypto/proof_source.h"
+#include "net/quic/core/crypto/quic_crypto_server_config.h"
+
+#include <memory>
+#include <string>
+
+namespace net {
+class QuicClock;
+} // namespace net
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * \brief Process-wide cache of server certificates and crypto configs.
+ *
+ * Loading a certificate chain and private key, and generating and signing
+ * a server config, is by far the most expensive part of starting a
+ * QuicServer. Servers asking for the same certificate and options get the
+ * same, already initialized, objects. Entries are reference counted and
+ * released with the last server using them.
+ */
+class QuicServerCryptoCache
+{
+public:
+  /**
+   * \brief Get the proof source for a certificate chain and key.
+   *
+   * Aborts if the files cannot be loaded.
+   *
+   * \param certFile PEM certificate chain, leaf first
+   * \param keyFile PKCS#8 private key of the leaf certificate
+   * \return the shared proof source
+   */
+  static std::shared_ptr<net::ProofSource> GetProofSource (const std::string &certFile,
+                                                           const std::string &keyFile);
+
+  /**
+   * \brief Get a crypto config holding a primary server config.
+   *
+   * \param certFile PEM certificate chain, leaf first
+   * \param keyFile PKCS#8 private key of the leaf certificate
+   * \param options options of the generated server config
+   * \param clock clock to date the server config with on creation
+   * \return the shared crypto config
+   */
+  static std::shared_ptr<net::QuicCryptoServerConfig> GetCryptoConfig (
+    const std::string &certFile, const std::string &keyFile,
+    const net::QuicCryptoServerConfig::ConfigOptions &options,
+    const net::QuicClock *clock);
+};
+
+} // namespace ns3
+
+#endif /* QUIC_CRYPTO_CACHE_H */
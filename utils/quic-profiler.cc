@@ -0,0 +1,335 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "quic-profiler.h"
+
+#include "ns3/global-value.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+#include "base/bind.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/trace_event/trace_event.h"
+#include "base/trace_event/trace_log.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QuicProfiler");
+
+namespace {
+
+GlobalValue g_summary ("QuicProfilerSummary",
+                       "File for the QuicProfiler table of wall-clock time per "
+                       "subsystem and simulated second, \"-\" for stdout; "
+                       "empty disables it",
+                       StringValue (""),
+                       MakeStringChecker ());
+
+GlobalValue g_trace ("QuicProfilerTrace",
+                     "File for the QuicProfiler Chrome trace; empty disables it",
+                     StringValue (""),
+                     MakeStringChecker ());
+
+const char kCategory[] = "quic";
+
+const char *const kNames[QuicProfiler::SUBSYSTEMS] = {
+  "connection", "framer", "crypto", "congestion", "alarms", "application",
+  "ns3-socket"
+};
+
+typedef std::chrono::steady_clock Clock;
+
+/// An open scope.
+struct Frame
+{
+  QuicProfiler::Subsystem subsystem; //!< Subsystem of the scope
+  Clock::time_point start;           //!< Wall-clock time it was opened
+  Clock::duration children;          //!< Time of the scopes nested in it
+};
+
+/// The measures of one simulated second.
+struct Second
+{
+  Clock::duration wall;                                 //!< Wall-clock time
+  Clock::duration time[QuicProfiler::SUBSYSTEMS];       //!< Time per subsystem
+  uint64_t calls[QuicProfiler::SUBSYSTEMS];             //!< Scopes per subsystem
+};
+
+/// State of a profiled simulation.
+struct State
+{
+  bool started = false;           //!< Whether Start() enabled the profiler
+  bool tracing = false;           //!< Whether the trace log is recording
+  std::string summary;            //!< Summary file
+  std::string trace;              //!< Trace file
+  std::vector<Frame> stack;       //!< Open scopes, innermost last
+  std::vector<Second> seconds;    //!< Measures by simulated second
+  int64_t second = 0;             //!< Simulated second being measured
+  Clock::time_point secondStart;  //!< Wall-clock time it started
+};
+
+State &
+GetState (void)
+{
+  static State *state = new State;
+  return *state;
+}
+
+Second &
+GetSecond (State &state, int64_t second)
+{
+  if (state.seconds.size () <= static_cast<size_t> (second))
+    {
+      Second zero = Second ();
+      state.seconds.resize (second + 1, zero);
+    }
+  return state.seconds[second];
+}
+
+// Closes the simulated seconds that ended before now.
+void
+AdvanceSecond (State &state, Clock::time_point now)
+{
+  int64_t second = static_cast<int64_t> (std::floor (Simulator::Now ().GetSeconds ()));
+  while (state.second < second)
+    {
+      GetSecond (state, state.second).wall += now - state.secondStart;
+      state.secondStart = now;
+      state.second++;
+      if (state.tracing)
+        {
+          TRACE_COUNTER1 (kCategory, "simulated second", state.second);
+        }
+    }
+}
+
+double
+Milliseconds (Clock::duration duration)
+{
+  return std::chrono::duration<double, std::milli> (duration).count ();
+}
+
+void
+WriteSummary (const State &state, std::ostream &os)
+{
+  os << "# QuicProfiler: wall-clock ms per subsystem and simulated second\n"
+     << std::left << std::setw (8) << "second" << std::setw (12) << "wall";
+  for (const char *name : kNames)
+    {
+      os << std::setw (12) << name;
+    }
+  os << std::setw (12) << "other" << "\n" << std::fixed << std::setprecision (3);
+
+  Second total = Second ();
+  for (size_t i = 0; i < state.seconds.size (); i++)
+    {
+      const Second &second = state.seconds[i];
+      Clock::duration other = second.wall;
+      os << std::setw (8) << i << std::setw (12) << Milliseconds (second.wall);
+      for (int s = 0; s < QuicProfiler::SUBSYSTEMS; s++)
+        {
+          os << std::setw (12) << Milliseconds (second.time[s]);
+          other -= second.time[s];
+          total.time[s] += second.time[s];
+          total.calls[s] += second.calls[s];
+        }
+      total.wall += second.wall;
+      os << std::setw (12) << Milliseconds (other) << "\n";
+    }
+
+  Clock::duration other = total.wall;
+  os << std::setw (8) << "total" << std::setw (12) << Milliseconds (total.wall);
+  for (int s = 0; s < QuicProfiler::SUBSYSTEMS; s++)
+    {
+      os << std::setw (12) << Milliseconds (total.time[s]);
+      other -= total.time[s];
+    }
+  os << std::setw (12) << Milliseconds (other) << "\n"
+     << std::setw (8) << "calls" << std::setw (12) << "";
+  for (int s = 0; s < QuicProfiler::SUBSYSTEMS; s++)
+    {
+      os << std::setw (12) << total.calls[s];
+    }
+  os << "\n";
+}
+
+// Appends the JSON events of a flush to the trace file.
+void
+WriteTraceChunk (std::ofstream *file, bool *first,
+                 const scoped_refptr<base::RefCountedString> &events,
+                 bool hasMoreEvents)
+{
+  const std::string &data = events->data ();
+  if (!data.empty ())
+    {
+      if (!*first)
+        {
+          *file << ",\n";
+        }
+      *file << data;
+      *first = false;
+    }
+}
+
+void
+WriteTrace (const std::string &filename)
+{
+  base::trace_event::TraceLog *log = base::trace_event::TraceLog::GetInstance ();
+  log->SetDisabled ();
+  std::ofstream file (filename.c_str ());
+  if (!file)
+    {
+      NS_LOG_ERROR ("Cannot create profiler trace " << filename);
+      return;
+    }
+  bool first = true;
+  file << "{\"traceEvents\":[\n";
+  // The current thread does not buffer events of its own, so the flush
+  // completes synchronously.
+  log->Flush (base::Bind (&WriteTraceChunk, &file, &first));
+  file << "\n]}\n";
+}
+
+} // namespace
+
+bool QuicProfiler::s_enabled = false;
+
+void
+QuicProfiler::Start (void)
+{
+  State &state = GetState ();
+  if (state.started)
+    {
+      return;
+    }
+  StringValue summary, trace;
+  g_summary.GetValue (summary);
+  g_trace.GetValue (trace);
+  if (summary.Get ().empty () && trace.Get ().empty ())
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (summary.Get () << trace.Get ());
+
+  state = State ();
+  state.started = true;
+  state.summary = summary.Get ();
+  state.trace = trace.Get ();
+  state.secondStart = Clock::now ();
+  state.second = static_cast<int64_t> (std::floor (Simulator::Now ().GetSeconds ()));
+  if (!state.trace.empty ())
+    {
+      base::trace_event::TraceLog *log = base::trace_event::TraceLog::GetInstance ();
+      // Events go straight to the shared buffer instead of a buffer of the
+      // message loop, which ns-3 never runs.
+      log->SetCurrentThreadBlocksMessageLoop ();
+      log->SetEnabled (base::trace_event::TraceConfig (
+                         kCategory, base::trace_event::RECORD_CONTINUOUSLY),
+                       base::trace_event::TraceLog::RECORDING_MODE);
+      state.tracing = true;
+    }
+  s_enabled = true;
+  Simulator::ScheduleDestroy (&QuicProfiler::Report);
+}
+
+void
+QuicProfiler::Enter (Subsystem subsystem)
+{
+  State &state = GetState ();
+  Clock::time_point now = Clock::now ();
+  AdvanceSecond (state, now);
+  Frame frame;
+  frame.subsystem = subsystem;
+  frame.start = now;
+  frame.children = Clock::duration::zero ();
+  state.stack.push_back (frame);
+  if (state.tracing)
+    {
+      TRACE_EVENT_BEGIN0 (kCategory, kNames[subsystem]);
+    }
+}
+
+void
+QuicProfiler::Exit (void)
+{
+  State &state = GetState ();
+  if (state.stack.empty ())
+    {
+      // Opened before the profiler was reset.
+      return;
+    }
+  Clock::time_point now = Clock::now ();
+  Frame frame = state.stack.back ();
+  state.stack.pop_back ();
+  Clock::duration elapsed = now - frame.start;
+  if (!state.stack.empty ())
+    {
+      state.stack.back ().children += elapsed;
+    }
+  Second &second = GetSecond (state, state.second);
+  second.time[frame.subsystem] += elapsed - frame.children;
+  second.calls[frame.subsystem]++;
+  if (state.tracing)
+    {
+      TRACE_EVENT_END0 (kCategory, kNames[frame.subsystem]);
+    }
+}
+
+void
+QuicProfiler::Report (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  State &state = GetState ();
+  s_enabled = false;
+  Clock::time_point now = Clock::now ();
+  AdvanceSecond (state, now);
+  GetSecond (state, state.second).wall += now - state.secondStart;
+
+  if (state.summary == "-")
+    {
+      WriteSummary (state, std::cout);
+    }
+  else if (!state.summary.empty ())
+    {
+      std::ofstream file (state.summary.c_str ());
+      if (file)
+        {
+          WriteSummary (state, file);
+        }
+      else
+        {
+          NS_LOG_ERROR ("Cannot create profiler summary " << state.summary);
+        }
+    }
+  if (state.tracing)
+    {
+      WriteTrace (state.trace);
+    }
+  state = State ();
+}
+
+} // namespace ns3
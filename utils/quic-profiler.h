@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUIC_PROFILER_H
+#define QUIC_PROFILER_H
+
+#include <stdint.h>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * \brief Opt-in wall-clock profiler of the QUIC stack.
+ *
+ * Scopes around the main entry points of the Chromium QUIC code measure
+ * the wall-clock time spent in each subsystem. The time of a nested scope
+ * is only charged to the innermost subsystem. ns-3 sockets send
+ * synchronously, so the "ns3-socket" subsystem includes the UDP and IP
+ * send path down to the device queue, as well as the socket reads. Time
+ * spent outside every scope goes to the ns-3 scheduler, the transmission
+ * and reception events of the devices and the receive path up to the
+ * socket callbacks. It is reported in the "other" column.
+ *
+ * The profiler is off unless one of these global values is set, e.g. on
+ * the command line:
+ *
+ * - QuicProfilerSummary: file to write a table of the time and calls of
+ *   every subsystem per simulated second, or "-" for standard output.
+ * - QuicProfilerTrace: file to write the scopes to as a Chrome trace
+ *   (chrome://tracing, Perfetto), recorded with base/trace_event in the
+ *   "quic" category. Only the most recent events are kept, in a ring
+ *   buffer.
+ *
+ * It starts with the first QUIC application and reports when the
+ * simulator is destroyed.
+ */
+class QuicProfiler
+{
+public:
+  /// Profiled subsystems.
+  enum Subsystem
+  {
+    CONNECTION = 0,       //!< QuicConnection packet processing and sending
+    FRAMER,               //!< Packet parsing and serialization
+    CRYPTO,               //!< Handshake messages and packet protection
+    CONGESTION_CONTROL,   //!< Sent packet manager, loss detection, senders
+    ALARMS,               //!< Alarm callbacks not covered by the above
+    APPLICATION,          //!< QuicClient and QuicServer read handlers
+    NS3_SOCKET,           //!< ns-3 socket calls, with the stack they send through
+    SUBSYSTEMS            //!< Number of subsystems
+  };
+
+  /**
+   * \brief Enable the profiler if the global values ask for it.
+   *
+   * Called when QUIC applications start; only the first call of a
+   * simulation has an effect.
+   */
+  static void Start (void);
+
+  /**
+   * \return whether scopes are being measured
+   */
+  static bool IsEnabled (void)
+  {
+    return s_enabled;
+  }
+
+  /**
+   * \brief Measures the wall-clock time of a block of code.
+   */
+  class Scope
+  {
+  public:
+    /**
+     * \param subsystem the subsystem to charge the time of the block to
+     */
+    explicit Scope (Subsystem subsystem)
+      : m_active (s_enabled)
+    {
+      if (m_active)
+        {
+          Enter (subsystem);
+        }
+    }
+    ~Scope ()
+    {
+      if (m_active)
+        {
+          Exit ();
+        }
+    }
+
+  private:
+    bool m_active; //!< Whether Enter() was called
+  };
+
+private:
+  /**
+   * \brief Open a scope.
+   * \param subsystem the subsystem of the scope
+   */
+  static void Enter (Subsystem subsystem);
+  /**
+   * \brief Close the innermost scope.
+   */
+  static void Exit (void);
+  /**
+   * \brief Write the reports and disable the profiler.
+   */
+  static void Report (void);
+
+  static bool s_enabled; //!< Whether scopes are being measured
+};
+
+} // namespace ns3
+
+/// Charge the wall-clock time of the enclosing block to a QuicProfiler
+/// subsystem.
+#define QUIC_PROFILE_SCOPE(subsystem) \
+  ::ns3::QuicProfiler::Scope quic_profile_scope (::ns3::QuicProfiler::subsystem)
+
+#endif /* QUIC_PROFILER_H */
@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "quic-quantile-sketch.h"
+
+#include "ns3/assert.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+QuicQuantileSketch::QuicQuantileSketch (uint32_t significantBits)
+  : m_significantBits (significantBits),
+    m_counts (kExponents),
+    m_zeros (0),
+    m_count (0),
+    m_sum (0),
+    m_min (0),
+    m_max (0)
+{
+  NS_ASSERT_MSG (significantBits <= 16, "Too many significant bits");
+}
+
+void
+QuicQuantileSketch::Add (double value)
+{
+  m_min = m_count == 0 ? value : std::min (m_min, value);
+  m_max = m_count == 0 ? value : std::max (m_max, value);
+  m_count++;
+  m_sum += value;
+  if (!(value > 0))
+    {
+      m_zeros++;
+      return;
+    }
+
+  // value = mantissa * 2^exponent, with mantissa in [0.5, 1).
+  int exponent;
+  double mantissa = std::frexp (value, &exponent);
+  uint32_t buckets = 1u << m_significantBits;
+  uint32_t bucket;
+  if (exponent < kMinExponent)
+    {
+      exponent = kMinExponent;
+      bucket = 0;
+    }
+  else if (exponent >= kMinExponent + kExponents)
+    {
+      exponent = kMinExponent + kExponents - 1;
+      bucket = buckets - 1;
+    }
+  else
+    {
+      bucket = std::min<uint32_t> (
+          static_cast<uint32_t> ((mantissa - 0.5) * 2 * buckets), buckets - 1);
+    }
+  std::vector<uint64_t> &counts = m_counts[exponent - kMinExponent];
+  if (counts.empty ())
+    {
+      counts.resize (buckets);
+    }
+  counts[bucket]++;
+}
+
+void
+QuicQuantileSketch::Merge (const QuicQuantileSketch &other)
+{
+  NS_ASSERT_MSG (other.m_significantBits == m_significantBits,
+                 "Cannot merge sketches of different precision");
+  if (other.m_count == 0)
+    {
+      return;
+    }
+  m_min = m_count == 0 ? other.m_min : std::min (m_min, other.m_min);
+  m_max = m_count == 0 ? other.m_max : std::max (m_max, other.m_max);
+  m_count += other.m_count;
+  m_sum += other.m_sum;
+  m_zeros += other.m_zeros;
+  for (int i = 0; i < kExponents; i++)
+    {
+      const std::vector<uint64_t> &from = other.m_counts[i];
+      if (from.empty ())
+        {
+          continue;
+        }
+      std::vector<uint64_t> &to = m_counts[i];
+      if (to.empty ())
+        {
+          to = from;
+          continue;
+        }
+      for (size_t bucket = 0; bucket < from.size (); bucket++)
+        {
+          to[bucket] += from[bucket];
+        }
+    }
+}
+
+void
+QuicQuantileSketch::Reset (void)
+{
+  for (std::vector<uint64_t> &counts : m_counts)
+    {
+      // Keep the buckets allocated: the next interval likely uses them.
+      std::fill (counts.begin (), counts.end (), 0);
+    }
+  m_zeros = 0;
+  m_count = 0;
+  m_sum = 0;
+  m_min = 0;
+  m_max = 0;
+}
+
+double
+QuicQuantileSketch::GetQuantile (double q) const
+{
+  if (m_count == 0)
+    {
+      return 0;
+    }
+  q = std::max (0.0, std::min (1.0, q));
+  // The rank of the wanted sample, from 1.
+  uint64_t rank = std::max<uint64_t> (1, static_cast<uint64_t> (std::ceil (q * m_count)));
+  uint64_t seen = m_zeros;
+  if (seen >= rank)
+    {
+      return std::min (0.0, m_max);
+    }
+  uint32_t buckets = 1u << m_significantBits;
+  for (int i = 0; i < kExponents; i++)
+    {
+      const std::vector<uint64_t> &counts = m_counts[i];
+      for (size_t bucket = 0; bucket < counts.size (); bucket++)
+        {
+          seen += counts[bucket];
+          if (seen >= rank)
+            {
+              // The middle of the bucket, within the exact range.
+              double mantissa = 0.5 + (bucket + 0.5) / (2.0 * buckets);
+              double value = std::ldexp (mantissa, i + kMinExponent);
+              return std::max (m_min, std::min (m_max, value));
+            }
+        }
+    }
+  return m_max;
+}
+
+uint64_t
+QuicQuantileSketch::GetCount (void) const
+{
+  return m_count;
+}
+
+double
+QuicQuantileSketch::GetMin (void) const
+{
+  return m_min;
+}
+
+double
+QuicQuantileSketch::GetMax (void) const
+{
+  return m_max;
+}
+
+double
+QuicQuantileSketch::GetMean (void) const
+{
+  return m_count == 0 ? 0 : m_sum / m_count;
+}
+
+QuicPercentiles
+QuicPercentiles::FromSketch (const QuicQuantileSketch &sketch)
+{
+  QuicPercentiles percentiles;
+  percentiles.count = sketch.GetCount ();
+  percentiles.p50 = sketch.GetQuantile (0.5);
+  percentiles.p99 = sketch.GetQuantile (0.99);
+  percentiles.p999 = sketch.GetQuantile (0.999);
+  percentiles.max = sketch.GetMax ();
+  return percentiles;
+}
+
+} // namespace ns3
@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUIC_QUANTILE_SKETCH_H
+#define QUIC_QUANTILE_SKETCH_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * \brief Online quantile estimator with constant memory.
+ *
+ * An HDR-histogram style log-linear histogram: every power of two between
+ * 2^-16 and 2^48 is split into 2^SignificantBits equal buckets, so any
+ * quantile is known within a relative error of 2^-(SignificantBits+1),
+ * whatever the number of samples. The buckets of a power of two are only
+ * allocated once a sample falls into it, which keeps the typical sketch
+ * to a few kilobytes; the bound is 64 * 2^SignificantBits counters.
+ * Values outside the range are clamped into it; zero and negative values
+ * are counted as zero. Min, max and mean are exact.
+ */
+class QuicQuantileSketch
+{
+public:
+  /**
+   * \param significantBits log2 of the number of buckets per power of two
+   */
+  explicit QuicQuantileSketch (uint32_t significantBits = 6);
+
+  /**
+   * \brief Account for a sample.
+   * \param value the sample
+   */
+  void Add (double value);
+
+  /**
+   * \brief Add the samples of another sketch of the same precision.
+   * \param other the sketch to merge
+   */
+  void Merge (const QuicQuantileSketch &other);
+
+  /**
+   * \brief Forget every sample.
+   */
+  void Reset (void);
+
+  /**
+   * \brief Estimate a quantile.
+   * \param q the quantile, in [0, 1]
+   * \return the estimate, or 0 if there are no samples
+   */
+  double GetQuantile (double q) const;
+
+  /// \return the number of samples
+  uint64_t GetCount (void) const;
+  /// \return the smallest sample, or 0 if there are none
+  double GetMin (void) const;
+  /// \return the largest sample, or 0 if there are none
+  double GetMax (void) const;
+  /// \return the mean of the samples, or 0 if there are none
+  double GetMean (void) const;
+
+private:
+  static const int kMinExponent = -16; //!< frexp exponent of the first bucket
+  static const int kExponents = 64;    //!< Powers of two covered
+
+  uint32_t m_significantBits;           //!< log2 of the buckets per power of two
+  std::vector<std::vector<uint64_t> > m_counts; //!< Buckets by exponent
+  uint64_t m_zeros;                     //!< Samples <= 0
+  uint64_t m_count;                     //!< Samples
+  double   m_sum;                       //!< Sum of the samples
+  double   m_min;                       //!< Smallest sample
+  double   m_max;                       //!< Largest sample
+};
+
+/**
+ * \ingroup applications
+ *
+ * \brief The quantiles of a QuicQuantileSketch that experiments report.
+ */
+struct QuicPercentiles
+{
+  uint64_t count;  //!< Samples
+  double   p50;    //!< Median
+  double   p99;    //!< 99th percentile
+  double   p999;   //!< 99.9th percentile
+  double   max;    //!< Largest sample
+
+  /**
+   * \brief Read the percentiles of a sketch.
+   * \param sketch the sketch
+   * \return the percentiles
+   */
+  static QuicPercentiles FromSketch (const QuicQuantileSketch &sketch);
+};
+
+} // namespace ns3
+
+#endif /* QUIC_QUANTILE_SKETCH_H */
@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulator.h"
+#include "quic-random.h"
+
+#include <cstring>
+#include <memory>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QuicRngStreamRandom");
+
+namespace {
+
+// Stream index of the QUIC generator. ns-3 hands out streams below 2^63
+// to AssignStreams() and above it automatically, so pick one from the
+// middle of the manual range that no model is likely to assign.
+const uint64_t kQuicRandomStream = (UINT64_C (1) << 62) + 0x51554943;
+
+std::unique_ptr<QuicRngStreamRandom> g_random;
+
+} // namespace
+
+QuicRngStreamRandom::QuicRngStreamRandom (uint32_t seed, uint64_t run)
+  : m_stream (seed, kQuicRandomStream, run),
+    m_seed (seed),
+    m_run (run)
+{
+  NS_LOG_FUNCTION (this << seed << run);
+}
+
+void
+QuicRngStreamRandom::Install (uint32_t seed, uint64_t run)
+{
+  if (seed == 0)
+    {
+      seed = RngSeedManager::GetSeed ();
+    }
+  if (run == 0)
+    {
+      run = RngSeedManager::GetRun ();
+    }
+  if (g_random)
+    {
+      if (g_random->GetSeed () != seed || g_random->GetRun () != run)
+        {
+          // Connection helpers keep the instance, so it is re-seeded rather
+          // than replaced.
+          NS_LOG_INFO ("Re-seeding the QUIC random generator from "
+                       << g_random->GetSeed () << "/" << g_random->GetRun ()
+                       << " to " << seed << "/" << run);
+          g_random->Reset (seed, run);
+        }
+      return;
+    }
+  g_random.reset (new QuicRngStreamRandom (seed, run));
+  net::QuicRandom::SetInstance (g_random.get ());
+  // The next simulation starts over from its own seed and run.
+  Simulator::ScheduleDestroy (&QuicRngStreamRandom::Uninstall);
+}
+
+void
+QuicRngStreamRandom::Uninstall (void)
+{
+  net::QuicRandom::SetInstance (nullptr);
+  g_random.reset ();
+}
+
+void
+QuicRngStreamRandom::Reset (uint32_t seed, uint64_t run)
+{
+  NS_LOG_FUNCTION (this << seed << run);
+  m_stream = RngStream (seed, kQuicRandomStream, run);
+  m_seed = seed;
+  m_run = run;
+}
+
+uint32_t
+QuicRngStreamRandom::GetSeed (void) const
+{
+  return m_seed;
+}
+
+uint64_t
+QuicRngStreamRandom::GetRun (void) const
+{
+  return m_run;
+}
+
+uint32_t
+QuicRngStreamRandom::Next32 (void)
+{
+  // MRG32k3a yields multiples of 1/m1 with m1 just below 2^32, which is as
+  // many bits as one draw carries.
+  return static_cast<uint32_t> (m_stream.RandU01 () * 4294967296.0);
+}
+
+void
+QuicRngStreamRandom::RandBytes (void *data, size_t len)
+{
+  uint8_t *out = static_cast<uint8_t *> (data);
+  while (len >= sizeof (uint32_t))
+    {
+      uint32_t word = Next32 ();
+      std::memcpy (out, &word, sizeof (word));
+      out += sizeof (word);
+      len -= sizeof (word);
+    }
+  if (len > 0)
+    {
+      uint32_t word = Next32 ();
+      std::memcpy (out, &word, len);
+    }
+}
+
+uint64_t
+QuicRngStreamRandom::RandUint64 ()
+{
+  uint64_t high = Next32 ();
+  return (high << 32) | Next32 ();
+}
+
+void
+QuicRngStreamRandom::Reseed (const void *additional_entropy, size_t entropy_len)
+{
+  // Mixing in outside entropy would defeat the point of this generator.
+}
+
+} // namespace ns3
@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUIC_RANDOM_H
+#define QUIC_RANDOM_H
+
+#include "ns3/rng-stream.h"
+
+#include "net/quic/core/crypto/quic_random.h"
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * \brief QuicRandom drawing its bytes from an ns-3 RngStream.
+ *
+ * Connection IDs, nonces and keys generated by Chromium's QUIC code come
+ * from net::QuicRandom::GetInstance(), which by default reads OS entropy.
+ * Installing a QuicRngStreamRandom makes them a function of the seed and
+ * run number, so two runs with the same ones are bit-identical.
+ *
+ * Not suitable for anything but simulation.
+ */
+class QuicRngStreamRandom : public net::QuicRandom
+{
+public:
+  /**
+   * \param seed the RngStream seed
+   * \param run the substream, i.e. the ns-3 run number
+   */
+  QuicRngStreamRandom (uint32_t seed, uint64_t run);
+
+  /**
+   * \brief Make net::QuicRandom::GetInstance() return a stream for
+   * \p seed and \p run.
+   *
+   * The first call creates the process-wide generator; later calls with
+   * the same seed and run keep using it so that every application draws
+   * from the same sequence, while a different seed or run restarts it from
+   * the new ones. Simulator::Destroy() uninstalls it. Zero selects the
+   * ns-3 global RngSeed or RngRun.
+   *
+   * \param seed the RngStream seed, or 0
+   * \param run the run number, or 0
+   */
+  static void Install (uint32_t seed, uint64_t run);
+
+  /**
+   * \brief Restore the default, entropy backed, net::QuicRandom.
+   */
+  static void Uninstall (void);
+
+  // net::QuicRandom
+  void RandBytes (void *data, size_t len) override;
+  uint64_t RandUint64 () override;
+  void Reseed (const void *additional_entropy, size_t entropy_len) override;
+
+  uint32_t GetSeed (void) const;
+  uint64_t GetRun (void) const;
+
+private:
+  /**
+   * \brief Restart the stream from \p seed and \p run.
+   * \param seed the RngStream seed
+   * \param run the substream
+   */
+  void Reset (uint32_t seed, uint64_t run);
+
+  /**
+   * \return 32 uniformly distributed bits
+   */
+  uint32_t Next32 (void);
+
+  RngStream m_stream; //!< Source of the bits
+  uint32_t m_seed;    //!< Seed the stream was created with
+  uint64_t m_run;     //!< Substream the stream was created with
+};
+
+} // namespace ns3
+
+#endif /* QUIC_RANDOM_H */
@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/fatal-error.h"
+#include "ns3/uinteger.h"
+#include "quic-results-writer.h"
+
+#include "third_party/zlib/zlib.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QuicResultsWriter");
+
+NS_OBJECT_ENSURE_REGISTERED (QuicResultsWriter);
+
+namespace {
+
+const char kMagic[4] = {'Q', 'R', 'E', 'S'};
+const uint32_t kVersion = 1;
+const uint32_t kFlagCompressed = 1;
+
+void
+WriteUint32 (std::ofstream &file, uint32_t value)
+{
+  unsigned char bytes[4];
+  for (int i = 0; i < 4; i++)
+    {
+      bytes[i] = static_cast<unsigned char> (value >> (8 * i));
+    }
+  file.write (reinterpret_cast<const char *> (bytes), sizeof (bytes));
+}
+
+} // namespace
+
+TypeId
+QuicResultsWriter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuicResultsWriter")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<QuicResultsWriter> ()
+    .AddAttribute ("Compress",
+                   "Whether to deflate each block with zlib.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&QuicResultsWriter::m_compress),
+                   MakeBooleanChecker ())
+    .AddAttribute ("BlockRecords",
+                   "Number of records buffered before a block is written.",
+                   UintegerValue (4096),
+                   MakeUintegerAccessor (&QuicResultsWriter::m_blockRecords),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+QuicResultsWriter::QuicResultsWriter ()
+  : m_buffered (0),
+    m_records (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+QuicResultsWriter::~QuicResultsWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+QuicResultsWriter::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  Object::DoDispose ();
+}
+
+void
+QuicResultsWriter::AddColumn (std::string name, ColumnType type)
+{
+  NS_LOG_FUNCTION (this << name << type);
+  NS_ASSERT_MSG (!m_file.is_open (), "AddColumn() after Open()");
+  NS_ASSERT_MSG (name.size () <= 255, "Column name too long: " << name);
+  Column column;
+  column.name = name;
+  column.type = type;
+  m_columns.push_back (column);
+}
+
+void
+QuicResultsWriter::Open (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  NS_ASSERT_MSG (!m_columns.empty (), "Open() without columns");
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_file)
+    {
+      NS_FATAL_ERROR ("Cannot create results file " << filename);
+    }
+
+  m_file.write (kMagic, sizeof (kMagic));
+  WriteUint32 (m_file, kVersion);
+  WriteUint32 (m_file, m_columns.size ());
+  WriteUint32 (m_file, m_compress ? kFlagCompressed : 0);
+  for (const Column &column : m_columns)
+    {
+      m_file.put (static_cast<char> (column.type));
+      m_file.put (static_cast<char> (column.name.size ()));
+      m_file.write (column.name.data (), column.name.size ());
+    }
+
+  m_block.assign (m_columns.size () * m_blockRecords, 0);
+  if (m_compress)
+    {
+      m_deflated.resize (compressBound (m_block.size () * sizeof (uint64_t)));
+    }
+  m_buffered = 0;
+  m_records = 0;
+}
+
+void
+QuicResultsWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this << m_buffered);
+  if (m_buffered == 0)
+    {
+      return;
+    }
+  // Only the first m_buffered values of each column are valid; pack them
+  // next to each other when the block is partial.
+  if (m_buffered < m_blockRecords)
+    {
+      for (size_t column = 1; column < m_columns.size (); column++)
+        {
+          std::memmove (&m_block[column * m_buffered],
+                        &m_block[column * m_blockRecords],
+                        m_buffered * sizeof (uint64_t));
+        }
+    }
+  size_t rawBytes = m_columns.size () * m_buffered * sizeof (uint64_t);
+  const char *payload = reinterpret_cast<const char *> (m_block.data ());
+  size_t payloadBytes = rawBytes;
+  if (m_compress)
+    {
+      uLongf deflatedBytes = m_deflated.size ();
+      int rc = compress2 (m_deflated.data (), &deflatedBytes,
+                          reinterpret_cast<const Bytef *> (payload), rawBytes,
+                          Z_BEST_SPEED);
+      if (rc != Z_OK)
+        {
+          NS_FATAL_ERROR ("Cannot compress results block: zlib error " << rc);
+        }
+      payload = reinterpret_cast<const char *> (m_deflated.data ());
+      payloadBytes = deflatedBytes;
+    }
+  WriteUint32 (m_file, m_buffered);
+  WriteUint32 (m_file, payloadBytes);
+  m_file.write (payload, payloadBytes);
+  m_buffered = 0;
+}
+
+void
+QuicResultsWriter::Close (void)
+{
+  if (!m_file.is_open ())
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  m_file.close ();
+  m_block.clear ();
+  m_block.shrink_to_fit ();
+  m_deflated.clear ();
+  m_deflated.shrink_to_fit ();
+}
+
+uint64_t
+QuicResultsWriter::GetRecords (void) const
+{
+  return m_records;
+}
+
+} // namespace ns3
@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUIC_RESULTS_WRITER_H
+#define QUIC_RESULTS_WRITER_H
+
+#include "ns3/assert.h"
+#include "ns3/object.h"
+
+#include <stdint.h>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * \brief Streams simulation samples to a compact binary file.
+ *
+ * Samples are fixed-width records of int64 or double columns. They are
+ * buffered column by column in a block of BlockRecords records, and the
+ * block is written out, zlib-compressed if Compress is set, whenever it
+ * fills up. Memory is bounded by one block whatever the length of the
+ * run, and Write() costs O(1) amortized.
+ *
+ * File layout, all integers little-endian (values are copied from memory,
+ * so the writer assumes a little-endian host, like every ns-3 target):
+ *
+ * \verbatim
+   header   "QRES", uint32 version (1), uint32 columns, uint32 flags
+            (bit 0: blocks are compressed), then per column a uint8 type
+            (0 int64, 1 double), a uint8 name length and the name
+   block    uint32 records N, uint32 payload bytes, payload: every column
+            in turn as N 8-byte values, deflated if compressed
+   \endverbatim
+ *
+ * experiments/qres2dat.py turns a file back into the tab-separated
+ * text the gnuplot scripts read.
+ */
+class QuicResultsWriter : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// Type of the values of a column.
+  enum ColumnType
+  {
+    INT64 = 0,   //!< Signed 64-bit integer
+    DOUBLE = 1   //!< IEEE 754 double
+  };
+
+  QuicResultsWriter ();
+  virtual ~QuicResultsWriter ();
+
+  /**
+   * \brief Add a column; must be called before Open().
+   * \param name column name, at most 255 bytes
+   * \param type type of the column values
+   */
+  void AddColumn (std::string name, ColumnType type);
+
+  /**
+   * \brief Create the file and write its header.
+   * \param filename path of the file
+   */
+  void Open (std::string filename);
+
+  /**
+   * \brief Append one record, one value per column in column order.
+   *
+   * Values are converted to the type of their column.
+   */
+  template <typename... Values>
+  void Write (Values... values);
+
+  /**
+   * \brief Write out the buffered records and close the file.
+   */
+  void Close (void);
+
+  /**
+   * \return the number of records written so far
+   */
+  uint64_t GetRecords (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// A column of the file.
+  struct Column
+  {
+    std::string name;  //!< Column name
+    ColumnType type;   //!< Type of the values
+  };
+
+  /**
+   * \brief Store a value in the current record.
+   * \param column index of the column
+   * \param value the value, converted to the column type
+   */
+  template <typename T>
+  void Set (size_t column, T value);
+
+  /**
+   * \brief Write out the buffered block.
+   */
+  void Flush (void);
+
+  bool        m_compress;       //!< Deflate the blocks
+  uint32_t    m_blockRecords;   //!< Records per block
+  std::vector<Column> m_columns; //!< Columns of the file
+  std::ofstream m_file;         //!< Output file
+  std::vector<uint64_t> m_block; //!< Buffered values, column-major
+  std::vector<unsigned char> m_deflated; //!< Compression buffer
+  uint32_t    m_buffered;       //!< Records in m_block
+  uint64_t    m_records;        //!< Records written so far
+};
+
+template <typename T>
+void
+QuicResultsWriter::Set (size_t column, T value)
+{
+  uint64_t bits;
+  if (m_columns[column].type == DOUBLE)
+    {
+      double d = static_cast<double> (value);
+      std::memcpy (&bits, &d, sizeof (bits));
+    }
+  else
+    {
+      int64_t i = static_cast<int64_t> (value);
+      std::memcpy (&bits, &i, sizeof (bits));
+    }
+  m_block[column * m_blockRecords + m_buffered] = bits;
+}
+
+template <typename... Values>
+void
+QuicResultsWriter::Write (Values... values)
+{
+  NS_ASSERT_MSG (sizeof... (values) == m_columns.size (),
+                 "Expected " << m_columns.size () << " values per record");
+  NS_ASSERT_MSG (m_file.is_open (), "Write() before Open()");
+  size_t column = 0;
+  int expand[] = {0, (Set (column++, values), 0)...};
+  (void) expand;
+  if (++m_buffered == m_blockRecords)
+    {
+      Flush ();
+    }
+  m_records++;
+}
+
+} // namespace ns3
+
+#endif /* QUIC_RESULTS_WRITER_H */
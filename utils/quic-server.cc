@@ -27,12 +27,20 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/string.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/quic-socket-factory.h"
 #include "ns3/quic-header.h"
 #include "ns3/quic-stream-frame.h"
 #include "quic-server.h"
-#include "quic-client.h"
+#include "quic-crypto-cache.h"
+#include "quic-profiler.h"
+#include "quic-random.h"
+#include "helper/socket_ns3.h"
 
 #include <iostream>
 using namespace std;
@@ -45,9 +53,10 @@ using namespace std;
 #include "model/base/strings/string_number_conversions.h"
 #include "model/net/base/ip_address.h"
 #include "model/net/base/ip_endpoint.h"
-#include "model/net/quic/chromium/crypto/proof_source_chromium.h"
+#include "model/net/quic/chromium/quic_chromium_packet_reader.h"
 #include "model/net/quic/core/quic_packets.h"
 #include "model/net/tools/quic/quic_http_response_cache.h"
+#include "model/net/tools/quic/quic_simple_dispatcher.h"
 #include "model/net/tools/quic/quic_simple_server.h"
 #include "model/net/base/ip_address.h"
 #include "model/net/base/ip_endpoint.h"
@@ -57,13 +66,6 @@ using net::IPEndPoint;
 // The port the quic server will listen on.
 int32_t FLAGS_port = 6121;
 
-std::unique_ptr<net::ProofSource> CreateProofSource() {
-  std::unique_ptr<net::ProofSourceChromium> proof_source(
-      new net::ProofSourceChromium());
-  CHECK(proof_source->Initialize(base::FilePath("src/quic/model/net/tools/quic/certs/out/leaf_cert.pem"), base::FilePath("src/quic/model/net/tools/quic/certs/out/leaf_cert.pkcs8"), base::FilePath()));
-  return std::move(proof_source);
-}
-
 
 namespace ns3 {
 
@@ -71,6 +73,28 @@ NS_LOG_COMPONENT_DEFINE ("QuicServer");
 
 NS_OBJECT_ENSURE_REGISTERED (QuicServer);
 
+class QuicServer::ConnectionTracer
+  : public net::QuicSimpleDispatcher::ConnectionObserver
+{
+public:
+  ConnectionTracer (QuicServer *server)
+    : m_server (server)
+  {
+  }
+
+  void OnConnectionClosed (net::QuicConnection *connection,
+                           net::QuicErrorCode error) override
+  {
+    NS_LOG_INFO ("Connection " << connection->connection_id () << " closed: "
+                 << net::QuicErrorCodeToString (error));
+    m_server->m_connectionClosedTrace (QuicConnectionSummary::FromStats (
+        connection->GetStats (), m_server->m_context->GetClock ()));
+  }
+
+private:
+  QuicServer *m_server; //!< Application owning the traces
+};
+
 TypeId
 QuicServer::GetTypeId (void)
 {
@@ -95,13 +119,106 @@ QuicServer::GetTypeId (void)
                    UintegerValue (0),
                    MakeUintegerAccessor (&QuicServer::m_maxBytes),
                    MakeUintegerChecker<uint64_t> ())
-    .AddAttribute ("Protocol", "The type of protocol to use.",
+    .AddAttribute ("Protocol",
+                   "The type of protocol to use: ns3::UdpSocketFactory to "
+                   "go through the socket_ns3 descriptors, or "
+                   "ns3::QuicSocketFactory for a socket of the node's "
+                   "QuicL4Protocol.",
                    TypeIdValue (UdpSocketFactory::GetTypeId ()),
                    MakeTypeIdAccessor (&QuicServer::m_tid),
                    MakeTypeIdChecker ())
+    .AddAttribute ("DrainReads",
+                   "Whether to read every queued datagram on each socket "
+                   "wakeup instead of a single one.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&QuicServer::m_drainReads),
+                   MakeBooleanChecker ())
+    .AddAttribute ("DeterministicRandom",
+                   "Whether QUIC connection IDs, nonces and keys are drawn "
+                   "from an ns-3 RngStream instead of OS entropy.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&QuicServer::m_deterministicRandom),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RandomSeed",
+                   "Seed of the QUIC random stream; 0 uses the global RngSeed.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&QuicServer::m_randomSeed),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("RandomRun",
+                   "Run number of the QUIC random stream; 0 uses the global RngRun.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&QuicServer::m_randomRun),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("NullEncryption",
+                   "Whether to offer clients the null AEAD, which leaves "
+                   "payloads unencrypted but keeps the 12-byte tag.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&QuicServer::m_nullEncryption),
+                   MakeBooleanChecker ())
+    .AddAttribute ("CertificateFile",
+                   "PEM certificate chain served to clients, leaf first. "
+                   "Relative paths are resolved against the working directory.",
+                   StringValue ("src/quic/model/net/tools/quic/certs/out/leaf_cert.pem"),
+                   MakeStringAccessor (&QuicServer::m_certFile),
+                   MakeStringChecker ())
+    .AddAttribute ("KeyFile",
+                   "PKCS#8 private key of the leaf certificate.",
+                   StringValue ("src/quic/model/net/tools/quic/certs/out/leaf_cert.pkcs8"),
+                   MakeStringAccessor (&QuicServer::m_keyFile),
+                   MakeStringChecker ())
+    .AddAttribute ("RandomBody",
+                   "Whether response bodies are drawn from the QUIC random "
+                   "generator instead of a fixed repeating pattern.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&QuicServer::m_randomBody),
+                   MakeBooleanChecker ())
+    .AddAttribute ("CongestionControl",
+                   "Congestion controller of the server side of each "
+                   "connection. Default keeps Cubic, or the one the client "
+                   "selects with connection options.",
+                   EnumValue (QUIC_CC_DEFAULT),
+                   MakeEnumAccessor (&QuicServer::m_congestionControl),
+                   MakeQuicCongestionControlChecker ())
+    .AddAttribute ("InitialCongestionWindow",
+                   "Initial congestion window, in packets, of the server "
+                   "side of each connection; 0 keeps the default of 32.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&QuicServer::m_initialCongestionWindow),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxCongestionWindow",
+                   "Maximum congestion window, in packets, of the server "
+                   "side of each connection; 0 keeps the default of 2000.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&QuicServer::m_maxCongestionWindow),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("StreamFlowControlWindow",
+                   "Receive window, in bytes, the server advertises for "
+                   "each stream; 0 keeps the default of 64 KB.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&QuicServer::m_streamFlowControlWindow),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("SessionFlowControlWindow",
+                   "Receive window, in bytes, the server advertises for "
+                   "each connection; 0 keeps the default of 1 MB.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&QuicServer::m_sessionFlowControlWindow),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Pacing",
+                   "Whether the server paces its packets.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&QuicServer::m_pacing),
+                   MakeBooleanChecker ())
     .AddTraceSource ("Tx", "A new packet is created and is sent",
                      MakeTraceSourceAccessor (&QuicServer::m_txTrace),
                      "ns3::Packet::TracedCallback")
+    .AddTraceSource ("PacketsPerWakeup",
+                     "Number of packets read in one socket wakeup",
+                     MakeTraceSourceAccessor (&QuicServer::m_packetsPerWakeupTrace),
+                     "ns3::TracedValueCallback::Uint32")
+    .AddTraceSource ("ConnectionClosed",
+                     "A connection closed",
+                     MakeTraceSourceAccessor (&QuicServer::m_connectionClosedTrace),
+                     "ns3::QuicConnectionSummary::TracedCallback")
   ;
   return tid;
 }
@@ -110,7 +227,10 @@ QuicServer::GetTypeId (void)
 QuicServer::QuicServer ()
   : m_socket (0),
     m_connected (false),
-    m_totBytes (0)
+    m_totBytes (0),
+    m_readWakeups (0),
+    m_packetsRead (0),
+    server (nullptr)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -127,6 +247,18 @@ QuicServer::SetMaxBytes (uint64_t maxBytes)
   m_maxBytes = maxBytes;
 }
 
+uint64_t
+QuicServer::GetReadWakeups (void) const
+{
+  return m_readWakeups;
+}
+
+uint64_t
+QuicServer::GetPacketsRead (void) const
+{
+  return m_packetsRead;
+}
+
 Ptr<Socket>
 QuicServer::GetSocket (void) const
 {
@@ -139,7 +271,23 @@ QuicServer::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
 
+  if (m_connectionTracer && server->dispatcher ())
+    {
+      static_cast<net::QuicSimpleDispatcher *> (server->dispatcher ())
+        ->set_connection_observer (nullptr);
+    }
+  m_connectionTracer.reset ();
+  if (server)
+    {
+      // Closes the server's socket, and its descriptor in the shim, without
+      // notifying the clients.
+      QuicContext::Scope scope (m_context);
+      delete server;
+      server = nullptr;
+    }
+  m_responseCache.reset ();
   m_socket = 0;
+  m_context = 0;
   // chain up
   Application::DoDispose ();
 }
@@ -150,27 +298,68 @@ void QuicServer::StartApplication (void) // Called at time specified by Start
   NS_LOG_FUNCTION (this);
   //cerr << "Server start" << endl;
 
-  kCurNode = GetNode();
-
-  if(!QuicClient::exit_manager) QuicClient::exit_manager = new base::AtExitManager;
-  if(!QuicClient::message_loop) QuicClient::message_loop = new base::MessageLoopForIO;
+  QuicContext::EnsureMessageLoop ();
+  if (m_deterministicRandom)
+    {
+      QuicRngStreamRandom::Install (m_randomSeed, m_randomRun);
+    }
+  m_context = QuicContext::Get (GetNode ());
+  QuicContext::Scope scope (m_context);
 
-  net::QuicHttpResponseCache response_cache;
+  m_responseCache.reset (new net::QuicHttpResponseCache);
+  m_responseCache->set_synthetic_body_type (
+    m_randomBody ? net::QuicHttpResponseCache::RANDOM_BODY
+                 : net::QuicHttpResponseCache::PATTERN_BODY);
 
   net::IPAddress ip = net::IPAddress::IPv6AllZeros();
 
   net::QuicConfig config;
+  QuicTransportConfig transport = {
+    m_congestionControl, m_initialCongestionWindow, m_maxCongestionWindow,
+    m_streamFlowControlWindow, m_sessionFlowControlWindow, m_pacing
+  };
+  transport.Apply (&config);
+  net::QuicCryptoServerConfig::ConfigOptions cryptoOptions;
+  cryptoOptions.null_encryption = m_nullEncryption;
+  // Every server with the same certificate and options shares one parsed
+  // chain and one signed server config.
   server = new net::QuicSimpleServer(
-      CreateProofSource(),
-      config, net::QuicCryptoServerConfig::ConfigOptions(),
-      net::AllSupportedVersions(), &response_cache);
+      QuicServerCryptoCache::GetCryptoConfig (m_certFile, m_keyFile,
+                                              cryptoOptions,
+                                              m_context->GetClock ()),
+      config, net::AllSupportedVersions(), m_responseCache.get (),
+      m_context->CreateConnectionHelper (), m_context->CreateAlarmFactory ());
 
   server->server_ = this;
 
-  int rc = server->Listen(net::IPEndPoint(ip, FLAGS_port));
-  if (rc < 0) {
-    return;
-  }
+  if (m_tid == QuicSocketFactory::GetTypeId ())
+    {
+      // Datagrams go straight between the QuicL4Protocol socket and the
+      // dispatcher, see HandleRead.
+      m_socket = Socket::CreateSocket (GetNode (), m_tid);
+      // MTU probes must be lost, not fragmented, when they exceed the path MTU.
+      m_socket->SetAttribute ("MtuDiscover", BooleanValue (true));
+      if (m_socket->Bind (InetSocketAddress (Ipv4Address::GetAny (), FLAGS_port)) < 0)
+        {
+          NS_FATAL_ERROR ("Cannot bind the QUIC socket to port " << FLAGS_port);
+        }
+      if (server->Listen (m_socket) < 0)
+        {
+          return;
+        }
+      m_socket->SetRecvCallback (MakeCallback (&QuicServer::HandleRead, this));
+    }
+  else
+    {
+      int rc = server->Listen(net::IPEndPoint(ip, FLAGS_port));
+      if (rc < 0) {
+        return;
+      }
+    }
+
+  m_connectionTracer.reset (new ConnectionTracer (this));
+  static_cast<net::QuicSimpleDispatcher *> (server->dispatcher ())
+    ->set_connection_observer (m_connectionTracer.get ());
 
   //cerr << "Server End" << endl;
 }
@@ -179,8 +368,15 @@ void QuicServer::StopApplication (void) // Called at time specified by Stop
 {
   NS_LOG_FUNCTION (this);
 
+  if (server)
+    {
+      // Closes the connections, then the socket the server listens on.
+      QuicContext::Scope scope (m_context);
+      server->Shutdown ();
+    }
   if (m_socket != 0)
     {
+      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
       m_socket->Close ();
       m_connected = false;
     }
@@ -248,29 +444,77 @@ void QuicServer::SendData (void)
 
 void QuicServer::HandleRead (Ptr<Socket> s)
 {
-  s->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+  if (!server || !server->dispatcher () || s->GetRxAvailable () == 0)
+    {
+      // A yielded wakeup whose queue was already drained, or that comes
+      // after the server was shut down.
+      return;
+    }
+  bool native = (s == m_socket);
+  if (!native)
+    {
+      // QuicSimpleServer::StartReading arms the callback again.
+      s->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+    }
   NS_LOG_FUNCTION (this << s);
+  QuicContext::Scope scope (m_context);
+  QUIC_PROFILE_SCOPE (APPLICATION);
   NS_LOG_INFO ("Received packet.");
   //cerr << "\nServer::HandleRead()" << endl;
-  QuicClient::last_time = Simulator::Now();
 
 
-  Address ad;
-  //Ptr<Packet> pk = s->RecvFrom(ad);
-  //if(!pk) return server->OnReadComplete(0);
-  int ret = s->RecvFrom(reinterpret_cast<uint8_t*>(server->read_buffer_->data()), server->read_buffer_->size(), 0, ad);
-  //cerr << "Read " << ret << " bytes" << endl;
+  // Simulated time does not advance while draining, so in practice the
+  // packet budget is what bounds a single wakeup.
+  Time yieldAfter = Simulator::Now () + MilliSeconds (net::kQuicYieldAfterDurationMilliseconds);
+  uint32_t packets = 0;
+  do
+    {
+      Address ad;
+      packets++;
+      if (native)
+        {
+          Ptr<Packet> packet;
+          {
+            QUIC_PROFILE_SCOPE (NS3_SOCKET);
+            packet = s->RecvFrom (ad);
+          }
+          server->ProcessPacket (packet, ad);
+        }
+      else
+        {
+          //Ptr<Packet> pk = s->RecvFrom(ad);
+          //if(!pk) return server->OnReadComplete(0);
+          int ret;
+          {
+            QUIC_PROFILE_SCOPE (NS3_SOCKET);
+            ret = s->RecvFrom(reinterpret_cast<uint8_t*>(server->read_buffer_->data()), server->read_buffer_->size(), 0, ad);
+          }
+          //cerr << "Read " << ret << " bytes" << endl;
+
+          // Built from the address bytes, which cannot fail the way
+          // parsing its text form could.
+          InetSocketAddress ip = InetSocketAddress::ConvertFrom(ad);
+          uint8_t bytes[4];
+          ip.GetIpv4 ().Serialize (bytes);
+          server->client_address_ = IPEndPoint(IPAddress(bytes), ip.GetPort());
+
+          server->OnReadComplete(ret);
+        }
+    }
+  while (m_drainReads && s->GetRxAvailable () > 0
+         && packets < uint32_t (net::kQuicYieldAfterPacketsRead)
+         && Simulator::Now () <= yieldAfter);
 
-  InetSocketAddress ip = InetSocketAddress::ConvertFrom(ad);
-  uint8_t buf[Address::MAX_SIZE];
-  int len = ad.CopyTo(buf);
-  stringstream ss;
-  ss << ip.GetIpv4();
-  IPAddress ipp;
-  assert(ipp.AssignFromIPLiteral(ss.str()));
-  server->client_address_ = IPEndPoint(ipp, InetSocketAddress::ConvertFrom(ad).GetPort());
+  m_readWakeups++;
+  m_packetsRead += packets;
+  m_packetsPerWakeupTrace (packets);
 
-  server->OnReadComplete(ret);
+  if (m_drainReads && s->GetRxAvailable () > 0)
+    {
+      // Out of budget: yield to the scheduler and pick up the rest of the
+      // queue in a fresh event, like the packet reader's PostTask().
+      Simulator::ScheduleNow (&QuicServer::HandleRead, this, s);
+    }
   //cerr << "QuicServer::HandleRead() FINISHED\n" << endl;
 }
 
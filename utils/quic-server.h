@@ -26,8 +26,15 @@
 #include "ns3/event-id.h"
 #include "ns3/ptr.h"
 #include "ns3/traced-callback.h"
+#include "quic-connection-summary.h"
+#include "quic-context.h"
+#include "quic-transport-config.h"
+
+#include <memory>
+#include <string>
 
 namespace net {
+class QuicHttpResponseCache;
 class QuicSimpleServer;
 } // namespace net
 
@@ -89,10 +96,25 @@ public:
 
   /**
    * \brief Handle an incoming packet
+   *
+   * When DrainReads is enabled every datagram queued on the socket is
+   * dispatched, up to the kQuicYieldAfterPacketsRead and
+   * kQuicYieldAfterDurationMilliseconds budgets of the packet reader.
+   *
    * \param socket the incoming packet socket
    */
   void HandleRead (Ptr<Socket> socket);
 
+  /**
+   * \return the number of HandleRead wakeups that read at least one packet
+   */
+  uint64_t GetReadWakeups (void) const;
+
+  /**
+   * \return the number of packets read over all wakeups
+   */
+  uint64_t GetPacketsRead (void) const;
+
 protected:
   virtual void DoDispose (void);
 private:
@@ -106,6 +128,7 @@ private:
   void SendData ();
 
   Ptr<Socket>     m_socket;       //!< Associated socket
+  Ptr<QuicContext> m_context;     //!< QUIC state of this node
   Address         m_local;        //!< Local address to bind to
   Address         m_from;         //!< Address to send data to
   bool            m_connected;    //!< True if connected
@@ -113,12 +136,39 @@ private:
   uint64_t        m_maxBytes;     //!< Limit total number of bytes sent
   uint64_t        m_totBytes;     //!< Total bytes sent so far
   TypeId          m_tid;          //!< The type of protocol to use.
+  bool            m_drainReads;   //!< Read every queued datagram per wakeup
+  uint64_t        m_readWakeups;  //!< Wakeups that read at least one packet
+  uint64_t        m_packetsRead;  //!< Packets read over all wakeups
+  bool            m_deterministicRandom; //!< Seed QuicRandom from ns-3
+  uint32_t        m_randomSeed;   //!< Seed of the QUIC random stream
+  uint64_t        m_randomRun;    //!< Run of the QUIC random stream
+  bool            m_nullEncryption; //!< Offer the null AEAD
+  std::string     m_certFile;     //!< Certificate chain file
+  std::string     m_keyFile;      //!< Private key file
+  bool            m_randomBody;   //!< Fill responses from QuicRandom
+  QuicCongestionControl m_congestionControl; //!< Congestion controller
+  uint32_t        m_initialCongestionWindow; //!< Packets, 0 for the default
+  uint32_t        m_maxCongestionWindow; //!< Packets, 0 for the default
+  uint32_t        m_streamFlowControlWindow; //!< Bytes, 0 for the default
+  uint32_t        m_sessionFlowControlWindow; //!< Bytes, 0 for the default
+  bool            m_pacing;       //!< Whether packets are paced
 
   /// Traced Callback: sent packets
   TracedCallback<Ptr<const Packet> > m_txTrace;
 
+  /// Traced Callback: packets read in one HandleRead wakeup.
+  TracedCallback<uint32_t> m_packetsPerWakeupTrace;
+
+  /// Traced Callback: a connection closed.
+  TracedCallback<const QuicConnectionSummary &> m_connectionClosedTrace;
+
+  /// Feeds the connections closed by the dispatcher to the traces.
+  class ConnectionTracer;
+
 private:
   net::QuicSimpleServer *server;
+  std::unique_ptr<net::QuicHttpResponseCache> m_responseCache; //!< Responses served by server
+  std::unique_ptr<ConnectionTracer> m_connectionTracer; //!< Observer of the dispatcher
 };
 
 } // namespace ns3
@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/enum.h"
+#include "quic-transport-config.h"
+
+#include "net/quic/core/quic_config.h"
+#include "net/quic/core/quic_constants.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+Ptr<const AttributeChecker>
+MakeQuicCongestionControlChecker (void)
+{
+  return MakeEnumChecker (QUIC_CC_DEFAULT, "Default",
+                          QUIC_CC_CUBIC, "Cubic",
+                          QUIC_CC_CUBIC_BYTES, "CubicBytes",
+                          QUIC_CC_RENO, "Reno",
+                          QUIC_CC_RENO_BYTES, "RenoBytes",
+                          QUIC_CC_BBR, "BBR",
+                          QUIC_CC_PCC, "PCC");
+}
+
+void
+QuicTransportConfig::Apply (net::QuicConfig *config) const
+{
+  switch (congestionControl)
+    {
+    case QUIC_CC_CUBIC:
+      config->set_congestion_control_type (net::kCubic);
+      break;
+    case QUIC_CC_CUBIC_BYTES:
+      config->set_congestion_control_type (net::kCubicBytes);
+      break;
+    case QUIC_CC_RENO:
+      config->set_congestion_control_type (net::kReno);
+      break;
+    case QUIC_CC_RENO_BYTES:
+      config->set_congestion_control_type (net::kRenoBytes);
+      break;
+    case QUIC_CC_BBR:
+      config->set_congestion_control_type (net::kBBR);
+      break;
+    case QUIC_CC_PCC:
+      config->set_congestion_control_type (net::kPCC);
+      break;
+    default:
+      break;
+    }
+  config->set_initial_congestion_window (initialCongestionWindow);
+  config->set_max_congestion_window (maxCongestionWindow);
+  config->set_pacing_enabled (pacing);
+
+  // The client and the server fill in windows still at the minimum with
+  // their own defaults when they initialize.
+  if (streamFlowControlWindow > 0)
+    {
+      config->SetInitialStreamFlowControlWindowToSend (
+        std::max<uint32_t> (streamFlowControlWindow,
+                            net::kMinimumFlowControlSendWindow));
+    }
+  if (sessionFlowControlWindow > 0)
+    {
+      config->SetInitialSessionFlowControlWindowToSend (
+        std::max<uint32_t> (sessionFlowControlWindow,
+                            net::kMinimumFlowControlSendWindow));
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2017 CCSL IME-USP
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUIC_TRANSPORT_CONFIG_H
+#define QUIC_TRANSPORT_CONFIG_H
+
+#include "ns3/attribute.h"
+#include "ns3/ptr.h"
+
+#include <stdint.h>
+
+namespace net {
+  class QuicConfig;
+}
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * Congestion controllers of a QUIC endpoint.
+ */
+enum QuicCongestionControl
+{
+  QUIC_CC_DEFAULT,      //!< Whatever the connection options select
+  QUIC_CC_CUBIC,        //!< net::kCubic
+  QUIC_CC_CUBIC_BYTES,  //!< net::kCubicBytes
+  QUIC_CC_RENO,         //!< net::kReno
+  QUIC_CC_RENO_BYTES,   //!< net::kRenoBytes
+  QUIC_CC_BBR,          //!< net::kBBR
+  QUIC_CC_PCC           //!< net::kPCC
+};
+
+/**
+ * \return the checker of QuicCongestionControl attributes, with the names
+ * Default, Cubic, CubicBytes, Reno, RenoBytes, BBR and PCC
+ */
+Ptr<const AttributeChecker> MakeQuicCongestionControlChecker (void);
+
+/**
+ * \ingroup applications
+ *
+ * \brief Transport settings of the connections of a QuicClient or a
+ * QuicServer.
+ *
+ * They only affect the endpoint they are set on: each end of a connection
+ * picks its own congestion controller and windows, and advertises its own
+ * receive windows to the peer. Zero keeps the default of a setting.
+ */
+struct QuicTransportConfig
+{
+  QuicCongestionControl congestionControl; //!< Congestion controller
+  uint32_t initialCongestionWindow;        //!< Packets, 0 for the default
+  uint32_t maxCongestionWindow;            //!< Packets, 0 for the default
+  uint32_t streamFlowControlWindow;        //!< Bytes, 0 for the default
+  uint32_t sessionFlowControlWindow;       //!< Bytes, 0 for the default
+  bool pacing;                             //!< Whether packets are paced
+
+  /**
+   * \brief Store the settings in \p config, before the connections using
+   * it are created.
+   *
+   * Flow control windows below kMinimumFlowControlSendWindow are raised to
+   * it.
+   *
+   * \param config the config of the client or the server
+   */
+  void Apply (net::QuicConfig *config) const;
+};
+
+} // namespace ns3
+
+#endif /* QUIC_TRANSPORT_CONFIG_H */
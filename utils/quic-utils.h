@@ -1,4 +1,9 @@
 #include "quic-client-helper.h"
 #include "quic-client.h"
+#include "quic-connection-summary.h"
+#include "quic-profiler.h"
+#include "quic-quantile-sketch.h"
+#include "quic-results-writer.h"
 #include "quic-server-helper.h"
 #include "quic-server.h"
+#include "quic-transport-config.h"